@@ -37,6 +37,15 @@ ifeq ($(HAVE_BOOST), 1)
 HAL_COMMON_CFLAGS := $(HAL_COMMON_CFLAGS) -DHAVE_BOOST
 endif
 
+# Per-stage CPU time accounting of the audio path, compiled out unless enabled.
+AUDIO_CPU_COST_ACCOUNTING ?= 0
+ifeq ($(AUDIO_CPU_COST_ACCOUNTING), 1)
+HAL_COMMON_CFLAGS := $(HAL_COMMON_CFLAGS) -DAUDIO_CPU_COST_ACCOUNTING
+endif
+
+# Forwards the audio trace points to atrace on target, in addition to their own buffers.
+AUDIO_TRACE_ATRACE := 0
+
 HAL_COMMON_CFLAGS := $(HAL_COMMON_CFLAGS) \
     -Wall -Werror -Wextra -Wno-unused-parameter -Wno-unused-function
 
@@ -54,6 +63,8 @@ SUBDIRS := audio_conversion \
            hardware_device \
            utilities/active_value_set \
            utilities/parameter \
+           utilities/telemetry \
+           utilities/trace \
            utilities \
            uevent_emulation
 
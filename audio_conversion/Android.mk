@@ -48,7 +48,8 @@ component_includes_dir_target := \
 
 component_static_lib := \
     libsamplespec_static \
-    libaudio_comms_utilities
+    libaudio_comms_utilities \
+    libaudio_hal_utilities
 
 component_static_lib_host += \
     $(foreach lib, $(component_static_lib), $(lib)_host)
@@ -120,10 +121,14 @@ component_fcttest_c_includes := \
     external/tinyalsa/include \
     frameworks/av/include/media
 
+# The test checks the CPU costs accounted by the library only if it was built to account them
+component_fcttest_defines := $(filter -DAUDIO_CPU_COST_ACCOUNTING, $(component_cflags))
+
 # Other Lib
 component_fcttest_static_lib := \
     libsamplespec_static \
     libaudio_comms_utilities \
+    libaudio_hal_utilities \
     libaudioconversion_static
 
 # Compile macro
@@ -19,6 +19,7 @@
 #include <SampleSpec.hpp>
 #include <media/AudioBufferProvider.h>
 #include <AudioNonCopyable.hpp>
+#include <CpuCost.hpp>
 #include <list>
 
 namespace intel_audio
@@ -105,6 +106,24 @@ public:
                                          const size_t outFrames,
                                          android::AudioBufferProvider *bufferProvider);
 
+    /** @return CPU time spent in the whole conversion chain. */
+    const CpuCost &getCpuCost() const { return mCpuCost; }
+
+    /**
+     * Gets the CPU time spent in a converter of the chain.
+     *
+     * @param[in] sampleSpecItem on which the converter is working.
+     *
+     * @return CPU cost of the converter.
+     */
+    const CpuCost &getConverterCpuCost(SampleSpecItem sampleSpecItem) const;
+
+    /** @return name of the converter working on a sample spec item. */
+    static const char *getConverterName(SampleSpecItem sampleSpecItem);
+
+    /** Clears the CPU cost of the chain and of its converters. */
+    void resetCpuCost();
+
 private:
     /**
      * This function pushes the converter to the list.
@@ -234,5 +253,7 @@ private:
      * Multiplication factor used to allocate a big enough conversion buffer.
      */
     static const uint32_t mAllocBufferMultFactor;
+
+    CpuCost mCpuCost; /**< CPU time spent in convert, whatever the converters. */
 };
 }  // namespace intel_audio
@@ -63,6 +63,27 @@ AudioConversion::~AudioConversion()
     mConvOutBuffer = NULL;
 }
 
+const CpuCost &AudioConversion::getConverterCpuCost(SampleSpecItem sampleSpecItem) const
+{
+    return mAudioConverter[sampleSpecItem]->getCpuCost();
+}
+
+const char *AudioConversion::getConverterName(SampleSpecItem sampleSpecItem)
+{
+    static const char *const converterNames[NbSampleSpecItems] = {
+        "remapper", "reformatter", "resampler"
+    };
+    return converterNames[sampleSpecItem];
+}
+
+void AudioConversion::resetCpuCost()
+{
+    mCpuCost.reset();
+    for (int i = 0; i < NbSampleSpecItems; i++) {
+        mAudioConverter[i]->getCpuCost().reset();
+    }
+}
+
 bool AudioConversion::supportConversion(const SampleSpec &ssSrc, const SampleSpec &ssDst)
 {
     return supportReformat(ssSrc.getFormat(), ssDst.getFormat()) &&
@@ -251,6 +272,7 @@ status_t AudioConversion::convert(const void *src,
         Log::Error() << __FUNCTION__ << ": NULL source buffer";
         return BAD_VALUE;
     }
+    AUDIO_CPU_COST_SCOPE(mCpuCost);
     const void *srcBuf = src;
     void *dstBuf = NULL;
     size_t srcFrames = inFrames;
@@ -286,7 +308,10 @@ status_t AudioConversion::convert(const void *src,
             // Last converter must output within the provided buffer (if provided!!!)
             dstBuf = *dst;
         }
-        status = pConv->convert(srcBuf, &dstBuf, srcFrames, &dstFrames);
+        {
+            AUDIO_CPU_COST_SCOPE(pConv->getCpuCost());
+            status = pConv->convert(srcBuf, &dstBuf, srcFrames, &dstFrames);
+        }
         if (status != NO_ERROR) {
 
             return status;
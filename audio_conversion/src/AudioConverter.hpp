@@ -19,6 +19,7 @@
 
 #include <SampleSpec.hpp>
 #include <AudioNonCopyable.hpp>
+#include <CpuCost.hpp>
 #include <utils/Errors.h>
 
 using audio_comms::utilities::NonCopyable;
@@ -88,6 +89,10 @@ public:
                                       size_t inFrames,
                                       size_t *outFrames);
 
+    /** @return CPU time spent converting, accounted by the conversion chain. */
+    CpuCost &getCpuCost() { return mCpuCost; }
+    const CpuCost &getCpuCost() const { return mCpuCost; }
+
 protected:
     /**
      * Converts the number of frames in the destination sample spec in a number of frames in the
@@ -142,5 +147,7 @@ private:
     size_t mConvertBufSize; /**< Size of the internal memory allocated. */
 
     SampleSpecItem mSampleSpecItem; /**< Sample spec item on which the converter is working. */
+
+    CpuCost mCpuCost;
 };
 }  // namespace intel_audio
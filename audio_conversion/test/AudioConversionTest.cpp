@@ -728,6 +728,39 @@ TEST(AudioConversion, memoryTest)
     delete audioConversion;
 }
 
+#if defined(AUDIO_CPU_COST_ACCOUNTING)
+/**
+ * Test the reset of the CPU costs of the chain and of its converters.
+ * The costs are only accounted if the build enables the accounting.
+ */
+TEST(AudioConversion, cpuCostReset)
+{
+    const SampleSpec sampleSpecSrc(2, AUDIO_FORMAT_PCM_16_BIT, 48000);
+    const SampleSpec sampleSpecDst(1, AUDIO_FORMAT_PCM_16_BIT, 48000);
+
+    AudioConversion audioConversion;
+    EXPECT_EQ(0, audioConversion.configure(sampleSpecSrc, sampleSpecDst));
+
+    const uint16_t sourceBuf[] = {
+        10, 20, 5, 1, 3, 8, 12, 15
+    };
+    uint16_t dstBuf[4];
+    uint16_t *dst = dstBuf;
+    size_t dstFrames = 0;
+    EXPECT_EQ(0, audioConversion.convert(sourceBuf, reinterpret_cast<void **>(&dst), 4,
+                                         &dstFrames));
+    EXPECT_EQ(1u, audioConversion.getCpuCost().getCalls());
+    EXPECT_EQ(1u, audioConversion.getConverterCpuCost(ChannelCountSampleSpecItem).getCalls());
+
+    audioConversion.resetCpuCost();
+    EXPECT_EQ(0u, audioConversion.getCpuCost().getCalls());
+    EXPECT_EQ(0u, audioConversion.getCpuCost().getCpuTimeNs());
+    const CpuCost &remapCost = audioConversion.getConverterCpuCost(ChannelCountSampleSpecItem);
+    EXPECT_EQ(0u, remapCost.getCalls());
+    EXPECT_EQ(0u, remapCost.getMaxCpuTimeNs());
+}
+#endif
+
 /**
  * Test a configure for every couple of source and destination frequency rates
  * usually used.
@@ -21,7 +21,10 @@ LOCAL_PATH := $(call my-dir)
 #######################################################################
 # Common variables
 
-component_src_files := HalAudioDump.cpp
+component_src_files := \
+    AudioFlightRecorder.cpp \
+    HalAudioDump.cpp \
+    HalAudioDumpWriter.cpp
 
 component_cflags := $(HAL_COMMON_CFLAGS)
 
@@ -82,3 +85,34 @@ LOCAL_STATIC_LIBRARIES := $(component_static_lib_host)
 
 include $(BUILD_HOST_STATIC_LIBRARY)
 endif
+
+#######################################################################
+# Component Host Unit Test
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := halaudiodump_unit_test_host
+LOCAL_MODULE_OWNER := intel
+
+LOCAL_SRC_FILES := \
+    test/AudioFlightRecorderTest.cpp \
+    test/HalAudioDumpTest.cpp
+
+LOCAL_C_INCLUDES := \
+    $(component_includes_dir_host) \
+    external/gtest/include
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -O0 -ggdb
+LOCAL_MODULE_TAGS := optional
+LOCAL_STRIP_MODULE := false
+
+LOCAL_STATIC_LIBRARIES := \
+    libhalaudiodump_host \
+    $(component_static_lib_host) \
+    libgtest_host \
+    libgtest_main_host
+
+LOCAL_LDFLAGS += -lpthread -lrt
+
+include $(BUILD_HOST_EXECUTABLE)
+endif
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AudioFlightRecorder"
+
+#include "AudioFlightRecorder.hpp"
+#include "WavHeader.hpp"
+#include <utilities/Log.hpp>
+#include <algorithm>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace android;
+using namespace std;
+using audio_comms::utilities::Log;
+
+const char *const AudioFlightRecorder::mExportDirPathDefault = "/data/misc/audioserver";
+
+const char *const AudioFlightRecorder::mStageNames[NbStages] = {
+    "client_write", "pcm_write", "pcm_read", "client_read"
+};
+
+/** Bytes per second of the reference format sizing the stage buffers: 48 kHz stereo 16 bits. */
+static const size_t gReferenceByteRate = 48000 * 2 * sizeof(int16_t);
+
+/** Delay between two checks of the audio thread leaving the buffers. */
+static const useconds_t gBusyPollUs = 100;
+
+static size_t roundUpToPowerOf2(size_t value)
+{
+    size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+AudioFlightRecorder::AudioFlightRecorder(const std::string &name, bool isOutput,
+                                         uint32_t seconds, uint32_t xrunThreshold,
+                                         const char *exportDirPath)
+    : mName(name),
+      mIsOutput(isOutput),
+      mXrunThreshold(max(xrunThreshold, 1u)),
+      mExportDirPath(exportDirPath),
+      mFrozen(false),
+      mBusy(0),
+      mExportPending(false),
+      mExportOnXrun(false),
+      mFreezeTimeNs(0),
+      mPendingXruns(0),
+      mLastXrunExportNs(0),
+      mRecordedBytes(0),
+      mSkippedWrites(0),
+      mTruncatedWrites(0),
+      mXrunCount(0),
+      mExportCount(0),
+      mExportErrors(0)
+{
+    static const Stage outputStages[] = { ClientWrite, PcmWrite };
+    static const Stage inputStages[] = { PcmRead, ClientRead };
+    const Stage *stages = isOutput ? outputStages : inputStages;
+    size_t capacity = roundUpToPowerOf2(max<size_t>(seconds, 1) * gReferenceByteRate);
+    for (size_t i = 0; i < 2; i++) {
+        Track &track = mTracks[stages[i]];
+        track.samples.resize(capacity);
+        track.entries.resize(mMaxEntries);
+    }
+    for (Track &track : mTracks) {
+        track.position = 0;
+        track.entryCount = 0;
+    }
+    HalAudioDumpWriter::getInstance().add(*this);
+}
+
+AudioFlightRecorder::~AudioFlightRecorder()
+{
+    HalAudioDumpWriter::getInstance().remove(*this);
+    onWriterWakeUp();
+}
+
+void AudioFlightRecorder::record(Stage stage, const void *buffer, size_t bytes,
+                                 uint32_t sampleRate, uint32_t channels,
+                                 uint32_t bytesPerSample)
+{
+    if (stage >= NbStages || buffer == NULL || bytes == 0) {
+        return;
+    }
+    Track &track = mTracks[stage];
+    size_t capacity = track.samples.size();
+    if (capacity == 0) {
+        return;
+    }
+    // Paired with the exporting thread: either it sees the copy in progress and waits for it,
+    // or this thread sees the freeze and leaves the buffers as they are.
+    mBusy.fetch_add(1);
+    if (mFrozen.load()) {
+        mBusy.fetch_sub(1, memory_order_release);
+        mSkippedWrites.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    const uint8_t *src = static_cast<const uint8_t *>(buffer);
+    size_t recorded = bytes;
+    if (bytes > capacity) {
+        // Keep the end of the buffer, on a frame boundary.
+        size_t frameSize = max<size_t>(channels * bytesPerSample, 1);
+        recorded = capacity - capacity % frameSize;
+        src += bytes - recorded;
+        mTruncatedWrites.fetch_add(1, memory_order_relaxed);
+    }
+    size_t offset = track.position & (capacity - 1);
+    size_t first = min(recorded, capacity - offset);
+    memcpy(&track.samples[offset], src, first);
+    memcpy(&track.samples[0], src + first, recorded - first);
+
+    Entry &entry = track.entries[track.entryCount & (mMaxEntries - 1)];
+    entry.timeNs = getMonotonicNs();
+    entry.position = track.position;
+    entry.bytes = recorded;
+    entry.sampleRate = sampleRate;
+    entry.channels = channels;
+    entry.bytesPerSample = bytesPerSample;
+    track.position += recorded;
+    track.entryCount++;
+    mBusy.fetch_sub(1, memory_order_release);
+
+    mRecordedBytes.fetch_add(recorded, memory_order_relaxed);
+}
+
+void AudioFlightRecorder::onXrun()
+{
+    mXrunCount.fetch_add(1, memory_order_relaxed);
+    if (++mPendingXruns < mXrunThreshold) {
+        return;
+    }
+    int64_t now = getMonotonicNs();
+    if (mLastXrunExportNs != 0 && now - mLastXrunExportNs < mXrunHoldOffNs) {
+        return;
+    }
+    bool frozen = false;
+    if (!mFrozen.compare_exchange_strong(frozen, true)) {
+        // Already being exported.
+        return;
+    }
+    mLastXrunExportNs = now;
+    mPendingXruns = 0;
+    mFreezeTimeNs = now;
+    mExportOnXrun.store(true, memory_order_relaxed);
+    mExportPending.store(true, memory_order_release);
+}
+
+void AudioFlightRecorder::requestExport()
+{
+    bool frozen = false;
+    if (!mFrozen.compare_exchange_strong(frozen, true)) {
+        return;
+    }
+    mFreezeTimeNs = getMonotonicNs();
+    mExportOnXrun.store(false, memory_order_relaxed);
+    mExportPending.store(true, memory_order_release);
+}
+
+void AudioFlightRecorder::flush()
+{
+    HalAudioDumpWriter::getInstance().flush(*this);
+}
+
+void AudioFlightRecorder::onWriterWakeUp()
+{
+    if (mExportPending.load(memory_order_acquire)) {
+        exportTracks();
+    }
+}
+
+void AudioFlightRecorder::exportTracks()
+{
+    while (mBusy.load() != 0) {
+        usleep(gBusyPollUs);
+    }
+    if (mkdir(mExportDirPath.c_str(), S_IRWXU | S_IRGRP | S_IROTH) != 0 && errno != EEXIST) {
+        Log::Error() << __FUNCTION__ << ": Cannot create directory " << mExportDirPath
+                     << " : " << strerror(errno);
+    }
+    uint32_t slot = mExportCount.load(memory_order_relaxed) % mMaxExports + 1;
+    for (size_t stage = 0; stage < NbStages; stage++) {
+        if (exportTrack(static_cast<Stage>(stage), slot) != OK) {
+            mExportErrors.fetch_add(1, memory_order_relaxed);
+        }
+    }
+    Log::Info() << __FUNCTION__ << ": flight recorder " << mName << " exported on "
+                << (mExportOnXrun.load(memory_order_relaxed) ? "xrun" : "request")
+                << " in slot " << slot;
+    mExportCount.fetch_add(1, memory_order_relaxed);
+    mExportPending.store(false, memory_order_relaxed);
+    mFrozen.store(false);
+}
+
+status_t AudioFlightRecorder::exportTrack(Stage stage, uint32_t slot)
+{
+    const Track &track = mTracks[stage];
+    if (track.entryCount == 0) {
+        return OK;
+    }
+    size_t capacity = track.samples.size();
+    size_t entryMask = mMaxEntries - 1;
+    uint64_t oldestPosition = track.position > capacity ? track.position - capacity : 0;
+    uint64_t oldestEntry = track.entryCount > mMaxEntries ? track.entryCount - mMaxEntries : 0;
+
+    // Walk back the writes still in the buffer, as long as the format does not change.
+    const Entry &last = track.entries[(track.entryCount - 1) & entryMask];
+    uint64_t firstEntry = track.entryCount - 1;
+    while (firstEntry > oldestEntry) {
+        const Entry &previous = track.entries[(firstEntry - 1) & entryMask];
+        if (previous.position < oldestPosition || previous.sampleRate != last.sampleRate ||
+            previous.channels != last.channels ||
+            previous.bytesPerSample != last.bytesPerSample) {
+            break;
+        }
+        firstEntry--;
+    }
+    uint64_t start = track.entries[firstEntry & entryMask].position;
+    uint32_t dataBytes = track.position - start;
+
+    string baseName = mExportDirPath + "/flight_" + mName + "_" + mStageNames[stage] + "_" +
+                      to_string(slot);
+    string wavName = baseName + ".wav";
+    FILE *file = fopen(wavName.c_str(), "wb");
+    if (file == NULL) {
+        Log::Error() << __FUNCTION__ << ": Cannot open " << wavName << ": " << strerror(errno);
+        return UNKNOWN_ERROR;
+    }
+    uint8_t wavHeader[WavHeader::mSize];
+    WavHeader::fill(wavHeader, last.sampleRate, last.channels, last.bytesPerSample, dataBytes);
+    size_t offset = start & (capacity - 1);
+    size_t first = min<size_t>(dataBytes, capacity - offset);
+    bool written = fwrite(wavHeader, sizeof(wavHeader), 1, file) == 1 &&
+                   fwrite(&track.samples[offset], 1, first, file) == first &&
+                   fwrite(&track.samples[0], 1, dataBytes - first, file) == dataBytes - first;
+    written = (fclose(file) == 0) && written;
+    if (!written) {
+        Log::Error() << __FUNCTION__ << ": Cannot write " << wavName << ": " << strerror(errno);
+        return UNKNOWN_ERROR;
+    }
+
+    // Index of the writes, to relate the samples to the time of the glitch.
+    string indexName = baseName + ".txt";
+    file = fopen(indexName.c_str(), "w");
+    if (file == NULL) {
+        Log::Error() << __FUNCTION__ << ": Cannot open " << indexName << ": " << strerror(errno);
+        return UNKNOWN_ERROR;
+    }
+    fprintf(file, "# %s %s frozen at %lld ns on %s, %u Hz, %u ch, %u bytes per sample\n",
+            mName.c_str(), mStageNames[stage], static_cast<long long>(mFreezeTimeNs),
+            mExportOnXrun.load(memory_order_relaxed) ? "xrun" : "request", last.sampleRate,
+            last.channels, last.bytesPerSample);
+    fprintf(file, "# time_ns offset_bytes bytes\n");
+    for (uint64_t index = firstEntry; index < track.entryCount; index++) {
+        const Entry &entry = track.entries[index & entryMask];
+        fprintf(file, "%lld %llu %u\n", static_cast<long long>(entry.timeNs),
+                static_cast<unsigned long long>(entry.position - start), entry.bytes);
+    }
+    if (ferror(file) || fclose(file) != 0) {
+        Log::Error() << __FUNCTION__ << ": Cannot write " << indexName;
+        return UNKNOWN_ERROR;
+    }
+    return OK;
+}
+
+int64_t AudioFlightRecorder::getMonotonicNs()
+{
+    // Served by the vDSO, no syscall on the audio thread.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+AudioFlightRecorder::Stats AudioFlightRecorder::getStats() const
+{
+    Stats stats;
+    stats.recordedBytes = mRecordedBytes.load(memory_order_relaxed);
+    stats.skippedWrites = mSkippedWrites.load(memory_order_relaxed);
+    stats.truncatedWrites = mTruncatedWrites.load(memory_order_relaxed);
+    stats.xrunCount = mXrunCount.load(memory_order_relaxed);
+    stats.exportCount = mExportCount.load(memory_order_relaxed);
+    stats.exportErrors = mExportErrors.load(memory_order_relaxed);
+    return stats;
+}
+
+status_t AudioFlightRecorder::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    string result;
+    Stats stats = getStats();
+    size_t capacity = mTracks[mIsOutput ? ClientWrite : PcmRead].samples.size();
+
+    snprintf(buffer, SIZE, "%*sFlight recorder %s: %zu KB per stage, %u xrun(s), "
+             "%u export(s), %u error(s)\n",
+             spaces, "", mName.c_str(), capacity / 1024, stats.xrunCount, stats.exportCount,
+             stats.exportErrors);
+    result.append(buffer);
+    snprintf(buffer, SIZE, "%*srecorded %llu bytes, %u write(s) skipped while frozen, "
+             "%u truncated\n",
+             spaces + 4, "", static_cast<unsigned long long>(stats.recordedBytes),
+             stats.skippedWrites, stats.truncatedWrites);
+    result.append(buffer);
+    write(fd, result.c_str(), result.size());
+    return OK;
+}
@@ -17,7 +17,11 @@
 #define LOG_TAG "HALAudioDump"
 
 #include "HalAudioDump.hpp"
+#include "HalAudioDumpWriter.hpp"
+#include "WavHeader.hpp"
 #include <utilities/Log.hpp>
+#include <algorithm>
+#include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -31,23 +35,46 @@ using audio_comms::utilities::Log;
 const char *HalAudioDump::mStreamDirections[] = {
     "in", "out"
 };
-const char *HalAudioDump::mDumpDirPath = "/data/misc/audioserver";
+const char *HalAudioDump::mDumpDirPathDefault = "/data/misc/audioserver";
 const uint32_t HalAudioDump::mMaxNumberOfFiles = 4;
 
 HalAudioDump::HalAudioDump()
-    : mDumpFile(0), mFileCount(0)
+    : HalAudioDump(mDumpDirPathDefault, mMaxDumpFileSize)
 {
-    if (mkdir(mDumpDirPath, S_IRWXU | S_IRGRP | S_IROTH) != 0) {
+}
+
+HalAudioDump::HalAudioDump(const char *dumpDirPath, uint32_t maxFileSize)
+    : mRing(mRingSize),
+      mRingMask(mRingSize - 1),
+      mWriteIndex(0),
+      mReadIndex(0),
+      mHasContext(false),
+      mPushedBytes(0),
+      mDroppedBytes(0),
+      mDroppedWrites(0),
+      mMaxFill(0),
+      mDumpDirPath(dumpDirPath),
+      mMaxFileSize(maxFileSize),
+      mDumpFile(NULL),
+      mFileFormat(),
+      mFileBytes(0),
+      mFileCount(0),
+      mWrittenBytes(0),
+      mOpenedFiles(0),
+      mWriteErrors(0)
+{
+    if (mkdir(mDumpDirPath.c_str(), S_IRWXU | S_IRGRP | S_IROTH) != 0 && errno != EEXIST) {
         Log::Error() << "Cannot create audio dumps directory at " << mDumpDirPath
                      << " : " << strerror(errno);
     }
+    HalAudioDumpWriter::getInstance().add(*this);
 }
 
 HalAudioDump::~HalAudioDump()
 {
-    if (mDumpFile) {
-        close();
-    }
+    HalAudioDumpWriter::getInstance().remove(*this);
+    drain();
+    closeDumpFile();
 }
 
 void HalAudioDump::dumpAudioSamples(const void *buffer,
@@ -55,87 +82,167 @@ void HalAudioDump::dumpAudioSamples(const void *buffer,
                                     bool isOutput,
                                     uint32_t sRate,
                                     uint32_t chNb,
-                                    const std::string &nameContext)
+                                    const std::string &nameContext,
+                                    uint32_t bytesPerSample)
 {
-    status_t write_status;
+    if (buffer == NULL || bytes <= 0) {
+        return;
+    }
+    if (!mHasContext.load(std::memory_order_relaxed)) {
+        mNameContext = nameContext;
+        mHasContext.store(true, std::memory_order_release);
+    }
+    size_t recordSize = sizeof(RecordHeader) + bytes;
+    size_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+    size_t used = writeIndex - mReadIndex.load(std::memory_order_acquire);
+    if (recordSize > mRing.size() - used) {
+        // The writer does not keep up: drop rather than stall the audio thread
+        mDroppedWrites.fetch_add(1, std::memory_order_relaxed);
+        mDroppedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        return;
+    }
+    RecordHeader header;
+    header.bytes = bytes;
+    header.sampleRate = sRate;
+    header.channels = chNb;
+    header.bytesPerSample = bytesPerSample;
+    header.isOutput = isOutput;
+    writeRing(writeIndex, &header, sizeof(header));
+    writeRing(writeIndex + sizeof(header), buffer, bytes);
+    mWriteIndex.store(writeIndex + recordSize, std::memory_order_release);
 
-    if (mDumpFile == NULL) {
-        char *audio_file_name;
-
-        /**
-         * A new dump file is created for each stream relevant to the dump needs
-         */
-        asprintf(&audio_file_name,
-                 "%s/audio_%s_%dKhz_%dch_%s_%d.pcm",
-                 mDumpDirPath,
-                 streamDirectionStr(isOutput),
-                 sRate,
-                 chNb,
-                 nameContext.c_str(),
-                 ++mFileCount);
-
-        if (!audio_file_name) {
-            return;
-        }
-
-        mDumpFile = fopen(audio_file_name, "wb");
-
-        if (mDumpFile == NULL) {
-            Log::Error() << __FUNCTION__
-                         << ": Cannot open dump file " << audio_file_name
-                         << " errno " << errno << ", reason: " << strerror(errno);
-            free(audio_file_name);
-            return;
-        }
-        Log::Info() << __FUNCTION__
-                    << ": Audio " << streamDirectionStr(isOutput)
-                    << "put stream dump file " << audio_file_name
-                    << ", fh " << mDumpFile << " opened.";
-        free(audio_file_name);
+    mPushedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    uint32_t fill = (used + recordSize) * 100 / mRing.size();
+    if (fill > mMaxFill.load(std::memory_order_relaxed)) {
+        mMaxFill.store(fill, std::memory_order_relaxed);
     }
+}
 
-    write_status = writeDumpFile(buffer, bytes);
+void HalAudioDump::close()
+{
+    HalAudioDumpWriter::getInstance().flush(*this);
+}
 
-    if (write_status == BAD_VALUE) {
+void HalAudioDump::writeRing(size_t index, const void *src, size_t bytes)
+{
+    size_t offset = index & mRingMask;
+    size_t first = min(bytes, mRing.size() - offset);
+    memcpy(&mRing[offset], src, first);
+    memcpy(&mRing[0], static_cast<const uint8_t *>(src) + first, bytes - first);
+}
+
+void HalAudioDump::readRing(size_t index, void *dst, size_t bytes) const
+{
+    size_t offset = index & mRingMask;
+    size_t first = min(bytes, mRing.size() - offset);
+    memcpy(dst, &mRing[offset], first);
+    memcpy(static_cast<uint8_t *>(dst) + first, &mRing[0], bytes - first);
+}
+
+void HalAudioDump::drain()
+{
+    size_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+    size_t writeIndex = mWriteIndex.load(std::memory_order_acquire);
+    while (readIndex != writeIndex) {
+        RecordHeader header;
+        readRing(readIndex, &header, sizeof(header));
+        writeRecord(header, readIndex + sizeof(header));
+        readIndex += sizeof(header) + header.bytes;
+        mReadIndex.store(readIndex, std::memory_order_release);
+    }
+    if (mDumpFile != NULL) {
+        fflush(mDumpFile);
+    }
+}
 
-        /**
-         * Max file size reached. Close file to open another one
-         * Up to 4 dump files are dumped. When 4 dump files are
-         * reached the last file is reused circularly.
-         */
-        close();
+void HalAudioDump::writeRecord(const RecordHeader &header, size_t index)
+{
+    if (mDumpFile != NULL &&
+        (header.sampleRate != mFileFormat.sampleRate || header.channels != mFileFormat.channels ||
+         header.bytesPerSample != mFileFormat.bytesPerSample ||
+         mFileBytes + header.bytes > mMaxFileSize)) {
+        // Max file size reached or new format: roll on to the next file.
+        closeDumpFile();
+    }
+    if (mDumpFile == NULL && openDumpFile(header) != OK) {
+        return;
+    }
+    size_t offset = index & mRingMask;
+    size_t first = min<size_t>(header.bytes, mRing.size() - offset);
+    if (fwrite(&mRing[offset], 1, first, mDumpFile) != first ||
+        fwrite(&mRing[0], 1, header.bytes - first, mDumpFile) != header.bytes - first) {
+        Log::Error() << __FUNCTION__
+                     << ": Error writing PCM in audio dump file : " << strerror(errno);
+        mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+        closeDumpFile();
+        return;
     }
+    mFileBytes += header.bytes;
+    mWrittenBytes.fetch_add(header.bytes, std::memory_order_relaxed);
+}
 
+status_t HalAudioDump::openDumpFile(const RecordHeader &header)
+{
     /**
      * Roll on 4 files, to keep at least the last audio dumps
-     * and to split dumps for more convenience.
+     * and to split dumps for more convenience: the oldest file is overwritten.
      */
-    if (write_status == INVALID_OPERATION) {
-        char *fileToRemove;
-
-        asprintf(&fileToRemove,
-                 "%s/audio_%s_%dKhz_%dch_%s_%d.pcm",
-                 mDumpDirPath,
-                 streamDirectionStr(isOutput),
-                 sRate,
-                 chNb,
-                 nameContext.c_str(),
-                 mFileCount);
-
-        if (!fileToRemove) {
-            return;
-        }
-
-        mFileCount--;
-
-        remove(fileToRemove);
-        free(fileToRemove);
-        close();
+    char *audioFileName;
+    if (asprintf(&audioFileName,
+                 "%s/audio_%s_%dKhz_%dch_%s_%d.wav",
+                 mDumpDirPath.c_str(),
+                 streamDirectionStr(header.isOutput),
+                 header.sampleRate,
+                 header.channels,
+                 mNameContext.c_str(),
+                 mFileCount % mMaxNumberOfFiles + 1) < 0) {
+        return NO_MEMORY;
     }
+    mFileCount++;
+
+    mDumpFile = fopen(audioFileName, "wb");
+    if (mDumpFile == NULL) {
+        Log::Error() << __FUNCTION__
+                     << ": Cannot open dump file " << audioFileName
+                     << " errno " << errno << ", reason: " << strerror(errno);
+        mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+        free(audioFileName);
+        return UNKNOWN_ERROR;
+    }
+    Log::Info() << __FUNCTION__
+                << ": Audio " << streamDirectionStr(header.isOutput)
+                << "put stream dump file " << audioFileName
+                << ", fh " << mDumpFile << " opened.";
+    free(audioFileName);
+
+    mFileFormat = header;
+    mFileBytes = 0;
+    mOpenedFiles.fetch_add(1, std::memory_order_relaxed);
+
+    // Header completed with the sizes on close.
+    uint8_t wavHeader[WavHeader::mSize] = {};
+    if (fwrite(wavHeader, sizeof(wavHeader), 1, mDumpFile) != 1) {
+        mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+        fclose(mDumpFile);
+        mDumpFile = NULL;
+        return UNKNOWN_ERROR;
+    }
+    return OK;
 }
 
-void HalAudioDump::close()
+void HalAudioDump::closeDumpFile()
 {
+    if (mDumpFile == NULL) {
+        return;
+    }
+    uint8_t wavHeader[WavHeader::mSize];
+    WavHeader::fill(wavHeader, mFileFormat.sampleRate, mFileFormat.channels,
+                    mFileFormat.bytesPerSample, mFileBytes);
+    if (fseek(mDumpFile, 0, SEEK_SET) != 0 ||
+        fwrite(wavHeader, sizeof(wavHeader), 1, mDumpFile) != 1) {
+        Log::Error() << __FUNCTION__ << ": Cannot complete WAV header: " << strerror(errno);
+        mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+    }
     fclose(mDumpFile);
     mDumpFile = NULL;
 }
@@ -145,38 +252,37 @@ const char *HalAudioDump::streamDirectionStr(bool isOut) const
     return mStreamDirections[isOut];
 }
 
-status_t HalAudioDump::checkDumpFile(ssize_t bytes)
+HalAudioDump::Stats HalAudioDump::getStats() const
 {
-    struct stat stDump;
-    /** klocwork complains it may access st_size unitialized, even if fstat succeeded.
-     * This failure pattern happens when given object as output parameter by reference.
-     */
-    stDump.st_size = 0;
-    if (mDumpFile && fstat(fileno(mDumpFile), &stDump) == 0
-        && (stDump.st_size + bytes) > mMaxDumpFileSize) {
-        Log::Error() << __FUNCTION__ << ": Max size reached";
-        return BAD_VALUE;
-    }
-    if (mFileCount >= mMaxNumberOfFiles) {
-        Log::Error() << __FUNCTION__ << ": Max number of allowed files reached";
-        return INVALID_OPERATION;
-    }
-    return OK;
+    Stats stats;
+    stats.pushedBytes = mPushedBytes.load(std::memory_order_relaxed);
+    stats.droppedBytes = mDroppedBytes.load(std::memory_order_relaxed);
+    stats.droppedWrites = mDroppedWrites.load(std::memory_order_relaxed);
+    stats.maxFillPercent = mMaxFill.load(std::memory_order_relaxed);
+    stats.writtenBytes = mWrittenBytes.load(std::memory_order_relaxed);
+    stats.fileCount = mOpenedFiles.load(std::memory_order_relaxed);
+    stats.writeErrors = mWriteErrors.load(std::memory_order_relaxed);
+    return stats;
 }
 
-status_t HalAudioDump::writeDumpFile(const void *buffer, ssize_t bytes)
+status_t HalAudioDump::dump(const int fd, int spaces) const
 {
-    status_t ret;
-
-    ret = checkDumpFile(bytes);
-    if (ret != OK) {
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    string result;
+    Stats stats = getStats();
 
-        return ret;
-    }
-    if (fwrite(buffer, bytes, 1, mDumpFile) != 1) {
-        Log::Error() << __FUNCTION__
-                     << ": Error writing PCM in audio dump file : " << strerror(errno);
-        return BAD_VALUE;
-    }
+    snprintf(buffer, SIZE, "%*sAudio dump %s: %llu bytes written in %u file(s), %u error(s)\n",
+             spaces, "",
+             mHasContext.load(std::memory_order_acquire) ? mNameContext.c_str() : "(idle)",
+             static_cast<unsigned long long>(stats.writtenBytes), stats.fileCount,
+             stats.writeErrors);
+    result.append(buffer);
+    snprintf(buffer, SIZE, "%*sring: max fill %u%%, dropped %u write(s), %llu of %llu bytes\n",
+             spaces + 4, "", stats.maxFillPercent, stats.droppedWrites,
+             static_cast<unsigned long long>(stats.droppedBytes),
+             static_cast<unsigned long long>(stats.pushedBytes + stats.droppedBytes));
+    result.append(buffer);
+    write(fd, result.c_str(), result.size());
     return OK;
 }
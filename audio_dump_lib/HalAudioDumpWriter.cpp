@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "HALAudioDump"
+
+#include "HalAudioDumpWriter.hpp"
+#include <utilities/Log.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <pthread.h>
+#include <sys/resource.h>
+
+using audio_comms::utilities::Log;
+
+const int HalAudioDumpWriter::mWriterNiceness = 10;
+const int HalAudioDumpWriter::mPeriodMs = 20;
+
+HalAudioDumpWriter &HalAudioDumpWriter::getInstance()
+{
+    // Never destroyed: a detached writer thread may still be exiting at process termination.
+    static HalAudioDumpWriter *instance = new HalAudioDumpWriter();
+    return *instance;
+}
+
+void HalAudioDumpWriter::add(Client &client)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    mClients.push_back(&client);
+    if (!mIsRunning) {
+        mIsRunning = true;
+        std::thread(&HalAudioDumpWriter::run, this).detach();
+    }
+}
+
+void HalAudioDumpWriter::remove(Client &client)
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mClients.erase(std::remove(mClients.begin(), mClients.end(), &client), mClients.end());
+    }
+    mCondition.notify_all();
+}
+
+void HalAudioDumpWriter::flush(Client &client)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    client.onWriterWakeUp();
+    client.onWriterFlush();
+}
+
+void HalAudioDumpWriter::run()
+{
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), "HalAudioDump");
+#endif
+    // On Linux, the nice value is per thread.
+    if (setpriority(PRIO_PROCESS, 0, mWriterNiceness) != 0) {
+        Log::Warning() << __FUNCTION__ << ": could not lower the priority of the writer";
+    }
+    std::unique_lock<std::mutex> lock(mLock);
+    while (!mClients.empty()) {
+        for (auto client : mClients) {
+            client->onWriterWakeUp();
+        }
+        mCondition.wait_for(lock, std::chrono::milliseconds(mPeriodMs));
+    }
+    mIsRunning = false;
+}
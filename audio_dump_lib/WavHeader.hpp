@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/** Canonical PCM WAV header, i.e. RIFF, fmt and data chunk headers. */
+class WavHeader
+{
+public:
+    static const size_t mSize = 44;
+
+    /**
+     * Fills a WAV header.
+     *
+     * @param[out] header buffer of mSize bytes.
+     * @param[in] sampleRate of the samples.
+     * @param[in] channels number of channels.
+     * @param[in] bytesPerSample size of a sample of one channel.
+     * @param[in] dataBytes size of the samples following the header.
+     */
+    static void fill(uint8_t *header, uint32_t sampleRate, uint32_t channels,
+                     uint32_t bytesPerSample, uint32_t dataBytes)
+    {
+        uint32_t frameSize = channels * bytesPerSample;
+        memcpy(header, "RIFF", 4);
+        setLe32(header + 4, mSize - 8 + dataBytes);
+        memcpy(header + 8, "WAVEfmt ", 8);
+        setLe32(header + 16, 16);
+        setLe16(header + 20, 1); // PCM
+        setLe16(header + 22, channels);
+        setLe32(header + 24, sampleRate);
+        setLe32(header + 28, sampleRate * frameSize);
+        setLe16(header + 32, frameSize);
+        setLe16(header + 34, bytesPerSample * 8);
+        memcpy(header + 36, "data", 4);
+        setLe32(header + 40, dataBytes);
+    }
+
+private:
+    static void setLe16(uint8_t *dst, uint16_t value)
+    {
+        dst[0] = value & 0xff;
+        dst[1] = value >> 8;
+    }
+
+    static void setLe32(uint8_t *dst, uint32_t value)
+    {
+        setLe16(dst, value & 0xffff);
+        setLe16(dst + 2, value >> 16);
+    }
+};
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "HalAudioDumpWriter.hpp"
+#include <stdint.h>
+#include <sys/types.h>
+#include <utils/Errors.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+ * Always-on recorder of the last seconds of audio of a stream, at several stages of its path.
+ * Each stage keeps its samples and their timestamps in fixed size circular buffers, allocated
+ * once. The recorder is frozen and exported when xruns cross a threshold, or on request, so that
+ * the audio which preceded a glitch can be analysed without enabling the dumps beforehand.
+ *
+ * The audio thread only copies the samples: no lock, no allocation and no syscall. Exporting is
+ * done by the low priority writer thread of the dumps. A recorder only has a single audio thread.
+ */
+class AudioFlightRecorder : private HalAudioDumpWriter::Client
+{
+public:
+    /** Stages of the audio path. */
+    enum Stage
+    {
+        ClientWrite,  /**< Playback samples as written by the client. */
+        PcmWrite,     /**< Playback samples once converted, handed to the PCM device. */
+        PcmRead,      /**< Capture samples as read from the PCM device. */
+        ClientRead,   /**< Capture samples once converted and processed, read by the client. */
+        NbStages
+    };
+
+    struct Stats
+    {
+        uint64_t recordedBytes; /**< Bytes copied in the stage buffers. */
+        uint32_t skippedWrites; /**< Calls ignored while frozen. */
+        uint32_t truncatedWrites; /**< Calls bigger than a stage buffer, only the end is kept. */
+        uint32_t xrunCount;
+        uint32_t exportCount;
+        uint32_t exportErrors;
+    };
+
+    /**
+     * @param[in] name of the recorder, used in the name of the exported files.
+     * @param[in] isOutput direction of the stream, selects the stages to allocate.
+     * @param[in] seconds of 48 kHz stereo 16 bits audio kept per stage.
+     * @param[in] xrunThreshold number of xruns triggering an export.
+     * @param[in] exportDirPath directory of the exported files.
+     */
+    AudioFlightRecorder(const std::string &name, bool isOutput, uint32_t seconds,
+                        uint32_t xrunThreshold = mXrunThresholdDefault,
+                        const char *exportDirPath = mExportDirPathDefault);
+
+    /** Completes a pending export. */
+    ~AudioFlightRecorder();
+
+    /**
+     * Records samples of a stage, overwriting the oldest ones.
+     * Safe to call from the audio thread: bounded copy, neither blocks nor allocates.
+     *
+     * @param[in] stage of the audio path, ignored if not allocated for the direction.
+     * @param[in] buffer samples to record.
+     * @param[in] bytes size of the samples.
+     * @param[in] sampleRate of the samples.
+     * @param[in] channels number of channels.
+     * @param[in] bytesPerSample size of a sample of one channel.
+     */
+    void record(Stage stage, const void *buffer, size_t bytes, uint32_t sampleRate,
+                uint32_t channels, uint32_t bytesPerSample);
+
+    /**
+     * Accounts an xrun of the stream. Freezes the recorder and schedules its export once the
+     * threshold is crossed, unless an export happened within the hold-off period.
+     * Safe to call from the audio thread.
+     */
+    void onXrun();
+
+    /** Freezes the recorder and schedules its export, whatever the xruns. */
+    void requestExport();
+
+    /** Completes a pending export, serialized with the writer thread. */
+    void flush();
+
+    Stats getStats() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+private:
+    /** Write of the audio thread, in the entry ring of a stage. */
+    struct Entry
+    {
+        int64_t timeNs; /**< Monotonic time of the write. */
+        uint64_t position; /**< Position in the stage of the first recorded byte. */
+        uint32_t bytes;
+        uint32_t sampleRate;
+        uint16_t channels;
+        uint16_t bytesPerSample;
+    };
+
+    /**
+     * Buffers of a stage. Written by the audio thread while not frozen, read by the writer
+     * thread only while frozen.
+     */
+    struct Track
+    {
+        std::vector<uint8_t> samples;
+        std::vector<Entry> entries;
+        uint64_t position; /**< Bytes recorded since creation. */
+        uint64_t entryCount; /**< Entries recorded since creation. */
+    };
+
+    /** From HalAudioDumpWriter::Client */
+    virtual void onWriterWakeUp();
+
+    /** Waits for the audio thread to leave the buffers, then exports them and unfreezes. */
+    void exportTracks();
+
+    /**
+     * Exports the samples of a stage, as a WAV file and a text index of the writes.
+     * Only the latest writes sharing the format of the last one are exported.
+     *
+     * @param[in] stage to export.
+     * @param[in] slot of the rotation of the exported files.
+     *
+     * @return OK if exported or empty, error code otherwise.
+     */
+    android::status_t exportTrack(Stage stage, uint32_t slot);
+
+    static int64_t getMonotonicNs();
+
+    const std::string mName;
+    const bool mIsOutput;
+    const uint32_t mXrunThreshold;
+    const std::string mExportDirPath;
+    Track mTracks[NbStages];
+
+    /* Handshake of the audio thread and the exporting thread. */
+    std::atomic<bool> mFrozen;
+    std::atomic<uint32_t> mBusy; /**< Set while the audio thread copies to the buffers. */
+    std::atomic<bool> mExportPending;
+    std::atomic<bool> mExportOnXrun; /**< Reason of the pending export. */
+    int64_t mFreezeTimeNs; /**< Set before scheduling the export. */
+
+    /* Xrun accounting, owned by the audio thread. */
+    uint32_t mPendingXruns;
+    int64_t mLastXrunExportNs;
+
+    /* Counters, relaxed: only meant for dump. */
+    std::atomic<uint64_t> mRecordedBytes;
+    std::atomic<uint32_t> mSkippedWrites;
+    std::atomic<uint32_t> mTruncatedWrites;
+    std::atomic<uint32_t> mXrunCount;
+    std::atomic<uint32_t> mExportCount;
+    std::atomic<uint32_t> mExportErrors;
+
+    static const char *const mExportDirPathDefault;
+    static const uint32_t mXrunThresholdDefault = 1;
+
+    /** Minimum delay between two exports triggered by xruns, not to flood the storage. */
+    static const int64_t mXrunHoldOffNs = 60LL * 1000 * 1000 * 1000;
+
+    /** Capacity of the entry ring of a stage, a power of 2: 10 s of 10 ms writes. */
+    static const size_t mMaxEntries = 1024;
+
+    /** Exported files are rotated on this number of slots. */
+    static const uint32_t mMaxExports = 4;
+
+    static const char *const mStageNames[NbStages];
+};
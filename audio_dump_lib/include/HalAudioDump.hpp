@@ -16,20 +16,51 @@
 
 #pragma once
 
+#include "HalAudioDumpWriter.hpp"
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/types.h>
 #include <utils/Errors.h>
+#include <atomic>
 #include <string>
+#include <vector>
 
-class HalAudioDump
+/**
+ * Dump point of the audio samples of a stream.
+ * The audio thread only copies the samples in a ring, a low priority writer thread shared by all
+ * dump points handles the file I/O, so that dumping does not change the real-time behavior of
+ * the stream being diagnosed. Samples that do not fit in the ring are dropped and counted.
+ */
+class HalAudioDump : private HalAudioDumpWriter::Client
 {
 public:
+    struct Stats
+    {
+        uint64_t pushedBytes; /**< Bytes copied in the ring. */
+        uint64_t droppedBytes; /**< Bytes dropped as the ring was full. */
+        uint32_t droppedWrites; /**< Calls that dropped their samples. */
+        uint32_t maxFillPercent; /**< Highest fill level of the ring. */
+        uint64_t writtenBytes; /**< Bytes of samples written in files. */
+        uint32_t fileCount; /**< Files opened. */
+        uint32_t writeErrors;
+    };
+
     HalAudioDump();
+
+    /**
+     * @param[in] dumpDirPath directory of the dump files.
+     * @param[in] maxFileSize in bytes of a dump file, rotated once reached.
+     */
+    HalAudioDump(const char *dumpDirPath, uint32_t maxFileSize);
+
+    /** Writes the samples still in the ring and closes the dump file. */
     ~HalAudioDump();
 
     /**
      * Dumps the raw audio samples in a file. The name of the
      * audio file contains the infos on the dump characteristics.
+     * Safe to call from the audio thread: neither blocks nor allocates, apart from the first call
+     * which latches the context name. A dump point only has a single audio thread.
      *
      * @param[in] buf const pointer the buffer to be dumped.
      * @param[in] bytes size in bytes to be written.
@@ -37,6 +68,7 @@ public:
      * @param[in] samplingRate sample rate of the stream.
      * @param[in] channelNb number of channels in the sample spec.
      * @param[in] nameContext context of the dump to be appended in the name of the dump file.
+     * @param[in] bytesPerSample size of a sample of one channel.
      *
      **/
     void dumpAudioSamples(const void *buf,
@@ -46,45 +78,96 @@ public:
                                                  // is unbound to the route manager, to
                                                  // avoid circular dependencies
                           uint32_t channelNb,
-                          const std::string &nameContext);
+                          const std::string &nameContext,
+                          uint32_t bytesPerSample = sizeof(int16_t));
 
+    /** Writes the samples still in the ring and closes the dump file. */
     void close();
 
+    Stats getStats() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
 private:
+    /** Format of the samples that follow in the ring. */
+    struct RecordHeader
+    {
+        uint32_t bytes;
+        uint32_t sampleRate;
+        uint16_t channels;
+        uint16_t bytesPerSample;
+        uint32_t isOutput;
+    };
+
     /**
-     * Returns the string of the stream direction.
+     * Moves the samples from the ring to the dump files.
+     * Called from the writer thread, or on close.
+     */
+    void drain();
+
+    /** From HalAudioDumpWriter::Client */
+    virtual void onWriterWakeUp() { drain(); }
+    virtual void onWriterFlush() { closeDumpFile(); }
+
+    /** Copy to the ring, wrapping around its end. */
+    void writeRing(size_t index, const void *src, size_t bytes);
+
+    /** Copy from the ring, wrapping around its end. */
+    void readRing(size_t index, void *dst, size_t bytes) const;
+
+    /**
+     * Opens the next dump file of the rotation, with a WAV header to complete on close.
      *
-     * @param[in] isOut true for input stream, false for input.
+     * @param[in] header format of the samples to write in the file.
      *
-     * @return direction name.
+     * @return OK if opened, error code otherwise.
      */
-    const char *streamDirectionStr(bool isOut) const;
+    android::status_t openDumpFile(const RecordHeader &header);
+
+    /** Completes the WAV header with the size of the samples, then closes the dump file. */
+    void closeDumpFile();
 
     /**
-     * Checks if dump file is ready for operation.
-     * It not only checks the validity and rights of the dump file, but also
-     * if the size will not reach the maximum allowed size.
+     * Writes the samples of a record in the dump file, rotating it once too big.
      *
-     * @param[in] bytes size expected to be written in the dump file.
-     *
-     * @return OK if ready to write, error code otherwise.
+     * @param[in] header of the record, at the read index of the ring.
+     * @param[in] index in the ring of the samples.
      */
-    android::status_t checkDumpFile(ssize_t bytes);
+    void writeRecord(const RecordHeader &header, size_t index);
 
     /**
-     * Writes the PCM samples in the dump file.
-     * Checks that file size does not exceed its maximum size.
+     * Returns the string of the stream direction.
      *
-     * @param[in] buf const pointer to the buffer to be dumped.
-     * @param[in] bytes size in bytes to be written.
+     * @param[in] isOut true for input stream, false for input.
      *
-     * @return error code.
-     **/
-    android::status_t writeDumpFile(const void *buf,
-                                    ssize_t bytes);
+     * @return direction name.
+     */
+    const char *streamDirectionStr(bool isOut) const;
 
+    /* Ring, written by the audio thread, read by the writer thread. */
+    std::vector<uint8_t> mRing;
+    size_t mRingMask;
+    std::atomic<size_t> mWriteIndex;
+    std::atomic<size_t> mReadIndex;
+    std::atomic<bool> mHasContext; /**< Set once the context name is latched. */
+    std::string mNameContext;
+
+    /* Counters of the audio thread, relaxed: only meant for dump. */
+    std::atomic<uint64_t> mPushedBytes;
+    std::atomic<uint64_t> mDroppedBytes;
+    std::atomic<uint32_t> mDroppedWrites;
+    std::atomic<uint32_t> mMaxFill;
+
+    /* Owned by the writer thread, or by the closing thread once unregistered. */
+    std::string mDumpDirPath;
+    uint32_t mMaxFileSize;
     FILE *mDumpFile;
+    RecordHeader mFileFormat; /**< Format of the samples in the opened file. */
+    uint32_t mFileBytes; /**< Bytes of samples in the opened file. */
     uint32_t mFileCount;
+    std::atomic<uint64_t> mWrittenBytes;
+    std::atomic<uint32_t> mOpenedFiles;
+    std::atomic<uint32_t> mWriteErrors;
 
     /**
      * Maximum number of files per dump instance.
@@ -99,11 +182,14 @@ private:
     /**
      * Dump directory path to store audio dump files.
      */
-    static const char *mDumpDirPath;
+    static const char *mDumpDirPathDefault;
 
     /**
      * Limit file size to about 20 MB for audio dump files
      * to avoid filling the mass storage to the brim.
      */
     static const uint32_t mMaxDumpFileSize = 20 * 1024 * 1024;
+
+    /** Ring capacity, a power of 2: about 2.7 s of 48 kHz stereo 16 bits samples. */
+    static const size_t mRingSize = 512 * 1024;
 };
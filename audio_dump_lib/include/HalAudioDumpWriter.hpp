@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/**
+ * Low priority thread performing the file I/O of the dump points, out of the audio threads.
+ * The thread runs as long as a client is registered.
+ */
+class HalAudioDumpWriter
+{
+public:
+    /** Object which file I/O is deferred to the writer thread. */
+    class Client
+    {
+    public:
+        virtual ~Client() {}
+
+        /**
+         * Perform the pending file I/O.
+         * Called periodically from the writer thread, or from flush.
+         */
+        virtual void onWriterWakeUp() = 0;
+
+        /** Complete the file I/O in progress, e.g. close the files. */
+        virtual void onWriterFlush() {}
+    };
+
+    static HalAudioDumpWriter &getInstance();
+
+    /** Register a client, starting the writer thread if needed. */
+    void add(Client &client);
+
+    /**
+     * Unregister a client. Once returned, the writer thread does not access it anymore, the
+     * caller completes its pending I/O.
+     */
+    void remove(Client &client);
+
+    /**
+     * Perform the pending I/O of a registered client then complete it, serialized with the
+     * writer thread.
+     *
+     * @param[in] client to flush.
+     */
+    void flush(Client &client);
+
+private:
+    HalAudioDumpWriter() : mIsRunning(false) {}
+
+    void run();
+
+    std::mutex mLock; /**< Protects the clients and their I/O. */
+    std::condition_variable mCondition;
+    std::vector<Client *> mClients;
+    bool mIsRunning;
+
+    static const int mWriterNiceness; /**< Below any audio thread. */
+    static const int mPeriodMs; /**< Draining period of the rings. */
+};
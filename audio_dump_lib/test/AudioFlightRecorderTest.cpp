@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AudioFlightRecorder.hpp>
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/** 10 ms of 48 kHz stereo 16 bits samples. */
+static const size_t gChunkSamples = 480 * 2;
+static const size_t gChunkBytes = gChunkSamples * sizeof(int16_t);
+
+/** 1 s stage buffer: 192000 bytes, rounded up to 256 KB. */
+static const size_t gStageBytes = 256 * 1024;
+
+/** Temporary export directory, removed with its files. */
+class ExportDir
+{
+public:
+    ExportDir()
+    {
+        char path[] = "/tmp/flightrecorderXXXXXX";
+        mPath = mkdtemp(path);
+    }
+
+    ~ExportDir()
+    {
+        DIR *dir = opendir(mPath.c_str());
+        for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                unlink((mPath + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+        rmdir(mPath.c_str());
+    }
+
+    const char *getPath() const { return mPath.c_str(); }
+
+    std::string getFile(const char *stage, uint32_t slot, const char *extension) const
+    {
+        return mPath + "/flight_test_" + stage + "_" + std::to_string(slot) + extension;
+    }
+
+private:
+    std::string mPath;
+};
+
+static std::vector<uint8_t> readFile(const std::string &fileName)
+{
+    std::vector<uint8_t> content;
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if (file == NULL) {
+        return content;
+    }
+    uint8_t buffer[4096];
+    for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        content.insert(content.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return content;
+}
+
+/** Records chunks of samples all equal to the index of the chunk, from first to last. */
+static void recordChunks(AudioFlightRecorder &recorder, AudioFlightRecorder::Stage stage,
+                         int16_t first, int16_t last)
+{
+    std::vector<int16_t> chunk(gChunkSamples);
+    for (int16_t index = first; index <= last; index++) {
+        std::fill(chunk.begin(), chunk.end(), index);
+        recorder.record(stage, &chunk[0], gChunkBytes, 48000, 2, sizeof(int16_t));
+    }
+}
+
+/** Returns the value of each sample of the exported WAV file of a stage. */
+static std::vector<int16_t> readExport(const ExportDir &dir, const char *stage, uint32_t slot)
+{
+    std::vector<uint8_t> content = readFile(dir.getFile(stage, slot, ".wav"));
+    std::vector<int16_t> samples;
+    if (content.size() < 44) {
+        return samples;
+    }
+    const int16_t *data = reinterpret_cast<const int16_t *>(&content[44]);
+    samples.assign(data, data + (content.size() - 44) / sizeof(int16_t));
+    return samples;
+}
+
+TEST(AudioFlightRecorder, exportKeepsLastSeconds)
+{
+    ExportDir dir;
+    AudioFlightRecorder recorder("test", true, 1, 1, dir.getPath());
+    // 3 s of audio, only the last 256 KB are kept
+    recordChunks(recorder, AudioFlightRecorder::ClientWrite, 0, 299);
+    recordChunks(recorder, AudioFlightRecorder::PcmWrite, 1000, 1009);
+    // Not allocated for an output
+    recordChunks(recorder, AudioFlightRecorder::PcmRead, 0, 9);
+    recorder.requestExport();
+    recorder.flush();
+
+    std::vector<int16_t> samples = readExport(dir, "client_write", 1);
+    // Only whole writes are exported
+    size_t chunks = gStageBytes / gChunkBytes;
+    ASSERT_EQ(chunks * gChunkSamples, samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        ASSERT_EQ(static_cast<int16_t>(300 - chunks + i / gChunkSamples), samples[i]);
+    }
+    samples = readExport(dir, "pcm_write", 1);
+    ASSERT_EQ(10 * gChunkSamples, samples.size());
+    EXPECT_EQ(1000, samples.front());
+    EXPECT_EQ(1009, samples.back());
+    EXPECT_NE(0, access(dir.getFile("pcm_read", 1, ".wav").c_str(), F_OK));
+
+    // One line per write, plus the 2 lines of the header
+    std::vector<uint8_t> index = readFile(dir.getFile("pcm_write", 1, ".txt"));
+    EXPECT_EQ(12, std::count(index.begin(), index.end(), '\n'));
+
+    AudioFlightRecorder::Stats stats = recorder.getStats();
+    EXPECT_EQ(1u, stats.exportCount);
+    EXPECT_EQ(0u, stats.exportErrors);
+    EXPECT_EQ(310 * gChunkBytes, stats.recordedBytes);
+}
+
+TEST(AudioFlightRecorder, xrunThresholdFreezes)
+{
+    ExportDir dir;
+    AudioFlightRecorder recorder("test", false, 1, 2, dir.getPath());
+    recordChunks(recorder, AudioFlightRecorder::PcmRead, 0, 9);
+    recorder.onXrun();
+    recordChunks(recorder, AudioFlightRecorder::PcmRead, 10, 19);
+    recorder.onXrun();
+    // Frozen until exported: the glitch is not overwritten
+    recordChunks(recorder, AudioFlightRecorder::PcmRead, 20, 29);
+    recorder.flush();
+
+    std::vector<int16_t> samples = readExport(dir, "pcm_read", 1);
+    ASSERT_EQ(20 * gChunkSamples, samples.size());
+    EXPECT_EQ(19, samples.back());
+
+    AudioFlightRecorder::Stats stats = recorder.getStats();
+    EXPECT_EQ(2u, stats.xrunCount);
+    EXPECT_EQ(1u, stats.exportCount);
+    EXPECT_EQ(10u, stats.skippedWrites);
+
+    // Within the hold-off period, xruns do not export again
+    recorder.onXrun();
+    recorder.onXrun();
+    recorder.flush();
+    EXPECT_EQ(1u, recorder.getStats().exportCount);
+    EXPECT_NE(0, access(dir.getFile("pcm_read", 2, ".wav").c_str(), F_OK));
+}
+
+TEST(AudioFlightRecorder, oversizedWriteKeepsItsEnd)
+{
+    ExportDir dir;
+    AudioFlightRecorder recorder("test", true, 1, 1, dir.getPath());
+    std::vector<int16_t> buffer(gStageBytes / sizeof(int16_t) + 6);
+    for (size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = i;
+    }
+    recorder.record(AudioFlightRecorder::ClientWrite, &buffer[0],
+                    buffer.size() * sizeof(int16_t), 48000, 2, sizeof(int16_t));
+    recorder.requestExport();
+    recorder.flush();
+
+    std::vector<int16_t> samples = readExport(dir, "client_write", 1);
+    ASSERT_EQ(gStageBytes / sizeof(int16_t), samples.size());
+    EXPECT_EQ(buffer.back(), samples.back());
+    EXPECT_EQ(1u, recorder.getStats().truncatedWrites);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <HalAudioDump.hpp>
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+/** 10 ms of 48 kHz stereo 16 bits samples. */
+static const size_t gChunkFrames = 480;
+static const size_t gChannels = 2;
+static const size_t gChunkSamples = gChunkFrames * gChannels;
+static const size_t gChunkBytes = gChunkSamples * sizeof(int16_t);
+
+/** Temporary dump directory, removed with its files. */
+class DumpDir
+{
+public:
+    DumpDir()
+    {
+        char path[] = "/tmp/halaudiodumpXXXXXX";
+        mPath = mkdtemp(path);
+    }
+
+    ~DumpDir()
+    {
+        DIR *dir = opendir(mPath.c_str());
+        for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                unlink((mPath + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+        rmdir(mPath.c_str());
+    }
+
+    const char *getPath() const { return mPath.c_str(); }
+
+    std::string getFile(uint32_t index) const
+    {
+        return mPath + "/audio_out_48000Khz_2ch_test_" + std::to_string(index) + ".wav";
+    }
+
+private:
+    std::string mPath;
+};
+
+static uint32_t getLe32(const uint8_t *src)
+{
+    return src[0] | src[1] << 8 | src[2] << 16 | static_cast<uint32_t>(src[3]) << 24;
+}
+
+static uint16_t getLe16(const uint8_t *src)
+{
+    return src[0] | src[1] << 8;
+}
+
+/**
+ * Reads a dump file, checks its WAV header and returns its chunks, each made of a single value.
+ *
+ * @param[in] fileName of the dump.
+ * @param[out] chunks values of the chunks of the file, in order.
+ */
+static void readDumpFile(const std::string &fileName, std::vector<int16_t> &chunks)
+{
+    FILE *file = fopen(fileName.c_str(), "rb");
+    ASSERT_TRUE(file != NULL) << fileName;
+    std::vector<uint8_t> content;
+    uint8_t buffer[4096];
+    for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        content.insert(content.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    ASSERT_GE(content.size(), 44u);
+    const uint8_t *header = &content[0];
+    uint32_t dataBytes = content.size() - 44;
+    EXPECT_EQ(0, memcmp(header, "RIFF", 4));
+    EXPECT_EQ(36 + dataBytes, getLe32(header + 4));
+    EXPECT_EQ(0, memcmp(header + 8, "WAVEfmt ", 8));
+    EXPECT_EQ(16u, getLe32(header + 16));
+    EXPECT_EQ(1u, getLe16(header + 20));
+    EXPECT_EQ(gChannels, getLe16(header + 22));
+    EXPECT_EQ(48000u, getLe32(header + 24));
+    EXPECT_EQ(48000u * gChannels * 2, getLe32(header + 28));
+    EXPECT_EQ(gChannels * 2, getLe16(header + 32));
+    EXPECT_EQ(16u, getLe16(header + 34));
+    EXPECT_EQ(0, memcmp(header + 36, "data", 4));
+    EXPECT_EQ(dataBytes, getLe32(header + 40));
+    ASSERT_EQ(0u, dataBytes % gChunkBytes) << "truncated chunk in " << fileName;
+
+    chunks.clear();
+    for (size_t offset = 44; offset < content.size(); offset += gChunkBytes) {
+        const int16_t *samples = reinterpret_cast<const int16_t *>(&content[offset]);
+        for (size_t i = 1; i < gChunkSamples; i++) {
+            ASSERT_EQ(samples[0], samples[i]) << "corrupted chunk in " << fileName;
+        }
+        chunks.push_back(samples[0]);
+    }
+}
+
+/** Dumps chunks of samples all equal to the index of the chunk, from first to last. */
+static void dumpChunks(HalAudioDump &dump, int16_t first, int16_t last, bool pace)
+{
+    std::vector<int16_t> chunk(gChunkSamples);
+    for (int16_t index = first; index <= last; index++) {
+        std::fill(chunk.begin(), chunk.end(), index);
+        dump.dumpAudioSamples(&chunk[0], gChunkBytes, true, 48000, gChannels, "test");
+        if (pace) {
+            usleep(1000);
+        }
+    }
+}
+
+TEST(HalAudioDump, wavFileIntegrity)
+{
+    DumpDir dir;
+    {
+        HalAudioDump dump(dir.getPath(), 1024 * 1024);
+        dumpChunks(dump, 0, 199, true);
+
+        HalAudioDump::Stats stats = dump.getStats();
+        EXPECT_EQ(0u, stats.droppedWrites);
+        EXPECT_EQ(200 * gChunkBytes, stats.pushedBytes);
+    }
+    std::vector<int16_t> chunks;
+    readDumpFile(dir.getFile(1), chunks);
+    ASSERT_EQ(200u, chunks.size());
+    for (size_t i = 0; i < chunks.size(); i++) {
+        EXPECT_EQ(static_cast<int16_t>(i), chunks[i]);
+    }
+}
+
+TEST(HalAudioDump, rotationKeepsLastFiles)
+{
+    DumpDir dir;
+    {
+        // 5 chunks per file, 10 files rotated on 4
+        HalAudioDump dump(dir.getPath(), 5 * gChunkBytes);
+        dumpChunks(dump, 0, 49, true);
+        dump.close();
+
+        HalAudioDump::Stats stats = dump.getStats();
+        EXPECT_EQ(10u, stats.fileCount);
+        EXPECT_EQ(50 * gChunkBytes, stats.writtenBytes);
+        EXPECT_EQ(0u, stats.writeErrors);
+    }
+    // Files 7 to 10 of the rotation remain, the 10th in the 2nd slot
+    static const uint32_t slots[] = { 3, 4, 1, 2 };
+    int16_t expected = 30;
+    for (uint32_t slot : slots) {
+        std::vector<int16_t> chunks;
+        readDumpFile(dir.getFile(slot), chunks);
+        ASSERT_EQ(5u, chunks.size()) << "slot " << slot;
+        for (int16_t chunk : chunks) {
+            EXPECT_EQ(expected++, chunk);
+        }
+    }
+    EXPECT_NE(0, access(dir.getFile(5).c_str(), F_OK));
+}
+
+TEST(HalAudioDump, overflowDropsWholeChunks)
+{
+    DumpDir dir;
+    HalAudioDump::Stats stats;
+    {
+        // Burst far above the ring capacity, faster than any storage
+        HalAudioDump dump(dir.getPath(), 64 * 1024 * 1024);
+        dumpChunks(dump, 0, 3000, false);
+        stats = dump.getStats();
+    }
+    EXPECT_GT(stats.droppedWrites, 0u);
+    EXPECT_EQ(3001 * gChunkBytes, stats.pushedBytes + stats.droppedBytes);
+    EXPECT_EQ(stats.droppedWrites * gChunkBytes, stats.droppedBytes);
+    EXPECT_GE(stats.maxFillPercent, 99u);
+
+    std::vector<int16_t> chunks;
+    readDumpFile(dir.getFile(1), chunks);
+    EXPECT_EQ(stats.pushedBytes, chunks.size() * gChunkBytes);
+    for (size_t i = 1; i < chunks.size(); i++) {
+        EXPECT_GT(chunks[i], chunks[i - 1]);
+    }
+}
@@ -61,6 +61,7 @@ component_static_lib := \
     libproperty \
     audio.routemanager.includes \
     libaudioparameters \
+    libaudiotrace \
     libevent-listener_static \
     libboost
 
@@ -134,6 +135,33 @@ include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
 
 include $(BUILD_HOST_STATIC_LIBRARY)
 endif
+
+# Functional test
+#######################################################################
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := test/PfwCriterionTest.cpp
+
+LOCAL_C_INCLUDES := $(component_includes_dir_host)
+
+LOCAL_STATIC_LIBRARIES := \
+    libaudioplatformstate_host \
+    $(component_static_lib_host)
+
+LOCAL_SHARED_LIBRARIES := \
+    libparameter_host
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := pfw_criterion_test
+LOCAL_REQUIRED_MODULES := host_test_app_pfw_files
+LOCAL_MODULE_OWNER := intel
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+include $(BUILD_HOST_NATIVE_TEST)
+endif
+
 #######################################################################
 
 include $(OPTIONAL_QUALITY_ENV_TEARDOWN)
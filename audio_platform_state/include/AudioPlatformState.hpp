@@ -18,11 +18,13 @@
 #include <Pfw.hpp>
 #include <AudioNonCopyable.hpp>
 #include <KeyValuePairs.hpp>
+#include <StreamsParameters.hpp>
 #include <AudioCommsAssert.hpp>
 #include <Direction.hpp>
 #include <utils/Errors.h>
 #include <utils/RWLock.h>
 #include <string>
+#include <vector>
 
 class CParameterMgrPlatformConnector;
 class Criterion;
@@ -126,6 +128,7 @@ public:
     void setConfig(Criteria criteria, CriterionTypes criterionTypes, Parameters parameters)
     {
         mParameterVector = parameters;
+        indexParameters();
         getPfw<pfw>()->setConfig(criteria, criterionTypes);
     }
 
@@ -151,6 +154,19 @@ public:
      */
     android::status_t setParameters(const std::string &keyValuePairs, bool &hasChanged);
 
+    /**
+     * Typed setParameter handler, used internally to apply the parameters inferred from the
+     * streams. Parameters are dispatched through an index built at configuration time, so
+     * neither the keys nor the numerical values are handled as strings.
+     *
+     * @param[in] parameters typed streams parameters.
+     * @param[out] hasChanged: return true if the platform has changed due to new param,
+     *                         false otherwise
+     *
+     * @return OK if these parameters were applyied correctly, error code otherwise.
+     */
+    android::status_t setParameters(const StreamsParameters &parameters, bool &hasChanged);
+
     /**
      * Get the global parameters of Audio HAL.
      *
@@ -184,9 +200,37 @@ public:
      * @tparam pfw instance of Parameter Manager targeted for this call.
      */
     template <pfwtype pfw>
-    void commitCriteriaAndApplyConfiguration()
+    uint32_t commitCriteriaAndApplyConfiguration()
+    {
+        return getPfw<pfw>()->commitCriteriaAndApplyConfiguration();
+    }
+
+    /**
+     * Commit the staged criteria on the parameter manager, without applying the configuration.
+     * Criteria whose value did not change are not set.
+     *
+     * @tparam pfw instance of Parameter Manager targeted for this call.
+     *
+     * @return number of criteria that really changed.
+     */
+    template <pfwtype pfw>
+    uint32_t commitCriteria()
+    {
+        return getPfw<pfw>()->commitCriteria();
+    }
+
+    /**
+     * Checks if criteria have been set on the parameter manager since the configuration was
+     * last applied.
+     *
+     * @tparam pfw instance of Parameter Manager targeted for this call.
+     *
+     * @return true if a configuration needs to be applied, false otherwise.
+     */
+    template <pfwtype pfw>
+    bool hasPendingConfiguration() const
     {
-        getPfw<pfw>()->commitCriteriaAndApplyConfiguration();
+        return getPfw<pfw>()->hasPendingConfiguration();
     }
 
     /**
@@ -204,12 +248,61 @@ public:
         return getPfw<pfw>()->setCriterion(name, value);
     }
 
+    /**
+     * Set a criterion to PFW through its interned identifier.
+     *
+     * @tparam pfw instance of Parameter Manager targeted for this call.
+     * @param[in] id of the PFW criterion (@see getCriterionId).
+     * @param[in] value criterion type name to which this criterion is associated to.
+     *
+     * @return true if the criterion value has changed, false otherwise.
+     */
+    template <pfwtype pfw>
+    bool setCriterion(CriterionId id, uint32_t value)
+    {
+        return getPfw<pfw>()->setCriterion(id, value);
+    }
+
+    /**
+     * Get the interned identifier of a criterion, to be resolved once at configuration time.
+     *
+     * @tparam pfw instance of Parameter Manager targeted for this call.
+     * @param[in] name of the PFW criterion.
+     *
+     * @return identifier of the criterion, gInvalidCriterionId if not found.
+     */
+    template <pfwtype pfw>
+    CriterionId getCriterionId(const std::string &name) const
+    {
+        return getPfw<pfw>()->getCriterionId(name);
+    }
+
+    /**
+     * Get the local value of a criterion.
+     *
+     * @tparam pfw instance of Parameter Manager targeted for this call.
+     * @param[in] id of the PFW criterion (@see getCriterionId).
+     *
+     * @return value of the criterion.
+     */
+    template <pfwtype pfw>
+    uint32_t getCriterion(CriterionId id) const
+    {
+        return getPfw<pfw>()->getCriterion(id);
+    }
+
     template <pfwtype pfw>
     bool commitCriterion(const std::string &name)
     {
         return getPfw<pfw>()->commitCriterion(name);
     }
 
+    template <pfwtype pfw>
+    bool commitCriterion(CriterionId id)
+    {
+        return getPfw<pfw>()->commitCriterion(id);
+    }
+
     template <pfwtype pfw>
     CParameterMgrPlatformConnector *getConnector()
     {
@@ -233,6 +326,12 @@ public:
         return getPfw<pfw>()->stageCriterion(name, value);
     }
 
+    template <pfwtype pfw>
+    bool stageCriterion(CriterionId id, uint32_t value)
+    {
+        return getPfw<pfw>()->stageCriterion(id, value);
+    }
+
     /**
      * Add a criterion type value pair to PFW.
      *
@@ -302,10 +401,21 @@ private:
      */
     void clearKeys(KeyValuePairs *pairs);
 
+    /**
+     * Build the index of parameters associated to the keys of the typed streams parameters.
+     */
+    void indexParameters();
+
     Pfw<PfwTrait<Audio> > *mAudioPfw;
 
     Parameters mParameterVector; /**< Map of parameters. */
 
+    /**
+     * Parameters indexed by typed streams parameter identifier. More than one parameter may be
+     * associated to the same key.
+     */
+    std::vector<Parameter *> mParameterIndex[StreamsParameters::gNbIds];
+
     /**
      * String containing a list of paths to the hardware debug files on target
      * to debug the audio firmware/driver in case of EIO error. Defined in pfw.
@@ -323,4 +433,60 @@ private:
     mutable android::RWLock mPfwLock;
 };
 
+/**
+ * Batch of criteria changes on a parameter manager instance.
+ * Any number of criteria may be staged in the transaction, they are committed together just
+ * before applying the configuration. Criteria whose value did not change are not committed, and
+ * the configuration is not applied if no criterion changed since the last application.
+ *
+ * @tparam pfw instance of Parameter Manager targeted by the transaction.
+ */
+template <pfwtype pfw>
+class CriteriaTransaction : private audio_comms::utilities::NonCopyable
+{
+public:
+    CriteriaTransaction(AudioPlatformState &platformState)
+        : mPlatformState(platformState)
+    {}
+
+    /**
+     * Stage a criterion change in the transaction.
+     *
+     * @param[in] id of the PFW criterion.
+     * @param[in] value to set.
+     *
+     * @return true if the staged value differs from the previous local value, false otherwise.
+     */
+    bool setCriterion(CriterionId id, uint32_t value)
+    {
+        return mPlatformState.stageCriterion<pfw>(id, value);
+    }
+
+    /**
+     * Commit the staged criteria and apply the configuration if anything changed.
+     * Note that criteria staged outside of the transaction (i.e. by platform parameters) are
+     * committed as well.
+     *
+     * @return number of criteria that really changed.
+     */
+    uint32_t commit()
+    {
+        uint32_t changes = mPlatformState.commitCriteria<pfw>();
+        if (mPlatformState.hasPendingConfiguration<pfw>()) {
+            mPlatformState.applyConfiguration<pfw>();
+        }
+        mChanges += changes;
+        return changes;
+    }
+
+    /**
+     * @return number of criteria that really changed over all commits of the transaction.
+     */
+    uint32_t getChanges() const { return mChanges; }
+
+private:
+    AudioPlatformState &mPlatformState;
+    uint32_t mChanges = 0;
+};
+
 } // namespace intel_audio
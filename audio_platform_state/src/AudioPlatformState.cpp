@@ -125,11 +125,9 @@ public:
         std::string key(param->getKey());
         std::string value;
         if (mPairs->get(key, value) == android::OK) {
-            std::string oldValue;
-            param->getValue(oldValue);
-
-            if (!param->setValue(value)) {
-                if (value.compare(oldValue) != 0) {
+            bool isValid;
+            if (!param->setLiteralValue(value, isValid)) {
+                if (!isValid) {
                     mRet = android::BAD_VALUE;
                 }
                 return;
@@ -161,6 +159,47 @@ status_t AudioPlatformState::setParameters(const string &keyValuePairs, bool &ha
     return ret;
 }
 
+void AudioPlatformState::indexParameters()
+{
+    for (auto &parameters : mParameterIndex) {
+        parameters.clear();
+    }
+    for (auto param : mParameterVector) {
+        StreamsParameters::Id id;
+        if (StreamsParameters::getId(param->getKey(), id)) {
+            mParameterIndex[id].push_back(param);
+        }
+    }
+}
+
+status_t AudioPlatformState::setParameters(const StreamsParameters &parameters, bool &hasChanged)
+{
+    status_t ret = android::OK;
+    for (size_t i = 0; i < StreamsParameters::gNbIds; i++) {
+        StreamsParameters::Id id = static_cast<StreamsParameters::Id>(i);
+        if (!parameters.isSet(id)) {
+            continue;
+        }
+        for (auto param : mParameterIndex[id]) {
+            bool isValid;
+            bool isChanged = parameters.isLiteral(id) ?
+                             param->setLiteralValue(parameters.getLiteral(id), isValid) :
+                             param->setNumericalValue(parameters.getValue(id), isValid);
+            if (!isValid) {
+                ret = android::BAD_VALUE;
+            }
+            if (!isChanged) {
+                continue;
+            }
+            hasChanged = true;
+            if (param->getType() == Parameter::CriterionParameter) {
+                criterionHasChanged(param->getName());
+            }
+        }
+    }
+    return ret;
+}
+
 void AudioPlatformState::criterionHasChanged(const std::string &event)
 {
     if (event == gAndroidModeCriterion) {
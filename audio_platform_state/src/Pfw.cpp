@@ -20,6 +20,7 @@
 #include "AudioPlatformState.hpp"
 #include "ParameterMgrPlatformConnector.h"
 #include <ParameterMgrHelper.hpp>
+#include <AudioTrace.hpp>
 #include <property/Property.hpp>
 #include <algorithm>
 #include <convert.hpp>
@@ -129,25 +130,71 @@ Pfw<Trait>::~Pfw()
 }
 
 template <class Trait>
-void Pfw<Trait>::commitCriteriaAndApplyConfiguration()
+void Pfw<Trait>::setConfig(Criteria criteria, CriterionTypes criterionTypes)
 {
+    mCriteria = criteria;
+    mCriterionTypes = criterionTypes;
+
+    mCriterionIds.clear();
+    for (CriterionId id = 0; id < mCriteria.size(); id++) {
+        mCriterionIds[mCriteria[id]->getName()] = id;
+    }
+    mCriterionTypeIndex.clear();
+    for (auto criterionType : mCriterionTypes) {
+        mCriterionTypeIndex[criterionType->getName()] = criterionType;
+    }
+}
+
+template <class Trait>
+CriterionId Pfw<Trait>::getCriterionId(const string &name) const
+{
+    auto it = mCriterionIds.find(name);
+    return (it != mCriterionIds.end()) ? it->second : gInvalidCriterionId;
+}
+
+template <class Trait>
+CriterionType *Pfw<Trait>::getCriterionTypeByName(const string &name) const
+{
+    auto it = mCriterionTypeIndex.find(name);
+    return (it != mCriterionTypeIndex.end()) ? it->second : nullptr;
+}
+
+template <class Trait>
+uint32_t Pfw<Trait>::commitCriteria()
+{
+    uint32_t changes = 0;
     for (auto criterion : mCriteria) {
-        criterion->setCriterionState();
+        if (criterion->commit()) {
+            ++changes;
+        }
+    }
+    if (changes != 0) {
+        mHasPendingConfiguration = true;
     }
+    return changes;
+}
+
+template <class Trait>
+uint32_t Pfw<Trait>::commitCriteriaAndApplyConfiguration()
+{
+    uint32_t changes = commitCriteria();
     applyConfiguration();
+    return changes;
 }
 
 template <class Trait>
 void Pfw<Trait>::applyConfiguration()
 {
+    AUDIO_TRACE_SCOPE("Pfw::applyConfiguration", mTag.c_str());
     mConnector->applyConfigurations();
+    mHasPendingConfiguration = false;
 }
 
 template <class Trait>
 void Pfw<Trait>::addCriterionTypeValuePair(const string &typeName, uint32_t numericValue,
                                            const string &literalValue)
 {
-    CriterionType *criterionType = mCriterionTypes.getByName(typeName);
+    CriterionType *criterionType = getCriterionTypeByName(typeName);
     AUDIOCOMMS_ASSERT(criterionType != nullptr,
                       "CriterionType " << typeName.c_str() << " not found");
     if (criterionType->hasValuePairByName(literalValue)) {
@@ -177,18 +224,37 @@ android::status_t Pfw<Trait>::start()
 template <class Trait>
 bool Pfw<Trait>::setCriterion(const string &name, uint32_t value)
 {
-    Criterion *criterion = mCriteria.getByName(name);
+    Criterion *criterion = getCriterionByName(name);
     if (criterion == nullptr) {
         Log::Error() << __FUNCTION__ << ": " << name << " is not a member of " << mTag << " PFW";
         return false;
     }
-    return criterion->setCriterionState<int32_t>(value);
+    if (!criterion->setCriterionState<int32_t>(value)) {
+        return false;
+    }
+    mHasPendingConfiguration = true;
+    return true;
+}
+
+template <class Trait>
+bool Pfw<Trait>::setCriterion(CriterionId id, uint32_t value)
+{
+    Criterion *criterion = getCriterionById(id);
+    if (criterion == nullptr) {
+        Log::Error() << __FUNCTION__ << ": id " << id << " is not a member of " << mTag << " PFW";
+        return false;
+    }
+    if (!criterion->setCriterionState<int32_t>(value)) {
+        return false;
+    }
+    mHasPendingConfiguration = true;
+    return true;
 }
 
 template <class Trait>
 bool Pfw<Trait>::stageCriterion(const string &name, uint32_t value)
 {
-    Criterion *criterion = mCriteria.getByName(name);
+    Criterion *criterion = getCriterionByName(name);
     if (criterion == nullptr) {
         Log::Error() << __FUNCTION__ << ": " << name << " is not a member of " << mTag << " PFW";
         return false;
@@ -196,16 +262,43 @@ bool Pfw<Trait>::stageCriterion(const string &name, uint32_t value)
     return criterion->setValue<uint32_t>(value);
 }
 
+template <class Trait>
+bool Pfw<Trait>::stageCriterion(CriterionId id, uint32_t value)
+{
+    Criterion *criterion = getCriterionById(id);
+    if (criterion == nullptr) {
+        Log::Error() << __FUNCTION__ << ": id " << id << " is not a member of " << mTag << " PFW";
+        return false;
+    }
+    return criterion->setValue<uint32_t>(value);
+}
+
 
 template <class Trait>
 bool Pfw<Trait>::commitCriterion(const string &name)
 {
-    Criterion *criterion = mCriteria.getByName(name);
+    Criterion *criterion = getCriterionByName(name);
     if (criterion == nullptr) {
         Log::Error() << __FUNCTION__ << ": " << name << " is not a member of " << mTag << " PFW";
         return false;
     }
-    criterion->setCriterionState();
+    if (criterion->commit()) {
+        mHasPendingConfiguration = true;
+    }
+    return true;
+}
+
+template <class Trait>
+bool Pfw<Trait>::commitCriterion(CriterionId id)
+{
+    Criterion *criterion = getCriterionById(id);
+    if (criterion == nullptr) {
+        Log::Error() << __FUNCTION__ << ": id " << id << " is not a member of " << mTag << " PFW";
+        return false;
+    }
+    if (criterion->commit()) {
+        mHasPendingConfiguration = true;
+    }
     return true;
 }
 
@@ -213,7 +306,7 @@ bool Pfw<Trait>::commitCriterion(const string &name)
 template <class Trait>
 uint32_t Pfw<Trait>::getCriterion(const string &name) const
 {
-    const Criterion *criterion = mCriteria.getByName(name);
+    const Criterion *criterion = getCriterionByName(name);
     if (criterion == nullptr) {
         Log::Error() << __FUNCTION__ << ": " << name << " is not a member of " << mTag << " PFW";
         return false;
@@ -221,10 +314,21 @@ uint32_t Pfw<Trait>::getCriterion(const string &name) const
     return criterion->getValue<uint32_t>();
 }
 
+template <class Trait>
+uint32_t Pfw<Trait>::getCriterion(CriterionId id) const
+{
+    const Criterion *criterion = getCriterionById(id);
+    if (criterion == nullptr) {
+        Log::Error() << __FUNCTION__ << ": id " << id << " is not a member of " << mTag << " PFW";
+        return false;
+    }
+    return criterion->getValue<uint32_t>();
+}
+
 template <class Trait>
 string Pfw<Trait>::getFormattedState(const string &typeName, uint32_t numeric) const
 {
-    const CriterionType *criterionType = mCriterionTypes.getByName(typeName);
+    const CriterionType *criterionType = getCriterionTypeByName(typeName);
     if (criterionType == nullptr) {
         Log::Error() << __FUNCTION__ << ": " << typeName << " is not a member of " << mTag <<
             " PFW";
@@ -237,7 +341,7 @@ template <class Trait>
 bool Pfw<Trait>::getNumericalValue(const string &criterionName, const string &literal,
                                    int &numeric) const
 {
-    const Criterion *criterion = mCriteria.getByName(criterionName);
+    const Criterion *criterion = getCriterionByName(criterionName);
     if (criterion == nullptr) {
         Log::Error() << __FUNCTION__ << ": " << criterionName << " is not a member of " << mTag <<
             " PFW";
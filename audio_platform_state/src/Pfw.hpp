@@ -22,6 +22,8 @@
 #include <cutils/config_utils.h>
 #include <utils/Errors.h>
 #include <inttypes.h>
+#include <string>
+#include <unordered_map>
 
 class CParameterMgrPlatformConnector;
 struct cnode;
@@ -51,11 +53,26 @@ public:
 
     android::status_t start();
 
-    void setConfig(Criteria criteria, CriterionTypes criterionTypes)
-    {
-        mCriteria = criteria;
-        mCriterionTypes = criterionTypes;
-    }
+    /**
+     * Set the criteria and criterion types collections.
+     * Names are interned at this time, so that the criteria may then be accessed through their
+     * identifier (@see getCriterionId) or through a hashed lookup of their name.
+     *
+     * @param[in] criteria collection of criteria of this PFW instance.
+     * @param[in] criterionTypes collection of criterion types of this PFW instance.
+     */
+    void setConfig(Criteria criteria, CriterionTypes criterionTypes);
+
+    /**
+     * Get the interned identifier of a criterion.
+     * Intended to be called once (at configuration time) by clients setting the same criteria
+     * many times, like the route manager does for each routing stage.
+     *
+     * @param[in] name of the PFW criterion.
+     *
+     * @return identifier of the criterion, gInvalidCriterionId if not found.
+     */
+    CriterionId getCriterionId(const std::string &name) const;
 
     /**
      * Add a criterion type value pair to PFW.
@@ -77,6 +94,17 @@ public:
      */
     bool setCriterion(const std::string &name, uint32_t value);
 
+    /**
+     * Set a criterion to PFW through its identifier.
+     * This value will be taken into account at next applyConfiguration.
+     *
+     * @param[in] id of the PFW criterion (@see getCriterionId).
+     * @param[in] value criterion type name to which this criterion is associated to.
+     *
+     * @return true if the criterion value has changed, false otherwise.
+     */
+    bool setCriterion(CriterionId id, uint32_t value);
+
     /**
      * Stage a criterion to PFW.
      * This value will NOT be taken into account at next applyConfiguration unless the criterion
@@ -89,6 +117,16 @@ public:
      */
     bool stageCriterion(const std::string &name, uint32_t value);
 
+    /**
+     * Stage a criterion to PFW through its identifier.
+     *
+     * @param[in] id of the PFW criterion (@see getCriterionId).
+     * @param[in] value criterion type name to which this criterion is associated to.
+     *
+     * @return true if the criterion value has changed, false otherwise.
+     */
+    bool stageCriterion(CriterionId id, uint32_t value);
+
     /**
      * Commit a criterion to PFW. The value will be taken into account at next applyConfiguration.
      *
@@ -98,8 +136,19 @@ public:
      */
     bool commitCriterion(const std::string &name);
 
+    /**
+     * Commit a criterion to PFW through its identifier.
+     *
+     * @param[in] id of the PFW criterion (@see getCriterionId).
+     *
+     * @return true if the criterion is valid, false otherwise.
+     */
+    bool commitCriterion(CriterionId id);
+
     uint32_t getCriterion(const std::string &name) const;
 
+    uint32_t getCriterion(CriterionId id) const;
+
     /**
      * Apply the configuration of the platform on the route parameter manager.
      * Once all the criteria have been set, the client of the platform state must call
@@ -108,7 +157,27 @@ public:
      */
     void applyConfiguration();
 
-    void commitCriteriaAndApplyConfiguration();
+    /**
+     * Commit the staged criteria to PFW.
+     * Only the criteria whose value differs from the one known by PFW are set.
+     *
+     * @return number of criteria that really changed.
+     */
+    uint32_t commitCriteria();
+
+    /**
+     * Checks if criteria have been set to PFW since the last applyConfiguration.
+     *
+     * @return true if a configuration needs to be applied, false otherwise.
+     */
+    bool hasPendingConfiguration() const { return mHasPendingConfiguration; }
+
+    /**
+     * Commit the staged criteria and apply the configuration.
+     *
+     * @return number of criteria that really changed.
+     */
+    uint32_t commitCriteriaAndApplyConfiguration();
 
     CParameterHandle *getDynamicParameterHandle(const std::string &dynamicParamPath);
 
@@ -119,13 +188,48 @@ public:
     CParameterMgrPlatformConnector *getConnector() { return mConnector; }
 
 private:
+    /**
+     * Get a criterion from its identifier.
+     *
+     * @param[in] id of the criterion.
+     *
+     * @return valid criterion if found, nullptr otherwise.
+     */
+    Criterion *getCriterionById(CriterionId id) const
+    {
+        return (id < mCriteria.size()) ? mCriteria[id] : nullptr;
+    }
+
+    /**
+     * Get a criterion from its name, using the hashed name index as fallback for clients
+     * that do not keep the criterion identifier.
+     *
+     * @param[in] name of the criterion.
+     *
+     * @return valid criterion if found, nullptr otherwise.
+     */
+    Criterion *getCriterionByName(const std::string &name) const
+    {
+        return getCriterionById(getCriterionId(name));
+    }
+
+    CriterionType *getCriterionTypeByName(const std::string &name) const;
+
     CriterionTypes mCriterionTypes; /**< Criterion type collection Map. */
     Criteria mCriteria; /**< Criteria collection Map. */
+
+    /** Hashed index of the criteria identifiers by name, built at configuration time. */
+    std::unordered_map<std::string, CriterionId> mCriterionIds;
+
+    /** Hashed index of the criterion types by name, built at configuration time. */
+    std::unordered_map<std::string, CriterionType *> mCriterionTypeIndex;
     CParameterMgrPlatformConnector *mConnector; /**< Parameter-Manager connector. */
     ParameterMgrPlatformConnectorLogger *mConnectorLogger; /**< Parameter-Manager logger. */
     ParameterMgrHelper *mParameterHelper;
 
     const std::string mTag;
+
+    bool mHasPendingConfiguration = false; /**< criteria set since last applyConfiguration. */
 };
 
 } // namespace intel_audio
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AudioPlatformState.hpp>
+#include <Criterion.hpp>
+#include <CriterionParameter.hpp>
+#include <CriterionType.hpp>
+#include <StreamsParameters.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace intel_audio;
+using namespace std;
+
+static const string gRoutingStageCriterion = "RoutageState";
+static const string gOpenedRouteCriterion[] = {
+    "OpenedCaptureRoutes",
+    "OpenedPlaybackRoutes",
+    "OpenedBackendRoutes"
+};
+static const uint32_t gNbRouteTypes = sizeof(gOpenedRouteCriterion) / sizeof(string);
+static const string gOutputDevicesCriterion = "SelectedOutputDevices";
+
+/** Number of criteria declared by a typical platform configuration. */
+static const uint32_t gNbPlatformCriteria = 48;
+
+/** Routing stage values set during a routing pass (mute, disable, configure, enable, unmute). */
+static const uint32_t gRoutingStages[] = {
+    0x2, 0x8, 0x4, 0x1, 0x1, 0x5, 0x7, 0xF, 0x1F
+};
+
+class PfwCriterionTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        mPlatformState = new AudioPlatformState();
+        CParameterMgrPlatformConnector *connector = mPlatformState->getConnector<Audio>();
+
+        CriterionType *maskType = new CriterionType("MaskType", true, connector);
+        for (uint32_t bit = 0; bit < 8; bit++) {
+            maskType->addValuePair(1 << bit, "Bit" + to_string(bit));
+        }
+        // Criterion required by the settings of the host test PFW configuration
+        CriterionType *volumeType = new CriterionType("VolumeType", false, connector);
+        volumeType->addValuePair(0, "muted");
+        volumeType->addValuePair(1, "max");
+
+        CriterionTypes criterionTypes;
+        criterionTypes.add(maskType);
+        criterionTypes.add(volumeType);
+
+        // Route manager criteria are appended after the platform ones, as the serializer does,
+        // which is the worst case for a name lookup.
+        Criteria criteria;
+        for (uint32_t i = 0; i < gNbPlatformCriteria; i++) {
+            criteria.add(new Criterion("PlatformCriterion" + to_string(i), maskType, connector));
+        }
+        for (const auto &name : gOpenedRouteCriterion) {
+            criteria.add(new Criterion(name, maskType, connector));
+        }
+        criteria.add(new Criterion(gRoutingStageCriterion, maskType, connector));
+        criteria.add(new Criterion("Volume", volumeType, connector));
+        Criterion *outputDevices = new Criterion(gOutputDevicesCriterion, maskType, connector);
+        criteria.add(outputDevices);
+
+        Parameters parameters;
+        parameters.add(new CriterionParameter(
+                           StreamsParameters::getKey(StreamsParameters::OutputDevices),
+                           gOutputDevicesCriterion, *outputDevices, "0"));
+
+        mPlatformState->setConfig<Audio>(criteria, criterionTypes, parameters);
+        ASSERT_EQ(android::OK, mPlatformState->start());
+    }
+
+    virtual void TearDown()
+    {
+        delete mPlatformState;
+    }
+
+    /**
+     * Emulates the criterion traffic of a full routing pass of the route manager.
+     */
+    void routingPassByName(uint32_t seed)
+    {
+        for (uint32_t stage : gRoutingStages) {
+            mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, stage);
+        }
+        for (uint32_t step = 0; step < 3; step++) {
+            for (uint32_t i = 0; i < gNbRouteTypes; i++) {
+                mPlatformState->setCriterion<Audio>(gOpenedRouteCriterion[i], (seed + step) & 0xFF);
+            }
+        }
+    }
+
+    void routingPassById(const vector<CriterionId> &openedRouteIds, CriterionId stageId,
+                         uint32_t seed)
+    {
+        for (uint32_t stage : gRoutingStages) {
+            mPlatformState->setCriterion<Audio>(stageId, stage);
+        }
+        for (uint32_t step = 0; step < 3; step++) {
+            for (uint32_t i = 0; i < gNbRouteTypes; i++) {
+                mPlatformState->setCriterion<Audio>(openedRouteIds[i], (seed + step) & 0xFF);
+            }
+        }
+    }
+
+    AudioPlatformState *mPlatformState;
+};
+
+TEST_F(PfwCriterionTest, InternedIdentifiers)
+{
+    CriterionId stageId = mPlatformState->getCriterionId<Audio>(gRoutingStageCriterion);
+    ASSERT_NE(gInvalidCriterionId, stageId);
+    EXPECT_EQ(gInvalidCriterionId, mPlatformState->getCriterionId<Audio>("UnknownCriterion"));
+
+    // Identifiers are stable
+    EXPECT_EQ(stageId, mPlatformState->getCriterionId<Audio>(gRoutingStageCriterion));
+
+    // Setting through the identifier or the name targets the same criterion
+    EXPECT_TRUE(mPlatformState->setCriterion<Audio>(stageId, 0x5));
+    EXPECT_FALSE(mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, 0x5));
+    EXPECT_TRUE(mPlatformState->stageCriterion<Audio>(stageId, 0x3));
+    EXPECT_TRUE(mPlatformState->commitCriterion<Audio>(stageId));
+    EXPECT_FALSE(mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, 0x3));
+
+    EXPECT_FALSE(mPlatformState->setCriterion<Audio>(gInvalidCriterionId, 0x1));
+    EXPECT_FALSE(mPlatformState->commitCriterion<Audio>(gInvalidCriterionId));
+}
+
+TEST_F(PfwCriterionTest, TransactionCommitsOnlyChangedCriteria)
+{
+    CriterionId stageId = mPlatformState->getCriterionId<Audio>(gRoutingStageCriterion);
+    CriterionId playbackId = mPlatformState->getCriterionId<Audio>(gOpenedRouteCriterion[1]);
+
+    CriteriaTransaction<Audio> transaction(*mPlatformState);
+    transaction.setCriterion(stageId, 0x1);
+    transaction.setCriterion(playbackId, 0x2);
+    EXPECT_EQ(2u, transaction.commit());
+    EXPECT_FALSE(mPlatformState->hasPendingConfiguration<Audio>());
+
+    // Staging the same values is a no-op stage
+    transaction.setCriterion(stageId, 0x1);
+    transaction.setCriterion(playbackId, 0x2);
+    EXPECT_EQ(0u, transaction.commit());
+
+    // Value staged then restored before commit is not a change either
+    transaction.setCriterion(stageId, 0x4);
+    transaction.setCriterion(stageId, 0x1);
+    transaction.setCriterion(playbackId, 0x3);
+    EXPECT_EQ(1u, transaction.commit());
+
+    EXPECT_EQ(3u, transaction.getChanges());
+    EXPECT_EQ(0x3u, mPlatformState->getCriterion<Audio>(playbackId));
+}
+
+TEST_F(PfwCriterionTest, TypedParametersDispatchedToCriteria)
+{
+    CriterionId devicesId = mPlatformState->getCriterionId<Audio>(gOutputDevicesCriterion);
+    ASSERT_NE(gInvalidCriterionId, devicesId);
+
+    StreamsParameters parameters;
+    EXPECT_TRUE(parameters.isEmpty());
+    parameters.set(StreamsParameters::OutputDevices, 0x6u);
+    parameters.set(StreamsParameters::OutputFlags, 0x2u);
+    EXPECT_FALSE(parameters.isEmpty());
+    EXPECT_EQ("output_devices=6;output_flags=2", parameters.toString());
+
+    // Keys without associated parameter are silently ignored
+    bool hasChanged = false;
+    EXPECT_EQ(android::OK, mPlatformState->setParameters(parameters, hasChanged));
+    EXPECT_TRUE(hasChanged);
+    EXPECT_EQ(0x6u, mPlatformState->getCriterion<Audio>(devicesId));
+
+    hasChanged = false;
+    EXPECT_EQ(android::OK, mPlatformState->setParameters(parameters, hasChanged));
+    EXPECT_FALSE(hasChanged);
+
+    // Typed and string forms target the same criterion
+    EXPECT_EQ(android::OK, mPlatformState->setParameters(string("output_devices=3"), hasChanged));
+    EXPECT_TRUE(hasChanged);
+    EXPECT_EQ(0x3u, mPlatformState->getCriterion<Audio>(devicesId));
+
+    StreamsParameters::Id id;
+    EXPECT_TRUE(StreamsParameters::getId("input_devices", id));
+    EXPECT_EQ(StreamsParameters::InputDevices, id);
+    EXPECT_FALSE(StreamsParameters::getId("unknown_key", id));
+}
+
+TEST_F(PfwCriterionTest, RoutingPassCriterionTrafficBenchmark)
+{
+    static const uint32_t nbPasses = 20000;
+
+    vector<CriterionId> openedRouteIds;
+    for (const auto &name : gOpenedRouteCriterion) {
+        openedRouteIds.push_back(mPlatformState->getCriterionId<Audio>(name));
+    }
+    CriterionId stageId = mPlatformState->getCriterionId<Audio>(gRoutingStageCriterion);
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < nbPasses; pass++) {
+        routingPassByName(pass);
+    }
+    auto byName = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+
+    start = chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < nbPasses; pass++) {
+        routingPassById(openedRouteIds, stageId, pass);
+    }
+    auto byId = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+
+    // Reported in the test results, e.g. in the XML output
+    RecordProperty("byNameNsPerPass", static_cast<int>(byName.count() / nbPasses));
+    RecordProperty("byIdNsPerPass", static_cast<int>(byId.count() / nbPasses));
+
+    // Both paths must end in the same state
+    EXPECT_EQ(gRoutingStages[sizeof(gRoutingStages) / sizeof(uint32_t) - 1],
+              mPlatformState->getCriterion<Audio>(stageId));
+}
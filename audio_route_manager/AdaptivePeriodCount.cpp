@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AdaptivePeriodCount.hpp"
+
+namespace intel_audio
+{
+
+AdaptivePeriodCount::AdaptivePeriodCount(uint32_t nominal, uint32_t max, uint32_t xrunsToGrow,
+                                         uint32_t stableMsToShrink)
+    : mNominal(nominal),
+      mMax(max > nominal ? max : nominal),
+      mXrunsToGrow(xrunsToGrow),
+      mStableMsToShrink(stableMsToShrink),
+      mPeriodCount(nominal),
+      mXruns(0),
+      mStableMs(0)
+{
+}
+
+uint32_t AdaptivePeriodCount::onDeviceClosed(uint32_t xruns, uint64_t durationMs)
+{
+    if (xruns != 0) {
+        mStableMs = 0;
+        mXruns += xruns;
+        if (mXruns >= mXrunsToGrow && mPeriodCount < mMax) {
+            mPeriodCount++;
+            mXruns = 0;
+        }
+        return mPeriodCount;
+    }
+    mStableMs += durationMs;
+    if (mStableMs >= mStableMsToShrink) {
+        // Stable long enough: the past xruns are forgiven, one period is given back.
+        mStableMs = 0;
+        mXruns = 0;
+        if (mPeriodCount > mNominal) {
+            mPeriodCount--;
+        }
+    }
+    return mPeriodCount;
+}
+
+} // namespace intel_audio
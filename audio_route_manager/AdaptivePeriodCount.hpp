@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Sizes the ring buffer of a stream route from the xruns seen while its device was opened.
+ * After repeated xruns, the period count grows by one, up to a maximum. After each long enough
+ * time without any, it shrinks back by one, down to the nominal count of the route.
+ * A new count applies when the device is opened next, a ring buffer cannot be resized while
+ * opened.
+ */
+class AdaptivePeriodCount
+{
+public:
+    /**
+     * @param[in] nominal period count, from the configuration of the route.
+     * @param[in] max period count, not less than the nominal one.
+     * @param[in] xrunsToGrow xruns after which the count grows.
+     * @param[in] stableMsToShrink time opened without xrun after which the count shrinks.
+     */
+    AdaptivePeriodCount(uint32_t nominal, uint32_t max, uint32_t xrunsToGrow,
+                        uint32_t stableMsToShrink);
+
+    /**
+     * Accounts an opening of the device, once closed.
+     *
+     * @param[in] xruns detected while opened.
+     * @param[in] durationMs of the opening.
+     *
+     * @return period count to open the device with next time.
+     */
+    uint32_t onDeviceClosed(uint32_t xruns, uint64_t durationMs);
+
+    uint32_t getPeriodCount() const { return mPeriodCount; }
+
+private:
+    const uint32_t mNominal;
+    const uint32_t mMax;
+    const uint32_t mXrunsToGrow;
+    const uint32_t mStableMsToShrink;
+
+    uint32_t mPeriodCount;
+    uint32_t mXruns; /**< Xruns not followed by a stable time yet. */
+    uint64_t mStableMs; /**< Time opened since the last xrun or the last change of count. */
+};
+
+} // namespace intel_audio
@@ -25,13 +25,17 @@ include $(OPTIONAL_QUALITY_ENV_SETUP)
 # Common variables
 
 component_src_files :=  \
+    AdaptivePeriodCount.cpp \
     AudioStreamRoute.cpp \
     AudioRouteManager.cpp \
     AudioRouteManagerObserver.cpp \
     MixPortConfig.cpp \
+    RoutingRecovery.cpp \
     AudioBackendRoute.cpp \
     AudioCapabilities.cpp \
-    Serializer.cpp
+    ConfigSnapshot.cpp \
+    Serializer.cpp \
+    StartupProfiler.cpp
 
 component_export_includes := \
     $(LOCAL_PATH)/includes \
@@ -67,6 +71,8 @@ component_static_lib := \
     libaudioplatformstate \
     libparametermgr_static \
     libaudioparameters \
+    libaudiotrace \
+    libaudiotelemetry \
     libaudio_comms_utilities \
     libaudio_comms_convert \
     libproperty \
@@ -146,16 +152,22 @@ include $(BUILD_SHARED_LIBRARY)
 ifeq (ENABLE_HOST_VERSION,1)
 include $(CLEAR_VARS)
 
-LOCAL_EXPORT_C_INCLUDE_DIRS := $(component_export_includes)
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(component_export_includes) $(LOCAL_PATH)/test
 
 LOCAL_C_INCLUDES := $(component_includes_dir_host)
 
 LOCAL_STATIC_LIBRARIES := $(component_static_lib_host)
 LOCAL_SHARED_LIBRARIES := $(component_shared_lib_host)
-LOCAL_SRC_FILES := $(component_src_files) test/HdmiAudioStreamRoute.cpp
+LOCAL_SRC_FILES := \
+    $(component_src_files) \
+    test/AudioDeviceStandIn.cpp \
+    test/HdmiAudioStreamRoute.cpp \
+    test/UEventStandIn.cpp
 LOCAL_CFLAGS := \
     $(component_cflags) -O0 -ggdb \
-    -DPFW_CONF_FILE_PATH=\"$(HOST_OUT)\"'"/etc/parameter-framework/"'
+    -DPFW_CONF_FILE_PATH=\"$(HOST_OUT)\"'"/etc/parameter-framework/"' \
+    -DUEVENT_STAND_IN \
+    -DAUDIO_DEVICE_STAND_IN
 
 LOCAL_MODULE := libaudioroutemanager_host
 LOCAL_MODULE_OWNER := intel
@@ -193,6 +205,43 @@ include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
 
 include $(BUILD_HOST_STATIC_LIBRARY)
 endif
+# Unit test
+#######################################################################
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := test/ConfigSnapshotTest.cpp
+
+LOCAL_C_INCLUDES := $(component_includes_dir_host) $(LOCAL_PATH)
+
+LOCAL_STATIC_LIBRARIES := $(component_static_lib_host)
+LOCAL_SHARED_LIBRARIES := libaudioroutemanager_host $(component_shared_lib_host)
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := route_manager_config_snapshot_test
+LOCAL_MODULE_OWNER := intel
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+include $(BUILD_HOST_NATIVE_TEST)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := test/AdaptivePeriodCountTest.cpp
+
+LOCAL_C_INCLUDES := $(component_includes_dir_host) $(LOCAL_PATH)
+
+LOCAL_STATIC_LIBRARIES := $(component_static_lib_host)
+LOCAL_SHARED_LIBRARIES := libaudioroutemanager_host $(component_shared_lib_host)
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := route_manager_adaptive_period_count_test
+LOCAL_MODULE_OWNER := intel
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+include $(BUILD_HOST_NATIVE_TEST)
+endif
 #######################################################################
 # Tools for audio pfw settings generation
 
@@ -153,4 +153,13 @@ const std::string AudioCapabilities::getSupportedRates() const
     return supportedRates;
 }
 
+AudioCapabilityLiterals AudioCapabilities::getLiterals(bool isOut) const
+{
+    AudioCapabilityLiterals literals;
+    literals.formats = getSupportedFormats();
+    literals.channelMasks = getSupportedChannelMasks(isOut);
+    literals.rates = getSupportedRates();
+    return literals;
+}
+
 } // namespace intel_audio
@@ -177,6 +177,10 @@ public:
      * get the route name
      */
     std::string getName() const { return mName; }
+    /**
+     * get the route name, valid as long as the route, e.g. for the trace points
+     */
+    const char *getNameCString() const { return mName.c_str(); }
     /**
      * Checks if a route needs to be muted / unmuted.
      *
@@ -197,6 +197,8 @@ public:
      * streams, closing alsa devices.
      * Disable Routes that were opened before reconsidering the routing and will be closed after
      * or routes that request to be rerouted.
+     * Note that a rerouted stream route whose pcm configuration is unchanged keeps its device
+     * opened, only the streams are detached.
      *
      * @param[in] bIsPostDisable if set, it indicates that the disable happens after unrouting.
      */
@@ -219,6 +221,7 @@ public:
      * streams, opening alsa devices.
      * Enable Routes that were not enabled and will be enabled after the routing reconsideration
      * or routes that requested to be rerouted.
+     * Note that a rerouted stream route that kept its device opened only attaches the new stream.
      *
      * @tparam isOut direction of the routes to disable.
      * @param[in] bIsPreEnable if set, it indicates that the enable happens before routing.
@@ -248,11 +251,26 @@ public:
      * @return valid stream route if found, NULL otherwise.
      */
     const AudioStreamRoute *findMatchingRouteForStream(const IoStream &stream) const
+    {
+        return findMatchingRouteForStream(stream, stream.getEffectRequested());
+    }
+
+    /**
+     * Find the most suitable route for a given stream if it requested the given effects in place
+     * of its own.
+     *
+     * @param[in] stream for which the matching route request is performed
+     * @param[in] effectMask mask of the effects requested.
+     *
+     * @return valid stream route if found, NULL otherwise.
+     */
+    const AudioStreamRoute *findMatchingRouteForStream(const IoStream &stream,
+                                                       uint32_t effectMask) const
     {
         for (const auto it : *this) {
             if (it->isMixRoute()) {
                 AudioStreamRoute *streamRoute = (AudioStreamRoute *)it;
-                if (streamRoute->isMatchingWithStream(stream)) {
+                if (streamRoute->isMatchingWithStream(stream, effectMask)) {
                     return streamRoute;
                 }
             }
@@ -260,6 +278,23 @@ public:
         return NULL;
     }
 
+    /**
+     * Checks whether the route to which the stream is attached is still the one the routing would
+     * elect for the stream, i.e. whether a change of its effects leaves the routing as it is.
+     * The route shall implement the requested effects, and no preceding route may match the
+     * stream better, e.g. a route without effects once they are removed.
+     *
+     * @param[in] stream attached to a route.
+     *
+     * @return true if the stream is routed and its route remains its matching route,
+     *         false otherwise.
+     */
+    bool isStreamRouteMatching(const IoStream &stream) const
+    {
+        const IStreamRoute *currentRoute = stream.getCurrentStreamRoute();
+        return currentRoute != NULL && findMatchingRouteForStream(stream) == currentRoute;
+    }
+
     /**
      * Handle the change of state of a device to whom it concerns by loading / resetting
      * capabilities of route(s) supporting this device.
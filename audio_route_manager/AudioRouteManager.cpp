@@ -24,14 +24,22 @@
 #include "Serializer.hpp"
 #include "RoutingStage.hpp"
 
+#include <AlsaMixer.hpp>
+#include <AlsaTopology.hpp>
 #include <AudioPlatformState.hpp>
+#include <AudioTelemetry.hpp>
+#include <AudioTrace.hpp>
+#include <KeyValueSlices.hpp>
 #include <EventThread.h>
 #include <property/Property.hpp>
 #include <Observer.hpp>
 #include <IoStream.hpp>
 #include <BitField.hpp>
 #include <cutils/bitops.h>
+#include <algorithm>
 #include <string>
+#include <thread>
+#include <time.h>
 #include <unistd.h>
 
 #include <utilities/Log.hpp>
@@ -45,6 +53,8 @@ static const uint8_t RECOVER = 8;
 static const uint8_t CRASH = 9;
 static const char *const uevent_socket_name = "uevent_emulation";
 
+#elif defined(UEVENT_STAND_IN)
+#include "test/UEventStandIn.hpp"
 #else
 #include <cutils/uevent.h>
 #endif
@@ -66,16 +76,6 @@ using audio_comms::utilities::Property;
 typedef android::RWLock::AutoRLock AutoR;
 typedef android::RWLock::AutoWLock AutoW;
 
-static const std::string gEventType {
-    "EVENT_TYPE"
-};
-static const std::string gRecoverUevent {
-    gEventType + "=" + "SST_RECOVERY"
-};
-static const std::string gCrashUevent {
-    gEventType + "=" + "SST_CRASHED"
-};
-
 namespace intel_audio
 {
 
@@ -93,59 +93,111 @@ static const std::string gRouteCriterionType[ROUTE_TYPE_NUM] = {
 };
 static const std::string gRoutingStageCriterion = "RoutageState";
 
+static uint64_t getMonotonicUs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
 AudioRouteManager::AudioRouteManager()
     : mRoutes(new AudioRouteCollection()),
       mEventThread(new CEventThread(this)),
-      mPlatformState(new AudioPlatformState())
+      mPlatformState(NULL),
+      mEffectUpdateStats(),
+      mTelemetry(NULL)
 {
+    // Load the configuration file, from its snapshot if up to date, while the platform state is
+    // created: neither depends on the other.
+    RouteSerializer serializer;
+    ConfigSnapshot snapshot;
+    status_t status = NAME_NOT_FOUND;
+    std::thread configLoader([this, &serializer, &snapshot, &status]() {
+        StartupProfiler::Phase phase(mStartupProfiler, "ConfigLoad");
+        for (const auto &path : gConfigFilePathList) {
+            status = serializer.load((string(path) + string(gConfigFileName)).c_str(), snapshot);
+            if (status == OK) {
+                break;
+            }
+        }
+    });
+
+    {
+        StartupProfiler::Phase phase(mStartupProfiler, "UEventSocketOpen");
 #ifdef EMULATE_UEVENT
-    mUEventFd = socket_local_server(uevent_socket_name, ANDROID_SOCKET_NAMESPACE_ABSTRACT,
-                                    SOCK_STREAM);
-    if (mUEventFd == -1) {
-        Log::Error() << __FUNCTION__ << "socket_local_server connection to uevent_emulation failed";
-    }
+        mUEventFd = socket_local_server(uevent_socket_name, ANDROID_SOCKET_NAMESPACE_ABSTRACT,
+                                        SOCK_STREAM);
+        if (mUEventFd == -1) {
+            Log::Error() << __FUNCTION__
+                         << "socket_local_server connection to uevent_emulation failed";
+        }
+#elif defined(UEVENT_STAND_IN)
+        mUEventFd = UEventStandIn::open();
 #else
-    mUEventFd = uevent_open_socket(gSocketBufferDefaultSize, true);
-    if (mUEventFd < 0) {
-        Log::Error() << __FUNCTION__ << "uevent_open_socket failed, recovery will not work";
-    }
+        mUEventFd = uevent_open_socket(gSocketBufferDefaultSize, true);
+        if (mUEventFd < 0) {
+            Log::Error() << __FUNCTION__ << "uevent_open_socket failed, recovery will not work";
+        }
 #endif
-    // Add UEvent to list of Fd to poll BEFORE starting this event thread.
-    if (mUEventFd >= 0) {
-        Log::Debug() << __FUNCTION__ << ": UEvent fd added to event thread";
-        mEventThread->addOpenedFd(FdFromSstDriver, mUEventFd, true);
-    }
-    // Load configuration file to populate Criterion types, criteria and rogues.
-    Criteria mCriteria;
-    CriterionTypes mCriterionTypes;
-    RouteManagerConfig config(*mRoutes, mCriteria, mCriterionTypes, mParameters,
-                              mPlatformState->getConnector<Audio>());
-    RouteSerializer serializer;
-    status_t status;
-    for (const auto &path : gConfigFilePathList) {
-        status = serializer.deserialize((string(path) + string(gConfigFileName)).c_str(), config);
-        if (status == OK) {
-            break;
+        // Add UEvent to list of Fd to poll BEFORE starting this event thread.
+        if (mUEventFd >= 0) {
+            Log::Debug() << __FUNCTION__ << ": UEvent fd added to event thread";
+            mEventThread->addOpenedFd(FdFromSstDriver, mUEventFd, true);
         }
     }
-    AUDIOCOMMS_ASSERT(status == NO_ERROR, "AudioRouteManager: could not parse any config file");
-
-    mPlatformState->setConfig<Audio>(mCriteria, mCriterionTypes, mParameters);
-    for (const auto route : *mRoutes) {
-        mPlatformState->addCriterionTypeValuePair<Audio>(gRouteCriterionType[route->
-                                                                             getRouteType()],
-                                                         route->getName(),
-                                                         route->getMask());
+    {
+        StartupProfiler::Phase phase(mStartupProfiler, "PlatformStateCreation");
+        mPlatformState = new AudioPlatformState();
+    }
+    {
+        // Browse the cards and device nodes once, the routes resolve them when opening.
+        StartupProfiler::Phase phase(mStartupProfiler, "AlsaTopologyScan");
+        AlsaTopology::getInstance().refresh();
     }
 
-    /// Construct the platform state component and start it
-    status = mPlatformState->start();
-    AUDIOCOMMS_ASSERT(status == NO_ERROR, "AudioRouteManager: could not start Platform State");
-
-    // Now that is setup correctly to ensure the route service, start the event thread!
-    bool isStarted = mEventThread->start();
-    AUDIOCOMMS_ASSERT(isStarted, "AudioRouteManager: Failed to start event thread");
+    // Join barrier: routes and criteria are deserialized against the platform state connector.
+    configLoader.join();
+    AUDIOCOMMS_ASSERT(status == NO_ERROR, "AudioRouteManager: could not parse any config file");
 
+    {
+        // Populate Criterion types, criteria and rogues.
+        StartupProfiler::Phase phase(mStartupProfiler, "ConfigDeserialization");
+        Criteria mCriteria;
+        CriterionTypes mCriterionTypes;
+        RouteManagerConfig config(*mRoutes, mCriteria, mCriterionTypes, mParameters,
+                                  mPlatformState->getConnector<Audio>());
+        status = serializer.deserialize(snapshot, config);
+        AUDIOCOMMS_ASSERT(status == NO_ERROR, "AudioRouteManager: could not deserialize config");
+
+        mPlatformState->setConfig<Audio>(mCriteria, mCriterionTypes, mParameters);
+    }
+    {
+        StartupProfiler::Phase phase(mStartupProfiler, "RouteCriteriaSetup");
+        // Intern the criteria set on each routing pass once for all
+        for (uint32_t i = 0; i < ROUTE_TYPE_NUM; i++) {
+            mOpenedRouteCriterionIds.push_back(
+                mPlatformState->getCriterionId<Audio>(gOpenedRouteCriterion[i]));
+        }
+        mRoutingStageCriterionId = mPlatformState->getCriterionId<Audio>(gRoutingStageCriterion);
+        for (const auto route : *mRoutes) {
+            mPlatformState->addCriterionTypeValuePair<Audio>(gRouteCriterionType[route->
+                                                                                 getRouteType()],
+                                                             route->getName(),
+                                                             route->getMask());
+        }
+    }
+    {
+        /// Construct the platform state component and start it
+        StartupProfiler::Phase phase(mStartupProfiler, "PlatformStateStart");
+        status = mPlatformState->start();
+        AUDIOCOMMS_ASSERT(status == NO_ERROR, "AudioRouteManager: could not start Platform State");
+    }
+    {
+        // Now that is setup correctly to ensure the route service, start the event thread!
+        StartupProfiler::Phase phase(mStartupProfiler, "EventThreadStart");
+        bool isStarted = mEventThread->start();
+        AUDIOCOMMS_ASSERT(isStarted, "AudioRouteManager: Failed to start event thread");
+    }
 }
 
 AudioRouteManager::~AudioRouteManager()
@@ -236,7 +288,8 @@ void AudioRouteManager::doReconsiderRouting()
         // Note that system Audio PFW Alsa plugin is not aware of availability of audio subsystem,
         // we prevent to use it while audio subsystem is down.
         if (mAudioSubsystemAvailable) {
-            mPlatformState->commitCriteriaAndApplyConfiguration<Audio>();
+            CriteriaTransaction<Audio> transaction(*mPlatformState);
+            transaction.commit();
         }
         return;
     }
@@ -279,15 +332,61 @@ void AudioRouteManager::executeRouting()
         mRoutes->postDisableRoutes();
         return;
     }
-    executeMuteRoutingStage();
+    AUDIO_TRACE_SCOPE("AudioRouteManager::executeRouting");
+    uint64_t startUs = getMonotonicUs();
+    uint32_t muteChanges = executeMuteRoutingStage();
 
-    executeDisableRoutingStage();
+    uint32_t disableChanges = executeDisableRoutingStage();
 
-    executeConfigureRoutingStage();
+    uint32_t configureChanges = executeConfigureRoutingStage();
 
-    executeEnableRoutingStage();
+    uint32_t enableChanges = executeEnableRoutingStage();
+
+    uint32_t unmuteChanges = executeUnmuteRoutingStage();
+
+    uint64_t endUs = getMonotonicUs();
+    uint64_t durationUs = endUs - startUs;
+    mEffectUpdateStats.routingCount++;
+    mEffectUpdateStats.routingLastUs = endUs;
+    mEffectUpdateStats.routingTotalUs += durationUs;
+    mEffectUpdateStats.routingMaxUs = std::max(mEffectUpdateStats.routingMaxUs, durationUs);
+    AudioTrace::counter("AudioRouteManager::criteriaChanges", muteChanges + disableChanges +
+                        configureChanges + enableChanges + unmuteChanges);
+    publishTelemetry();
+
+    Log::Debug() << __FUNCTION__ << ": criteria changes per stage: mute=" << muteChanges
+                 << " disable=" << disableChanges << " configure=" << configureChanges
+                 << " enable=" << enableChanges << " unmute=" << unmuteChanges;
+}
+
+void AudioRouteManager::executeRecovery()
+{
+    mRecovery.onRecoveryStart();
 
+    // Mixer values were lost with the subsystem.
+    AlsaMixerService::getInstance().reset();
+
+    // Routes were disabled and their devices closed on crash, without involving the PFW.
+    resetRouting();
+    mRoutes->prepareRouting();
+
+    // Restore in one batch the route criteria as they stand once disabled, along with any
+    // criterion staged while the subsystem was down: nothing is left to mute nor to disable.
+    {
+        CriteriaTransaction<Audio> transaction(*mPlatformState);
+        for (const auto id : mOpenedRouteCriterionIds) {
+            transaction.setCriterion(id, 0);
+        }
+        transaction.setCriterion(mRoutingStageCriterionId, PathMask);
+        transaction.commit();
+    }
+    // Reopen the devices needed by the streams in dependency order: devices to open before
+    // routing, paths, stream paths, then the other devices and the streams attached.
+    executeConfigureRoutingStage();
+    executeEnableRoutingStage();
     executeUnmuteRoutingStage();
+
+    mRecovery.onRecoveryDone(*mRoutes);
 }
 
 void AudioRouteManager::resetRouting()
@@ -304,87 +403,101 @@ bool AudioRouteManager::checkAndPrepareRouting()
     return mRoutes->routingHasChanged();
 }
 
-void AudioRouteManager::executeMuteRoutingStage()
+uint32_t AudioRouteManager::executeMuteRoutingStage()
 {
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, FlowMask);
+    AUDIO_TRACE_SCOPE("AudioRouteManager::executeMuteRoutingStage");
+    CriteriaTransaction<Audio> transaction(*mPlatformState);
+    transaction.setCriterion(mRoutingStageCriterionId, FlowMask);
     setRouteCriteriaForMute();
-    mPlatformState->commitCriteriaAndApplyConfiguration<Audio>();
+    transaction.commit();
+    return transaction.getChanges();
 }
 
-void AudioRouteManager::executeDisableRoutingStage()
+uint32_t AudioRouteManager::executeDisableRoutingStage()
 {
+    AUDIO_TRACE_SCOPE("AudioRouteManager::executeDisableRoutingStage");
+    CriteriaTransaction<Audio> transaction(*mPlatformState);
     mRoutes->disableRoutes();
 
     setRouteCriteriaForDisable();
 
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, PostPathMask);
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.setCriterion(mRoutingStageCriterionId, PostPathMask);
+    transaction.commit();
 
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, StreamPathMask);
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.setCriterion(mRoutingStageCriterionId, StreamPathMask);
+    transaction.commit();
 
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, PathMask);
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.setCriterion(mRoutingStageCriterionId, PathMask);
+    transaction.commit();
 
     mRoutes->postDisableRoutes();
 
+    return transaction.getChanges();
 }
 
-void AudioRouteManager::executeConfigureRoutingStage()
+uint32_t AudioRouteManager::executeConfigureRoutingStage()
 {
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, ConfigureMask);
+    AUDIO_TRACE_SCOPE("AudioRouteManager::executeConfigureRoutingStage");
+    CriteriaTransaction<Audio> transaction(*mPlatformState);
+    transaction.setCriterion(mRoutingStageCriterionId, ConfigureMask);
     setRouteCriteriaForConfigure();
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.commit();
+    return transaction.getChanges();
 }
 
-void AudioRouteManager::executeEnableRoutingStage()
+uint32_t AudioRouteManager::executeEnableRoutingStage()
 {
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion, ConfigureMask | PathMask);
+    AUDIO_TRACE_SCOPE("AudioRouteManager::executeEnableRoutingStage");
+    CriteriaTransaction<Audio> transaction(*mPlatformState);
+    transaction.setCriterion(mRoutingStageCriterionId, ConfigureMask | PathMask);
 
     mRoutes->preEnableRoutes();
 
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.commit();
 
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion,
-                                        ConfigureMask | PathMask | StreamPathMask);
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.setCriterion(mRoutingStageCriterionId, ConfigureMask | PathMask | StreamPathMask);
+    transaction.commit();
 
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion,
-                                        ConfigureMask | PathMask | StreamPathMask | PostPathMask);
-    mPlatformState->applyConfiguration<Audio>();
+    transaction.setCriterion(mRoutingStageCriterionId,
+                             ConfigureMask | PathMask | StreamPathMask | PostPathMask);
+    transaction.commit();
 
     mRoutes->enableRoutes();
+
+    return transaction.getChanges();
 }
 
-void AudioRouteManager::executeUnmuteRoutingStage()
+uint32_t AudioRouteManager::executeUnmuteRoutingStage()
 {
-    mPlatformState->setCriterion<Audio>(gRoutingStageCriterion,
-                                        ConfigureMask | PathMask | StreamPathMask | PostPathMask |
-                                        FlowMask);
-    mPlatformState->applyConfiguration<Audio>();
+    AUDIO_TRACE_SCOPE("AudioRouteManager::executeUnmuteRoutingStage");
+    CriteriaTransaction<Audio> transaction(*mPlatformState);
+    transaction.setCriterion(mRoutingStageCriterionId,
+                             ConfigureMask | PathMask | StreamPathMask | PostPathMask | FlowMask);
+    transaction.commit();
+    return transaction.getChanges();
 }
 
 void AudioRouteManager::setRouteCriteriaForConfigure()
 {
     for (uint32_t i = 0; i < ROUTE_TYPE_NUM; i++) {
-        mPlatformState->setCriterion<Audio>(gOpenedRouteCriterion[i],
-                                            mRoutes->enabledRouteMask(i));
+        mPlatformState->stageCriterion<Audio>(mOpenedRouteCriterionIds[i],
+                                              mRoutes->enabledRouteMask(i));
     }
 }
 
 void AudioRouteManager::setRouteCriteriaForMute()
 {
     for (uint32_t i = 0; i < ROUTE_TYPE_NUM; i++) {
-        mPlatformState->setCriterion<Audio>(gOpenedRouteCriterion[i],
-                                            mRoutes->unmutedRoutes(i));
+        mPlatformState->stageCriterion<Audio>(mOpenedRouteCriterionIds[i],
+                                              mRoutes->unmutedRoutes(i));
     }
 }
 
 void AudioRouteManager::setRouteCriteriaForDisable()
 {
     for (uint32_t i = 0; i < ROUTE_TYPE_NUM; i++) {
-        mPlatformState->setCriterion<Audio>(gOpenedRouteCriterion[i],
-                                            mRoutes->openedRoutes(i));
+        mPlatformState->stageCriterion<Audio>(mOpenedRouteCriterionIds[i],
+                                              mRoutes->openedRoutes(i));
     }
 }
 
@@ -423,32 +536,43 @@ bool AudioRouteManager::onEvent(int fd)
         char msg[gUEventMsgMaxLeng + 1] = {
             0
         };
-        char *cp;
         int n;
 
+#ifdef UEVENT_STAND_IN
+        n = UEventStandIn::receive(mUEventFd, msg, gUEventMsgMaxLeng);
+#else
         n = uevent_kernel_multicast_recv(mUEventFd, msg, gUEventMsgMaxLeng);
+#endif
         if (n <= 0 || n > gUEventMsgMaxLeng) {
             return false;
         }
         msg[n] = '\0';
-        cp = msg;
-        while (cp < msg + n) {
-            if (!strcmp(cp, gRecoverUevent.c_str())) {
-                Log::Warning() << __FUNCTION__ << ": Audio Subsystem Up and Running again :-)";
-                audioSubsystemAvailable = true;
-                break;
-            } else if (!strcmp(cp, gCrashUevent.c_str())) {
-                Log::Warning() << __FUNCTION__ << ": Audio Subsystem down :-(";
-                audioSubsystemAvailable = false;
-                break;
-            }
-            cp += strlen(cp) + 1;
+        if (AlsaTopology::getInstance().onUEvent(msg, n)) {
+            AlsaMixerService::getInstance().reset();
+        }
+        switch (RoutingRecovery::parseUEvent(msg, n)) {
+        case RoutingRecovery::SubsystemRecovered:
+            Log::Warning() << __FUNCTION__ << ": Audio Subsystem Up and Running again :-)";
+            audioSubsystemAvailable = true;
+            break;
+        case RoutingRecovery::SubsystemCrashed:
+            Log::Warning() << __FUNCTION__ << ": Audio Subsystem down :-(";
+            audioSubsystemAvailable = false;
+            break;
+        case RoutingRecovery::NoSubsystemEvent:
+            break;
         }
 #endif
         AutoW lock(mRoutingLock);
         if (audioSubsystemAvailable != mAudioSubsystemAvailable) {
-            mAudioSubsystemAvailable = audioSubsystemAvailable;
-            doReconsiderRouting();
+            if (audioSubsystemAvailable) {
+                mAudioSubsystemAvailable = true;
+                executeRecovery();
+            } else {
+                mRecovery.onCrash(*mRoutes);
+                mAudioSubsystemAvailable = false;
+                doReconsiderRouting();
+            }
         }
     }
     return false;
@@ -550,16 +674,23 @@ uint32_t AudioRouteManager::getLatencyInUs(const IoStream &stream) const
 
 bool AudioRouteManager::supportStreamConfig(const IoStream &stream) const
 {
-    return mRoutes->findMatchingRouteForStream(stream) != nullptr;
+    return supportStreamConfig(stream, stream.getEffectRequested());
+}
+
+bool AudioRouteManager::supportStreamConfig(const IoStream &stream, uint32_t effectMask) const
+{
+    AutoR lock(mRoutingLock);
+    return mRoutes->findMatchingRouteForStream(stream, effectMask) != nullptr;
 }
 
-AudioCapabilities AudioRouteManager::getCapabilities(const IoStream &stream) const
+AudioCapabilityLiterals AudioRouteManager::getCapabilityLiterals(const IoStream &stream) const
 {
+    AutoR lock(mRoutingLock);
     auto streamRoute = mRoutes->findMatchingRouteForStream(stream);
     if (streamRoute != nullptr) {
-        return streamRoute->getCapabilities();
+        return streamRoute->getCapabilityLiterals();
     }
-    return AudioCapabilities();
+    return AudioCapabilityLiterals();
 }
 
 status_t AudioRouteManager::setParameters(const std::string &keyValuePair, bool isSynchronous)
@@ -567,7 +698,7 @@ status_t AudioRouteManager::setParameters(const std::string &keyValuePair, bool
     AutoW lock(mRoutingLock);
     bool hasChanged = false;
     status_t ret = mPlatformState->setParameters(keyValuePair, hasChanged);
-    KeyValuePairs pairs(keyValuePair);
+    KeyValueSlices pairs(keyValuePair);
     bool isSelect = false;
     for (const auto param : mParameters) {
         status_t st = pairs.get<bool>(param->getKey(), isSelect);
@@ -598,6 +729,79 @@ status_t AudioRouteManager::setParameters(const std::string &keyValuePair, bool
     return ret;
 }
 
+status_t AudioRouteManager::setParameters(const StreamsParameters &parameters,
+                                          bool isSynchronous)
+{
+    AutoW lock(mRoutingLock);
+    bool hasChanged = false;
+    status_t ret = mPlatformState->setParameters(parameters, hasChanged);
+
+    // Inconditionnaly reconsider the routing as even if the parameters are the same, concurrent
+    // streams with identical settings may have been stopped/started.
+    reconsiderRoutingUnsafe(isSynchronous);
+    return ret;
+}
+
+status_t AudioRouteManager::updateStreamEffects(const IoStream &stream,
+                                                const StreamsParameters &parameters)
+{
+    AutoW lock(mRoutingLock);
+    // The PFW Alsa plugin is not aware of the audio subsystem availability, do not involve it.
+    if (!mAudioSubsystemAvailable || !mRoutes->isStreamRouteMatching(stream)) {
+        mEffectUpdateStats.reroutingCount++;
+        return INVALID_OPERATION;
+    }
+    uint64_t startUs = getMonotonicUs();
+    bool hasChanged = false;
+    status_t ret = mPlatformState->setParameters(parameters, hasChanged);
+    if (hasChanged) {
+        CriteriaTransaction<Audio> transaction(*mPlatformState);
+        transaction.commit();
+    }
+    uint64_t durationUs = getMonotonicUs() - startUs;
+    mEffectUpdateStats.inPlaceCount++;
+    mEffectUpdateStats.inPlaceTotalUs += durationUs;
+    mEffectUpdateStats.inPlaceMaxUs = std::max(mEffectUpdateStats.inPlaceMaxUs, durationUs);
+    Log::Debug() << __FUNCTION__ << ": effects applied in place in " << durationUs << " us";
+    return ret;
+}
+
+RoutingRecovery::Stats AudioRouteManager::getRecoveryStats() const
+{
+    AutoR lock(mRoutingLock);
+    return mRecovery.getStats();
+}
+
+AudioRouteManager::EffectUpdateStats AudioRouteManager::getEffectUpdateStats() const
+{
+    AutoR lock(mRoutingLock);
+    return mEffectUpdateStats;
+}
+
+void AudioRouteManager::setTelemetry(AudioTelemetry *telemetry)
+{
+    AutoW lock(mRoutingLock);
+    mTelemetry = telemetry;
+    publishTelemetry();
+}
+
+void AudioRouteManager::publishTelemetry() const
+{
+    telemetry::RoutingSlot *slot = mTelemetry != NULL ? mTelemetry->getRoutingSlot() : NULL;
+    if (slot == NULL) {
+        return;
+    }
+    telemetry::RoutingCounters counters;
+    counters.routingCount = mEffectUpdateStats.routingCount;
+    counters.routingTotalUs = mEffectUpdateStats.routingTotalUs;
+    counters.routingMaxUs = mEffectUpdateStats.routingMaxUs;
+    counters.lastRoutingTimeNs = mEffectUpdateStats.routingLastUs * 1000;
+    counters.updateTimeNs = AudioTelemetry::getMonotonicNs();
+    counters.enabledPlaybackRoutes = mRoutes->enabledRouteMask(ROUTE_TYPE_STREAM_PLAYBACK);
+    counters.enabledCaptureRoutes = mRoutes->enabledRouteMask(ROUTE_TYPE_STREAM_CAPTURE);
+    slot->write(counters);
+}
+
 std::string AudioRouteManager::getParameters(const std::string &keys) const
 {
     AutoR lock(mRoutingLock);
@@ -613,8 +817,25 @@ android::status_t AudioRouteManager::dump(const int fd, int spaces) const
 
     snprintf(buffer, SIZE, "%*sAudio Route Manager:\n", spaces, "");
     result.append(buffer);
+    const EffectUpdateStats &stats = mEffectUpdateStats;
+    snprintf(buffer, SIZE, "%*sEffect updates: in place %u (avg %llu us, max %llu us),"
+             " rerouted %u\n", spaces + 4, "", stats.inPlaceCount,
+             static_cast<unsigned long long>(stats.inPlaceCount != 0 ?
+                                             stats.inPlaceTotalUs / stats.inPlaceCount : 0),
+             static_cast<unsigned long long>(stats.inPlaceMaxUs), stats.reroutingCount);
+    result.append(buffer);
+    snprintf(buffer, SIZE, "%*sRouting passes: %u (avg %llu us, max %llu us)\n", spaces + 4, "",
+             stats.routingCount,
+             static_cast<unsigned long long>(stats.routingCount != 0 ?
+                                             stats.routingTotalUs / stats.routingCount : 0),
+             static_cast<unsigned long long>(stats.routingMaxUs));
+    result.append(buffer);
 
     write(fd, result.string(), result.size());
+    mStartupProfiler.dump(fd, spaces + 4);
+    mRecovery.dump(fd, spaces + 4);
+    AlsaTopology::getInstance().dump(fd, spaces + 4);
+    AlsaMixerService::getInstance().dump(fd, spaces + 4);
     mRoutes->dump(fd, spaces + 4);
     return android::OK;
 }
@@ -17,6 +17,7 @@
 // #define LOG_NDEBUG 0
 
 #include "AudioStreamRoute.hpp"
+#include "AdaptivePeriodCount.hpp"
 #include <AudioDevice.hpp>
 #include <typeconverter/TypeConverter.hpp>
 #include <AudioUtils.hpp>
@@ -24,24 +25,40 @@
 #include <IStreamRoute.hpp>
 #include <EffectHelper.hpp>
 #include <AudioCommsAssert.hpp>
+#include <AudioTrace.hpp>
 #include <utilities/Log.hpp>
+#include <property/Property.hpp>
 #include <policy.h>
 #include <utils/String8.h>
 #include "AudioPort.hpp"
+#include <time.h>
 #include <unistd.h>
 
 using namespace std;
 using audio_comms::utilities::Log;
+using audio_comms::utilities::Property;
 
 namespace intel_audio
 {
 
+const char *const AudioStreamRoute::mMaxPeriodCountProp = "audio.route.max_period_count";
+
+static uint64_t getMonotonicMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
 AudioStreamRoute::AudioStreamRoute(string name, AudioPorts &sinks, AudioPorts &sources,
                                    uint32_t type)
     : AudioRoute(name, sinks, sources, type),
       mCurrentStream(NULL),
       mNewStream(NULL),
-      mEffectSupported(0)
+      mEffectSupported(0),
+      mOpenedPcmConfig(),
+      mAdaptivePeriodCount(NULL),
+      mDeviceOpenedMs(0)
 {
     mIsOut = (type == ROUTE_TYPE_STREAM_PLAYBACK);
     MixPort *port = NULL;
@@ -52,10 +69,18 @@ AudioStreamRoute::AudioStreamRoute(string name, AudioPorts &sinks, AudioPorts &s
     }
     mConfig = port->getConfig();
     mAudioDevice = port->getAlsaDevice();
+
+    uint32_t maxPeriodCount = Property<uint32_t>(mMaxPeriodCountProp, 0).getValue();
+    if (maxPeriodCount > mConfig.periodCount) {
+        mAdaptivePeriodCount = new AdaptivePeriodCount(mConfig.periodCount, maxPeriodCount,
+                                                       mXrunsToGrowPeriodCount,
+                                                       mStableMsToShrinkPeriodCount);
+    }
 }
 
 AudioStreamRoute::~AudioStreamRoute()
 {
+    delete mAdaptivePeriodCount;
     delete mAudioDevice;
 }
 
@@ -84,8 +109,9 @@ bool AudioStreamRoute::needReflow()
 android::status_t AudioStreamRoute::route(bool isPreEnable)
 {
     AUDIOCOMMS_ASSERT(mAudioDevice != nullptr, "No valid device attached");
-    if (isPreEnable == isPreEnableRequired()) {
+    if ((isPreEnable == isPreEnableRequired()) && !mKeepDeviceOpened) {
 
+        AUDIO_TRACE_SCOPE("AudioStreamRoute::openDevice", getNameCString());
         android::status_t err = mAudioDevice->open(getCardName(), getPcmDeviceId(),
                                                    getRouteConfig(), isOut());
         if (err) {
@@ -93,9 +119,12 @@ android::status_t AudioStreamRoute::route(bool isPreEnable)
             // Failed to open PCM device -> bailing out
             return err;
         }
+        mConfig.getPcmConfig(mOpenedPcmConfig);
+        mDeviceOpenedMs = getMonotonicMs();
     }
 
     if (!isPreEnable) {
+        mKeepDeviceOpened = false;
 
         if (!mAudioDevice->isOpened()) {
             Log::Error() << __FUNCTION__ << ": error opening audio device, cannot route new stream";
@@ -122,6 +151,14 @@ void AudioStreamRoute::unroute(bool isPostDisable)
     AUDIOCOMMS_ASSERT(mAudioDevice != nullptr, "No valid device attached");
     if (!isPostDisable) {
 
+        // A repath with unchanged hardware parameters only swaps the streams, the device
+        // is kept opened to save the close / reopen cost and the resulting glitch.
+        mKeepDeviceOpened = needRepath() && canKeepDeviceOpened();
+        if (mKeepDeviceOpened) {
+            Log::Debug() << __FUNCTION__ << ": route " << getName()
+                         << " repathed with unchanged pcm config, keeping device opened";
+        }
+
         if (!mAudioDevice->isOpened()) {
             Log::Error() << __FUNCTION__
                          << ": error opening audio device, cannot unroute current stream";
@@ -136,14 +173,50 @@ void AudioStreamRoute::unroute(bool isPostDisable)
         detachCurrentStream();
     }
 
-    if (isPostDisable == isPostDisableRequired()) {
+    if ((isPostDisable == isPostDisableRequired()) && !mKeepDeviceOpened) {
 
+        AUDIO_TRACE_SCOPE("AudioStreamRoute::closeDevice", getNameCString());
+        uint32_t xruns = mAudioDevice->getXrunCounters().xruns;
         android::status_t err = mAudioDevice->close();
         if (err) {
 
             return;
         }
+        adaptPeriodCount(xruns);
+    }
+}
+
+void AudioStreamRoute::adaptPeriodCount(uint32_t xruns)
+{
+    if (mAdaptivePeriodCount == NULL) {
+        return;
+    }
+    uint32_t periodCount =
+        mAdaptivePeriodCount->onDeviceClosed(xruns, getMonotonicMs() - mDeviceOpenedMs);
+    if (periodCount != mConfig.periodCount) {
+        Log::Info() << __FUNCTION__ << ": route " << getName() << " resized from "
+                    << mConfig.periodCount << " to " << periodCount << " periods after "
+                    << xruns << " xrun(s)";
+        mConfig.setPeriodCount(periodCount);
+    }
+}
+
+bool AudioStreamRoute::canKeepDeviceOpened() const
+{
+    if (!mAudioDevice->isOpened()) {
+        return false;
     }
+    pcm_config newConfig;
+    mConfig.getPcmConfig(newConfig);
+    return (newConfig.rate == mOpenedPcmConfig.rate) &&
+           (newConfig.channels == mOpenedPcmConfig.channels) &&
+           (newConfig.format == mOpenedPcmConfig.format) &&
+           (newConfig.period_size == mOpenedPcmConfig.period_size) &&
+           (newConfig.period_count == mOpenedPcmConfig.period_count) &&
+           (newConfig.start_threshold == mOpenedPcmConfig.start_threshold) &&
+           (newConfig.stop_threshold == mOpenedPcmConfig.stop_threshold) &&
+           (newConfig.silence_threshold == mOpenedPcmConfig.silence_threshold) &&
+           (newConfig.avail_min == mOpenedPcmConfig.avail_min);
 }
 
 void AudioStreamRoute::resetAvailability()
@@ -182,12 +255,12 @@ bool AudioStreamRoute::setStream(IoStream &stream)
     return true;
 }
 
-bool AudioStreamRoute::isMatchingWithStream(const IoStream &stream) const
+bool AudioStreamRoute::isMatchingWithStream(const IoStream &stream, uint32_t effectMask) const
 {
     bool verdict = ((stream.isOut() == isOut()) &&
                     areFlagsMatching(stream.getFlagMask()) &&
                     areUseCasesMatching(stream.getUseCaseMask()) &&
-                    implementsEffects(stream.getEffectRequested()) &&
+                    implementsEffects(effectMask) &&
                     supportDeviceAddress(stream.getDeviceAddress(), stream.getDevices()) &&
                     supportStreamConfig(stream) &&
                     supportDevices(stream.getDevices()));
@@ -22,6 +22,7 @@
 #include <SampleSpec.hpp>
 #include <IoStream.hpp>
 #include <list>
+#include <tinyalsa/asoundlib.h>
 #include <utils/Errors.h>
 #include "AudioPort.hpp"
 #include "AudioRoute.hpp"
@@ -30,6 +31,7 @@ namespace intel_audio
 {
 
 class IAudioDevice;
+class AdaptivePeriodCount;
 
 
 
@@ -132,7 +134,21 @@ public:
      *
      * @return true if the route matches, false otherwise.
      */
-    bool isMatchingWithStream(const IoStream &stream) const;
+    bool isMatchingWithStream(const IoStream &stream) const
+    {
+        return isMatchingWithStream(stream, stream.getEffectRequested());
+    }
+
+    /**
+     * Checks if the stream route matches the given stream attributes, the stream requesting the
+     * given effects in place of its own.
+     *
+     * @param stream candidate for using this route.
+     * @param effectMask mask of the effects requested.
+     *
+     * @return true if the route matches, false otherwise.
+     */
+    bool isMatchingWithStream(const IoStream &stream, uint32_t effectMask) const;
 
     /**
      * Checks if the stream route capabilities are matching with the stream sample specification
@@ -224,6 +240,16 @@ public:
      */
     bool supportDevices(audio_devices_t streamDeviceMask) const;
 
+    /**
+     * Checks if route implements all effects in the mask.
+     *
+     * @param[in] effectMask mask of the effects to check.
+     *
+     * @return true if all effects in the mask are supported by the stream route,
+     *          false otherwise
+     */
+    bool implementsEffects(uint32_t effectMask) const;
+
     /**
      * Checks if a route needs to be muted / unmuted.
      *
@@ -247,7 +273,10 @@ public:
         return stillUsed() && (mCurrentStream != mNewStream);
     }
 
-    AudioCapabilities getCapabilities() const { return mConfig.mAudioCapabilities; }
+    const AudioCapabilityLiterals &getCapabilityLiterals() const
+    {
+        return mConfig.getCapabilityLiterals();
+    }
 
     android::status_t dump(const int fd, int spaces = 0) const;
 
@@ -280,16 +309,6 @@ private:
      */
     inline bool areFlagsMatching(uint32_t streamFlagMask) const;
 
-    /**
-     * Checks if route implements all effects in the mask.
-     *
-     * @param[in] effectMask mask of the effects to check.
-     *
-     * @return true if all effects in the mask are supported by the stream route,
-     *          false otherwise
-     */
-    bool implementsEffects(uint32_t effectMask) const;
-
     /**
      * Get the id of current pcm device.
      *
@@ -325,8 +344,42 @@ private:
      */
     android::status_t detachCurrentStream();
 
+    /**
+     * Feeds the adaptive period count policy, if enabled, with an opening of the device once
+     * closed, and resizes the ring buffer of the next opening accordingly.
+     *
+     * @param[in] xruns detected while the device was opened.
+     */
+    void adaptPeriodCount(uint32_t xruns);
+
+    /**
+     * Checks if the audio device may be kept opened while the route is repathed, i.e. if the
+     * pcm configuration required by the new stream is the same as the one used to open
+     * the device.
+     *
+     * @return true if the device does not need to be closed / reopened, false otherwise.
+     */
+    bool canKeepDeviceOpened() const;
+
     IAudioDevice *mAudioDevice; /**< Platform dependant audio device. */
     bool mIsOut;
+
+    pcm_config mOpenedPcmConfig; /**< Pcm configuration used to open the audio device. */
+
+    /**
+     * Set if the route is repathed without closing / reopening the audio device, only the
+     * streams are detached / attached around the path stages.
+     */
+    bool mKeepDeviceOpened = false;
+
+    /** Period count policy, NULL unless enabled by mMaxPeriodCountProp. */
+    AdaptivePeriodCount *mAdaptivePeriodCount;
+    uint64_t mDeviceOpenedMs; /**< CLOCK_MONOTONIC time of the last opening of the device. */
+
+    /** Max period count of the adaptive policy, disabled if not above the nominal count. */
+    static const char *const mMaxPeriodCountProp;
+    static const uint32_t mXrunsToGrowPeriodCount = 2;
+    static const uint32_t mStableMsToShrinkPeriodCount = 60000;
 };
 
 } // namespace intel_audio
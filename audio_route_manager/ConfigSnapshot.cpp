@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RouteManager/ConfigSnapshot"
+
+#include "ConfigSnapshot.hpp"
+#include <AudioCommsAssert.hpp>
+#include <utilities/Log.hpp>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using android::status_t;
+using audio_comms::utilities::Log;
+
+namespace intel_audio
+{
+
+const uint32_t ConfigSnapshotBuilder::gNoElement = UINT32_MAX;
+
+const uint32_t ConfigSnapshot::gMagic = 0x53434d52; // "RMCS" read as little endian
+const uint32_t ConfigSnapshot::gVersion = 1;
+
+/** Size and modification time of a file, all zero if the file is missing. */
+static void getFileStamp(const string &path, uint32_t &size, uint32_t &time, uint32_t &timeNs)
+{
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0) {
+        size = time = timeNs = 0;
+        return;
+    }
+    size = static_cast<uint32_t>(fileStat.st_size);
+    time = static_cast<uint32_t>(fileStat.st_mtim.tv_sec);
+    timeNs = static_cast<uint32_t>(fileStat.st_mtim.tv_nsec);
+}
+
+const char *ConfigNode::getName() const
+{
+    return mSnapshot->getString(mSnapshot->mNodes[mIndex].name);
+}
+
+string ConfigNode::getAttribute(const char *name) const
+{
+    const ConfigSnapshot::Node &node = mSnapshot->mNodes[mIndex];
+    for (uint32_t i = 0; i < node.attributeCount; i++) {
+        const ConfigSnapshot::Attribute &attribute =
+            mSnapshot->mAttributes[node.firstAttribute + i];
+        if (strcmp(mSnapshot->getString(attribute.name), name) == 0) {
+            return mSnapshot->getString(attribute.value);
+        }
+    }
+    return "";
+}
+
+ConfigNode ConfigNode::getFirstChild() const
+{
+    return ConfigNode(mSnapshot, mSnapshot->mNodes[mIndex].firstChild);
+}
+
+ConfigNode ConfigNode::getNext() const
+{
+    return ConfigNode(mSnapshot, mSnapshot->mNodes[mIndex].next);
+}
+
+ConfigNode::ConfigNode(const ConfigSnapshot *snapshot, uint32_t index)
+    : mSnapshot(index == ConfigSnapshotBuilder::gNoElement ? NULL : snapshot),
+      mIndex(index)
+{
+}
+
+ConfigSnapshotBuilder::ConfigSnapshotBuilder()
+{
+}
+
+uint32_t ConfigSnapshotBuilder::addString(const char *str)
+{
+    auto it = mStringOffsets.find(str);
+    if (it != mStringOffsets.end()) {
+        return it->second;
+    }
+    uint32_t offset = mStrings.size();
+    mStrings.append(str, strlen(str) + 1);
+    mStringOffsets[str] = offset;
+    return offset;
+}
+
+void ConfigSnapshotBuilder::addSource(const string &path)
+{
+    Source source;
+    source.path = addString(path.c_str());
+    getFileStamp(path, source.size, source.modificationTime, source.modificationTimeNs);
+    mSources.push_back(source);
+}
+
+uint32_t ConfigSnapshotBuilder::addElement(uint32_t parent, const char *name)
+{
+    AUDIOCOMMS_ASSERT(parent != gNoElement || mNodes.empty(), "Only one root element allowed");
+    uint32_t index = mNodes.size();
+    Node node = {
+        addString(name), static_cast<uint32_t>(mAttributes.size()), 0, gNoElement, gNoElement
+    };
+    mNodes.push_back(node);
+    mLastChildren.push_back(gNoElement);
+    if (parent != gNoElement) {
+        if (mLastChildren[parent] == gNoElement) {
+            mNodes[parent].firstChild = index;
+        } else {
+            mNodes[mLastChildren[parent]].next = index;
+        }
+        mLastChildren[parent] = index;
+    }
+    return index;
+}
+
+void ConfigSnapshotBuilder::addAttribute(uint32_t element, const char *name, const char *value)
+{
+    AUDIOCOMMS_ASSERT(element == mNodes.size() - 1, "Attributes shall follow their element");
+    Attribute attribute = {
+        addString(name), addString(value)
+    };
+    mAttributes.push_back(attribute);
+    mNodes[element].attributeCount++;
+}
+
+void ConfigSnapshotBuilder::build(vector<char> &image) const
+{
+    ConfigSnapshot::Header header;
+    header.magic = ConfigSnapshot::gMagic;
+    header.version = ConfigSnapshot::gVersion;
+    header.checksum = 0;
+    header.sourceCount = mSources.size();
+    header.nodeCount = mNodes.size();
+    header.attributeCount = mAttributes.size();
+    header.stringsSize = mStrings.size();
+
+    size_t sourcesSize = mSources.size() * sizeof(Source);
+    size_t nodesSize = mNodes.size() * sizeof(Node);
+    size_t attributesSize = mAttributes.size() * sizeof(Attribute);
+    image.resize(sizeof(header) + sourcesSize + nodesSize + attributesSize + mStrings.size());
+
+    char *it = image.data() + sizeof(header);
+    memcpy(it, mSources.data(), sourcesSize);
+    it += sourcesSize;
+    memcpy(it, mNodes.data(), nodesSize);
+    it += nodesSize;
+    memcpy(it, mAttributes.data(), attributesSize);
+    it += attributesSize;
+    memcpy(it, mStrings.data(), mStrings.size());
+
+    header.checksum = ConfigSnapshot::computeChecksum(image.data() + sizeof(header),
+                                                      image.size() - sizeof(header));
+    memcpy(image.data(), &header, sizeof(header));
+}
+
+ConfigSnapshot::ConfigSnapshot()
+    : mMapping(NULL),
+      mMappingSize(0),
+      mHeader(NULL),
+      mSources(NULL),
+      mNodes(NULL),
+      mAttributes(NULL),
+      mStrings(NULL)
+{
+}
+
+ConfigSnapshot::~ConfigSnapshot()
+{
+    unload();
+}
+
+void ConfigSnapshot::unload()
+{
+    if (mMapping != NULL) {
+        munmap(mMapping, mMappingSize);
+        mMapping = NULL;
+        mMappingSize = 0;
+    }
+    mImage.clear();
+    mHeader = NULL;
+}
+
+uint32_t ConfigSnapshot::computeChecksum(const char *data, size_t size)
+{
+    // CRC-32 (IEEE 802.3), table built on first use
+    static const vector<uint32_t> table = [] {
+        vector<uint32_t> crcTable(256);
+        for (uint32_t i = 0; i < crcTable.size(); i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+            }
+            crcTable[i] = crc;
+        }
+        return crcTable;
+    } ();
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+status_t ConfigSnapshot::validate(const char *image, size_t size)
+{
+    if (size < sizeof(Header)) {
+        Log::Error() << __FUNCTION__ << ": truncated header";
+        return android::BAD_VALUE;
+    }
+    const Header *header = reinterpret_cast<const Header *>(image);
+    if (header->magic != gMagic || header->version != gVersion) {
+        Log::Error() << __FUNCTION__ << ": unsupported version " << header->version;
+        return android::BAD_VALUE;
+    }
+    // Compute the expected size on 64 bits, so that counts cannot overflow
+    uint64_t expectedSize = sizeof(Header) +
+                            static_cast<uint64_t>(header->sourceCount) * sizeof(Source) +
+                            static_cast<uint64_t>(header->nodeCount) * sizeof(Node) +
+                            static_cast<uint64_t>(header->attributeCount) * sizeof(Attribute) +
+                            header->stringsSize;
+    if (expectedSize != size || header->sourceCount == 0 || header->nodeCount == 0 ||
+        header->stringsSize == 0 || image[size - 1] != '\0') {
+        Log::Error() << __FUNCTION__ << ": inconsistent layout";
+        return android::BAD_VALUE;
+    }
+    if (computeChecksum(image + sizeof(Header), size - sizeof(Header)) != header->checksum) {
+        Log::Error() << __FUNCTION__ << ": checksum mismatch";
+        return android::BAD_VALUE;
+    }
+    const Source *sources = reinterpret_cast<const Source *>(image + sizeof(Header));
+    const Node *nodes = reinterpret_cast<const Node *>(sources + header->sourceCount);
+    const Attribute *attributes = reinterpret_cast<const Attribute *>(nodes + header->nodeCount);
+
+    // Check all the references once for all, so that views never get out of the image
+    bool isValid = true;
+    for (uint32_t i = 0; i < header->sourceCount; i++) {
+        isValid &= sources[i].path < header->stringsSize;
+    }
+    for (uint32_t i = 0; i < header->nodeCount; i++) {
+        const Node &node = nodes[i];
+        // Children and siblings come after their element in document order, so no cycle
+        isValid &= node.name < header->stringsSize &&
+                   node.firstAttribute <= header->attributeCount &&
+                   node.attributeCount <= header->attributeCount - node.firstAttribute &&
+                   (node.firstChild == ConfigSnapshotBuilder::gNoElement ||
+                    (node.firstChild > i && node.firstChild < header->nodeCount)) &&
+                   (node.next == ConfigSnapshotBuilder::gNoElement ||
+                    (node.next > i && node.next < header->nodeCount));
+    }
+    for (uint32_t i = 0; i < header->attributeCount; i++) {
+        isValid &= attributes[i].name < header->stringsSize &&
+                   attributes[i].value < header->stringsSize;
+    }
+    if (!isValid) {
+        Log::Error() << __FUNCTION__ << ": reference out of the image";
+        return android::BAD_VALUE;
+    }
+    mHeader = header;
+    mSources = sources;
+    mNodes = nodes;
+    mAttributes = attributes;
+    mStrings = reinterpret_cast<const char *>(attributes + header->attributeCount);
+    return android::OK;
+}
+
+bool ConfigSnapshot::isUpToDate(const string &configFile) const
+{
+    if (configFile != getString(mSources[0].path)) {
+        Log::Debug() << __FUNCTION__ << ": snapshot of " << getString(mSources[0].path);
+        return false;
+    }
+    for (uint32_t i = 0; i < mHeader->sourceCount; i++) {
+        const Source &source = mSources[i];
+        Source current = source;
+        getFileStamp(getString(source.path), current.size, current.modificationTime,
+                     current.modificationTimeNs);
+        if (current.size != source.size || current.modificationTime != source.modificationTime ||
+            current.modificationTimeNs != source.modificationTimeNs) {
+            Log::Debug() << __FUNCTION__ << ": " << getString(source.path) << " has changed";
+            return false;
+        }
+    }
+    return true;
+}
+
+status_t ConfigSnapshot::load(const string &path, const string &configFile)
+{
+    unload();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Log::Debug() << __FUNCTION__ << ": no snapshot " << path << ": " << strerror(errno);
+        return android::NAME_NOT_FOUND;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        return android::BAD_VALUE;
+    }
+    void *mapping = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        Log::Error() << __FUNCTION__ << ": could not map " << path << ": " << strerror(errno);
+        return android::NO_MEMORY;
+    }
+    mMapping = mapping;
+    mMappingSize = fileStat.st_size;
+
+    if (validate(static_cast<const char *>(mMapping), mMappingSize) != android::OK ||
+        !isUpToDate(configFile)) {
+        Log::Warning() << __FUNCTION__ << ": snapshot " << path << " discarded";
+        unload();
+        return android::BAD_VALUE;
+    }
+    return android::OK;
+}
+
+status_t ConfigSnapshot::load(const ConfigSnapshotBuilder &builder)
+{
+    unload();
+    builder.build(mImage);
+    status_t status = validate(mImage.data(), mImage.size());
+    if (status != android::OK) {
+        unload();
+    }
+    return status;
+}
+
+status_t ConfigSnapshot::save(const string &path) const
+{
+    if (mHeader == NULL) {
+        return android::NO_INIT;
+    }
+    const char *image = reinterpret_cast<const char *>(mHeader);
+    size_t size = mMapping != NULL ? mMappingSize : mImage.size();
+
+    string temporaryPath = path + ".tmp";
+    int fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (fd < 0) {
+        Log::Warning() << __FUNCTION__ << ": could not create " << temporaryPath << ": "
+                       << strerror(errno);
+        return android::PERMISSION_DENIED;
+    }
+    size_t written = 0;
+    while (written < size) {
+        ssize_t ret = write(fd, image + written, size - written);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        written += ret;
+    }
+    bool isWritten = (written == size) && (fsync(fd) == 0);
+    close(fd);
+    if (!isWritten || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        Log::Warning() << __FUNCTION__ << ": could not write " << path << ": " << strerror(errno);
+        unlink(temporaryPath.c_str());
+        return android::UNKNOWN_ERROR;
+    }
+    return android::OK;
+}
+
+ConfigNode ConfigSnapshot::getRoot() const
+{
+    return mHeader == NULL ? ConfigNode() : ConfigNode(this, 0);
+}
+
+} // namespace intel_audio
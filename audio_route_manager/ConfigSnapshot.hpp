@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <utils/Errors.h>
+#include <map>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+class ConfigSnapshot;
+
+/**
+ * Read only view on an element of the route configuration tree, i.e. a name, attributes and
+ * children elements, browsed the same way as a DOM node.
+ * A view refers to the snapshot it is taken from, which must outlive it.
+ */
+class ConfigNode
+{
+public:
+    /** @return true if the view refers to an element, false if past the last sibling / child. */
+    bool isValid() const { return mSnapshot != NULL; }
+
+    const char *getName() const;
+
+    bool hasName(const char *name) const { return strcmp(getName(), name) == 0; }
+
+    /**
+     * @param[in] name of the attribute.
+     * @return value of the attribute, empty if the element has no such attribute.
+     */
+    std::string getAttribute(const char *name) const;
+
+    /** @return first child of the element, invalid if none. */
+    ConfigNode getFirstChild() const;
+
+    /** @return next sibling of the element, invalid if none. */
+    ConfigNode getNext() const;
+
+private:
+    friend class ConfigSnapshot;
+
+    ConfigNode() : mSnapshot(NULL), mIndex(0) {}
+    ConfigNode(const ConfigSnapshot *snapshot, uint32_t index);
+
+    const ConfigSnapshot *mSnapshot;
+    uint32_t mIndex;
+};
+
+/**
+ * Collects the elements of the route configuration tree and the source files they were read
+ * from, and lays them out as a snapshot image.
+ * Elements shall be added in document order, each element followed by its own attributes.
+ */
+class ConfigSnapshotBuilder : private audio_comms::utilities::NonCopyable
+{
+public:
+    /** Parent of the root element. */
+    static const uint32_t gNoElement;
+
+    ConfigSnapshotBuilder();
+
+    /**
+     * Add a source file of the configuration. Its size and modification time are recorded, so
+     * that a snapshot is not used any more once the file has changed.
+     * The first source added is the main configuration file.
+     *
+     * @param[in] path of the source file.
+     */
+    void addSource(const std::string &path);
+
+    /**
+     * @param[in] parent element, gNoElement for the root element.
+     * @param[in] name of the element.
+     * @return handle of the element.
+     */
+    uint32_t addElement(uint32_t parent, const char *name);
+
+    /**
+     * @param[in] element handle of the last element added.
+     * @param[in] name of the attribute.
+     * @param[in] value of the attribute.
+     */
+    void addAttribute(uint32_t element, const char *name, const char *value);
+
+    /**
+     * Lay out the snapshot image.
+     * @param[out] image of the snapshot, checksum included.
+     */
+    void build(std::vector<char> &image) const;
+
+private:
+    uint32_t addString(const char *str);
+
+    struct Node
+    {
+        uint32_t name;
+        uint32_t firstAttribute;
+        uint32_t attributeCount;
+        uint32_t firstChild;
+        uint32_t next;
+    };
+
+    struct Attribute
+    {
+        uint32_t name;
+        uint32_t value;
+    };
+
+    struct Source
+    {
+        uint32_t path;
+        uint32_t size;
+        uint32_t modificationTime;
+        uint32_t modificationTimeNs;
+    };
+
+    friend class ConfigSnapshot;
+
+    std::vector<Source> mSources;
+    std::vector<Node> mNodes;
+    std::vector<uint32_t> mLastChildren; /**< Last child of each node, to link next siblings. */
+    std::vector<Attribute> mAttributes;
+    std::string mStrings; /**< Null terminated strings, referred by offset. */
+    std::map<std::string, uint32_t> mStringOffsets; /**< Strings already added. */
+};
+
+/**
+ * Versioned and checksummed binary image of the route configuration tree.
+ * Once validated, the image is browsed in place through ConfigNode views, from the memory
+ * mapped snapshot file or from the image built while parsing the XML configuration file.
+ */
+class ConfigSnapshot : private audio_comms::utilities::NonCopyable
+{
+public:
+    ConfigSnapshot();
+    ~ConfigSnapshot();
+
+    /**
+     * Map a snapshot file and check it may be used instead of parsing the configuration file:
+     * version, checksum and layout of the image must be valid and the source files must be
+     * unchanged since the snapshot was written.
+     *
+     * @param[in] path of the snapshot file.
+     * @param[in] configFile main configuration file the snapshot is expected to come from.
+     *
+     * @return OK if the snapshot may be used, error code otherwise.
+     */
+    android::status_t load(const std::string &path, const std::string &configFile);
+
+    /**
+     * Take the image built from the configuration file.
+     *
+     * @param[in] builder holding the elements of the configuration.
+     *
+     * @return OK if the image is valid, error code otherwise.
+     */
+    android::status_t load(const ConfigSnapshotBuilder &builder);
+
+    /**
+     * Write the image atomically, i.e. through a temporary file renamed once written.
+     *
+     * @param[in] path of the snapshot file.
+     *
+     * @return OK if written, error code otherwise.
+     */
+    android::status_t save(const std::string &path) const;
+
+    /** @return root element of the configuration, invalid if no image is loaded. */
+    ConfigNode getRoot() const;
+
+private:
+    friend class ConfigNode;
+    friend class ConfigSnapshotBuilder;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t checksum; /**< CRC-32 of the image following the header. */
+        uint32_t sourceCount;
+        uint32_t nodeCount;
+        uint32_t attributeCount;
+        uint32_t stringsSize;
+    };
+
+    typedef ConfigSnapshotBuilder::Node Node;
+    typedef ConfigSnapshotBuilder::Attribute Attribute;
+    typedef ConfigSnapshotBuilder::Source Source;
+
+    static const uint32_t gMagic;
+    static const uint32_t gVersion;
+
+    static uint32_t computeChecksum(const char *data, size_t size);
+
+    /** Check the header, checksum and bounds of all the records of the image. */
+    android::status_t validate(const char *image, size_t size);
+
+    /** @return true if the source files are unchanged since the image was built. */
+    bool isUpToDate(const std::string &configFile) const;
+
+    void unload();
+
+    const char *getString(uint32_t offset) const { return mStrings + offset; }
+
+    std::vector<char> mImage; /**< Image built from the configuration file, if any. */
+    void *mMapping; /**< Mapped snapshot file, if any. */
+    size_t mMappingSize;
+
+    const Header *mHeader; /**< Header of the valid image, NULL if none. */
+    const Source *mSources;
+    const Node *mNodes;
+    const Attribute *mAttributes;
+    const char *mStrings;
+};
+
+} // namespace intel_audio
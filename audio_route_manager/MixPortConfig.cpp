@@ -19,14 +19,13 @@
 #include "MixPortConfig.hpp"
 #include <AudioConversion.hpp>
 #include <tinyalsa/asoundlib.h>
+#include <AlsaMixer.hpp>
 #include <AudioUtils.hpp>
-#include <convert.hpp>
 #include <utilities/Log.hpp>
 #include <string>
 
 using namespace std;
 using audio_comms::utilities::Log;
-using audio_comms::utilities::convertTo;
 
 namespace intel_audio
 {
@@ -116,11 +115,36 @@ uint32_t MixPortConfig::getChannelCount() const
            audio_channel_count_from_in_mask(getChannelMask());
 }
 
+void MixPortConfig::getPcmConfig(pcm_config &config) const
+{
+    config.rate = getRate();
+    config.channels = getChannelCount();
+    config.format = AudioUtils::convertHalToTinyFormat(getFormat());
+    config.period_size = periodSize;
+    config.period_count = periodCount;
+    config.start_threshold = startThreshold;
+    config.stop_threshold = stopThreshold;
+    config.silence_threshold = silenceThreshold;
+    config.silence_size = 0;
+    config.avail_min = availMin;
+}
+
+void MixPortConfig::setPeriodCount(uint32_t count)
+{
+    uint32_t bufferSize = periodSize * periodCount;
+    uint32_t newBufferSize = periodSize * count;
+    if (stopThreshold <= bufferSize && stopThreshold + newBufferSize > bufferSize) {
+        stopThreshold = stopThreshold + newBufferSize - bufferSize;
+    }
+    periodCount = count;
+}
+
 void MixPortConfig::resetCapabilities()
 {
     for (auto &capabilities : mAudioCapabilities) {
         capabilities.reset();
     }
+    updateCapabilityLiterals();
 }
 
 void MixPortConfig::loadCapabilities()
@@ -138,6 +162,12 @@ void MixPortConfig::loadCapabilities()
             Log::Debug() << __FUNCTION__ << ": Control for format: " << dynamicFormatsControl;
         }
     }
+    updateCapabilityLiterals();
+}
+
+void MixPortConfig::updateCapabilityLiterals()
+{
+    mCapabilityLiterals = mAudioCapabilities.getLiterals(isOut);
 }
 
 /**
@@ -150,9 +180,6 @@ android::status_t MixPortConfig::loadChannelMaskCapabilities(AudioCapability &ca
     // Discover supported channel maps from control parameter
     Log::Debug() << __FUNCTION__ << ": Control for channels: " << dynamicChannelMapsControl;
 
-    struct mixer *mixer;
-    struct mixer_ctl *ctl;
-    unsigned int channelMaskSize;
     int channelCount = 0;
 
     int cardIndex = AudioUtils::getCardIndexByName(cardName.c_str());
@@ -160,27 +187,26 @@ android::status_t MixPortConfig::loadChannelMaskCapabilities(AudioCapability &ca
         Log::Error() << __FUNCTION__ << ": Failed to get Card Name index " << cardIndex;
         return android::BAD_VALUE;
     }
-    mixer = mixer_open(cardIndex);
-    if (!mixer) {
-        Log::Error() << __FUNCTION__ << ": Failed to open mixer for card " << cardName.c_str();
+    AlsaMixerService &mixer = AlsaMixerService::getInstance();
+    mixer_ctl_type type;
+    uint32_t channelMaskSize;
+    if (mixer.getControlInfo(cardIndex, dynamicChannelMapsControl, type,
+                             channelMaskSize) != android::OK) {
+        Log::Error() << __FUNCTION__ << ": Failed to get control for card " << cardName;
         return android::BAD_VALUE;
     }
-    uint32_t controlNumber;
-    if (convertTo<std::string, uint32_t>(dynamicChannelMapsControl, controlNumber)) {
-        ctl = mixer_get_ctl(mixer, controlNumber);
-    } else {
-        ctl = mixer_get_ctl_by_name(mixer, dynamicChannelMapsControl.c_str());
-    }
-    if (mixer_ctl_get_type(ctl) != MIXER_CTL_TYPE_INT) {
+    if (type != MIXER_CTL_TYPE_INT) {
         audio_comms::utilities::Log::Error() << __FUNCTION__ << ": invalid mixer type";
-        mixer_close(mixer);
         return android::BAD_VALUE;
     }
-    channelMaskSize = mixer_ctl_get_num_values(ctl);
+    std::vector<int> channelMap;
+    if (mixer.getValues(cardIndex, dynamicChannelMapsControl, channelMap) != android::OK) {
+        return android::BAD_VALUE;
+    }
 
     // Parse the channel allocation array to check if present or not.
     for (uint32_t channelPosition = 0; channelPosition < channelMaskSize; channelPosition++) {
-        if (mixer_ctl_get_value(ctl, channelPosition) > 0) {
+        if (channelMap[channelPosition] > 0) {
             ++channelCount;
             if (isOut && channelCount != 2 && channelCount != 6 && channelCount != 8) {
                 // Until now, limit the support to stereo, 5.1 & 7.1
@@ -200,7 +226,6 @@ android::status_t MixPortConfig::loadChannelMaskCapabilities(AudioCapability &ca
         audio_channel_mask_t mask = isOut ? AUDIO_CHANNEL_OUT_STEREO : AUDIO_CHANNEL_IN_STEREO;
         capability.mSupportedChannelMasks.push_back(mask);
     }
-    mixer_close(mixer);
     return android::OK;
 }
 
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RouteManager/RoutingRecovery"
+
+#include "RoutingRecovery.hpp"
+#include "AudioRouteCollection.hpp"
+#include <IStreamRoute.hpp>
+#include <IoStream.hpp>
+#include <utilities/Log.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+using audio_comms::utilities::Log;
+using namespace std;
+
+namespace intel_audio
+{
+
+static const char *const gRecoverUevent = "EVENT_TYPE=SST_RECOVERY";
+static const char *const gCrashUevent = "EVENT_TYPE=SST_CRASHED";
+
+RoutingRecovery::RoutingRecovery() : mStats(), mCrashUs(0), mRecoveryStartUs(0)
+{
+}
+
+uint64_t RoutingRecovery::getMonotonicUs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+RoutingRecovery::SubsystemEvent RoutingRecovery::parseUEvent(const char *msg, size_t size)
+{
+    const char *end = msg + size;
+    for (const char *entry = msg; entry < end; entry += strnlen(entry, end - entry) + 1) {
+        size_t length = strnlen(entry, end - entry);
+        if (length == strlen(gRecoverUevent) && !strncmp(entry, gRecoverUevent, length)) {
+            return SubsystemRecovered;
+        }
+        if (length == strlen(gCrashUevent) && !strncmp(entry, gCrashUevent, length)) {
+            return SubsystemCrashed;
+        }
+    }
+    return NoSubsystemEvent;
+}
+
+void RoutingRecovery::onCrash(const AudioRouteCollection &routes)
+{
+    mCrashUs = getMonotonicUs();
+    mStats.crashCount++;
+
+    mSnapshot.streams.clear();
+    for (uint32_t type = 0; type < ROUTE_TYPE_STREAM_NUM; type++) {
+        for (const auto stream : routes.mOrderedStreamList[type]) {
+            IStreamRoute *route = stream->getCurrentStreamRoute();
+            if (route != NULL) {
+                StreamAttachment attachment;
+                attachment.route = route->getName();
+                attachment.isOut = stream->isOut();
+                attachment.routeSampleSpec = stream->routeSampleSpec();
+                mSnapshot.streams.push_back(attachment);
+            }
+        }
+    }
+    Log::Warning() << __FUNCTION__ << ": routing snapshot taken, " << mSnapshot.streams.size()
+                   << " stream(s) attached";
+}
+
+void RoutingRecovery::onRecoveryStart()
+{
+    mRecoveryStartUs = getMonotonicUs();
+    mStats.lastDowntimeUs = mCrashUs != 0 ? mRecoveryStartUs - mCrashUs : 0;
+}
+
+void RoutingRecovery::onRecoveryDone(const AudioRouteCollection &routes)
+{
+    mStats.recoveryCount++;
+    mStats.lastRecoveryUs = getMonotonicUs() - mRecoveryStartUs;
+    if (mStats.lastRecoveryUs > mStats.maxRecoveryUs) {
+        mStats.maxRecoveryUs = mStats.lastRecoveryUs;
+    }
+    mStats.lastRestoredStreams = 0;
+    for (const auto &attachment : mSnapshot.streams) {
+        bool isRestored = false;
+        for (const auto stream : routes.mOrderedStreamList[attachment.isOut]) {
+            IStreamRoute *route = stream->getCurrentStreamRoute();
+            if (route != NULL && route->getName() == attachment.route &&
+                stream->routeSampleSpec() == attachment.routeSampleSpec) {
+                isRestored = true;
+                break;
+            }
+        }
+        if (isRestored) {
+            mStats.lastRestoredStreams++;
+        } else {
+            Log::Warning() << __FUNCTION__ << ": stream of route " << attachment.route
+                           << " not restored, stopped or rerouted meanwhile";
+        }
+    }
+    mStats.lastMissingStreams = mSnapshot.streams.size() - mStats.lastRestoredStreams;
+    Log::Warning() << __FUNCTION__ << ": routing restored in " << mStats.lastRecoveryUs
+                   << " us after " << mStats.lastDowntimeUs / 1000 << " ms of downtime, "
+                   << mStats.lastRestoredStreams << "/" << mSnapshot.streams.size()
+                   << " stream(s) restored";
+}
+
+android::status_t RoutingRecovery::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    string result;
+
+    snprintf(buffer, SIZE, "%*sSubsystem recovery: crashes %u recoveries %u\n", spaces, "",
+             mStats.crashCount, mStats.recoveryCount);
+    result.append(buffer);
+    if (mStats.recoveryCount != 0) {
+        snprintf(buffer, SIZE, "%*slast downtime %llu ms, recovery %llu us (max %llu us),"
+                 " streams restored %u missing %u\n", spaces + 4, "",
+                 static_cast<unsigned long long>(mStats.lastDowntimeUs / 1000),
+                 static_cast<unsigned long long>(mStats.lastRecoveryUs),
+                 static_cast<unsigned long long>(mStats.maxRecoveryUs),
+                 mStats.lastRestoredStreams, mStats.lastMissingStreams);
+        result.append(buffer);
+    }
+    for (const auto &attachment : mSnapshot.streams) {
+        snprintf(buffer, SIZE, "%*s%s stream on %s: %u Hz, %u channels, format 0x%x\n",
+                 spaces + 4, "", attachment.isOut ? "output" : "input",
+                 attachment.route.c_str(), attachment.routeSampleSpec.getSampleRate(),
+                 attachment.routeSampleSpec.getChannelCount(),
+                 attachment.routeSampleSpec.getFormat());
+        result.append(buffer);
+    }
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
@@ -18,13 +18,11 @@
 
 #include "RouteManagerConfig.hpp"
 #include "AudioPort.hpp"
+#include "ConfigSnapshot.hpp"
 #include <stdint.h>
 #include <string>
 #include <utils/Errors.h>
 
-struct _xmlNode;
-struct _xmlDoc;
-
 namespace intel_audio
 {
 
@@ -45,7 +43,7 @@ struct AudioCriterionTypeTraits
     typedef CriterionTypes Collection;
     typedef RouteManagerConfig *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 };
 
@@ -69,7 +67,7 @@ struct AudioCriterionTraits
     typedef Criteria Collection;
     typedef RouteManagerConfig *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 };
 
@@ -93,7 +91,7 @@ struct RogueParameterTraits
     typedef Parameters Collection;
     typedef RouteManagerConfig *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 };
 
@@ -114,7 +112,7 @@ struct AudioProfileTraits
     typedef AudioCapabilities Collection;
     typedef void *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 };
 
@@ -136,7 +134,7 @@ struct DevicePortTraits
     typedef AudioPorts Collection;
     typedef void *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 };
 
@@ -173,7 +171,7 @@ struct RouteTraits
                                         bool &hasMixPort,
                                         PtrSerializingCtx ctx);
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 };
 
@@ -188,8 +186,8 @@ struct ModuleTraits
     typedef std::vector<Module *> Collection;
     typedef RouteManagerConfig *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc * doc, const _xmlNode * root, PtrElement & element,
-                                         PtrSerializingCtx /*serializingContext*/);
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
+                                         PtrSerializingCtx serializingContext);
 };
 
 struct MixPortTraits
@@ -233,7 +231,7 @@ struct MixPortTraits
     typedef AudioPorts Collection;
     typedef RouteManagerConfig *PtrSerializingCtx;
 
-    static android::status_t deserialize(_xmlDoc *doc, const _xmlNode *root, PtrElement &element,
+    static android::status_t deserialize(const ConfigNode &root, PtrElement &element,
                                          PtrSerializingCtx serializingContext);
 
     // MixPort has no child
@@ -251,11 +249,61 @@ private:
 
 public:
     RouteSerializer();
+
+    /**
+     * Deserialize the route configuration from its snapshot if up to date, from the xml
+     * configuration file otherwise. The snapshot is written once the xml file is deserialized.
+     *
+     * @param[in] str path of the xml configuration file.
+     * @param[out] config of the route manager.
+     *
+     * @return OK if the configuration was deserialized, error code otherwise.
+     */
     android::status_t deserialize(const char *str, RouteManagerConfig &config);
 
+    /**
+     * Load the route configuration from its snapshot if up to date, by parsing the xml
+     * configuration file otherwise.
+     * It does not depend on the platform state, hence may run concurrently with its creation.
+     *
+     * @param[in] configFile path of the xml configuration file.
+     * @param[out] snapshot of the configuration.
+     *
+     * @return OK if loaded, error code otherwise.
+     */
+    android::status_t load(const char *configFile, ConfigSnapshot &snapshot);
+
+    /**
+     * Deserialize the route configuration from the snapshot loaded by this serializer.
+     * The snapshot is written if it was parsed from the xml configuration file.
+     *
+     * @param[in] snapshot of the configuration.
+     * @param[out] config of the route manager.
+     *
+     * @return OK if the configuration was deserialized, error code otherwise.
+     */
+    android::status_t deserialize(const ConfigSnapshot &snapshot, RouteManagerConfig &config);
+
 private:
+    /**
+     * Parse the xml configuration file, includes resolved, into a snapshot.
+     *
+     * @param[in] configFile path of the xml configuration file.
+     * @param[out] snapshot of the configuration.
+     *
+     * @return OK if parsed, error code otherwise.
+     */
+    android::status_t parse(const char *configFile, ConfigSnapshot &snapshot);
+
+    /** Deserialize the route configuration from the root element of a snapshot. */
+    android::status_t deserialize(const ConfigNode &root, RouteManagerConfig &config);
+
+    static const char *const gSnapshotFile; /**< Snapshot of the parsed configuration. */
+
     std::string mRootElementName;
     std::string mVersion;
+    std::string mConfigFile; /**< Configuration file of the last load. */
+    bool mIsFromSnapshot; /**< Whether the last load was served by the snapshot file. */
 };
 
 }  // namespace intel_audio
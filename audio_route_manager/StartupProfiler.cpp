@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RouteManager/StartupProfiler"
+
+#include "StartupProfiler.hpp"
+#include <utilities/Log.hpp>
+#include <sstream>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using audio_comms::utilities::Log;
+using audio_comms::utilities::Mutex;
+using namespace std;
+
+namespace intel_audio
+{
+
+StartupProfiler::Phase::Phase(StartupProfiler &profiler, const char *name)
+    : mProfiler(profiler), mName(name), mStartUs(profiler.getElapsedUs())
+{
+}
+
+StartupProfiler::Phase::~Phase()
+{
+    mProfiler.record(mName, mStartUs, mProfiler.getElapsedUs());
+}
+
+StartupProfiler::StartupProfiler() : mOriginUs(getMonotonicUs()), mTotalUs(0)
+{
+}
+
+uint64_t StartupProfiler::getMonotonicUs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+uint64_t StartupProfiler::getElapsedUs() const
+{
+    return getMonotonicUs() - mOriginUs;
+}
+
+void StartupProfiler::record(const char *name, uint64_t startUs, uint64_t endUs)
+{
+    PhaseRecord phase;
+    phase.name = name;
+    phase.thread = static_cast<pid_t>(syscall(SYS_gettid));
+    phase.startUs = startUs;
+    phase.durationUs = endUs - startUs;
+
+    Mutex::Locker locker(mLock);
+    mPhases.push_back(phase);
+}
+
+void StartupProfiler::complete()
+{
+    {
+        Mutex::Locker locker(mLock);
+        if (mTotalUs != 0) {
+            return;
+        }
+        mTotalUs = getElapsedUs();
+    }
+    Log::Info() << __FUNCTION__ << ": " << getReport();
+}
+
+bool StartupProfiler::isComplete() const
+{
+    Mutex::Locker locker(mLock);
+    return mTotalUs != 0;
+}
+
+uint64_t StartupProfiler::getTotalUs() const
+{
+    Mutex::Locker locker(mLock);
+    return mTotalUs != 0 ? mTotalUs : getElapsedUs();
+}
+
+vector<StartupProfiler::PhaseRecord> StartupProfiler::getPhases() const
+{
+    Mutex::Locker locker(mLock);
+    return mPhases;
+}
+
+string StartupProfiler::getReport() const
+{
+    vector<PhaseRecord> phases = getPhases();
+    ostringstream report;
+    report << "{\"total_us\":" << getTotalUs() << ",\"phases\":[";
+    for (size_t i = 0; i < phases.size(); i++) {
+        report << (i ? "," : "") << "{\"name\":\"" << phases[i].name << "\""
+               << ",\"thread\":" << phases[i].thread
+               << ",\"start_us\":" << phases[i].startUs
+               << ",\"duration_us\":" << phases[i].durationUs << "}";
+    }
+    report << "]}";
+    return report.str();
+}
+
+android::status_t StartupProfiler::dump(const int fd, int spaces) const
+{
+    vector<PhaseRecord> phases = getPhases();
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    string result;
+
+    snprintf(buffer, SIZE, "%*sStartup%s: %llu us\n", spaces, "",
+             isComplete() ? "" : " (in progress)",
+             static_cast<unsigned long long>(getTotalUs()));
+    result.append(buffer);
+    for (const auto &phase : phases) {
+        snprintf(buffer, SIZE, "%*s%-24s thread %-6d start %8llu us duration %8llu us\n",
+                 spaces + 4, "", phase.name.c_str(), phase.thread,
+                 static_cast<unsigned long long>(phase.startUs),
+                 static_cast<unsigned long long>(phase.durationUs));
+        result.append(buffer);
+    }
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
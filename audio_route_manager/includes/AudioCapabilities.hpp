@@ -17,6 +17,7 @@
 
 #include <hardware/audio.h>
 #include <utils/Errors.h>
+#include <string>
 #include <vector>
 
 namespace intel_audio
@@ -109,11 +110,28 @@ struct AudioCapability
     android::status_t dump(const int fd, int spaces, bool isOut) const;
 };
 
+/**
+ * Capabilities formatted as expected by the AUDIO_PARAMETER_STREAM_SUP_* keys.
+ */
+struct AudioCapabilityLiterals
+{
+    std::string formats; /**< "|" separated string of formats. */
+    std::string channelMasks; /**< "|" separated string of channel masks. */
+    std::string rates; /**< "|" separated string of rates. */
+};
+
 struct AudioCapabilities : public std::vector<AudioCapability>
 {
     const std::string getSupportedFormats() const;
     const std::string getSupportedChannelMasks(bool isOut) const;
     const std::string getSupportedRates() const;
+
+    /**
+     * Format all the capabilities at once.
+     * @param[in] isOut direction of the stream capabilities requested
+     * @return formatted capabilities.
+     */
+    AudioCapabilityLiterals getLiterals(bool isOut) const;
 };
 
 } // namespace intel_audio
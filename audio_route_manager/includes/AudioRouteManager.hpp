@@ -16,8 +16,12 @@
 #pragma once
 
 #include "AudioCapabilities.hpp"
+#include "RoutingRecovery.hpp"
+#include "StartupProfiler.hpp"
 #include <AudioCommsAssert.hpp>
+#include <Criterion.hpp>
 #include <Parameter.hpp>
+#include <StreamsParameters.hpp>
 #include <Observable.hpp>
 #include <EventListener.h>
 #include <AudioNonCopyable.hpp>
@@ -35,6 +39,7 @@ class IoStream;
 struct pcm_config;
 class AudioPlatformState;
 class AudioRouteCollection;
+class AudioTelemetry;
 
 class AudioRouteManager : private IEventListener,
                           private audio_comms::utilities::Observable,
@@ -126,6 +131,19 @@ public:
      */
     bool supportStreamConfig(const IoStream &stream) const;
 
+    /**
+     * Checks whether the stream would match with a stream route if it requested the given effects
+     * in place of its own. The effects of the stream are left untouched, so that the routing
+     * never sees a candidate mask.
+     *
+     * @param[in] stream to be checked for support
+     * @param[in] effectMask mask of the effects requested.
+     *
+     * @return true if the stream requesting these effects is supported by a route,
+     *              false otherwise.
+     */
+    bool supportStreamConfig(const IoStream &stream, uint32_t effectMask) const;
+
 
     /**
      * Retrieve the capabilities for a given stream, i.e. what is the list of sample rates, formats
@@ -133,15 +151,46 @@ public:
      * given device, during a given use case (aka input source, not defined for output), in a given
      * manneer (aka with input or output flags).
      *
+     * Capabilities are formatted once when loaded by the route, not on each request.
+     *
      * @param[in] stream for which the capabilities are requested
      *
-     * @return capabilities supported for this stream.
+     * @return formatted capabilities supported for this stream.
      */
-    AudioCapabilities getCapabilities(const IoStream &stream) const;
+    AudioCapabilityLiterals getCapabilityLiterals(const IoStream &stream) const;
 
     android::status_t setParameters(const std::string &keyValuePair,
                                     bool isSynchronous = false);
 
+    /**
+     * Apply the typed parameters inferred from the streams and reconsider the routing.
+     * Contrary to the string version, it does not handle route selection nor device connection
+     * keys, which are only received from the public setParameters API.
+     *
+     * @param[in] parameters typed streams parameters.
+     * @param[in] isSynchronous: need to reconsider the routing in a synchronous way or not.
+     *
+     * @return OK if these parameters were applyied correctly, error code otherwise.
+     */
+    android::status_t setParameters(const StreamsParameters &parameters,
+                                    bool isSynchronous = false);
+
+    /**
+     * Apply in place the effects requested by a stream attached to a route, leaving the routing
+     * untouched: effect criteria are committed from the caller context, without going through
+     * the routing thread nor muting the routes.
+     * It is not possible if the route of the stream does not implement all the requested effects,
+     * or if another route matches the stream better, the routing shall be reconsidered then.
+     *
+     * @param[in] stream which requested effects changed.
+     * @param[in] parameters typed streams parameters, holding only effect parameters.
+     *
+     * @return OK if the effects were applied in place, INVALID_OPERATION if the routing shall be
+     *         reconsidered, error code otherwise.
+     */
+    android::status_t updateStreamEffects(const IoStream &stream,
+                                          const StreamsParameters &parameters);
+
     std::string getParameters(const std::string &keys) const;
 
     /**
@@ -151,6 +200,41 @@ public:
 
     android::status_t dump(const int  fd, int spaces = 0) const;
 
+    /**
+     * Phases of the startup are recorded from the creation of the route manager. The owner
+     * completes the profile once the initial routing is done.
+     *
+     * @return profiler of the startup phases.
+     */
+    StartupProfiler &getStartupProfiler() { return mStartupProfiler; }
+    const StartupProfiler &getStartupProfiler() const { return mStartupProfiler; }
+
+    /** @return statistics of the recoveries from audio subsystem crashes. */
+    RoutingRecovery::Stats getRecoveryStats() const;
+
+    /** Latency of the effect changes applied in place compared to the routing passes. */
+    struct EffectUpdateStats
+    {
+        uint32_t inPlaceCount; /**< Effect changes applied without routing. */
+        uint64_t inPlaceTotalUs;
+        uint64_t inPlaceMaxUs;
+        uint32_t reroutingCount; /**< Effect changes that required to reconsider the routing. */
+        uint32_t routingCount; /**< Routing passes executing the 5 steps. */
+        uint64_t routingTotalUs;
+        uint64_t routingMaxUs;
+        uint64_t routingLastUs; /**< Monotonic time of the end of the last routing pass. */
+    };
+
+    /** @return statistics of the effect changes and routing passes. */
+    EffectUpdateStats getEffectUpdateStats() const;
+
+    /**
+     * Sets the telemetry page in which the routing counters are published after each pass.
+     *
+     * @param[in] telemetry page, outliving the route manager, NULL to stop publishing.
+     */
+    void setTelemetry(AudioTelemetry *telemetry);
+
 private:
     /**
      * From worker thread context
@@ -188,11 +272,19 @@ private:
      */
     void executeRouting();
 
+    /**
+     * Publishes the routing counters in the telemetry page, if any.
+     * Called with the routing lock held for writing, which serializes the updates of the page.
+     */
+    void publishTelemetry() const;
+
     /**
      * Mute the routes.
      * Mute action will be applied on route pointed by ClosingRoutes criterion.
+     *
+     * @return number of criteria that really changed during this stage.
      */
-    void executeMuteRoutingStage();
+    uint32_t executeMuteRoutingStage();
 
     /**
      * Computes the PFW route criteria to mute the routes.
@@ -205,14 +297,18 @@ private:
 
     /**
      * Unmute the routes
+     *
+     * @return number of criteria that really changed during this stage.
      */
-    void executeUnmuteRoutingStage();
+    uint32_t executeUnmuteRoutingStage();
 
     /**
      * Performs the configuration of the routes.
      * Change here the devices, the mode, ... all the criteria required for the routing.
+     *
+     * @return number of criteria that really changed during this stage.
      */
-    void executeConfigureRoutingStage();
+    uint32_t executeConfigureRoutingStage();
 
     /**
      * Computes the PFW route criteria to configure the routes.
@@ -223,8 +319,10 @@ private:
 
     /**
      * Disable the routes
+     *
+     * @return number of criteria that really changed during this stage.
      */
-    void executeDisableRoutingStage();
+    uint32_t executeDisableRoutingStage();
 
     /**
      * Computes the PFW route criteria to disable the routes.
@@ -237,8 +335,10 @@ private:
 
     /**
      * Enable the routes.
+     *
+     * @return number of criteria that really changed during this stage.
      */
-    void executeEnableRoutingStage();
+    uint32_t executeEnableRoutingStage();
 
     /**
      * Returns the formatted state of the route criterion according to the mask.
@@ -251,6 +351,12 @@ private:
     template <uint32_t type>
     inline const std::string routeMaskToString(uint32_t mask) const;
 
+    /**
+     * Replay the routing once the audio subsystem recovered from a crash.
+     * As the routes were disabled on crash, the mute and disable stages are skipped.
+     */
+    void executeRecovery();
+
     /**
      * Reset the routing conditions.
      * It backup the enabled routes, resets the route criteria, resets the needReconfigure flags,
@@ -266,6 +372,8 @@ private:
     virtual void onPollError();
     virtual bool onProcess(void *, uint32_t);
 
+    StartupProfiler mStartupProfiler; /**< First member, to stamp the beginning of the startup. */
+
     AudioRouteCollection *mRoutes;
     Parameters mParameters; // the parameters defined in the audio_criteria.xml
 
@@ -275,6 +383,15 @@ private:
 
     AudioPlatformState *mPlatformState; /**< Platform state handler for Route / Audio PFW. */
 
+    /** Interned identifiers of the opened routes criteria, indexed by route type. */
+    std::vector<CriterionId> mOpenedRouteCriterionIds;
+
+    CriterionId mRoutingStageCriterionId; /**< Interned identifier of the routing stage criterion. */
+
+    EffectUpdateStats mEffectUpdateStats;
+
+    AudioTelemetry *mTelemetry; /**< Telemetry page of the HAL, NULL if not published. */
+
     /**Socket Id enumerator */
     enum UeventSockDesc
     {
@@ -292,6 +409,8 @@ private:
     static const int gSocketBufferDefaultSize;
 
     bool mAudioSubsystemAvailable = true;
+
+    RoutingRecovery mRecovery; /**< Routing state saved on audio subsystem crash. */
 };
 
 } // namespace intel_audio
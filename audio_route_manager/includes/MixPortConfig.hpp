@@ -19,6 +19,8 @@
 #include <SampleSpec.hpp>
 #include <string>
 
+struct pcm_config;
+
 namespace intel_audio
 {
 
@@ -95,6 +97,31 @@ struct MixPortConfig
 
     void loadCapabilities();
 
+    /**
+     * Format the capabilities once for all the queries of the streams. Shall be called each time
+     * the capabilities are changed, i.e. reset, loaded or set from the configuration file.
+     */
+    void updateCapabilityLiterals();
+
+    /** @return capabilities formatted by the last call to updateCapabilityLiterals. */
+    const AudioCapabilityLiterals &getCapabilityLiterals() const { return mCapabilityLiterals; }
+
+    /**
+     * Fill the pcm configuration to be programmed on the device according to the current sample
+     * specification and the ring buffer settings of this port.
+     *
+     * @param[out] config pcm configuration of the port.
+     */
+    void getPcmConfig(pcm_config &config) const;
+
+    /**
+     * Resizes the ring buffer of the port. A stop threshold within the ring buffer keeps its
+     * distance to the end of the buffer, so that the device does not stop earlier than before.
+     *
+     * @param[in] count of periods of the ring buffer.
+     */
+    void setPeriodCount(uint32_t count);
+
     /**
      * Load the capabilities in term of channel mask supported, i.e. it initializes the vector of
      * supported channel mask (stereo, 5.1, 7.1, ...)
@@ -103,6 +130,9 @@ struct MixPortConfig
     android::status_t loadChannelMaskCapabilities(AudioCapability &capability);
 
     android::status_t dump(const int fd, int spaces) const;
+
+private:
+    AudioCapabilityLiterals mCapabilityLiterals; /**< Formatted capabilities cache. */
 };
 
 } // namespace intel_audio
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <SampleSpec.hpp>
+#include <utils/Errors.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+class AudioRouteCollection;
+
+/**
+ * Keeps track of the streams routed across a crash of the audio subsystem (aka SST), to check
+ * and time their restoration once the routing is replayed on recovery.
+ * Only accessed from the routing thread, with the routing lock held.
+ */
+class RoutingRecovery : private audio_comms::utilities::NonCopyable
+{
+public:
+    /** Audio subsystem events carried by the uevents of the audio driver. */
+    enum SubsystemEvent
+    {
+        NoSubsystemEvent,
+        SubsystemCrashed,
+        SubsystemRecovered
+    };
+
+    /** Stream attached to a route when the subsystem crashed. */
+    struct StreamAttachment
+    {
+        std::string route;
+        bool isOut;
+        SampleSpec routeSampleSpec;
+    };
+
+    /** Streams routed before the subsystem crashed, to check against once recovered. */
+    struct Snapshot
+    {
+        std::vector<StreamAttachment> streams;
+    };
+
+    struct Stats
+    {
+        uint32_t crashCount;
+        uint32_t recoveryCount;
+        uint64_t lastDowntimeUs; /**< From crash to recovery event. */
+        uint64_t lastRecoveryUs; /**< From recovery event to streams restored. */
+        uint64_t maxRecoveryUs;
+        uint32_t lastRestoredStreams; /**< Streams of the snapshot attached again to their route. */
+        uint32_t lastMissingStreams; /**< Streams of the snapshot not routed any more. */
+    };
+
+    RoutingRecovery();
+
+    /**
+     * Parse a uevent, i.e. a sequence of null terminated "key=value" entries.
+     *
+     * @param[in] msg uevent message.
+     * @param[in] size of the message in bytes.
+     *
+     * @return event of the audio subsystem carried by the uevent, if any.
+     */
+    static SubsystemEvent parseUEvent(const char *msg, size_t size);
+
+    /**
+     * Snapshot the streams attached to their route on crash, before the routes are disabled.
+     *
+     * @param[in] routes collection, with streams attached to the routes.
+     */
+    void onCrash(const AudioRouteCollection &routes);
+
+    /** Stamp the beginning of the recovery. */
+    void onRecoveryStart();
+
+    /**
+     * Stamp the end of the recovery and check the streams of the snapshot were restored.
+     *
+     * @param[in] routes collection, once the routing is replayed.
+     */
+    void onRecoveryDone(const AudioRouteCollection &routes);
+
+    const Stats &getStats() const { return mStats; }
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+private:
+    static uint64_t getMonotonicUs();
+
+    Snapshot mSnapshot;
+    Stats mStats;
+    uint64_t mCrashUs; /**< Time of the last crash. */
+    uint64_t mRecoveryStartUs; /**< Time of the last recovery event. */
+};
+
+} // namespace intel_audio
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <Mutex.hpp>
+#include <utils/Errors.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+/**
+ * Records the duration of the phases of the HAL startup, i.e. from the creation of the route
+ * manager until the initial routing is done.
+ * Phases may be recorded from concurrent threads. Times are relative to the creation of the
+ * profiler, in microseconds of the monotonic clock.
+ */
+class StartupProfiler : private audio_comms::utilities::NonCopyable
+{
+public:
+    struct PhaseRecord
+    {
+        std::string name;
+        pid_t thread; /**< Thread the phase ran in. */
+        uint64_t startUs;
+        uint64_t durationUs;
+    };
+
+    /** Scope of a startup phase: recorded from construction to destruction. */
+    class Phase : private audio_comms::utilities::NonCopyable
+    {
+    public:
+        Phase(StartupProfiler &profiler, const char *name);
+        ~Phase();
+
+    private:
+        StartupProfiler &mProfiler;
+        const char *mName;
+        uint64_t mStartUs;
+    };
+
+    StartupProfiler();
+
+    /** Stamp the end of the startup and log the report. Further calls are ignored. */
+    void complete();
+
+    bool isComplete() const;
+
+    /** @return duration of the startup, or elapsed time so far if not complete. */
+    uint64_t getTotalUs() const;
+
+    /** @return phases in order of completion. */
+    std::vector<PhaseRecord> getPhases() const;
+
+    /**
+     * @return JSON formatted report of the startup, i.e.
+     *      {"total_us":N,"phases":[{"name":"...","thread":N,"start_us":N,"duration_us":N},...]}
+     */
+    std::string getReport() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+private:
+    void record(const char *name, uint64_t startUs, uint64_t endUs);
+
+    /** @return time elapsed since the creation of the profiler. */
+    uint64_t getElapsedUs() const;
+
+    static uint64_t getMonotonicUs();
+
+    const uint64_t mOriginUs;
+    uint64_t mTotalUs; /**< Duration of the startup, 0 until complete. */
+    std::vector<PhaseRecord> mPhases;
+    mutable audio_comms::utilities::Mutex mLock; /**< Protects phases recorded concurrently. */
+};
+
+} // namespace intel_audio
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AdaptivePeriodCount.hpp"
+#include <gtest/gtest.h>
+
+namespace intel_audio
+{
+
+TEST(AdaptivePeriodCount, growsAfterRepeatedXruns)
+{
+    AdaptivePeriodCount periods(2, 4, 2, 60000);
+    EXPECT_EQ(2u, periods.getPeriodCount());
+
+    // A single xrun is tolerated, a second one grows the count.
+    EXPECT_EQ(2u, periods.onDeviceClosed(1, 1000));
+    EXPECT_EQ(3u, periods.onDeviceClosed(1, 1000));
+    EXPECT_EQ(4u, periods.onDeviceClosed(5, 1000));
+
+    // Never beyond the max.
+    EXPECT_EQ(4u, periods.onDeviceClosed(10, 1000));
+}
+
+TEST(AdaptivePeriodCount, shrinksBackWhenStable)
+{
+    AdaptivePeriodCount periods(2, 4, 1, 60000);
+    periods.onDeviceClosed(1, 0);
+    EXPECT_EQ(4u, periods.onDeviceClosed(1, 0));
+
+    // Stable time adds up over the openings, one period given back each time.
+    EXPECT_EQ(4u, periods.onDeviceClosed(0, 30000));
+    EXPECT_EQ(3u, periods.onDeviceClosed(0, 30000));
+    EXPECT_EQ(2u, periods.onDeviceClosed(0, 90000));
+
+    // Never below the nominal count.
+    EXPECT_EQ(2u, periods.onDeviceClosed(0, 600000));
+}
+
+TEST(AdaptivePeriodCount, xrunRestartsStableTime)
+{
+    AdaptivePeriodCount periods(2, 4, 2, 60000);
+    periods.onDeviceClosed(2, 0);
+    EXPECT_EQ(3u, periods.getPeriodCount());
+
+    periods.onDeviceClosed(0, 50000);
+    periods.onDeviceClosed(1, 1000);
+    EXPECT_EQ(3u, periods.onDeviceClosed(0, 50000));
+
+    // The lone xrun was forgiven by the stable time, another one does not grow the count.
+    EXPECT_EQ(2u, periods.onDeviceClosed(0, 10000));
+    EXPECT_EQ(2u, periods.onDeviceClosed(1, 1000));
+}
+
+} // namespace intel_audio
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "RouteManager/AudioDeviceStandIn"
+
+#include "test/AudioDeviceStandIn.hpp"
+#include <MixPortConfig.hpp>
+#include <utilities/Log.hpp>
+#include <tinyalsa/asoundlib.h>
+#include <string.h>
+#include <time.h>
+
+using audio_comms::utilities::Log;
+
+namespace intel_audio
+{
+
+android::status_t AudioDeviceStandIn::open(const char *cardName, uint32_t deviceId,
+                                           const MixPortConfig &routeConfig, bool isOut)
+{
+    if (mIsOpened) {
+        Log::Error() << __FUNCTION__ << ": device already opened";
+        return android::INVALID_OPERATION;
+    }
+    pcm_config config;
+    routeConfig.getPcmConfig(config);
+    mFrameSize = config.channels * pcm_format_to_bits(config.format) / 8;
+    mBufferSizeInFrames = config.period_size * config.period_count;
+    mIsOut = isOut;
+    mIsOpened = true;
+    Log::Debug() << __FUNCTION__ << ": card (" << cardName << ", " << deviceId << ") for "
+                 << (isOut ? "output" : "input") << ", " << mBufferSizeInFrames << " frames";
+    return android::OK;
+}
+
+android::status_t AudioDeviceStandIn::close()
+{
+    if (!mIsOpened) {
+        return android::INVALID_OPERATION;
+    }
+    mIsOpened = false;
+    return android::OK;
+}
+
+android::status_t AudioDeviceStandIn::pcmReadFrames(void *buffer, size_t frames,
+                                                    std::string &error) const
+{
+    if (!mIsOpened) {
+        error = "device not opened";
+        return android::NO_INIT;
+    }
+    memset(buffer, 0, frames * mFrameSize);
+    return android::OK;
+}
+
+android::status_t AudioDeviceStandIn::pcmWriteFrames(void *, ssize_t, std::string &error) const
+{
+    if (!mIsOpened) {
+        error = "device not opened";
+        return android::NO_INIT;
+    }
+    return android::OK;
+}
+
+android::status_t AudioDeviceStandIn::getFramesAvailable(size_t &avail,
+                                                         struct timespec &tStamp) const
+{
+    if (!mIsOpened) {
+        return android::INVALID_OPERATION;
+    }
+    // What is played is dropped at once, what is captured is produced on demand.
+    avail = mIsOut ? mBufferSizeInFrames : 0;
+    clock_gettime(CLOCK_MONOTONIC, &tStamp);
+    return android::OK;
+}
+
+} // namespace intel_audio
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioDevice.hpp>
+
+namespace intel_audio
+{
+
+/**
+ * Stand-in of the tinyalsa devices for host builds, where no sound card can be opened: the
+ * device opens with the configuration of its route, captures silence and drops what is played,
+ * without pacing the transfers. It lets the tests route streams through the real routing stages.
+ */
+class AudioDeviceStandIn : public IAudioDevice
+{
+public:
+    AudioDeviceStandIn() : mIsOpened(false), mIsOut(false), mFrameSize(0), mBufferSizeInFrames(0) {}
+
+    virtual android::status_t open(const char *cardName, uint32_t deviceId,
+                                   const MixPortConfig &config, bool isOut);
+
+    virtual bool isOpened() { return mIsOpened; }
+
+    virtual android::status_t close();
+
+    virtual android::status_t pcmReadFrames(void *buffer, size_t frames, std::string &error) const;
+
+    virtual android::status_t pcmWriteFrames(void *buffer, ssize_t frames,
+                                             std::string &error) const;
+
+    virtual uint32_t getBufferSizeInBytes() const { return mBufferSizeInFrames * mFrameSize; }
+
+    virtual size_t getBufferSizeInFrames() const { return mBufferSizeInFrames; }
+
+    virtual android::status_t getFramesAvailable(size_t &avail, struct timespec &tStamp) const;
+
+    virtual android::status_t pcmStop() const { return android::OK; }
+
+    virtual XrunCounters getXrunCounters() const
+    {
+        XrunCounters counters = { 0, 0 };
+        return counters;
+    }
+
+private:
+    bool mIsOpened;
+    bool mIsOut;
+    uint32_t mFrameSize; /**< in bytes, of the configuration opened. */
+    uint32_t mBufferSizeInFrames;
+};
+
+} // namespace intel_audio
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ConfigSnapshot.hpp"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+using namespace intel_audio;
+using namespace std;
+
+class ConfigSnapshotTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char directory[] = "/tmp/config_snapshot_testXXXXXX";
+        ASSERT_TRUE(mkdtemp(directory) != NULL);
+        mDirectory = directory;
+        mConfigFile = mDirectory + "/audio_policy_configuration.xml";
+        mIncludedFile = mDirectory + "/included_configuration.xml";
+        mSnapshotFile = mDirectory + "/route_manager_config.snapshot";
+        writeFile(mConfigFile, "<audioPolicyConfiguration version=\"1.0\"/>");
+        writeFile(mIncludedFile, "<mixPorts/>");
+    }
+
+    virtual void TearDown()
+    {
+        unlink(mConfigFile.c_str());
+        unlink(mIncludedFile.c_str());
+        unlink(mSnapshotFile.c_str());
+        rmdir(mDirectory.c_str());
+    }
+
+    static void writeFile(const string &path, const string &content)
+    {
+        ofstream file(path.c_str(), ios::binary | ios::trunc);
+        file << content;
+    }
+
+    /** Fill a builder with a configuration tree made of a module with two mix ports. */
+    void buildConfiguration(ConfigSnapshotBuilder &builder)
+    {
+        builder.addSource(mConfigFile);
+        builder.addSource(mIncludedFile);
+        uint32_t root = builder.addElement(ConfigSnapshotBuilder::gNoElement,
+                                           "audioPolicyConfiguration");
+        builder.addAttribute(root, "version", "1.0");
+        uint32_t module = builder.addElement(root, "module");
+        builder.addAttribute(module, "name", "primary");
+        uint32_t mixPorts = builder.addElement(module, "mixPorts");
+        uint32_t mixPort = builder.addElement(mixPorts, "mixPort");
+        builder.addAttribute(mixPort, "name", "media");
+        builder.addAttribute(mixPort, "role", "source");
+        builder.addElement(mixPort, "profile");
+        mixPort = builder.addElement(mixPorts, "mixPort");
+        builder.addAttribute(mixPort, "name", "voice");
+        builder.addAttribute(mixPort, "role", "sink");
+        builder.addElement(root, "criteria");
+    }
+
+    /** Check the tree of the snapshot is the one filled by buildConfiguration. */
+    static void checkConfiguration(const ConfigSnapshot &snapshot)
+    {
+        ConfigNode root = snapshot.getRoot();
+        ASSERT_TRUE(root.isValid());
+        EXPECT_STREQ("audioPolicyConfiguration", root.getName());
+        EXPECT_EQ("1.0", root.getAttribute("version"));
+        EXPECT_EQ("", root.getAttribute("name"));
+        EXPECT_FALSE(root.getNext().isValid());
+
+        ConfigNode module = root.getFirstChild();
+        ASSERT_TRUE(module.isValid());
+        EXPECT_TRUE(module.hasName("module"));
+        EXPECT_EQ("primary", module.getAttribute("name"));
+
+        ConfigNode criteria = module.getNext();
+        ASSERT_TRUE(criteria.isValid());
+        EXPECT_TRUE(criteria.hasName("criteria"));
+        EXPECT_FALSE(criteria.getFirstChild().isValid());
+        EXPECT_FALSE(criteria.getNext().isValid());
+
+        ConfigNode mixPorts = module.getFirstChild();
+        ASSERT_TRUE(mixPorts.isValid());
+        EXPECT_FALSE(mixPorts.getNext().isValid());
+
+        ConfigNode mixPort = mixPorts.getFirstChild();
+        ASSERT_TRUE(mixPort.isValid());
+        EXPECT_EQ("media", mixPort.getAttribute("name"));
+        EXPECT_EQ("source", mixPort.getAttribute("role"));
+        ASSERT_TRUE(mixPort.getFirstChild().isValid());
+        EXPECT_TRUE(mixPort.getFirstChild().hasName("profile"));
+        EXPECT_EQ("", mixPort.getFirstChild().getAttribute("name"));
+
+        mixPort = mixPort.getNext();
+        ASSERT_TRUE(mixPort.isValid());
+        EXPECT_EQ("voice", mixPort.getAttribute("name"));
+        EXPECT_EQ("sink", mixPort.getAttribute("role"));
+        EXPECT_FALSE(mixPort.getFirstChild().isValid());
+        EXPECT_FALSE(mixPort.getNext().isValid());
+    }
+
+    void saveConfiguration()
+    {
+        ConfigSnapshotBuilder builder;
+        buildConfiguration(builder);
+        ConfigSnapshot snapshot;
+        ASSERT_EQ(android::OK, snapshot.load(builder));
+        ASSERT_EQ(android::OK, snapshot.save(mSnapshotFile));
+    }
+
+    /** Overwrite a byte of the snapshot file. */
+    void corruptSnapshot(size_t offset)
+    {
+        fstream file(mSnapshotFile.c_str(), ios::binary | ios::in | ios::out);
+        file.seekg(offset);
+        char byte = file.get();
+        file.seekp(offset);
+        file.put(byte ^ 0x5a);
+    }
+
+    string mDirectory;
+    string mConfigFile;
+    string mIncludedFile;
+    string mSnapshotFile;
+};
+
+TEST_F(ConfigSnapshotTest, BrowseBuiltConfiguration)
+{
+    ConfigSnapshot snapshot;
+    EXPECT_FALSE(snapshot.getRoot().isValid());
+
+    ConfigSnapshotBuilder builder;
+    buildConfiguration(builder);
+    ASSERT_EQ(android::OK, snapshot.load(builder));
+    checkConfiguration(snapshot);
+}
+
+TEST_F(ConfigSnapshotTest, SavedConfigurationIsMappedBack)
+{
+    saveConfiguration();
+
+    ConfigSnapshot snapshot;
+    ASSERT_EQ(android::OK, snapshot.load(mSnapshotFile, mConfigFile));
+    checkConfiguration(snapshot);
+}
+
+TEST_F(ConfigSnapshotTest, MissingSnapshotIsRejected)
+{
+    ConfigSnapshot snapshot;
+    EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mConfigFile));
+    EXPECT_FALSE(snapshot.getRoot().isValid());
+}
+
+TEST_F(ConfigSnapshotTest, SnapshotOfAnotherConfigurationIsRejected)
+{
+    saveConfiguration();
+
+    ConfigSnapshot snapshot;
+    EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mIncludedFile));
+    EXPECT_FALSE(snapshot.getRoot().isValid());
+}
+
+TEST_F(ConfigSnapshotTest, ChangedSourcesAreDetected)
+{
+    saveConfiguration();
+    writeFile(mConfigFile, "<audioPolicyConfiguration version=\"1.0\"><modules/>"
+                           "</audioPolicyConfiguration>");
+    ConfigSnapshot snapshot;
+    EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mConfigFile));
+
+    saveConfiguration();
+    writeFile(mIncludedFile, "<mixPorts></mixPorts>");
+    EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mConfigFile));
+
+    saveConfiguration();
+    unlink(mIncludedFile.c_str());
+    EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mConfigFile));
+}
+
+TEST_F(ConfigSnapshotTest, CorruptedSnapshotIsRejected)
+{
+    saveConfiguration();
+    ifstream file(mSnapshotFile.c_str(), ios::binary | ios::ate);
+    size_t size = file.tellg();
+    file.close();
+
+    // Each byte of the image is either checked against a constant, or covered by the checksum
+    for (size_t offset = 0; offset < size; offset++) {
+        saveConfiguration();
+        corruptSnapshot(offset);
+        ConfigSnapshot snapshot;
+        EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mConfigFile)) << "offset " << offset;
+    }
+
+    saveConfiguration();
+    ASSERT_EQ(0, truncate(mSnapshotFile.c_str(), size - 1));
+    ConfigSnapshot snapshot;
+    EXPECT_NE(android::OK, snapshot.load(mSnapshotFile, mConfigFile));
+}
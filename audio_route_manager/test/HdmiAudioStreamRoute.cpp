@@ -46,6 +46,7 @@ void HdmiAudioStreamRoute::loadCapabilities()
             capability.mSupportedRates.push_back(192000);
         }
     }
+    mConfig.updateCapabilityLiterals();
 }
 
 } // namespace intel_audio
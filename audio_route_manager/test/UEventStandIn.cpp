@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "RouteManager/UEventStandIn"
+
+#include "test/UEventStandIn.hpp"
+#include <utilities/Log.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using audio_comms::utilities::Log;
+using std::string;
+using std::vector;
+
+namespace intel_audio
+{
+
+int UEventStandIn::mPeerFd = -1;
+
+int UEventStandIn::open()
+{
+    int fds[2];
+    // Sequenced packets keep the boundaries of the uevents, as netlink datagrams do
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) < 0) {
+        Log::Error() << __FUNCTION__ << ": could not create socket pair";
+        return -1;
+    }
+    if (mPeerFd >= 0) {
+        close(mPeerFd);
+    }
+    mPeerFd = fds[1];
+    return fds[0];
+}
+
+ssize_t UEventStandIn::receive(int fd, char *buffer, size_t size)
+{
+    return recv(fd, buffer, size, 0);
+}
+
+bool UEventStandIn::inject(const vector<string> &entries)
+{
+    if (mPeerFd < 0) {
+        return false;
+    }
+    string uevent;
+    for (const auto &entry : entries) {
+        uevent.append(entry.c_str(), entry.size() + 1);
+    }
+    return send(mPeerFd, uevent.data(), uevent.size(), MSG_NOSIGNAL) ==
+           static_cast<ssize_t>(uevent.size());
+}
+
+} // namespace intel_audio
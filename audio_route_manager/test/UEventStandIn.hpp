@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+/**
+ * Stand-in of the kernel uevent socket for host builds: a socket pair whose peer end lets the
+ * tests inject uevents, as the audio driver would broadcast them.
+ */
+class UEventStandIn
+{
+public:
+    /** @return socket the route manager listens to, -1 on failure. */
+    static int open();
+
+    /**
+     * @param[in] fd socket returned by open.
+     * @param[out] buffer receiving the uevent.
+     * @param[in] size of the buffer.
+     *
+     * @return size of the uevent received, negative on error.
+     */
+    static ssize_t receive(int fd, char *buffer, size_t size);
+
+    /**
+     * Inject a uevent.
+     *
+     * @param[in] entries of the uevent, i.e. "key=value" strings.
+     *
+     * @return true if sent, false if the socket is not opened or on error.
+     */
+    static bool inject(const std::vector<std::string> &entries);
+
+private:
+    static int mPeerFd; /**< End of the socket pair the uevents are injected from. */
+};
+
+} // namespace intel_audio
@@ -31,6 +31,12 @@ component_src_files :=  \
     src/StreamIn.cpp \
     src/StreamOut.cpp \
     src/CompressedStreamOut.cpp \
+    src/CompressDeviceBackend.cpp \
+    src/EffectChain.cpp \
+    src/LatencyHistogram.cpp \
+    src/OffloadCommandQueue.cpp \
+    src/OffloadFragmentPlanner.cpp \
+    src/PositionSnapshot.cpp \
     src/Patch.cpp \
     src/Port.cpp
 
@@ -59,6 +65,8 @@ component_static_lib += \
     libparametermgr_static \
     libaudioparameters \
     libaudio_hal_utilities \
+    libaudiotrace \
+    libaudiotelemetry \
     libproperty \
     libaudio_comms_utilities \
     libaudio_comms_convert \
@@ -235,6 +243,45 @@ include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
 include $(BUILD_HOST_EXECUTABLE)
 endif
 
+# Stream helpers unit test for HOST
+#######################################################################
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+    test/EffectChainTest.cpp \
+    test/LatencyHistogramTest.cpp \
+    test/OffloadFragmentPlannerTest.cpp \
+    test/PositionSnapshotTest.cpp
+
+LOCAL_C_INCLUDES := \
+    test \
+    external/gtest/include \
+    $(component_includes_dir_host) \
+
+LOCAL_STATIC_LIBRARIES := \
+    audio.primary_host \
+    $(component_static_lib_host) \
+    $(component_whole_static_lib)_host \
+    libgtest_host \
+    libgtest_main_host
+
+LOCAL_SHARED_LIBRARIES := \
+    $(component_shared_lib_host)
+
+LOCAL_LDFLAGS += -lpthread -lrt
+LOCAL_MODULE := audio-hal-stream_unit_test_host
+LOCAL_MODULE_OWNER := intel
+LOCAL_MODULE_TAGS := optional
+LOCAL_STRIP_MODULE := false
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -O0 -ggdb
+
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+
+include $(BUILD_HOST_EXECUTABLE)
+endif
+
 #######################################################################
 # Build for configuration file
 
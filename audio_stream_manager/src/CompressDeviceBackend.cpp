@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CompressDeviceBackend"
+
+#include "CompressDeviceBackend.hpp"
+#include "AudioUtils.hpp"
+#include <utilities/Log.hpp>
+#include <sound/compress_params.h>
+#include <sound/compress_offload.h>
+#include <tinycompress/tinycompress.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+using audio_comms::utilities::Log;
+
+namespace intel_audio
+{
+
+/** Compress devices of the kernel, queried through their node and driven with tinycompress. */
+class KernelCompressDeviceBackend : public CompressDeviceBackend
+{
+public:
+    virtual bool getCaps(uint32_t card, uint32_t device, CompressCaps &caps)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/dev/snd/comprC%uD%u", card, device);
+        int fd = ::open(path, O_WRONLY | O_CLOEXEC);
+        if (fd < 0) {
+            Log::Error() << __FUNCTION__ << ": cannot open " << path << ", error " << errno;
+            return false;
+        }
+        struct snd_compr_caps compressCaps;
+        int ret = ioctl(fd, SNDRV_COMPRESS_GET_CAPS, &compressCaps);
+        ::close(fd);
+        if (ret < 0) {
+            Log::Error() << __FUNCTION__ << ": cannot get caps of " << path;
+            return false;
+        }
+        caps.minFragmentSize = compressCaps.min_fragment_size;
+        caps.maxFragmentSize = compressCaps.max_fragment_size;
+        caps.minFragments = compressCaps.min_fragments;
+        caps.maxFragments = compressCaps.max_fragments;
+        return true;
+    }
+
+    virtual int getCardIndex(const char *name) { return AudioUtils::getCardIndexByName(name); }
+
+    virtual int getDeviceIndex() { return AudioUtils::getCompressDeviceIndex(); }
+
+    virtual struct compress *open(unsigned int card, unsigned int device, unsigned int flags,
+                                  struct compr_config *config)
+    {
+        return compress_open(card, device, flags, config);
+    }
+
+    virtual void close(struct compress *compress) { compress_close(compress); }
+
+    virtual bool isReady(struct compress *compress) { return is_compress_ready(compress); }
+
+    virtual const char *getError(struct compress *compress)
+    {
+        return compress_get_error(compress);
+    }
+
+    virtual void setNonBlocking(struct compress *compress, bool nonBlocking)
+    {
+        compress_nonblock(compress, nonBlocking);
+    }
+
+    virtual int setGaplessMetadata(struct compress *compress,
+                                   struct compr_gapless_mdata *metadata)
+    {
+        return compress_set_gapless_metadata(compress, metadata);
+    }
+
+    virtual int write(struct compress *compress, const void *buffer, size_t bytes)
+    {
+        return compress_write(compress, buffer, bytes);
+    }
+
+    virtual int start(struct compress *compress) { return compress_start(compress); }
+
+    virtual int stop(struct compress *compress) { return compress_stop(compress); }
+
+    virtual int pause(struct compress *compress) { return compress_pause(compress); }
+
+    virtual int resume(struct compress *compress) { return compress_resume(compress); }
+
+    virtual int wait(struct compress *compress, int timeoutMs)
+    {
+        return compress_wait(compress, timeoutMs);
+    }
+
+    virtual int drain(struct compress *compress) { return compress_drain(compress); }
+
+    virtual int partialDrain(struct compress *compress)
+    {
+        return compress_partial_drain(compress);
+    }
+
+    virtual int nextTrack(struct compress *compress) { return compress_next_track(compress); }
+
+    virtual int getTstamp(struct compress *compress, unsigned long *frames,
+                          unsigned int *sampleRate)
+    {
+        return compress_get_tstamp(compress, frames, sampleRate);
+    }
+
+    virtual int getHpointer(struct compress *compress, unsigned int *available,
+                            struct timespec *timestamp)
+    {
+        return compress_get_hpointer(compress, available, timestamp);
+    }
+};
+
+CompressDeviceBackend &CompressDeviceBackend::getKernelBackend()
+{
+    static KernelCompressDeviceBackend backend;
+    return backend;
+}
+
+} // namespace intel_audio
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+struct compress;
+struct compr_config;
+struct compr_gapless_mdata;
+
+namespace intel_audio
+{
+
+/** Buffering limits advertised by the driver of a compress device. */
+struct CompressCaps
+{
+    uint32_t minFragmentSize; /**< in bytes. */
+    uint32_t maxFragmentSize; /**< in bytes. */
+    uint32_t minFragments;
+    uint32_t maxFragments;
+};
+
+/**
+ * Access to the compress devices, abstracted so that the fragment planner and the compressed
+ * stream can run against a fake one.
+ * Besides the caps query, the operations follow the tinycompress API they forward to on target.
+ */
+class CompressDeviceBackend
+{
+public:
+    virtual ~CompressDeviceBackend() {}
+
+    /** @return backend of the kernel compress devices, driven through tinycompress. */
+    static CompressDeviceBackend &getKernelBackend();
+
+    /**
+     * Query the buffering limits of a compress device.
+     *
+     * @param[in] card index of the sound card.
+     * @param[in] device index of the compress device on the card.
+     * @param[out] caps advertised by the driver.
+     *
+     * @return true if the device answered, false otherwise.
+     */
+    virtual bool getCaps(uint32_t card, uint32_t device, CompressCaps &caps) = 0;
+
+    /**
+     * @param[in] name of the sound card.
+     *
+     * @return index of the sound card, negative error code if not found.
+     */
+    virtual int getCardIndex(const char *name) = 0;
+
+    /** @return index of the compress device to play on, negative error code if none. */
+    virtual int getDeviceIndex() = 0;
+
+    virtual struct compress *open(unsigned int card, unsigned int device, unsigned int flags,
+                                  struct compr_config *config) = 0;
+    virtual void close(struct compress *compress) = 0;
+    virtual bool isReady(struct compress *compress) = 0;
+    virtual const char *getError(struct compress *compress) = 0;
+    virtual void setNonBlocking(struct compress *compress, bool nonBlocking) = 0;
+    virtual int setGaplessMetadata(struct compress *compress,
+                                   struct compr_gapless_mdata *metadata) = 0;
+
+    /** @return bytes written, negative error code on failure. */
+    virtual int write(struct compress *compress, const void *buffer, size_t bytes) = 0;
+
+    virtual int start(struct compress *compress) = 0;
+    virtual int stop(struct compress *compress) = 0;
+    virtual int pause(struct compress *compress) = 0;
+    virtual int resume(struct compress *compress) = 0;
+    virtual int wait(struct compress *compress, int timeoutMs) = 0;
+    virtual int drain(struct compress *compress) = 0;
+    virtual int partialDrain(struct compress *compress) = 0;
+    virtual int nextTrack(struct compress *compress) = 0;
+
+    /**
+     * @param[in] compress device to query.
+     * @param[out] frames rendered by the DSP.
+     * @param[out] sampleRate the frames are rendered at.
+     *
+     * @return 0 on success, negative error code otherwise.
+     */
+    virtual int getTstamp(struct compress *compress, unsigned long *frames,
+                          unsigned int *sampleRate) = 0;
+
+    /**
+     * @param[in] compress device to query.
+     * @param[out] available bytes free in the buffer of the device.
+     * @param[out] timestamp of the audio rendered.
+     *
+     * @return 0 on success, negative error code otherwise.
+     */
+    virtual int getHpointer(struct compress *compress, unsigned int *available,
+                            struct timespec *timestamp) = 0;
+};
+
+} // namespace intel_audio
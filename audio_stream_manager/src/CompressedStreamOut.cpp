@@ -18,6 +18,9 @@
 
 #include "CompressedStreamOut.hpp"
 #include "AudioUtils.hpp"
+#include <AlsaMixer.hpp>
+#include <AudioTrace.hpp>
+#include <KeyValueSlices.hpp>
 #include <property/Property.hpp>
 #include <convert/convert.hpp>
 #include <utilities/Log.hpp>
@@ -51,18 +54,19 @@ namespace intel_audio
 {
 
 static const int gDefaultRampInMs = 5; // valid mixer range is from 5 to 5000
-static const size_t gOffloadMinAllowedBufferSizeInBytes = (2 * 1024);
-static const size_t gOffloadMaxAllowedBufferSizeInBytes = (128 * 1024);
-static const uint32_t gOffloadTransferIntervalInSec = 8;
 static const uint32_t gCodecOffloadDefaultBitrateInBps = 128000;
 
 CompressedStreamOut::CompressedStreamOut(Device *parent, audio_io_handle_t handle,
                                          uint32_t flagMask, audio_devices_t devices,
-                                         const std::string &address)
+                                         const std::string &address,
+                                         CompressDeviceBackend *backend)
     : StreamOut(parent, handle, flagMask, devices, address),
       mCompress(NULL),
       mVolume(SST_VOLUME_MUTE),
       mIsVolumeChangeRequestPending(false),
+      mBackend(backend != NULL ? *backend : CompressDeviceBackend::getKernelBackend()),
+      mFragmentPlanner(&mBackend),
+      mPlan(),
       mIsOffloadThreadBlocked(false),
       mOffloadCookie(NULL),
       mNewMetadataPendingToSend(true),
@@ -88,8 +92,12 @@ CompressedStreamOut::CompressedStreamOut(Device *parent, audio_io_handle_t handl
     Log::Info() << __FUNCTION__ << ": The mixer control name for volume = "
                 << mMixVolumeCtl << ", mute = " << mMixMuteCtl << ", Ramp = " << mMixVolumeRampCtl;
 
+    mFragmentPlanner.setWakeupIntervals(
+        Property<uint32_t>("offload.wakeup.interval.ms", 8000).getValue(),
+        Property<uint32_t>("offload.wakeup.interval.max.ms", 32000).getValue());
+
     string cardName(Property<string>("audio.device.name", "0").getValue());
-    mSoundCardNo = AudioUtils::getCardIndexByName(cardName.c_str());
+    mSoundCardNo = mBackend.getCardIndex(cardName.c_str());
 
     Log::Verbose() << __FUNCTION__ << ": creating callback";
     createOffloadCallbackThread();
@@ -137,6 +145,7 @@ CompressedStreamOut::~CompressedStreamOut()
 
 status_t CompressedStreamOut::pause()
 {
+    AUDIO_TRACE_SCOPE("CompressedStreamOut::pause");
     Mutex::Locker locker(mCodecLock);
 
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] in";
@@ -144,17 +153,20 @@ status_t CompressedStreamOut::pause()
         Log::Verbose() << __FUNCTION__ << ": [" << mState << "] ignored";
         return android::OK;
     }
-    if (compress_pause(mCompress) < 0) {
-        Log::Error() << __FUNCTION__ << ": failed, Err=" << compress_get_error(mCompress);
+    if (mBackend.pause(mCompress) < 0) {
+        Log::Error() << __FUNCTION__ << ": failed, Err=" << mBackend.getError(mCompress);
         return android::INVALID_OPERATION;
     }
     mState = SstState::PAUSED;
+    mFragmentPlanner.onInterrupted();
+    publishPositionUnsafe();
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] out";
     return android::OK;
 }
 
 status_t CompressedStreamOut::resume()
 {
+    AUDIO_TRACE_SCOPE("CompressedStreamOut::resume");
     Mutex::Locker locker(mCodecLock);
 
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] in";
@@ -162,11 +174,12 @@ status_t CompressedStreamOut::resume()
         Log::Verbose() << __FUNCTION__ << ": [" << mState << "] ignored";
         return android::OK;
     }
-    if (compress_resume(mCompress) < 0) {
-        Log::Error() << __FUNCTION__ << ": failed, Err=" << compress_get_error(mCompress);
+    if (mBackend.resume(mCompress) < 0) {
+        Log::Error() << __FUNCTION__ << ": failed, Err=" << mBackend.getError(mCompress);
         return android::INVALID_OPERATION;
     }
     mState = SstState::PLAYING;
+    publishPositionUnsafe();
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] out";
     return android::OK;
 }
@@ -177,29 +190,28 @@ status_t CompressedStreamOut::closeDeviceUnsafe()
     if (mCompress != NULL) {
         if (mState == SstState::DRAINING) {
             Log::Verbose() << __FUNCTION__ << ": called after partial drain, Call the drain";
-            compress_drain(mCompress);
+            mBackend.drain(mCompress);
             Log::Verbose() << __FUNCTION__ << ": coming out of drain";
         }
         Log::Verbose() << __FUNCTION__ << ": compress_close";
-        compress_close(mCompress);
+        mBackend.close(mCompress);
         mCompress = NULL;
     }
     mState = SstState::CLOSED;
+    publishPositionUnsafe();
     return android::OK;
 }
 
-status_t CompressedStreamOut::setMuteUnsafe(bool muted, struct mixer *mixer)
+status_t CompressedStreamOut::setMuteUnsafe(bool muted)
 {
     if (muted == isMuted()) {
         return android::OK;
     }
-
-    struct mixer_ctl *mute_ctl = mixer_get_ctl_by_name(mixer, mMixMuteCtl.c_str());
-    if (!mute_ctl) {
-        Log::Error() << __FUNCTION__ << ": Error opening mixerMutecontrol" << mMixMuteCtl;
+    if (AlsaMixerService::getInstance().setValues(mSoundCardNo, mMixMuteCtl, {muted}) !=
+        android::OK) {
+        Log::Error() << __FUNCTION__ << ": Error setting mixer mute control " << mMixMuteCtl;
         return android::BAD_VALUE;
     }
-    mixer_ctl_set_value(mute_ctl, 0, muted);
     Log::Verbose() << __FUNCTION__ << ": muting=" << muted;
     return android::OK;
 }
@@ -208,7 +220,7 @@ status_t CompressedStreamOut::openDeviceUnsafe()
 {
     struct compr_config config;
     struct snd_codec codec;
-    int device = AudioUtils::getCompressDeviceIndex();
+    int device = mBackend.getDeviceIndex();
     if (device < 0) {
         Log::Error() << __FUNCTION__ << ": Error getting device number ";
         return android::BAD_VALUE;
@@ -235,31 +247,27 @@ status_t CompressedStreamOut::openDeviceUnsafe()
                 << ",codec.rate_control=" << codec.rate_control << ", codec.profile="
                 << codec.profile << ",codec.level=" << codec.level << ",codec.ch_mode="
                 << codec.ch_mode << ",codec.format=" << codec.format;
-    config.fragment_size = mBufferSize;
-    config.fragments = 2;
+    mPlan = mFragmentPlanner.plan(mSoundCardNo, device, codec.id, channel_count,
+                                  getPlanningBitRate());
+    config.fragment_size = mPlan.fragmentSize;
+    config.fragments = mPlan.fragments;
     config.codec = &codec;
 
-    mCompress = compress_open(mSoundCardNo, device, COMPRESS_IN, &config);
-    if (mCompress && !is_compress_ready(mCompress)) {
+    mCompress = mBackend.open(mSoundCardNo, device, COMPRESS_IN, &config);
+    if (mCompress && !mBackend.isReady(mCompress)) {
         Log::Error() << __FUNCTION__ << ": Failed opening card " << mSoundCardNo << " device "
-                     << device << " (error=" << compress_get_error(mCompress) << ")";
+                     << device << " (error=" << mBackend.getError(mCompress) << ")";
         closeDeviceUnsafe();
         return android::BAD_VALUE;
     }
     Log::Verbose() << __FUNCTION__ << ": Compress device opened sucessfully";
     Log::Verbose() << __FUNCTION__ << ": setting compress non block";
-    compress_nonblock(mCompress, mIsNonBlocking);
+    mBackend.setNonBlocking(mCompress, mIsNonBlocking);
 
-    struct mixer *mixer;
-    mixer = mixer_open(mSoundCardNo);
-    if (!mixer) {
-        Log::Error() << __FUNCTION__ << ": Failed to open mixer for card " << mSoundCardNo;
-        return android::INVALID_OPERATION;
-    }
-    unmute(mixer);
-    mixer_close(mixer);
+    unmute();
 
     mState = SstState::IDLE;
+    publishPositionUnsafe();
     return android::OK;
 }
 
@@ -267,11 +275,13 @@ void CompressedStreamOut::stopCompressedOutputUnsafe()
 {
     mNewMetadataPendingToSend = true;
     if (mCompress != NULL) {
-        compress_stop(mCompress);
+        mBackend.stop(mCompress);
         while (mIsOffloadThreadBlocked) {
             mCond.wait(mCodecLock);
         }
         mState = SstState::IDLE;
+        mFragmentPlanner.onInterrupted();
+        publishPositionUnsafe();
     }
 }
 
@@ -299,41 +309,28 @@ status_t CompressedStreamOut::setParameters(const std::string &kvpairs)
 
     Mutex::Locker locker(mCodecLock);
 
-    KeyValuePairs pairs(kvpairs);
+    KeyValueSlices pairs(kvpairs);
     string key(AUDIO_OFFLOAD_CODEC_BIT_PER_SAMPLE);
     status_t status = pairs.get<int>(key, mCodec.bitsPerSample);
-    if (status == android::OK) {
-        pairs.remove(key);
-    }
     // Avg bitrate in bps - for AAC/MP3
     key = AUDIO_OFFLOAD_CODEC_AVG_BIT_RATE;
     status = pairs.get<int>(key, mCodec.avgBitRate);
     if (status == android::OK) {
-        pairs.remove(key);
         Log::Verbose() << __FUNCTION__ << ": average bit rate set to " << mCodec.avgBitRate;
     }
     // Number of channels present (for AAC)
     key = AUDIO_OFFLOAD_CODEC_NUM_CHANNEL;
     status = pairs.get<int>(key, mCodec.numChannels);
-    if (status == android::OK) {
-        pairs.remove(key);
-    }
     // Sample rate - for AAC direct from parser
     key = AUDIO_OFFLOAD_CODEC_SAMPLE_RATE;
     status = pairs.get<int>(key, mCodec.sampleRate);
-    if (status == android::OK) {
-        pairs.remove(key);
-    }
     // Delay and Padding samples shall be sent at the same time - for MP3
     key = AUDIO_OFFLOAD_CODEC_DELAY_SAMPLES;
     status = pairs.get<int>(key, delay);
     if (status == android::OK) {
-        pairs.remove(key);
-
         key = AUDIO_OFFLOAD_CODEC_PADDING_SAMPLES;
         status = pairs.get<int>(key, padding);
         if (status == android::OK) {
-            pairs.remove(key);
             mGaplessMdata.encoder_delay = delay;
             mGaplessMdata.encoder_padding = padding;
             Log::Verbose() << __FUNCTION__ << ": Delay=" << delay << ", Padding=" << padding;
@@ -367,92 +364,48 @@ android::status_t CompressedStreamOut::setVolumeUnsafe(float left, float right)
     // If error happens during setting the volume, try to set while in out_write
     mIsVolumeChangeRequestPending = true;
 
-    struct mixer *mixer;
-    struct mixer_ctl *vol_ctl;
-    int volume[2];
-    int prevVolume[2];
-    struct mixer_ctl *volRamp_ctl;
-
-    mixer = mixer_open(mSoundCardNo);
-    if (!mixer) {
-        Log::Error() << __FUNCTION__ << ": Failed to open mixer for card " << mSoundCardNo;
-        return android::INVALID_OPERATION;
-    }
-    status_t ret = (left == 0 && right == 0) ? mute(mixer) : unmute(mixer);
+    status_t ret = (left == 0 && right == 0) ? mute() : unmute();
     if (ret != android::OK) {
-        mixer_close(mixer);
         return ret;
     }
 
     StreamOut::setVolume(left, right);
 
     if (isMuted()) {
-        mixer_close(mixer);
         mIsVolumeChangeRequestPending = false;
         return android::OK;
     }
 
     // gain library expects user input of integer gain in 0.1dB
     // Eg., 60 in decimal represents 6dB
-    volume[0] = convertAmplToBel(left);
-    volume[1] = convertAmplToBel(right);
-    vol_ctl = mixer_get_ctl_by_name(mixer, mMixVolumeCtl.c_str());
-    if (!vol_ctl) {
-        Log::Error() << __FUNCTION__ << ": Error opening mixerVolumecontrol " << mMixVolumeCtl;
-        mixer_close(mixer);
-        return android::INVALID_OPERATION;
-    }
-    Log::Verbose() << __FUNCTION__ << ": volume computed: %x db" << volume[0];
-    mixer_ctl_get_array(vol_ctl, prevVolume, 2);
-    if (prevVolume[0] == volume[0] && prevVolume[1] == volume[1]) {
-        Log::Verbose() << __FUNCTION__ << ": No update since volume requested";
-        mixer_close(mixer);
-        mIsVolumeChangeRequestPending = false;
-        return android::OK;
-    }
-    volRamp_ctl = mixer_get_ctl_by_name(mixer, mMixVolumeRampCtl.c_str());
-    if (!volRamp_ctl) {
-        Log::Error() << __FUNCTION__ << ": Error opening mixerVolRamp ctl " << mMixVolumeRampCtl;
-        mixer_close(mixer);
-        return android::INVALID_OPERATION;
-    }
-    unsigned int num_ctl_values =  mixer_ctl_get_num_values(volRamp_ctl);
-    Log::Verbose() << __FUNCTION__ << ": num_ctl_ramp_values = " << num_ctl_values;
-    for (unsigned int i = 0; i < num_ctl_values; i++) {
-        int retval = mixer_ctl_set_value(volRamp_ctl, i, gDefaultRampInMs);
-        if (retval < 0) {
-            Log::Info() << __FUNCTION__ << ": Error setting volumeRamp =" << std::hex
-                        << gDefaultRampInMs << ", error =" << retval;
-        }
-    }
-    int retval1 = mixer_ctl_set_array(vol_ctl, volume, 2);
-    if (retval1 < 0) {
-        Log::Error() << __FUNCTION__ << ": Err setting volume dB value %x" << volume[0];
-        mixer_close(mixer);
+    vector<int> volume = {
+        convertAmplToBel(left), convertAmplToBel(right)
+    };
+    Log::Verbose() << __FUNCTION__ << ": volume computed: " << volume[0] << " (0.1 dB)";
+
+    // The mixer service skips the controls already holding the values requested
+    AlsaMixerService &mixer = AlsaMixerService::getInstance();
+    if (mixer.setValues(mSoundCardNo, mMixVolumeRampCtl, {gDefaultRampInMs}) != android::OK) {
+        Log::Info() << __FUNCTION__ << ": Error setting volumeRamp =" << gDefaultRampInMs;
+    }
+    if (mixer.setValues(mSoundCardNo, mMixVolumeCtl, volume) != android::OK) {
+        Log::Error() << __FUNCTION__ << ": Err setting volume dB value " << volume[0];
         return android::INVALID_OPERATION;
     }
     Log::Verbose() << __FUNCTION__ << ": Successful in set volume";
-    mixer_close(mixer);
     mIsVolumeChangeRequestPending = false;
     return android::OK;
 }
 
-android::status_t CompressedStreamOut::sendOffloadCmdUnsafe(offload_cmd::Command command)
+android::status_t CompressedStreamOut::sendOffloadCmdUnsafe(OffloadCommandQueue::Command command)
 {
-    struct offload_cmd *cmd = new struct offload_cmd (command);
-    if (!cmd) {
-        Log::Verbose() << __FUNCTION__ << ": NO_MEMORY";
-        return android::NO_MEMORY;
-    }
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] cmd=" << command;
-
-    list_add_tail(&mOffloadCmdList, &cmd->node);
-    mOffloadCond.signal();
-    return android::OK;
+    return mOffloadCommands.push(command);
 }
 
 android::status_t CompressedStreamOut::write(const void *buffer, size_t &bytes)
 {
+    AUDIO_TRACE_SCOPE("CompressedStreamOut::write");
     Mutex::Locker locker(mCodecLock);
 
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "]";
@@ -466,9 +419,9 @@ android::status_t CompressedStreamOut::write(const void *buffer, size_t &bytes)
     }
 
     if (mNewMetadataPendingToSend) {
-        if ((compress_set_gapless_metadata(mCompress, &mGaplessMdata)) < 0) {
+        if ((mBackend.setGaplessMetadata(mCompress, &mGaplessMdata)) < 0) {
             Log::Error() << __FUNCTION__ << ": setting meta data failed, err="
-                         << compress_get_error(mCompress);
+                         << mBackend.getError(mCompress);
             return -EINVAL;
         }
         mNewMetadataPendingToSend = false;
@@ -476,68 +429,120 @@ android::status_t CompressedStreamOut::write(const void *buffer, size_t &bytes)
     if (mIsVolumeChangeRequestPending) {
         setVolumeUnsafe(mVolume, mVolume);
     }
+    if (mState == SstState::PLAYING) {
+        // Whole buffer free while playing: the DSP ran dry before the writer came back.
+        unsigned int available;
+        struct timespec tstamp;
+        if (mBackend.getHpointer(mCompress, &available, &tstamp) == 0 &&
+            available >= mPlan.fragments * mPlan.fragmentSize) {
+            Log::Warning() << __FUNCTION__ << ": [" << mState << "] underrun";
+            mFragmentPlanner.onUnderrun();
+        }
+    }
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] Calling compress write with "
                    << bytes << " bytes";
-    int ret = compress_write(mCompress, buffer, bytes);
+    int ret = mBackend.write(mCompress, buffer, bytes);
     if ((ret >= 0) && (ret < static_cast<int>(bytes))) {
         Log::Verbose() << __FUNCTION__ << ": [" << mState << "] sending wait for buffer cmd";
-        sendOffloadCmdUnsafe(offload_cmd::WAIT_FOR_BUFFER);
+        sendOffloadCmdUnsafe(OffloadCommandQueue::WAIT_FOR_BUFFER);
     }
     if (ret < 0) {
-        Log::Error() << __FUNCTION__ << ": compress write error: " << compress_get_error(mCompress);
+        Log::Error() << __FUNCTION__ << ": compress write error: "
+                     << mBackend.getError(mCompress);
         return ret;
     }
     bytes = ret;
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] written " << ret << " bytes now";
     if (mState != SstState::PLAYING) {
-        ret = compress_start(mCompress);
+        ret = mBackend.start(mCompress);
         if (ret < 0) {
             Log::Info() << __FUNCTION__ << ": [" << mState << "] compress_start error: "
-                        << compress_get_error(mCompress);
+                        << mBackend.getError(mCompress);
             return ret;
         }
         mState = SstState::PLAYING;
         Log::Verbose() << __FUNCTION__ << ": [" << mState << "] compress_start success";
     }
+    publishPositionUnsafe();
     return android::OK;
 }
 
+void CompressedStreamOut::publishPositionUnsafe()
+{
+    PositionSnapshot::Position position = mPosition.read();
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    position.timestampNs = static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    position.state = mState;
+    position.running = (mState == SstState::PLAYING);
+    position.valid = true;
+    position.maxInterpolationNs = 0;
+    if (mCompress == NULL) {
+        position.frames = 0;
+    } else {
+        unsigned long frames;
+        unsigned int samplingRate;
+        if (mBackend.getTstamp(mCompress, &frames, &samplingRate) == 0) {
+            position.frames = frames;
+            position.sampleRate = samplingRate;
+        } else {
+            Log::Warning() << __FUNCTION__ << ": Failed Err=" << mBackend.getError(mCompress);
+            position.valid = false;
+        }
+        // Never guess beyond the data queued to the DSP
+        uint64_t bufferBytes = static_cast<uint64_t>(mPlan.fragments) * mPlan.fragmentSize;
+        unsigned int available;
+        struct timespec tstamp;
+        if (position.running && mBackend.getHpointer(mCompress, &available, &tstamp) == 0 &&
+            available < bufferBytes) {
+            position.maxInterpolationNs = (bufferBytes - available) * 8 * 1000000000ULL /
+                                          getPlanningBitRate();
+        }
+    }
+    // The DSP counts from 0 again once stopped, closed or done with a track
+    bool rewind = (mState != SstState::PLAYING && mState != SstState::PAUSED);
+    mPosition.publish(position, rewind);
+}
+
 android::status_t CompressedStreamOut::getRenderPosition(uint32_t &dspFrames) const
 {
-    Mutex::Locker locker(mCodecLock);
-    unsigned int sampling_rate;
+    uint64_t frames;
+    struct timespec timestamp;
+    status_t status = readPosition(frames, timestamp);
+    dspFrames = static_cast<uint32_t>(frames);
+    return status;
+}
 
-    dspFrames = 0;
-    if (!isStarted()) {
-        Log::Verbose() << __FUNCTION__ << ": [" << mState << "] stream not started";
+android::status_t CompressedStreamOut::getPresentationPosition(uint64_t &frames, struct timespec &timestamp) const
+{
+    // A position not to be trusted is not reported, rather than reporting one going backwards
+    return readPosition(frames, timestamp);
+}
+
+android::status_t CompressedStreamOut::readPosition(uint64_t &frames,
+                                                    struct timespec &timestamp) const
+{
+    // Lock free: the codec lock may be held across a blocking write or drain.
+    PositionSnapshot::Position position = mPosition.read();
+    clock_gettime(CLOCK_MONOTONIC, &timestamp);
+
+    frames = 0;
+    if (position.state == SstState::CLOSED) {
+        Log::Verbose() << __FUNCTION__ << ": [" << position.state << "] stream not started";
         return -EINVAL;
     }
-    if (mState == SstState::DRAINING) {
+    if (position.state == SstState::DRAINING) {
         // In repeated mode, the track will get recycled and this API is called during draining.
         // So, it keeps updating the progress bar
-        dspFrames = 0;
         return android::OK;
     }
-
-    if (compress_get_tstamp(mCompress, (long unsigned int *)&dspFrames,
-                            &sampling_rate) < 0) {
-        Log::Warning() << __FUNCTION__ << ": Failed Err=" << compress_get_error(mCompress);
+    if (!position.valid) {
+        Log::Verbose() << __FUNCTION__ << ": [" << position.state << "] DSP position unknown";
         return -EINVAL;
     }
-
-
-    Log::Verbose() << __FUNCTION__ << ": [" << mState << "] time (ms) returned = " << dspFrames;
-    return android::OK;
-}
-
-android::status_t CompressedStreamOut::getPresentationPosition(uint64_t &frames, struct timespec &timestamp) const
-{
-    uint32_t dsp_frames;
-
-    getRenderPosition(dsp_frames);
-
-    frames = (uint64_t) dsp_frames;
-    clock_gettime(CLOCK_MONOTONIC, &timestamp);
+    uint64_t nowNs = static_cast<uint64_t>(timestamp.tv_sec) * 1000000000 + timestamp.tv_nsec;
+    frames = mPosition.getMonotonicFramesAt(position, nowNs);
+    Log::Verbose() << __FUNCTION__ << ": [" << position.state << "] frames returned = " << frames;
     return android::OK;
 }
 
@@ -553,13 +558,14 @@ status_t CompressedStreamOut::setCallback(stream_callback_t callback, void *cook
 
 status_t CompressedStreamOut::drain(audio_drain_type_t type)
 {
+    AUDIO_TRACE_SCOPE("CompressedStreamOut::drain");
     Mutex::Locker locker(mCodecLock);
 
     Log::Verbose() << __FUNCTION__;
     int status = -ENOSYS;
     if (type == AUDIO_DRAIN_EARLY_NOTIFY) {
         Log::Verbose() << __FUNCTION__ << ": send command PARTIAL_DRAIN";
-        status = sendOffloadCmdUnsafe(offload_cmd::PARTIAL_DRAIN);
+        status = sendOffloadCmdUnsafe(OffloadCommandQueue::PARTIAL_DRAIN);
         Log::Verbose() << __FUNCTION__ << ": recovery " << mRecoveryOnGoing;
         if (mRecoveryOnGoing) {
             Log::Verbose() << __FUNCTION__ << ": stop compress output due to recovery";
@@ -568,7 +574,7 @@ status_t CompressedStreamOut::drain(audio_drain_type_t type)
         }
     } else {
         Log::Verbose() << __FUNCTION__ << ": send command DRAIN";
-        status = sendOffloadCmdUnsafe(offload_cmd::DRAIN);
+        status = sendOffloadCmdUnsafe(OffloadCommandQueue::DRAIN);
     }
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] return status " << status;
     return status;
@@ -576,6 +582,7 @@ status_t CompressedStreamOut::drain(audio_drain_type_t type)
 
 status_t CompressedStreamOut::flush()
 {
+    AUDIO_TRACE_SCOPE("CompressedStreamOut::flush");
     Mutex::Locker locker(mCodecLock);
 
     if (!isStarted()) {
@@ -597,8 +604,9 @@ void CompressedStreamOut::recover()
 {
     Mutex::Locker locker(mCodecLock);
 
-    compress_stop(mCompress);
+    mBackend.stop(mCompress);
     closeDeviceUnsafe();
+    mFragmentPlanner.onUnderrun();
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] device closed";
     openDeviceUnsafe();
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] device opened";
@@ -606,12 +614,19 @@ void CompressedStreamOut::recover()
     Log::Verbose() << __FUNCTION__ << ": [" << mState << "] write old buffer";
 }
 
-bool CompressedStreamOut::handleCommand(offload_cmd::Command cmd, stream_callback_event_t &event)
+bool CompressedStreamOut::handleCommand(OffloadCommandQueue::Command cmd,
+                                        stream_callback_event_t &event)
 {
+    static const char *const commandNames[] = {
+        "EXIT", "DRAIN", "PARTIAL_DRAIN", "WAIT_FOR_BUFFER"
+    };
+    AUDIO_TRACE_SCOPE("CompressedStreamOut::handleCommand",
+                      cmd >= 0 && cmd <= OffloadCommandQueue::WAIT_FOR_BUFFER ?
+                      commandNames[cmd] : NULL);
     int retval;
     switch (cmd) {
-    case offload_cmd::WAIT_FOR_BUFFER:
-        retval = compress_wait(mCompress, -1);
+    case OffloadCommandQueue::WAIT_FOR_BUFFER:
+        retval = mBackend.wait(mCompress, -1);
         Log::Verbose() << __FUNCTION__ << ": compress_wait returns " << retval;
 
         /* TODO: remove the below check for value of flushedState and
@@ -620,16 +635,21 @@ bool CompressedStreamOut::handleCommand(offload_cmd::Command cmd, stream_callbac
         if (retval < 0 && !mIsInFlushedState) {
             Log::Verbose() << __FUNCTION__ << ": compress_wait returns error, do recovery";
             recover();
+        } else if (retval >= 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            mFragmentPlanner.onWakeup(static_cast<uint64_t>(now.tv_sec) * 1000000 +
+                                      now.tv_nsec / 1000);
         }
         Log::Verbose() << __FUNCTION__ << ": WAIT_FOR_BUFFER out of Compress_wait";
         event = STREAM_CBK_EVENT_WRITE_READY;
         return true;
 
-    case offload_cmd::PARTIAL_DRAIN:
+    case OffloadCommandQueue::PARTIAL_DRAIN:
         Log::Verbose() << __FUNCTION__ << ": PARTIAL_DRAIN: Calling next_track";
-        compress_next_track(mCompress);
+        mBackend.nextTrack(mCompress);
         Log::Verbose() << __FUNCTION__ << ": PARTIAL_DRAIN: Calling partial drain";
-        retval = compress_partial_drain(mCompress);
+        retval = mBackend.partialDrain(mCompress);
         Log::Verbose() << __FUNCTION__ << ": PARTIAL_DRAIN: returns " << retval;
         event = STREAM_CBK_EVENT_DRAIN_READY;
         {
@@ -640,9 +660,9 @@ bool CompressedStreamOut::handleCommand(offload_cmd::Command cmd, stream_callbac
         }
         return true;
 
-    case offload_cmd::DRAIN:
+    case OffloadCommandQueue::DRAIN:
         Log::Verbose() << __FUNCTION__ << ": DRAIN: calling compress_drain";
-        compress_drain(mCompress);
+        mBackend.drain(mCompress);
         event = STREAM_CBK_EVENT_DRAIN_READY;
         {
             Mutex::Locker locker(mCodecLock);
@@ -657,7 +677,6 @@ bool CompressedStreamOut::handleCommand(offload_cmd::Command cmd, stream_callbac
 void *CompressedStreamOut::offloadThreadLoop(void *context)
 {
     CompressedStreamOut *out = static_cast<CompressedStreamOut *>(context);
-    struct listnode *item;
 
     setpriority(PRIO_PROCESS, 0, ANDROID_PRIORITY_AUDIO);
     set_sched_policy(0, SP_FOREGROUND);
@@ -665,27 +684,24 @@ void *CompressedStreamOut::offloadThreadLoop(void *context)
 
     Log::Verbose() << __FUNCTION__;
 
-    Mutex::Locker locker(out->mCodecLock);
-
     for (;;) {
-        offload_cmd *cmd = NULL;
+        OffloadCommandQueue::Command cmd;
 
-        if (list_empty(&out->mOffloadCmdList)) {
-            Log::Verbose() << __FUNCTION__ << ": [" << out->mState << "] Cmd list empty, SLEEPING";
-            out->mOffloadCond.wait(out->mCodecLock);
-            Log::Verbose() << __FUNCTION__ << ": [" << out->mState << "] RUNNING";
+        // Commands are popped without the codec lock, which is only taken to run them.
+        if (!out->mOffloadCommands.pop(cmd)) {
+            Log::Verbose() << __FUNCTION__ << ": Cmd queue empty, SLEEPING";
+            out->mOffloadCommands.wait();
+            Log::Verbose() << __FUNCTION__ << ": RUNNING";
             continue;
         }
 
-        item = list_head(&out->mOffloadCmdList);
-        cmd = node_to_item(item, offload_cmd, node);
-        list_remove(item);
+        Mutex::Locker locker(out->mCodecLock);
 
-        Log::Verbose() << __FUNCTION__ << ": [" << out->mState << "] CMD " << cmd->get();
+        Log::Verbose() << __FUNCTION__ << ": [" << out->mState << "] CMD " << cmd;
 
-        if (cmd->get() == offload_cmd::EXIT) {
-            delete cmd;
+        if (cmd == OffloadCommandQueue::EXIT) {
             Log::Verbose() << __FUNCTION__ << ": [" << out->mState << "] EXITING";
+            out->mCond.signal();
             break;
         }
 
@@ -699,31 +715,23 @@ void *CompressedStreamOut::offloadThreadLoop(void *context)
         out->mCodecLock.unlock();
 
         stream_callback_event_t event;
-        bool sendCallback = out->handleCommand(cmd->get(), event);
+        bool sendCallback = out->handleCommand(cmd, event);
 
         out->mCodecLock.lock();
 
         out->mIsOffloadThreadBlocked = false;
+        out->publishPositionUnsafe();
         out->mCond.signal();
         if (sendCallback) {
             Log::Verbose() << __FUNCTION__ << ": sending callback event" << static_cast<int>(event);
             out->mOffloadCallback(event, NULL, out->mOffloadCookie);
         }
-        delete cmd;
-    }
-
-    out->mCond.signal();
-    while (!list_empty(&out->mOffloadCmdList)) {
-        item = list_head(&out->mOffloadCmdList);
-        list_remove(item);
-        free(node_to_item(item, offload_cmd, node));
     }
     return NULL;
 }
 
 status_t CompressedStreamOut::createOffloadCallbackThread()
 {
-    list_init(&mOffloadCmdList);
     pthread_create(&mOffloadThread, (const pthread_attr_t *)NULL, offloadThreadLoop, this);
     return android::OK;
 }
@@ -734,7 +742,7 @@ status_t CompressedStreamOut::destroyOffloadCallbackThread()
 
     Log::Verbose() << __FUNCTION__;
     stopCompressedOutputUnsafe();
-    sendOffloadCmdUnsafe(offload_cmd::EXIT);
+    sendOffloadCmdUnsafe(OffloadCommandQueue::EXIT);
 
     mCodecLock.unlock();
 
@@ -742,32 +750,38 @@ status_t CompressedStreamOut::destroyOffloadCallbackThread()
     return android::OK;
 }
 
-void CompressedStreamOut::setBufferSize()
+status_t CompressedStreamOut::dump(int fd) const
+{
+    mFragmentPlanner.dump(fd, 2);
+    return mOffloadCommands.dump(fd, 2);
+}
+
+uint32_t CompressedStreamOut::getPlanningBitRate() const
 {
     if (mCodec.avgBitRate >= 12000) {
-        mBufferSize = (gOffloadTransferIntervalInSec * mCodec.avgBitRate) / 8; /* in bytes */
-    } else {
-        // Though we could not take the decision based on exact bit-rate,
-        // select optimal bufferSize based on samplingRate & Channel of the stream
-        if (mCodec.sampleRate <= 8000) {
-            mBufferSize = gOffloadMinAllowedBufferSizeInBytes; // Voice data in Mono/Stereo
-        } else if (mCodec.numChannels == AUDIO_CHANNEL_OUT_MONO) {
-            mBufferSize = 4 * 1024; // Mono music
-        } else if (mCodec.sampleRate <= 32000) {
-            mBufferSize = 16 * 1024; // Stereo low quality music
-        } else if (mCodec.sampleRate <= 48000) {
-            mBufferSize = 32 * 1024; // Stereo high quality music
-        } else {
-            mBufferSize = 64 * 1024; // HiFi stereo music
-        }
-    }
-    if (mBufferSize > gOffloadMaxAllowedBufferSizeInBytes) {
-        mBufferSize = gOffloadMaxAllowedBufferSizeInBytes;
-    }
-    // Make the bufferSize to be of 2^n bytes
-    for (size_t i = 1; (mBufferSize & ~i) != 0; i <<= 1) {
-        mBufferSize &= ~i;
-    }
+        return mCodec.avgBitRate;
+    }
+    // Though we could not take the decision based on exact bit-rate,
+    // select a nominal bit-rate based on samplingRate & Channel of the stream
+    if (mCodec.sampleRate <= 8000) {
+        return 24000; // Voice data in Mono/Stereo
+    } else if (mCodec.numChannels == AUDIO_CHANNEL_OUT_MONO) {
+        return 64000; // Mono music
+    } else if (mCodec.sampleRate <= 32000) {
+        return 96000; // Stereo low quality music
+    } else if (mCodec.sampleRate <= 48000) {
+        return gCodecOffloadDefaultBitrateInBps; // Stereo high quality music
+    }
+    return 256000; // HiFi stereo music
+}
+
+void CompressedStreamOut::setBufferSize()
+{
+    int device = mBackend.getDeviceIndex();
+    uint32_t codecId = (getFormat() == AUDIO_FORMAT_MP3) ? SND_AUDIOCODEC_MP3 : SND_AUDIOCODEC_AAC;
+    mPlan = mFragmentPlanner.plan(mSoundCardNo, device < 0 ? 0 : device, codecId,
+                                  popcount(getChannels()), getPlanningBitRate());
+    mBufferSize = mPlan.fragmentSize;
     Log::Verbose() << __FUNCTION__ << ": bufSize=" << mBufferSize;
 }
 
@@ -20,9 +20,11 @@
 #include <sound/compress_params.h>
 #include <tinycompress/tinycompress.h>
 
+#include "OffloadCommandQueue.hpp"
+#include "OffloadFragmentPlanner.hpp"
+#include "PositionSnapshot.hpp"
 #include <Mutex.hpp>
 #include <ConditionVariable.hpp>
-#include <cutils/list.h>
 
 static const uint32_t CODEC_OFFLOAD_LATENCY = 10;      /* Default latency in mSec  */
 
@@ -57,29 +59,13 @@ private:
             Type mState;
     };
 
-    struct offload_cmd
-    {
-        enum Enum
-        {
-            EXIT,               /* exit compress offload thread loop*/
-            DRAIN,              /* send a full drain request to DSP */
-            PARTIAL_DRAIN,      /* send a partial drain request to DSP */
-            WAIT_FOR_BUFFER     /* wait for buffer released by DSP */
-        };
-        typedef int Command;
-
-        offload_cmd(Command offloadCommand) : mCmd(offloadCommand) {}
-
-        Command get() const { return mCmd; }
-        struct listnode node;
-        // @todo: private member but beware since used in list.h with widespread usage
-        // of offsetof
-        Command mCmd;
-    };
-
 public:
+    /**
+     * @param[in] backend to drive the compress device with, NULL for the kernel compress devices.
+     */
     CompressedStreamOut(Device *parent, audio_io_handle_t handle, uint32_t flagMask,
-                        audio_devices_t devices, const std::string &address);
+                        audio_devices_t devices, const std::string &address,
+                        CompressDeviceBackend *backend = NULL);
 
     virtual ~CompressedStreamOut();
 
@@ -93,7 +79,7 @@ public:
 
     virtual android::status_t standby();
 
-    virtual android::status_t dump(int) const { return android::OK; }
+    virtual android::status_t dump(int fd) const;
 
     virtual android::status_t setParameters(const std::string &keyValuePairs);
 
@@ -129,7 +115,7 @@ private:
      *
      * @return true if callback shall be sent with event and event is set, false otherwise
      */
-    bool handleCommand(offload_cmd::Command cmd, stream_callback_event_t &event);
+    bool handleCommand(OffloadCommandQueue::Command cmd, stream_callback_event_t &event);
 
     /**
      * Set the volume using mixer control retrieved by android property,
@@ -149,14 +135,13 @@ private:
      * directly. So the must is performed by the codec itself. Must be call with lock held.
      *
      * @param muted true if mute request, false if unmute request
-     * @param mixer to be used for mute control
      * @return OK if operation is successfull, false otherwise.
      */
-    android::status_t setMuteUnsafe(bool muted, struct mixer *mixer);
+    android::status_t setMuteUnsafe(bool muted);
 
-    android::status_t mute(struct mixer *mixer) { return setMuteUnsafe(true, mixer); }
+    android::status_t mute() { return setMuteUnsafe(true); }
 
-    android::status_t unmute(struct mixer *mixer) { return setMuteUnsafe(false, mixer); }
+    android::status_t unmute() { return setMuteUnsafe(false); }
 
     /**
      * Check if a given format is supported for HW decoding by the codec.
@@ -169,11 +154,16 @@ private:
 
     /**
      * Goal is to compute an optimal bufferSize that shall be used by
-     * Multimedia framework in transferring the encoded stream to LPE firmware
-     * in duration of OFFLOAD_TRANSFER_INTERVAL defined.
+     * Multimedia framework in transferring the encoded stream to LPE firmware:
+     * one fragment as planned for the first opening of the device.
      */
     void setBufferSize();
 
+    /**
+     * @return bit rate of the stream in bps, a nominal one if the stream does not provide it.
+     */
+    uint32_t getPlanningBitRate() const;
+
     /**
      * Send a command to offload thread.
      *
@@ -181,7 +171,7 @@ private:
      *
      * @return OK is sent is successfull, error code otherwise.
      */
-    android::status_t sendOffloadCmdUnsafe(offload_cmd::Command command);
+    android::status_t sendOffloadCmdUnsafe(OffloadCommandQueue::Command command);
 
     /**
      * Stop the compress output stream, wait that all buffer has been consummed (drain or partial
@@ -216,7 +206,8 @@ private:
     android::status_t createOffloadCallbackThread();
 
     /**
-     * Offload Thread Main loop: it waits commands from the list, and notify if required the caller.
+     * Offload Thread Main loop: it waits commands from the queue, and notifies the caller if
+     * required.
      * @param[in] context
      * @return start_routing exit status
      */
@@ -227,17 +218,39 @@ private:
      */
     void recover();
 
+    /**
+     * Read the position of the DSP and publish it with the state for the position queries.
+     * Must be called with lock held, after each operation on the device or change of state.
+     * The interpolation of the readers is bounded by the audio queued to the DSP.
+     */
+    void publishPositionUnsafe();
+
+    /**
+     * Estimate the frames rendered now from the last position published, without locking.
+     * The frames never go backwards until the DSP is stopped, closed or done with a track.
+     *
+     * @param[out] frames rendered by the DSP, 0 if not started or draining.
+     * @param[out] timestamp monotonic time of the estimation.
+     *
+     * @return OK if the stream is started and the DSP answered the last position query,
+     *         error code otherwise.
+     */
+    android::status_t readPosition(uint64_t &frames, struct timespec &timestamp) const;
+
     audio_comms::utilities::ConditionVariable mCond;
     SstState mState;
     compress *mCompress;
     float mVolume;
     bool mIsVolumeChangeRequestPending;
+    CompressDeviceBackend &mBackend;
     size_t mBufferSize;
     mutable audio_comms::utilities::Mutex mCodecLock;
     bool mIsNonBlocking;
-    audio_comms::utilities::ConditionVariable mOffloadCond;
     pthread_t mOffloadThread;
-    struct listnode mOffloadCmdList;
+    OffloadCommandQueue mOffloadCommands;
+    OffloadFragmentPlanner mFragmentPlanner;
+    OffloadFragmentPlanner::Plan mPlan; /**< Buffering the device is opened with. */
+    PositionSnapshot mPosition; /**< Published with lock held, read without. */
     bool mIsOffloadThreadBlocked;
 
     stream_callback_t mOffloadCallback;
@@ -21,6 +21,7 @@
 #include "CompressedStreamOut.hpp"
 #include <typeconverter/TypeConverter.hpp>
 #include <AudioConversion.hpp>
+#include <AudioTrace.hpp>
 #include <hardware/audio.h>
 #include <Parameters.hpp>
 #include <hardware/audio_effect.h>
@@ -40,7 +41,15 @@ Device::Device()
       mStreamInterface(new AudioRouteManager()),
       mPrimaryOutput(NULL)
 {
-    mStreamInterface->reconsiderRouting(true);
+    if (mTelemetry.init() == android::OK) {
+        mStreamInterface->setTelemetry(&mTelemetry);
+    }
+    StartupProfiler &profiler = mStreamInterface->getStartupProfiler();
+    {
+        StartupProfiler::Phase phase(profiler, "InitialRouting");
+        mStreamInterface->reconsiderRouting(true);
+    }
+    profiler.complete();
 
     Log::Debug() << __FUNCTION__ << ": Route Manager Service successfully started";
 }
@@ -250,6 +259,32 @@ status_t Device::setParameters(const string &keyValuePairs)
 {
     Log::Verbose() << __FUNCTION__ << ": key value pair " << keyValuePairs;
     KeyValuePairs pairs(keyValuePairs);
+    if (pairs.hasKey(Parameters::gKeyFlightRecorderExport)) {
+        // Freeze all the recorders at once, so that the exports relate to the same instant.
+        for (auto &it : mStreams) {
+            AudioFlightRecorder *recorder = it.second->getFlightRecorder();
+            if (recorder != NULL) {
+                recorder->requestExport();
+            }
+        }
+        pairs.remove(Parameters::gKeyFlightRecorderExport);
+    }
+    if (pairs.hasKey(Parameters::gKeyLatencyStatsReset)) {
+        for (auto &it : mStreams) {
+            it.second->resetLatencyStats();
+        }
+        pairs.remove(Parameters::gKeyLatencyStatsReset);
+    }
+    bool traceEnabled;
+    if (pairs.get(Parameters::gKeyAudioTrace, traceEnabled) == android::OK) {
+        AudioTrace::setEnabled(traceEnabled);
+        pairs.remove(Parameters::gKeyAudioTrace);
+    }
+    string tracePath;
+    if (pairs.get(Parameters::gKeyAudioTraceExport, tracePath) == android::OK) {
+        AudioTrace::exportChromeJson(tracePath);
+        pairs.remove(Parameters::gKeyAudioTraceExport);
+    }
     status_t status = mStreamInterface->setParameters(pairs.toString());
     return status;
 }
@@ -481,21 +516,21 @@ status_t Device::releaseAudioPatch(audio_patch_handle_t handle)
 status_t Device::updateParameters(bool updateSourceDevice, bool updateSinkDevice,
                                   audio_patch_handle_t lastPatch, bool synchronous)
 {
-    KeyValuePairs pairs;
+    StreamsParameters parameters;
     // Update now the routing, i.e. the devices in input and/or output
     if (updateSourceDevice) {
         // Source Port update requested: it may impact input streams parameters
-        prepareStreamsParameters(AUDIO_PORT_ROLE_SINK, pairs);
+        prepareStreamsParameters(AUDIO_PORT_ROLE_SINK, parameters);
     }
     if (updateSinkDevice) {
         // Sink Port update requested: it may impact output streams parameters
-        prepareStreamsParameters(AUDIO_PORT_ROLE_SOURCE, pairs, lastPatch);
+        prepareStreamsParameters(AUDIO_PORT_ROLE_SOURCE, parameters, lastPatch);
     }
-    if (pairs.toString().empty()) {
+    if (parameters.isEmpty()) {
         return android::OK;
     }
-    Log::Verbose() << __FUNCTION__ << ": Parameters:" << pairs.toString();
-    return mStreamInterface->setParameters(pairs.toString(), synchronous);
+    Log::Verbose() << __FUNCTION__ << ": Parameters:" << parameters.toString();
+    return mStreamInterface->setParameters(parameters, synchronous);
 }
 
 status_t Device::getAudioPort(struct audio_port & /*port*/) const
@@ -523,7 +558,8 @@ uint32_t Device::selectOutputDevices(uint32_t streamDeviceMask)
     return selectedDeviceMask;
 }
 
-void Device::prepareStreamsParameters(audio_port_role_t streamPortRole, KeyValuePairs &pairs,
+void Device::prepareStreamsParameters(audio_port_role_t streamPortRole,
+                                      StreamsParameters &parameters,
                                       audio_patch_handle_t lastPatch)
 {
     audio_devices_t deviceMask = AUDIO_DEVICE_NONE;
@@ -582,18 +618,20 @@ void Device::prepareStreamsParameters(audio_port_role_t streamPortRole, KeyValue
         }
     }
 
+    Direction::Values direction = getDirectionFromMix(streamPortRole);
     if (streamPortRole == AUDIO_PORT_ROLE_SOURCE) {
         deviceMask = selectOutputDevices(deviceMask);
-        pairs.add(Parameters::gKeyAndroidMode, mode());
+        parameters.set(StreamsParameters::AndroidMode, static_cast<uint32_t>(mode()));
     } else {
-        pairs.add<int>(Parameters::gKeyVoipBandType, getBandFromActiveInput());
-        pairs.add(Parameters::gKeyPreProcRequested, requestedEffectMask);
-    }
-    pairs.add(Parameters::gKeyUseCases[getDirectionFromMix(streamPortRole)], streamsUseCaseMask);
-    pairs.add(Parameters::gKeyDevices[getDirectionFromMix(streamPortRole)],
-              deviceMask | internalDeviceMask);
-    pairs.add(Parameters::gKeyDeviceAddresses[getDirectionFromMix(streamPortRole)], deviceAddress);
-    pairs.add(Parameters::gKeyFlags[getDirectionFromMix(streamPortRole)], streamsFlagMask);
+        parameters.set(StreamsParameters::VoipBandType,
+                       static_cast<uint32_t>(getBandFromActiveInput()));
+        parameters.set(StreamsParameters::PreProcRequested, requestedEffectMask);
+    }
+    parameters.set(StreamsParameters::getUseCasesId(direction), streamsUseCaseMask);
+    parameters.set(StreamsParameters::getDevicesId(direction),
+                   static_cast<uint32_t>(deviceMask | internalDeviceMask));
+    parameters.set(StreamsParameters::getDeviceAddressesId(direction), deviceAddress);
+    parameters.set(StreamsParameters::getFlagsId(direction), streamsFlagMask);
     mPatchCollectionLock.unlock();
 }
 
@@ -612,6 +650,33 @@ CAudioBand::Type Device::getBandFromActiveInput() const
            CAudioBand::ENarrow : CAudioBand::EWide;
 }
 
+uint32_t Device::getEffectsRequestedByActiveInput() const
+{
+    uint32_t requestedEffectMask = 0;
+    for (const auto &it : mStreams) {
+        const Stream *stream = it.second;
+        if (!stream->isOut() && stream->isStarted() && stream->isRoutedByPolicy()) {
+            requestedEffectMask |= stream->getEffectRequested();
+        }
+    }
+    return requestedEffectMask;
+}
+
+status_t Device::updateStreamEffects(const Stream &stream)
+{
+    StreamsParameters parameters;
+    mPatchCollectionLock.lock();
+    parameters.set(StreamsParameters::PreProcRequested, getEffectsRequestedByActiveInput());
+    mPatchCollectionLock.unlock();
+
+    status_t status = mStreamInterface->updateStreamEffects(stream, parameters);
+    if (status != android::INVALID_OPERATION) {
+        return status;
+    }
+    Log::Debug() << __FUNCTION__ << ": route does not implement the effects, reconsider routing";
+    return updateStreamsParametersAsync(stream.getRole());
+}
+
 bool Device::isPrimaryOutput(const Stream &stream) const
 {
     return &stream == mPrimaryOutput;
@@ -18,7 +18,9 @@
 #include "Patch.hpp"
 #include "Port.hpp"
 #include <AudioRouteManager.hpp>
+#include <AudioTelemetry.hpp>
 #include <KeyValuePairs.hpp>
+#include <StreamsParameters.hpp>
 #include <Direction.hpp>
 #include <audio_effects/effect_aec.h>
 #include <audio_utils/echo_reference.h>
@@ -114,6 +116,27 @@ public:
     /** @note Routing Control API used for routing with AUDIO_DEVICE_API_VERSION >= 3.0. */
     virtual android::status_t setAudioPortConfig(const struct audio_port_config &config);
 
+    /** @return profile of the startup phases of the HAL, complete once the Device is created. */
+    const StartupProfiler &getStartupProfiler() const
+    {
+        return mStreamInterface->getStartupProfiler();
+    }
+
+    /** @return statistics of the recoveries from audio subsystem crashes. */
+    RoutingRecovery::Stats getRecoveryStats() const
+    {
+        return mStreamInterface->getRecoveryStats();
+    }
+
+    /** @return statistics of the effect changes and routing passes. */
+    AudioRouteManager::EffectUpdateStats getEffectUpdateStats() const
+    {
+        return mStreamInterface->getEffectUpdateStats();
+    }
+
+    /** @return telemetry page of the HAL, in which the streams publish their counters. */
+    AudioTelemetry &getTelemetry() { return mTelemetry; }
+
 protected:
     /**
      * Update the streams parameters upon start / stop / change of devices events on streams.
@@ -141,6 +164,19 @@ protected:
         return updateStreamsParameters(streamPortRole, false);
     }
 
+    /**
+     * Apply the effects requested by a running input stream.
+     * If the route of the stream remains its matching route, only the effect criteria are
+     * updated, in place: the routing is left untouched so that the capture is not muted.
+     * Otherwise, the routing is reconsidered asynchronously.
+     * Must not be called with a lock of the stream held, as it takes the routing lock.
+     *
+     * @param[in] stream which requested effects changed.
+     *
+     * @return OK if successfully updated the effects, error code otherwise.
+     */
+    android::status_t updateStreamEffects(const Stream &stream);
+
     /**
      * Returns the stream interface of the route manager.
      * As a AudioHAL creator must ensure HAL is started to performs any action on AudioHAL,
@@ -226,9 +262,10 @@ private:
      * Prepare the streams parameters to be sent to the parameter framework for routing.
      *
      * @param[in] streamPortRole direction of stream from which the events is issued.
-     * @param[out] pairs: parameters as collection of {key,value} pairs.
+     * @param[out] parameters: typed streams parameters, indexed by parameter identifier.
      */
-    void prepareStreamsParameters(audio_port_role_t streamPortRole, KeyValuePairs &pairs,
+    void prepareStreamsParameters(audio_port_role_t streamPortRole,
+                                  StreamsParameters &parameters,
                                   audio_patch_handle_t handle = AUDIO_PATCH_HANDLE_NONE);
 
     /**
@@ -267,6 +304,13 @@ private:
      */
     inline CAudioBand::Type getBandFromActiveInput() const;
 
+    /**
+     * Only one input stream may be active at one time by design of android audio policy.
+     *
+     * @return mask of the effects requested by the active input stream.
+     */
+    uint32_t getEffectsRequestedByActiveInput() const;
+
     /**
      * @return true if the collection of stream managed by the HW Device has a stream tracked by the
      *         given stream handle, false otherwise.
@@ -367,6 +411,9 @@ private:
 
     AudioRouteManager *mStreamInterface; /**< Route Manager Stream Interface pointer. */
 
+    /** Counters of the streams and of the routing, shared with the monitoring tools. */
+    AudioTelemetry mTelemetry;
+
     audio_mode_t mMode; /**< Android telephony mode. */
 
     StreamCollection mStreams; /**< Collection of opened streams. */
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "EffectChain"
+
+#include "EffectChain.hpp"
+#include <utilities/Log.hpp>
+#include <audio_effects/effect_aec.h>
+#include <audio_effects/effect_agc.h>
+#include <audio_effects/effect_ns.h>
+#include <algorithm>
+#include <cerrno>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+
+using android::status_t;
+using audio_comms::utilities::Log;
+using std::memory_order_relaxed;
+using std::min;
+
+namespace intel_audio
+{
+
+static const char *const gStageNames[] = {
+    "AEC", "NS", "AGC", "other"
+};
+
+EffectChain::EffectChain()
+    : mCapacityInFrames(0), mFrameSize(0)
+{
+    mBuffers[0] = mBuffers[1] = NULL;
+}
+
+EffectChain::~EffectChain()
+{
+    free(mBuffers[0]);
+    free(mBuffers[1]);
+}
+
+status_t EffectChain::configure(size_t frames, size_t frameSize)
+{
+    if (frames <= mCapacityInFrames && frameSize == mFrameSize) {
+        return android::OK;
+    }
+    free(mBuffers[0]);
+    free(mBuffers[1]);
+    mBuffers[0] = mBuffers[1] = NULL;
+    mCapacityInFrames = 0;
+
+    for (size_t i = 0; i < 2; i++) {
+        if (posix_memalign(&mBuffers[i], gAlignment, frames * frameSize) != 0) {
+            Log::Error() << __FUNCTION__ << ": cannot allocate " << frames << " frames";
+            free(mBuffers[0]);
+            mBuffers[0] = mBuffers[1] = NULL;
+            return android::NO_MEMORY;
+        }
+    }
+    mCapacityInFrames = frames;
+    mFrameSize = frameSize;
+    return android::OK;
+}
+
+EffectChain::Stage EffectChain::getStage(effect_handle_t effect)
+{
+    effect_descriptor_t desc;
+    if ((*effect)->get_descriptor(effect, &desc) != 0) {
+        Log::Error() << __FUNCTION__ << ": could not get effect descriptor";
+        return Other;
+    }
+    if (memcmp(&desc.type, FX_IID_AEC, sizeof(effect_uuid_t)) == 0) {
+        return Aec;
+    }
+    if (memcmp(&desc.type, FX_IID_NS, sizeof(effect_uuid_t)) == 0) {
+        return Ns;
+    }
+    if (memcmp(&desc.type, FX_IID_AGC, sizeof(effect_uuid_t)) == 0) {
+        return Agc;
+    }
+    return Other;
+}
+
+status_t EffectChain::add(effect_handle_t effect, bool inPlace)
+{
+    if (effect == NULL || *effect == NULL) {
+        return android::BAD_VALUE;
+    }
+    std::list<Effect>::iterator it;
+    for (it = mEffects.begin(); it != mEffects.end(); ++it) {
+        if (it->handle == effect) {
+            return android::ALREADY_EXISTS;
+        }
+    }
+    Stage stage = getStage(effect);
+    for (it = mEffects.begin(); it != mEffects.end() && it->stage <= stage; ++it) {
+    }
+    mEffects.emplace(it, effect, stage, inPlace);
+    Log::Debug() << __FUNCTION__ << ": " << gStageNames[stage] << " effect " << effect
+                 << " added, " << mEffects.size() << " effect(s)";
+    return android::OK;
+}
+
+status_t EffectChain::remove(effect_handle_t effect)
+{
+    for (std::list<Effect>::iterator it = mEffects.begin(); it != mEffects.end(); ++it) {
+        if (it->handle == effect) {
+            mEffects.erase(it);
+            return android::OK;
+        }
+    }
+    return android::BAD_VALUE;
+}
+
+uint64_t EffectChain::getThreadCpuTimeNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+int EffectChain::process(audio_buffer_t &in, audio_buffer_t &out)
+{
+    if (mCapacityInFrames == 0) {
+        return android::NO_INIT;
+    }
+    size_t frames = min(in.frameCount, mCapacityInFrames);
+    memcpy(mBuffers[0], in.raw, frames * mFrameSize);
+    in.frameCount = frames;
+    size_t current = 0;
+
+    for (std::list<Effect>::iterator it = mEffects.begin(); it != mEffects.end() && frames != 0;
+         ++it) {
+        Effect &effect = *it;
+        size_t target = effect.inPlace ? current : 1 - current;
+        audio_buffer_t effectIn;
+        effectIn.frameCount = frames;
+        effectIn.raw = mBuffers[current];
+        audio_buffer_t effectOut;
+        effectOut.frameCount = frames;
+        effectOut.raw = mBuffers[target];
+
+        uint64_t startNs = getThreadCpuTimeNs();
+        int ret = (*effect.handle)->process(effect.handle, &effectIn, &effectOut);
+        uint64_t cpuTimeNs = getThreadCpuTimeNs() - startNs;
+
+        effect.calls.fetch_add(1, memory_order_relaxed);
+        effect.cpuTimeNs.fetch_add(cpuTimeNs, memory_order_relaxed);
+        if (cpuTimeNs > effect.maxCpuTimeNs.load(memory_order_relaxed)) {
+            effect.maxCpuTimeNs.store(cpuTimeNs, memory_order_relaxed);
+        }
+        effect.bypassed.store(ret == -ENODATA, memory_order_relaxed);
+        if (ret == -ENODATA) {
+            effect.bypassedCalls.fetch_add(1, memory_order_relaxed);
+            continue;
+        }
+        if (ret != 0) {
+            Log::Error() << __FUNCTION__ << ": " << gStageNames[effect.stage] << " effect "
+                         << effect.handle << " failed, error " << ret;
+            return ret;
+        }
+        current = target;
+        // The effect may keep frames to process them along with the next ones
+        frames = min(frames, effectOut.frameCount);
+    }
+    frames = min(frames, out.frameCount);
+    memcpy(out.raw, mBuffers[current], frames * mFrameSize);
+    out.frameCount = frames;
+    return 0;
+}
+
+status_t EffectChain::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    std::string result;
+
+    snprintf(buffer, SIZE, "%*sEffect chain: %zu effect(s), %zu frames buffers\n", spaces, "",
+             mEffects.size(), mCapacityInFrames);
+    result.append(buffer);
+    for (std::list<Effect>::const_iterator it = mEffects.begin(); it != mEffects.end(); ++it) {
+        uint64_t calls = it->calls.load(memory_order_relaxed);
+        uint64_t cpuTimeNs = it->cpuTimeNs.load(memory_order_relaxed);
+        snprintf(buffer, SIZE, "%*s%s %p%s: %s, %llu calls (%llu bypassed), cpu %llu us average,"
+                 " %llu us max\n", spaces + 4, "", gStageNames[it->stage], it->handle,
+                 it->inPlace ? "" : " (not in place)",
+                 it->bypassed.load(memory_order_relaxed) ? "bypassed" : "active",
+                 static_cast<unsigned long long>(calls),
+                 static_cast<unsigned long long>(it->bypassedCalls.load(memory_order_relaxed)),
+                 static_cast<unsigned long long>(calls ? cpuTimeNs / calls / 1000 : 0),
+                 static_cast<unsigned long long>(it->maxCpuTimeNs.load(memory_order_relaxed) /
+                                                 1000));
+        result.append(buffer);
+    }
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <hardware/audio_effect.h>
+#include <utils/Errors.h>
+#include <atomic>
+#include <list>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Runs the software effects of a capture stream one after the other, within two buffers
+ * allocated once: an effect working in place processes the current buffer, any other one writes
+ * into the other buffer which then becomes the current one. The effects are ordered as the
+ * acoustic processing expects, echo cancellation first, then noise suppression, then automatic
+ * gain control, then any other effect in the order they were added.
+ *
+ * An effect returning -ENODATA is disabled: it is bypassed, the data is left as it was.
+ *
+ * Not thread safe, except the statistics read by dump.
+ */
+class EffectChain : private audio_comms::utilities::NonCopyable
+{
+public:
+    enum Stage
+    {
+        Aec,
+        Ns,
+        Agc,
+        Other
+    };
+
+    EffectChain();
+    ~EffectChain();
+
+    /**
+     * Size the buffers of the chain. The only place allocating memory.
+     *
+     * @param[in] frames maximum number of frames processed at once.
+     * @param[in] frameSize in bytes.
+     *
+     * @return OK if allocated, NO_MEMORY otherwise.
+     */
+    android::status_t configure(size_t frames, size_t frameSize);
+
+    /**
+     * Append an effect at the position of its stage.
+     *
+     * @param[in] effect to add.
+     * @param[in] inPlace true if the effect may process its input buffer in place.
+     *
+     * @return OK if added, ALREADY_EXISTS if already in the chain, BAD_VALUE if invalid.
+     */
+    android::status_t add(effect_handle_t effect, bool inPlace = true);
+
+    /**
+     * @param[in] effect to remove.
+     *
+     * @return OK if removed, BAD_VALUE if not in the chain.
+     */
+    android::status_t remove(effect_handle_t effect);
+
+    bool empty() const { return mEffects.empty(); }
+
+    /**
+     * Process frames through all the effects of the chain.
+     *
+     * @param[in,out] in frames to process, frame count updated with the frames consumed.
+     * @param[in,out] out buffer to fill, frame count updated with the frames produced.
+     *
+     * @return 0 if processed, error code returned by the failing effect otherwise.
+     */
+    int process(audio_buffer_t &in, audio_buffer_t &out);
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+    /**
+     * @param[in] effect to classify.
+     *
+     * @return stage of the effect, according to its type.
+     */
+    static Stage getStage(effect_handle_t effect);
+
+private:
+    struct Effect
+    {
+        Effect(effect_handle_t handle, Stage stage, bool inPlace)
+            : handle(handle), stage(stage), inPlace(inPlace), bypassed(false), calls(0),
+              bypassedCalls(0), cpuTimeNs(0), maxCpuTimeNs(0) {}
+
+        effect_handle_t handle;
+        Stage stage;
+        bool inPlace;
+
+        /** Statistics, relaxed: only meant for dump. */
+        std::atomic<bool> bypassed; /**< State seen on the last call. */
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> bypassedCalls;
+        std::atomic<uint64_t> cpuTimeNs; /**< Spent in process by the calling thread. */
+        std::atomic<uint64_t> maxCpuTimeNs;
+    };
+
+    static uint64_t getThreadCpuTimeNs();
+
+    /** Kept as a list, so that effects are never moved and are updated in place. */
+    std::list<Effect> mEffects;
+    void *mBuffers[2];
+    size_t mCapacityInFrames;
+    size_t mFrameSize;
+
+    static const size_t gAlignment = 32; /**< In bytes, for vector instructions. */
+};
+
+} // namespace intel_audio
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+using std::memory_order_relaxed;
+
+namespace intel_audio
+{
+
+/** Buckets per power of 2, as the 2 bits following the most significant one. */
+static const uint32_t gSubBucketBits = 2;
+static const uint32_t gSubBuckets = 1 << gSubBucketBits;
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+size_t LatencyHistogram::getBucket(uint64_t durationUs)
+{
+    if (durationUs < gSubBuckets) {
+        return durationUs;
+    }
+    uint32_t msb = 63 - __builtin_clzll(durationUs);
+    size_t bucket = (msb - gSubBucketBits + 1) * gSubBuckets +
+                    ((durationUs >> (msb - gSubBucketBits)) & (gSubBuckets - 1));
+    return std::min(bucket, mNbBuckets - 1);
+}
+
+uint64_t LatencyHistogram::getBucketLowerUs(size_t bucket)
+{
+    if (bucket < gSubBuckets) {
+        return bucket;
+    }
+    uint32_t msb = bucket / gSubBuckets + gSubBucketBits - 1;
+    return static_cast<uint64_t>(gSubBuckets + bucket % gSubBuckets) << (msb - gSubBucketBits);
+}
+
+void LatencyHistogram::record(uint64_t durationNs)
+{
+    uint64_t durationUs = durationNs / 1000;
+    mBuckets[getBucket(durationUs)].fetch_add(1, memory_order_relaxed);
+    mCount.fetch_add(1, memory_order_relaxed);
+    mSumUs.fetch_add(durationUs, memory_order_relaxed);
+    // Single writer in practice: the loop only runs again against a concurrent reset.
+    uint64_t maxUs = mMaxUs.load(memory_order_relaxed);
+    while (durationUs > maxUs &&
+           !mMaxUs.compare_exchange_weak(maxUs, durationUs, memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : mBuckets) {
+        bucket.store(0, memory_order_relaxed);
+    }
+    mCount.store(0, memory_order_relaxed);
+    mSumUs.store(0, memory_order_relaxed);
+    mMaxUs.store(0, memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getPercentileUs(double percent) const
+{
+    uint64_t counts[mNbBuckets];
+    uint64_t total = 0;
+    for (size_t i = 0; i < mNbBuckets; i++) {
+        counts[i] = mBuckets[i].load(memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(ceil(total * std::min(percent, 100.) / 100), 1);
+    uint64_t cumulated = 0;
+    size_t bucket = 0;
+    for (; bucket < mNbBuckets - 1; bucket++) {
+        cumulated += counts[bucket];
+        if (cumulated >= rank) {
+            break;
+        }
+    }
+    // The max is exact, and tighter than the bound of the last bucket.
+    return std::min(getBucketLowerUs(bucket + 1), getMaxUs());
+}
+
+android::status_t LatencyHistogram::dump(const int fd, int spaces, const char *name) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    uint64_t count = getCount();
+
+    snprintf(buffer, SIZE, "%*s%s: %llu sample(s), mean %llu us, p50 %llu us, p90 %llu us,"
+             " p99 %llu us, p99.9 %llu us, max %llu us\n", spaces, "", name,
+             static_cast<unsigned long long>(count),
+             static_cast<unsigned long long>(
+                 count ? mSumUs.load(memory_order_relaxed) / count : 0),
+             static_cast<unsigned long long>(getPercentileUs(50)),
+             static_cast<unsigned long long>(getPercentileUs(90)),
+             static_cast<unsigned long long>(getPercentileUs(99)),
+             static_cast<unsigned long long>(getPercentileUs(99.9)),
+             static_cast<unsigned long long>(getMaxUs()));
+    std::string result(buffer);
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <utils/Errors.h>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Log-scale histogram of durations, in microseconds from 1 us to about 30 s, with 4 buckets per
+ * power of 2, i.e. percentiles are reported within 25%.
+ * Lock-free: updated with relaxed atomics from the audio thread, read by dump from any thread.
+ * A read concurrent with an update may be off by the samples being recorded.
+ */
+class LatencyHistogram : private audio_comms::utilities::NonCopyable
+{
+public:
+    LatencyHistogram();
+
+    /**
+     * Records a duration.
+     *
+     * @param[in] durationNs duration in nanoseconds, clipped to the range of the histogram.
+     */
+    void record(uint64_t durationNs);
+
+    /** Clears the recorded durations. Durations recorded concurrently may be kept or lost. */
+    void reset();
+
+    /** @return number of durations recorded. */
+    uint64_t getCount() const { return mCount.load(std::memory_order_relaxed); }
+
+    /** @return longest duration recorded, in microseconds. */
+    uint64_t getMaxUs() const { return mMaxUs.load(std::memory_order_relaxed); }
+
+    /**
+     * Computes a percentile of the recorded durations.
+     *
+     * @param[in] percent of durations below the returned one, from 0 to 100.
+     *
+     * @return upper bound of the bucket of the percentile, in microseconds, 0 if empty.
+     */
+    uint64_t getPercentileUs(double percent) const;
+
+    /**
+     * Prints the count, mean, percentiles and max of the durations on a single line.
+     *
+     * @param[in] fd file descriptor to print to.
+     * @param[in] spaces indentation of the line.
+     * @param[in] name of the durations.
+     */
+    android::status_t dump(const int fd, int spaces, const char *name) const;
+
+    static const size_t mNbBuckets = 96;
+
+    /** @return index of the bucket of a duration in microseconds. */
+    static size_t getBucket(uint64_t durationUs);
+
+    /** @return smallest duration in microseconds of a bucket. */
+    static uint64_t getBucketLowerUs(size_t bucket);
+
+private:
+    std::atomic<uint32_t> mBuckets[mNbBuckets];
+    std::atomic<uint64_t> mCount;
+    std::atomic<uint64_t> mSumUs;
+    std::atomic<uint64_t> mMaxUs;
+};
+
+} // namespace intel_audio
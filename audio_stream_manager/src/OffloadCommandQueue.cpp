@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OffloadCommandQueue"
+
+#include "OffloadCommandQueue.hpp"
+#include <utilities/Log.hpp>
+#include <cerrno>
+#include <stdio.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+using android::status_t;
+using audio_comms::utilities::Log;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+
+namespace intel_audio
+{
+
+static const uint32_t gPollingPeriodUs = 1000;
+
+static_assert((OffloadCommandQueue::gCapacity & (OffloadCommandQueue::gCapacity - 1)) == 0,
+              "capacity of the offload command ring must be a power of 2");
+
+OffloadCommandQueue::OffloadCommandQueue()
+    : mHead(0), mTail(0), mEventFd(eventfd(0, EFD_CLOEXEC)),
+      mMaxDepth(0), mPushed(0), mCoalesced(0), mOverflows(0),
+      mLastLatencyUs(0), mMaxLatencyUs(0), mTotalLatencyUs(0), mPopped(0)
+{
+    if (mEventFd < 0) {
+        Log::Error() << __FUNCTION__ << ": eventfd failed, error " << errno;
+    }
+}
+
+OffloadCommandQueue::~OffloadCommandQueue()
+{
+    if (mEventFd >= 0) {
+        close(mEventFd);
+    }
+}
+
+uint64_t OffloadCommandQueue::getMonotonicUs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+status_t OffloadCommandQueue::push(Command command)
+{
+    uint32_t tail = mTail.load(memory_order_relaxed);
+    uint32_t head = mHead.load(memory_order_acquire);
+
+    if (command == WAIT_FOR_BUFFER) {
+        // Entries between head and tail are not overwritten until popped, reading them is safe.
+        // A wait popped meanwhile runs after the write that triggered this one anyway.
+        for (uint32_t index = head; index != tail; index++) {
+            if (mRing[index & (gCapacity - 1)].command == WAIT_FOR_BUFFER) {
+                mCoalesced.fetch_add(1, memory_order_relaxed);
+                return android::OK;
+            }
+        }
+    }
+    if (tail - head == gCapacity) {
+        mOverflows.fetch_add(1, memory_order_relaxed);
+        Log::Error() << __FUNCTION__ << ": ring full, command " << command << " dropped";
+        return android::NO_MEMORY;
+    }
+    Entry &entry = mRing[tail & (gCapacity - 1)];
+    entry.command = command;
+    entry.queuedUs = getMonotonicUs();
+    mTail.store(tail + 1, memory_order_release);
+
+    uint32_t depth = tail + 1 - head;
+    if (depth > mMaxDepth.load(memory_order_relaxed)) {
+        mMaxDepth.store(depth, memory_order_relaxed);
+    }
+    mPushed.fetch_add(1, memory_order_relaxed);
+
+    uint64_t wake = 1;
+    if (write(mEventFd, &wake, sizeof(wake)) != sizeof(wake)) {
+        Log::Error() << __FUNCTION__ << ": cannot wake offload thread up, error " << errno;
+    }
+    return android::OK;
+}
+
+bool OffloadCommandQueue::pop(Command &command)
+{
+    uint32_t head = mHead.load(memory_order_relaxed);
+    if (head == mTail.load(memory_order_acquire)) {
+        return false;
+    }
+    const Entry &entry = mRing[head & (gCapacity - 1)];
+    command = entry.command;
+    uint64_t latencyUs = getMonotonicUs() - entry.queuedUs;
+    mHead.store(head + 1, memory_order_release);
+
+    mLastLatencyUs.store(latencyUs, memory_order_relaxed);
+    if (latencyUs > mMaxLatencyUs.load(memory_order_relaxed)) {
+        mMaxLatencyUs.store(latencyUs, memory_order_relaxed);
+    }
+    mTotalLatencyUs.fetch_add(latencyUs, memory_order_relaxed);
+    mPopped.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+void OffloadCommandQueue::wait()
+{
+    if (mEventFd < 0) {
+        // No way to be woken up, poll
+        usleep(gPollingPeriodUs);
+        return;
+    }
+    uint64_t pushes;
+    // A push racing with the emptiness check of the consumer leaves the counter set.
+    while (read(mEventFd, &pushes, sizeof(pushes)) < 0 && errno == EINTR) {
+    }
+}
+
+OffloadCommandQueue::Stats OffloadCommandQueue::getStats() const
+{
+    Stats stats;
+    stats.depth = mTail.load(memory_order_acquire) - mHead.load(memory_order_acquire);
+    stats.maxDepth = mMaxDepth.load(memory_order_relaxed);
+    stats.pushed = mPushed.load(memory_order_relaxed);
+    stats.coalesced = mCoalesced.load(memory_order_relaxed);
+    stats.overflows = mOverflows.load(memory_order_relaxed);
+    stats.lastLatencyUs = mLastLatencyUs.load(memory_order_relaxed);
+    stats.maxLatencyUs = mMaxLatencyUs.load(memory_order_relaxed);
+    stats.totalLatencyUs = mTotalLatencyUs.load(memory_order_relaxed);
+    stats.popped = mPopped.load(memory_order_relaxed);
+    return stats;
+}
+
+status_t OffloadCommandQueue::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    std::string result;
+    Stats stats = getStats();
+
+    snprintf(buffer, SIZE, "%*sOffload commands: depth %u (max %u), pushed %u, coalesced %u,"
+             " overflows %u\n", spaces, "", stats.depth, stats.maxDepth, stats.pushed,
+             stats.coalesced, stats.overflows);
+    result.append(buffer);
+    snprintf(buffer, SIZE, "%*squeued latency: last %llu us, max %llu us, average %llu us\n",
+             spaces + 4, "", static_cast<unsigned long long>(stats.lastLatencyUs),
+             static_cast<unsigned long long>(stats.maxLatencyUs),
+             static_cast<unsigned long long>(stats.popped ?
+                                             stats.totalLatencyUs / stats.popped : 0));
+    result.append(buffer);
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
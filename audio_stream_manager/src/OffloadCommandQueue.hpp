@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <utils/Errors.h>
+#include <atomic>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Fixed capacity ring of the commands sent to the offload thread of a compressed stream.
+ * Single producer (the stream, with its lock held), single consumer (the offload thread): no
+ * allocation nor lock on either side. The consumer sleeps on an eventfd while the ring is empty.
+ */
+class OffloadCommandQueue : private audio_comms::utilities::NonCopyable
+{
+public:
+    enum Enum
+    {
+        EXIT,               /* exit compress offload thread loop*/
+        DRAIN,              /* send a full drain request to DSP */
+        PARTIAL_DRAIN,      /* send a partial drain request to DSP */
+        WAIT_FOR_BUFFER     /* wait for buffer released by DSP */
+    };
+    typedef int Command;
+
+    struct Stats
+    {
+        uint32_t depth; /**< Commands queued, not yet popped. */
+        uint32_t maxDepth;
+        uint32_t pushed;
+        uint32_t coalesced; /**< Commands dropped as a same command was still queued. */
+        uint32_t overflows; /**< Commands rejected as the ring was full. */
+        uint64_t lastLatencyUs; /**< Time spent queued by the last command popped. */
+        uint64_t maxLatencyUs;
+        uint64_t totalLatencyUs; /**< Sum of the time spent queued by the commands popped. */
+        uint32_t popped;
+    };
+
+    OffloadCommandQueue();
+    ~OffloadCommandQueue();
+
+    /**
+     * Queue a command and wake the consumer up. A WAIT_FOR_BUFFER command is coalesced with the
+     * one still queued if any, as a single wake up of the writer is expected.
+     *
+     * @param[in] command to queue.
+     *
+     * @return OK if queued or coalesced, NO_MEMORY if the ring is full.
+     */
+    android::status_t push(Command command);
+
+    /**
+     * Pop the oldest command, if any.
+     *
+     * @param[out] command popped.
+     *
+     * @return true if a command was popped, false if the ring is empty.
+     */
+    bool pop(Command &command);
+
+    /** Block the consumer until a command is pushed. Returns immediately if one is pending. */
+    void wait();
+
+    Stats getStats() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+    static const uint32_t gCapacity = 16; /**< Must be a power of 2. */
+
+private:
+    struct Entry
+    {
+        Command command;
+        uint64_t queuedUs; /**< Monotonic time the command was pushed at. */
+    };
+
+    static uint64_t getMonotonicUs();
+
+    Entry mRing[gCapacity];
+    std::atomic<uint32_t> mHead; /**< Next entry to pop, written by the consumer only. */
+    std::atomic<uint32_t> mTail; /**< Next entry to push, written by the producer only. */
+    int mEventFd; /**< Counts the pushes not yet waited by the consumer. */
+
+    /** Counters, relaxed: only meant for dump. */
+    std::atomic<uint32_t> mMaxDepth;
+    std::atomic<uint32_t> mPushed;
+    std::atomic<uint32_t> mCoalesced;
+    std::atomic<uint32_t> mOverflows;
+    std::atomic<uint64_t> mLastLatencyUs;
+    std::atomic<uint64_t> mMaxLatencyUs;
+    std::atomic<uint64_t> mTotalLatencyUs;
+    std::atomic<uint32_t> mPopped;
+};
+
+} // namespace intel_audio
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OffloadFragmentPlanner"
+
+#include "OffloadFragmentPlanner.hpp"
+#include <utilities/Log.hpp>
+#include <sound/compress_offload.h>
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+using android::status_t;
+using audio_comms::utilities::Log;
+using audio_comms::utilities::Mutex;
+using std::max;
+using std::min;
+
+namespace intel_audio
+{
+
+/** Limits used when the driver cannot be queried, as the HAL used before asking the driver. */
+static const CompressCaps gDefaultCaps = {
+    2 * 1024, 128 * 1024, 2, 8
+};
+static const uint32_t gMinFragments = 2; /**< Double buffering at least. */
+static const uint32_t gDefaultBaseIntervalMs = 8000;
+static const uint32_t gDefaultMaxIntervalMs = 32000;
+static const uint32_t gAacMaxFrameSizePerChannel = 768; /**< 6144 bits per channel. */
+static const uint64_t gWakeupRateWindowUs = 60 * 1000000ULL;
+
+/** @return largest power of 2 not above value, value being not null. */
+static uint32_t floorPowerOf2(uint32_t value)
+{
+    uint32_t power = 1;
+    while (value >>= 1) {
+        power <<= 1;
+    }
+    return power;
+}
+
+OffloadFragmentPlanner::OffloadFragmentPlanner(CompressDeviceBackend *backend)
+    : mBackend(backend != NULL ? backend : &CompressDeviceBackend::getKernelBackend()),
+      mBaseIntervalMs(0), mMaxIntervalMs(0), mLevel(0), mMaxLevel(0), mSteadyWakeups(0),
+      mStats(), mLastPlan(), mWindowStartUs(0), mWindowWakeups(0)
+{
+    setWakeupIntervals(gDefaultBaseIntervalMs, gDefaultMaxIntervalMs);
+}
+
+void OffloadFragmentPlanner::setWakeupIntervals(uint32_t baseMs, uint32_t maxMs)
+{
+    Mutex::Locker locker(mLock);
+    mBaseIntervalMs = max(baseMs, 1u);
+    mMaxIntervalMs = max(maxMs, mBaseIntervalMs);
+    mMaxLevel = 0;
+    while ((static_cast<uint64_t>(mBaseIntervalMs) << mMaxLevel) < mMaxIntervalMs) {
+        mMaxLevel++;
+    }
+    mLevel = 0;
+    mSteadyWakeups = 0;
+}
+
+uint32_t OffloadFragmentPlanner::getIntervalMsUnsafe() const
+{
+    return static_cast<uint32_t>(min(static_cast<uint64_t>(mBaseIntervalMs) << mLevel,
+                                     static_cast<uint64_t>(mMaxIntervalMs)));
+}
+
+OffloadFragmentPlanner::Plan OffloadFragmentPlanner::plan(uint32_t card, uint32_t device,
+                                                          uint32_t codecId, uint32_t channels,
+                                                          uint32_t bitRate)
+{
+    CompressCaps caps;
+    if (!mBackend->getCaps(card, device, caps)) {
+        caps = gDefaultCaps;
+    }
+    caps.minFragmentSize = max(caps.minFragmentSize, gDefaultCaps.minFragmentSize);
+    if (caps.maxFragmentSize < caps.minFragmentSize) {
+        caps.maxFragmentSize = caps.minFragmentSize;
+    }
+    caps.minFragments = max(caps.minFragments, gMinFragments);
+    if (caps.maxFragments < caps.minFragments) {
+        caps.maxFragments = caps.minFragments;
+    }
+    // A fragment shall hold a whole frame of the codec at least
+    uint32_t minFragmentSize = caps.minFragmentSize;
+    if (codecId == SND_AUDIOCODEC_AAC) {
+        minFragmentSize = max(minFragmentSize, gAacMaxFrameSizePerChannel * max(channels, 1u));
+    }
+    minFragmentSize = min(minFragmentSize, caps.maxFragmentSize);
+    bitRate = max(bitRate, 8u);
+
+    Mutex::Locker locker(mLock);
+    uint32_t intervalMs = getIntervalMsUnsafe();
+    uint64_t intervalBytes = static_cast<uint64_t>(bitRate) / 8 * intervalMs / 1000;
+
+    Plan plan;
+    plan.fragmentSize = floorPowerOf2(static_cast<uint32_t>(
+                                          min<uint64_t>(max<uint64_t>(intervalBytes, 1),
+                                                        caps.maxFragmentSize)));
+    plan.fragmentSize = max(plan.fragmentSize, minFragmentSize);
+    // Room for the interval plus a fragment, in more fragments if their size is capped.
+    uint64_t fragments = intervalBytes / plan.fragmentSize + 1;
+    plan.fragments = static_cast<uint32_t>(min<uint64_t>(max<uint64_t>(fragments,
+                                                                       caps.minFragments),
+                                                         caps.maxFragments));
+    plan.wakeupIntervalMs =
+        static_cast<uint32_t>(static_cast<uint64_t>(plan.fragmentSize) * 8 * 1000 / bitRate);
+    mLastPlan = plan;
+
+    Log::Verbose() << __FUNCTION__ << ": level " << mLevel << ", " << plan.fragments << " x "
+                   << plan.fragmentSize << " bytes, wakeup every " << plan.wakeupIntervalMs
+                   << " ms";
+    return plan;
+}
+
+void OffloadFragmentPlanner::onWakeup(uint64_t nowUs)
+{
+    Mutex::Locker locker(mLock);
+    mStats.wakeups++;
+
+    if (mWindowStartUs == 0) {
+        mWindowStartUs = nowUs;
+        mWindowWakeups = 0;
+    } else {
+        mWindowWakeups++;
+        uint64_t elapsedUs = nowUs - mWindowStartUs;
+        if (elapsedUs >= gWakeupRateWindowUs) {
+            mStats.wakeupsPerMinute =
+                static_cast<uint32_t>(mWindowWakeups * gWakeupRateWindowUs / elapsedUs);
+            mWindowStartUs = nowUs;
+            mWindowWakeups = 0;
+        }
+    }
+    if (++mSteadyWakeups >= gSteadyStateWakeups && mLevel < mMaxLevel) {
+        mLevel++;
+        mStats.promotions++;
+        mSteadyWakeups = 0;
+        Log::Debug() << __FUNCTION__ << ": steady playback, interval grows to "
+                     << getIntervalMsUnsafe() << " ms on next start";
+    }
+}
+
+void OffloadFragmentPlanner::onInterrupted()
+{
+    Mutex::Locker locker(mLock);
+    mSteadyWakeups = 0;
+    mWindowStartUs = 0;
+    mWindowWakeups = 0;
+}
+
+void OffloadFragmentPlanner::onUnderrun()
+{
+    Mutex::Locker locker(mLock);
+    mStats.underruns++;
+    if (mLevel != 0) {
+        Log::Info() << __FUNCTION__ << ": back to an interval of " << mBaseIntervalMs << " ms";
+    }
+    mLevel = 0;
+    mSteadyWakeups = 0;
+}
+
+OffloadFragmentPlanner::Stats OffloadFragmentPlanner::getStats() const
+{
+    Mutex::Locker locker(mLock);
+    Stats stats = mStats;
+    stats.level = mLevel;
+    stats.maxLevel = mMaxLevel;
+    return stats;
+}
+
+status_t OffloadFragmentPlanner::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    std::string result;
+    Stats stats = getStats();
+
+    Mutex::Locker locker(mLock);
+    snprintf(buffer, SIZE, "%*sOffload fragments: %u x %u bytes, wakeup every %u ms,"
+             " level %u/%u\n", spaces, "", mLastPlan.fragments, mLastPlan.fragmentSize,
+             mLastPlan.wakeupIntervalMs, stats.level, stats.maxLevel);
+    result.append(buffer);
+    snprintf(buffer, SIZE, "%*swakeups: %u per minute, %u total, %u promotions, %u underruns\n",
+             spaces + 4, "", stats.wakeupsPerMinute, stats.wakeups, stats.promotions,
+             stats.underruns);
+    result.append(buffer);
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
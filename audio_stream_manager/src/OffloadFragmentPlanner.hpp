@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "CompressDeviceBackend.hpp"
+#include <AudioNonCopyable.hpp>
+#include <Mutex.hpp>
+#include <utils/Errors.h>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Chooses the fragment size and count a compressed offload stream opens its device with.
+ *
+ * The DSP wakes the AP up each time a fragment has been consumed, so the fragment size sets the
+ * wakeup interval: it is computed from the bit rate of the stream to last the target interval,
+ * within the limits of the driver and of the codec frames. Once playback went steady for a while,
+ * the target interval doubles step by step up to a ceiling; the new plan applies on the next
+ * opening of the device. An underrun falls back to the base interval.
+ */
+class OffloadFragmentPlanner : private audio_comms::utilities::NonCopyable
+{
+public:
+    struct Plan
+    {
+        uint32_t fragmentSize; /**< in bytes. */
+        uint32_t fragments;
+        uint32_t wakeupIntervalMs; /**< Expected time between two wakeups of the AP. */
+    };
+
+    struct Stats
+    {
+        uint32_t level; /**< Number of times the base interval has been doubled. */
+        uint32_t maxLevel;
+        uint32_t wakeups; /**< Since the planner was created. */
+        uint32_t promotions;
+        uint32_t underruns;
+        uint32_t wakeupsPerMinute; /**< Over the last full minute of playback, 0 if none yet. */
+    };
+
+    /**
+     * @param[in] backend to query the devices with, NULL for the kernel compress devices.
+     */
+    OffloadFragmentPlanner(CompressDeviceBackend *backend = NULL);
+
+    /**
+     * Set the wakeup intervals targeted. Resets the buffering growth.
+     *
+     * @param[in] baseMs interval of the first plan.
+     * @param[in] maxMs ceiling of the interval once grown, growth disabled if not above baseMs.
+     */
+    void setWakeupIntervals(uint32_t baseMs, uint32_t maxMs);
+
+    /**
+     * Compute the buffering of a stream, for the current growth level.
+     *
+     * @param[in] card index of the sound card.
+     * @param[in] device index of the compress device.
+     * @param[in] codecId SND_AUDIOCODEC_* identifier of the stream.
+     * @param[in] channels count of the stream.
+     * @param[in] bitRate of the stream in bps, its nominal value if the stream does not give it.
+     *
+     * @return plan to open the device with.
+     */
+    Plan plan(uint32_t card, uint32_t device, uint32_t codecId, uint32_t channels,
+              uint32_t bitRate);
+
+    /**
+     * Account a wakeup of the AP by the DSP, i.e. a wait for buffer completed.
+     *
+     * @param[in] nowUs monotonic time of the wakeup.
+     */
+    void onWakeup(uint64_t nowUs);
+
+    /** Playback stopped or paused: steady state and wakeup rate measure start over. */
+    void onInterrupted();
+
+    /** The DSP ran out of data: buffering falls back to the base interval. */
+    void onUnderrun();
+
+    Stats getStats() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+    /** Wakeups in a row required to consider the playback as steady. */
+    static const uint32_t gSteadyStateWakeups = 8;
+
+private:
+    uint32_t getIntervalMsUnsafe() const;
+
+    CompressDeviceBackend *mBackend;
+    mutable audio_comms::utilities::Mutex mLock;
+    uint32_t mBaseIntervalMs;
+    uint32_t mMaxIntervalMs;
+    uint32_t mLevel;
+    uint32_t mMaxLevel;
+    uint32_t mSteadyWakeups; /**< Wakeups since the last interruption. */
+    Stats mStats;
+    Plan mLastPlan;
+
+    uint64_t mWindowStartUs; /**< Time of the first wakeup of the current measure window. */
+    uint32_t mWindowWakeups; /**< Wakeups after the first one in the current measure window. */
+};
+
+} // namespace intel_audio
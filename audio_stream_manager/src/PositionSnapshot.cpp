@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PositionSnapshot.hpp"
+#include <algorithm>
+
+using std::atomic_thread_fence;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+
+namespace intel_audio
+{
+
+static const uint32_t gFloorFramesBits = 48;
+static const uint64_t gFloorFramesMask = (1ULL << gFloorFramesBits) - 1;
+
+static uint64_t makeFloor(uint32_t run, uint64_t frames)
+{
+    return (static_cast<uint64_t>(run) << gFloorFramesBits) | (frames & gFloorFramesMask);
+}
+
+static uint32_t getFloorRun(uint64_t floor)
+{
+    return static_cast<uint32_t>(floor >> gFloorFramesBits);
+}
+
+PositionSnapshot::PositionSnapshot()
+    : mSequence(0), mFrames(0), mSampleRate(0), mTimestampNs(0), mState(0), mRunning(false),
+      mValid(false), mMaxInterpolationNs(0), mRun(0), mFloor(0), mRetries(0)
+{
+}
+
+void PositionSnapshot::publish(const Position &position, bool rewind)
+{
+    uint32_t sequence = mSequence.load(memory_order_relaxed);
+    mSequence.store(sequence + 1, memory_order_relaxed);
+    // Readers seeing any of the new fields see the odd sequence
+    atomic_thread_fence(memory_order_release);
+
+    mFrames.store(position.frames, memory_order_relaxed);
+    mSampleRate.store(position.sampleRate, memory_order_relaxed);
+    mTimestampNs.store(position.timestampNs, memory_order_relaxed);
+    mState.store(position.state, memory_order_relaxed);
+    mRunning.store(position.running, memory_order_relaxed);
+    mValid.store(position.valid, memory_order_relaxed);
+    mMaxInterpolationNs.store(position.maxInterpolationNs, memory_order_relaxed);
+    if (rewind) {
+        // Readers of the new run see its floor, readers of the previous one see it has changed
+        uint32_t run = mRun.load(memory_order_relaxed) + 1;
+        mRun.store(run, memory_order_relaxed);
+        mFloor.store(makeFloor(run, 0), memory_order_relaxed);
+    }
+
+    mSequence.store(sequence + 2, memory_order_release);
+}
+
+PositionSnapshot::Position PositionSnapshot::read() const
+{
+    Position position;
+    for (;;) {
+        uint32_t sequence = mSequence.load(memory_order_acquire);
+        if ((sequence & 1) == 0) {
+            position.frames = mFrames.load(memory_order_relaxed);
+            position.sampleRate = mSampleRate.load(memory_order_relaxed);
+            position.timestampNs = mTimestampNs.load(memory_order_relaxed);
+            position.state = mState.load(memory_order_relaxed);
+            position.running = mRunning.load(memory_order_relaxed);
+            position.valid = mValid.load(memory_order_relaxed);
+            position.maxInterpolationNs = mMaxInterpolationNs.load(memory_order_relaxed);
+            position.run = mRun.load(memory_order_relaxed);
+
+            // Fields read before the sequence is checked again
+            atomic_thread_fence(memory_order_acquire);
+            if (mSequence.load(memory_order_relaxed) == sequence) {
+                return position;
+            }
+        }
+        mRetries.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+uint64_t PositionSnapshot::getFramesAt(const Position &position, uint64_t nowNs)
+{
+    if (!position.running || nowNs <= position.timestampNs) {
+        return position.frames;
+    }
+    uint64_t elapsedNs = std::min(nowNs - position.timestampNs, position.maxInterpolationNs);
+    return position.frames + elapsedNs * position.sampleRate / 1000000000ULL;
+}
+
+uint64_t PositionSnapshot::getMonotonicFramesAt(const Position &position, uint64_t nowNs) const
+{
+    uint64_t frames = std::min(getFramesAt(position, nowNs), gFloorFramesMask);
+    uint32_t run = getFloorRun(makeFloor(position.run, 0));
+    uint64_t floor = mFloor.load(memory_order_relaxed);
+    while (getFloorRun(floor) == run) {
+        uint64_t floorFrames = floor & gFloorFramesMask;
+        if (frames <= floorFrames) {
+            return floorFrames;
+        }
+        if (mFloor.compare_exchange_weak(floor, makeFloor(run, frames), memory_order_relaxed)) {
+            return frames;
+        }
+    }
+    // Rewound since the position was read: it belongs to the previous run, not to clamp with.
+    return frames;
+}
+
+} // namespace intel_audio
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <atomic>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Last position reported by the DSP of a stream, published by a single writer and read without
+ * lock by any number of readers (seqlock): readers never wait for the writer, they retry in the
+ * unlikely case they overlapped a publication.
+ * The frames estimated by the readers never go backwards within a run of the DSP, even when a
+ * position published later is below what was interpolated from the previous one.
+ */
+class PositionSnapshot : private audio_comms::utilities::NonCopyable
+{
+public:
+    struct Position
+    {
+        uint64_t frames; /**< Frames rendered by the DSP at timestamp. */
+        uint32_t sampleRate; /**< Rate the frames are rendered at. */
+        uint64_t timestampNs; /**< Monotonic time the frames were read at. */
+        int state; /**< State of the stream, opaque to the snapshot. */
+        bool running; /**< True if the frames move forward with time. */
+        bool valid; /**< False if the DSP could not be queried, frames being the last known. */
+        uint64_t maxInterpolationNs; /**< Bound of the time interpolated past the timestamp. */
+        uint32_t run; /**< Set by the snapshot: rewinds published so far. */
+    };
+
+    PositionSnapshot();
+
+    /**
+     * Publish a new position. Publications must be serialized by the caller.
+     *
+     * @param[in] position to publish, its run being ignored.
+     * @param[in] rewind true if the DSP counts from 0 again, e.g. once stopped: the frames
+     *                   estimated may then go below the ones already returned.
+     */
+    void publish(const Position &position, bool rewind = false);
+
+    /** @return last position published, a null one if none yet. */
+    Position read() const;
+
+    /**
+     * Estimate the frames rendered at a given time from a position, interpolated with the sample
+     * rate if running, within the interpolation bound.
+     *
+     * @param[in] position to interpolate from.
+     * @param[in] nowNs monotonic time of the estimation.
+     *
+     * @return frames rendered at nowNs.
+     */
+    static uint64_t getFramesAt(const Position &position, uint64_t nowNs);
+
+    /**
+     * Estimate the frames rendered at a given time as getFramesAt does, clamped so that it never
+     * returns less than it already did for the same run.
+     *
+     * @param[in] position to interpolate from, as read from this snapshot.
+     * @param[in] nowNs monotonic time of the estimation.
+     *
+     * @return frames rendered at nowNs.
+     */
+    uint64_t getMonotonicFramesAt(const Position &position, uint64_t nowNs) const;
+
+    /** @return count of reads that overlapped a publication and were retried. */
+    uint32_t getRetries() const { return mRetries.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> mSequence; /**< Odd while a publication is ongoing. */
+    std::atomic<uint64_t> mFrames;
+    std::atomic<uint32_t> mSampleRate;
+    std::atomic<uint64_t> mTimestampNs;
+    std::atomic<int> mState;
+    std::atomic<bool> mRunning;
+    std::atomic<bool> mValid;
+    std::atomic<uint64_t> mMaxInterpolationNs;
+    std::atomic<uint32_t> mRun;
+    /** Highest frames returned in the run, the low bits of the run being in the high bits. */
+    mutable std::atomic<uint64_t> mFloor;
+    mutable std::atomic<uint32_t> mRetries;
+};
+
+} // namespace intel_audio
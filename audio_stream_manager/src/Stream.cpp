@@ -20,8 +20,10 @@
 #include "Stream.hpp"
 #include <Parameters.hpp>
 #include <KeyValuePairs.hpp>
+#include <KeyValueSlices.hpp>
 #include <typeconverter/TypeConverter.hpp>
 #include <AudioCommsAssert.hpp>
+#include <AudioTrace.hpp>
 #include <utilities/Log.hpp>
 #include <property/Property.hpp>
 #include <AudioConversion.hpp>
@@ -29,6 +31,8 @@
 #include <string>
 #include <utils/String8.h>
 #include <unistd.h>
+#include <string.h>
+#include <time.h>
 
 using android::status_t;
 using audio_comms::utilities::Log;
@@ -49,6 +53,11 @@ const std::string Stream::dumpAfterConvProps[Direction::gNbDirections] = {
     "media.dump_input.aftconv", "media.dump_output.aftconv"
 };
 
+const char *const Stream::mFlightRecorderSecondsProp = "media.audio.flight_recorder.seconds";
+const char *const Stream::mFlightRecorderXrunsProp = "media.audio.flight_recorder.xruns";
+const uint32_t Stream::mFlightRecorderSecondsDefault = 2;
+const uint32_t Stream::mFlightRecorderXrunsDefault = 1;
+
 Stream::Stream(Device *parent, audio_io_handle_t handle, uint32_t flagMask)
     : mParent(parent),
       mStandby(true),
@@ -58,9 +67,13 @@ Stream::Stream(Device *parent, audio_io_handle_t handle, uint32_t flagMask)
       mUseCaseMask(0),
       mDumpBeforeConv(NULL),
       mDumpAfterConv(NULL),
+      mFlightRecorder(NULL),
+      mLastCallStartNs(0),
+      mTelemetrySlot(NULL),
       mHandle(handle),
       mPatchHandle(AUDIO_PATCH_HANDLE_NONE)
 {
+    memset(&mTelemetryCounters, 0, sizeof(mTelemetryCounters));
 }
 
 Stream::~Stream()
@@ -68,6 +81,8 @@ Stream::~Stream()
     delete mAudioConversion;
     delete mDumpAfterConv;
     delete mDumpBeforeConv;
+    delete mFlightRecorder;
+    mParent->getTelemetry().releaseStreamSlot(mTelemetrySlot);
 }
 
 void Stream::getDefaultConfig(audio_config_t &config) const
@@ -88,6 +103,27 @@ status_t Stream::set(audio_config_t &config)
     setConfig(config, isOut());
     if (mParent->getStreamInterface().supportStreamConfig(*this)) {
         updateLatency();
+        // Created before the stream is published, the recorder is always on: no lazy creation
+        // racing with the audio thread or with an export request.
+        uint32_t seconds =
+            Property<uint32_t>(mFlightRecorderSecondsProp, mFlightRecorderSecondsDefault)
+            .getValue();
+        if (mFlightRecorder == NULL && seconds != 0) {
+            mFlightRecorder = new AudioFlightRecorder(
+                std::string(isOut() ? "out_" : "in_") + std::to_string(mHandle), isOut(), seconds,
+                Property<uint32_t>(mFlightRecorderXrunsProp, mFlightRecorderXrunsDefault)
+                .getValue());
+        }
+        if (mTelemetrySlot == NULL) {
+            mTelemetrySlot = mParent->getTelemetry().acquireStreamSlot();
+        }
+        mTelemetryCounters.inUse = 1;
+        mTelemetryCounters.handle = mHandle;
+        mTelemetryCounters.isOutput = isOut();
+        mTelemetryCounters.sampleRate = config.sample_rate;
+        mTelemetryCounters.channelCount = streamSampleSpec().getChannelCount();
+        mTelemetryCounters.latencyMs = getLatencyMs();
+        publishTelemetry();
         return android::OK;
     }
     getDefaultConfig(config);
@@ -96,21 +132,35 @@ status_t Stream::set(audio_config_t &config)
 
 std::string Stream::getParameters(const std::string &keys) const
 {
-    KeyValuePairs pairs(keys);
+    KeyValueSlices pairs(keys);
     KeyValuePairs returnedPairs;
-    const AudioCapabilities &capabilities = mParent->getStreamInterface().getCapabilities(*this);
+    const AudioCapabilityLiterals &capabilities =
+        mParent->getStreamInterface().getCapabilityLiterals(*this);
 
     string key(AUDIO_PARAMETER_STREAM_SUP_CHANNELS);
     if (pairs.hasKey(key)) {
-        returnedPairs.add(key, capabilities.getSupportedChannelMasks(isOut()));
+        returnedPairs.add(key, capabilities.channelMasks);
     }
     key = AUDIO_PARAMETER_STREAM_SUP_FORMATS;
     if (pairs.hasKey(key)) {
-        returnedPairs.add(key, capabilities.getSupportedFormats());
+        returnedPairs.add(key, capabilities.formats);
     }
     key =  AUDIO_PARAMETER_STREAM_SUP_SAMPLING_RATES;
     if (pairs.hasKey(key)) {
-        returnedPairs.add(key, capabilities.getSupportedRates());
+        returnedPairs.add(key, capabilities.rates);
+    }
+    if (pairs.hasKey(Parameters::gKeyCpuCost)) {
+        // stage:calls:total us:max us, comma separated
+        std::vector<std::pair<std::string, const CpuCost *> > costs;
+        getCpuCosts(costs);
+        string value;
+        for (const auto &cost : costs) {
+            value += (value.empty() ? "" : ",") + cost.first + ":" +
+                     std::to_string(cost.second->getCalls()) + ":" +
+                     std::to_string(cost.second->getCpuTimeNs() / 1000) + ":" +
+                     std::to_string(cost.second->getMaxCpuTimeNs() / 1000);
+        }
+        returnedPairs.add(Parameters::gKeyCpuCost, value);
     }
 
     return returnedPairs.toString();
@@ -174,7 +224,7 @@ status_t Stream::setParameters(const string &keyValuePairs)
 {
     status_t result(android::BAD_VALUE);
 
-    KeyValuePairs pairs(keyValuePairs);
+    KeyValueSlices pairs(keyValuePairs);
 
     string key(AUDIO_PARAMETER_STREAM_CHANNELS);
     uint32_t value;
@@ -272,6 +322,11 @@ status_t Stream::attachRouteL()
     Log::Verbose() << __FUNCTION__ << ": " << (isOut() ? "output" : "input") << " stream";
     IoStream::attachRouteL();
 
+    strncpy(mTelemetryCounters.route, getCurrentStreamRoute()->getName().c_str(),
+            sizeof(mTelemetryCounters.route) - 1);
+    mTelemetryCounters.latencyMs = getLatencyMs();
+    publishTelemetry();
+
     SampleSpec ssSrc;
     SampleSpec ssDst;
 
@@ -293,6 +348,9 @@ status_t Stream::detachRouteL()
     Log::Verbose() << __FUNCTION__ << ": " << (isOut() ? "output" : "input") << " stream";
     IoStream::detachRouteL();
 
+    mTelemetryCounters.route[0] = '\0';
+    publishTelemetry();
+
     return android::OK;
 }
 
@@ -323,6 +381,8 @@ void Stream::setStarted(bool isStarted)
 {
     AutoW lock(mStreamLock);
     mStandby = !isStarted;
+    // The interval spanning a standby is not a jitter of the stream.
+    mLastCallStartNs.store(0, std::memory_order_relaxed);
 
     if (isStarted) {
 
@@ -358,6 +418,119 @@ void Stream::initAudioDump()
     }
 }
 
+void Stream::recordFlightSamples(AudioFlightRecorder::Stage stage, const void *buffer,
+                                 size_t frames, const SampleSpec &sampleSpec) const
+{
+    if (mFlightRecorder != NULL) {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(DumpCost));
+        mFlightRecorder->record(stage, buffer, sampleSpec.convertFramesToBytes(frames),
+                                sampleSpec.getSampleRate(), sampleSpec.getChannelCount(),
+                                audio_bytes_per_sample(sampleSpec.getFormat()));
+    }
+}
+
+void Stream::recordXrun(uint32_t xruns, uint64_t framesLost)
+{
+    AudioTrace::instant(isOut() ? "StreamOut::xrun" : "StreamIn::xrun");
+    if (mFlightRecorder != NULL) {
+        mFlightRecorder->onXrun();
+    }
+    if (isOut()) {
+        mTelemetryCounters.underruns += xruns;
+    } else {
+        mTelemetryCounters.overruns += xruns;
+    }
+    mTelemetryCounters.framesLost += framesLost;
+    mTelemetryCounters.lastXrunTimeNs = getMonotonicNs();
+    publishTelemetry();
+}
+
+uint32_t Stream::recordDeviceXrunsL(const XrunCounters &before, uint64_t *framesLost)
+{
+    XrunCounters after = getXrunCounters();
+    uint32_t xruns = after.xruns - before.xruns;
+    // Measured at the rate of the device, i.e. of the route.
+    uint64_t lost = AudioUtils::convertSrcToDstInFrames(after.framesLost - before.framesLost,
+                                                        routeSampleSpec(), streamSampleSpec());
+    if (xruns != 0) {
+        Log::Warning() << __FUNCTION__ << ": " << xruns << (isOut() ? " underrun" : " overrun")
+                       << "(s) detected, " << lost << " frames lost";
+        recordXrun(xruns, lost);
+    }
+    if (framesLost != NULL) {
+        *framesLost = lost;
+    }
+    return xruns;
+}
+
+void Stream::publishTelemetryL(uint64_t frames, uint64_t hwBlockingNs)
+{
+    mTelemetryCounters.frames = frames;
+    mTelemetryCounters.hwBlockingNs = hwBlockingNs;
+    publishTelemetry();
+}
+
+void Stream::publishTelemetry()
+{
+    if (mTelemetrySlot != NULL) {
+        mTelemetryCounters.updateTimeNs = getMonotonicNs();
+        mTelemetrySlot->write(mTelemetryCounters);
+    }
+}
+
+void Stream::getCpuCosts(std::vector<std::pair<std::string, const CpuCost *> > &costs) const
+{
+    static const char *const stageNames[NbCpuCostStages] = {
+        "echo_reference", "dump", "effects", "pcm"
+    };
+    costs.clear();
+    for (size_t stage = 0; stage < NbCpuCostStages; stage++) {
+        costs.push_back(std::make_pair(stageNames[stage], &mCpuCosts[stage]));
+    }
+    costs.push_back(std::make_pair("conversion", &mAudioConversion->getCpuCost()));
+    for (int item = 0; item < NbSampleSpecItems; item++) {
+        SampleSpecItem sampleSpecItem = static_cast<SampleSpecItem>(item);
+        costs.push_back(std::make_pair(
+                            std::string("conversion.") +
+                            AudioConversion::getConverterName(sampleSpecItem),
+                            &mAudioConversion->getConverterCpuCost(sampleSpecItem)));
+    }
+}
+
+void Stream::resetLatencyStats()
+{
+    for (auto &histogram : mLatencyHistograms) {
+        histogram.reset();
+    }
+    for (auto &cost : mCpuCosts) {
+        cost.reset();
+    }
+    mAudioConversion->resetCpuCost();
+}
+
+Stream::IoCallTimer::IoCallTimer(Stream &stream)
+    : mStream(stream),
+      mStartNs(getMonotonicNs())
+{
+    uint64_t lastStartNs = mStream.mLastCallStartNs.exchange(mStartNs,
+                                                             std::memory_order_relaxed);
+    if (lastStartNs != 0) {
+        mStream.recordLatency(CallInterval, mStartNs - lastStartNs);
+    }
+}
+
+Stream::IoCallTimer::~IoCallTimer()
+{
+    mStream.recordLatency(CallDuration, getMonotonicNs() - mStartNs);
+}
+
+uint64_t Stream::getMonotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
 bool Stream::safeSleep(uint32_t sleepTimeUs)
 {
     struct timespec tim;
@@ -399,6 +572,47 @@ android::status_t Stream::dump(int fd) const
              InputSourceConverter::maskToString(mUseCaseMask, ",").c_str());
     result.append(buffer);
     write(fd, result.string(), result.size());
+    if (mDumpBeforeConv != NULL) {
+        mDumpBeforeConv->dump(fd, spaces + 2);
+    }
+    if (mDumpAfterConv != NULL) {
+        mDumpAfterConv->dump(fd, spaces + 2);
+    }
+    if (mFlightRecorder != NULL) {
+        mFlightRecorder->dump(fd, spaces + 2);
+    }
+    static const char *const latencyNames[NbLatencyStages][Direction::gNbDirections] = {
+        { "read() duration", "write() duration" },
+        { "pcm_read blocking", "pcm_write blocking" },
+        { "conversion", "conversion" },
+        { "read() interval", "write() interval" }
+    };
+#if defined(AUDIO_CPU_COST_ACCOUNTING)
+    snprintf(buffer, SIZE, "%*s- CPU cost:\n", spaces + 2, "");
+    write(fd, buffer, strlen(buffer));
+    std::vector<std::pair<std::string, const CpuCost *> > costs;
+    getCpuCosts(costs);
+    for (const auto &cost : costs) {
+        uint64_t calls = cost.second->getCalls();
+        if (calls == 0) {
+            continue;
+        }
+        snprintf(buffer, SIZE, "%*s%s: %llu calls, %llu us total, %llu us average, %llu us max\n",
+                 spaces + 4, "", cost.first.c_str(), static_cast<unsigned long long>(calls),
+                 static_cast<unsigned long long>(cost.second->getCpuTimeNs() / 1000),
+                 static_cast<unsigned long long>(cost.second->getCpuTimeNs() / calls / 1000),
+                 static_cast<unsigned long long>(cost.second->getMaxCpuTimeNs() / 1000));
+        write(fd, buffer, strlen(buffer));
+    }
+#else
+    snprintf(buffer, SIZE, "%*s- CPU cost: not accounted in this build\n", spaces + 2, "");
+    write(fd, buffer, strlen(buffer));
+#endif
+    snprintf(buffer, SIZE, "%*s- Latency:\n", spaces + 2, "");
+    write(fd, buffer, strlen(buffer));
+    for (size_t stage = 0; stage < NbLatencyStages; stage++) {
+        mLatencyHistograms[stage].dump(fd, spaces + 4, latencyNames[stage][isOut()]);
+    }
     return IoStream::dump(fd, spaces + 2);
 }
 
@@ -20,9 +20,16 @@
 #include <AudioNonCopyable.hpp>
 #include <Direction.hpp>
 #include <IoStream.hpp>
+#include <AudioFlightRecorder.hpp>
+#include <AudioTelemetryLayout.hpp>
+#include "LatencyHistogram.hpp"
+#include <CpuCost.hpp>
 #include <media/AudioBufferProvider.h>
 #include <hardware/audio.h>
+#include <atomic>
 #include <string>
+#include <utility>
+#include <vector>
 #include <utils/RWLock.h>
 
 class HalAudioDump;
@@ -105,6 +112,19 @@ public:
      */
     void updateLatency();
 
+    /**
+     * Get the flight recorder of the stream, keeping the last seconds of its audio.
+     *
+     * @return the flight recorder, NULL if disabled.
+     */
+    AudioFlightRecorder *getFlightRecorder() const
+    {
+        return mFlightRecorder;
+    }
+
+    /** Clears the latency histograms and the CPU costs of the stream. */
+    void resetLatencyStats();
+
 protected:
     Stream(Device *parent, audio_io_handle_t handle, uint32_t flagMask);
 
@@ -224,6 +244,109 @@ protected:
         return mDumpAfterConv;
     }
 
+    /**
+     * Records samples of a stage of the audio path in the flight recorder, if enabled.
+     * Safe to call from the audio thread.
+     *
+     * @param[in] stage of the audio path.
+     * @param[in] buffer samples to record.
+     * @param[in] frames number of frames to record.
+     * @param[in] sampleSpec of the samples.
+     */
+    void recordFlightSamples(AudioFlightRecorder::Stage stage, const void *buffer, size_t frames,
+                             const SampleSpec &sampleSpec) const;
+
+    /**
+     * Accounts xruns of the stream in the trace, the flight recorder and the telemetry.
+     * Called with the stream lock held.
+     *
+     * @param[in] xruns to account.
+     * @param[in] framesLost frames of the client lost by these xruns, 0 if unknown.
+     */
+    void recordXrun(uint32_t xruns = 1, uint64_t framesLost = 0);
+
+    /**
+     * Accounts the xruns the device detected since its counters were sampled, i.e. during a
+     * transfer. Called with the stream lock held, while routed.
+     *
+     * @param[in] before counters of the device sampled before the transfer.
+     * @param[out] framesLost if not NULL, frames of the client lost by these xruns.
+     *
+     * @return number of xruns detected.
+     */
+    uint32_t recordDeviceXrunsL(const XrunCounters &before, uint64_t *framesLost = NULL);
+
+    /** @return xruns accounted to the stream so far. Called with the stream lock held. */
+    uint64_t getXrunCountL() const
+    {
+        return mTelemetryCounters.underruns + mTelemetryCounters.overruns;
+    }
+
+    /**
+     * Publishes the counters of the stream in the telemetry page, if any.
+     * Called with the stream lock held, which serializes the updates of the telemetry slot.
+     *
+     * @param[in] frames written or read by the client so far.
+     * @param[in] hwBlockingNs time blocked in the device by the last read or write.
+     */
+    void publishTelemetryL(uint64_t frames, uint64_t hwBlockingNs);
+
+    /** Durations of the I/O path, histogrammed per stream. */
+    enum LatencyStage
+    {
+        CallDuration,   /**< Duration of a read or write call. */
+        HwBlocking,     /**< Time blocked in the PCM device read or write. */
+        Conversion,     /**< Time spent converting the samples. */
+        CallInterval,   /**< Interval between the starts of two read or write calls. */
+        NbLatencyStages
+    };
+
+    /**
+     * Records a duration of the I/O path. Lock-free, safe to call from the audio thread.
+     *
+     * @param[in] stage of the I/O path.
+     * @param[in] durationNs duration in nanoseconds.
+     */
+    void recordLatency(LatencyStage stage, uint64_t durationNs)
+    {
+        mLatencyHistograms[stage].record(durationNs);
+    }
+
+    /**
+     * Times a read or write call for its scope, and the interval since the previous call.
+     */
+    class IoCallTimer : private audio_comms::utilities::NonCopyable
+    {
+    public:
+        explicit IoCallTimer(Stream &stream);
+        ~IoCallTimer();
+
+    private:
+        Stream &mStream;
+        uint64_t mStartNs;
+    };
+
+    static uint64_t getMonotonicNs();
+
+    /** Stages of the audio path which CPU time is accounted, besides the conversion. */
+    enum CpuCostStage
+    {
+        EchoReferenceCost,  /**< Echo reference push, for the AEC. */
+        DumpCost,           /**< Audio dumps and flight recorder. */
+        EffectsCost,        /**< Pre-processing effects. */
+        PcmCost,            /**< PCM device read or write. */
+        NbCpuCostStages
+    };
+
+    /**
+     * Gets the CPU cost of a stage, to account with AUDIO_CPU_COST_SCOPE.
+     *
+     * @param[in] stage of the audio path.
+     *
+     * @return CPU cost of the stage.
+     */
+    CpuCost &getCpuCost(CpuCostStage stage) const { return mCpuCosts[stage]; }
+
     /**
      * Used to sleep on the current thread.
      *
@@ -274,6 +397,16 @@ private:
      */
     android::status_t configureAudioConversion(const SampleSpec &ssSrc, const SampleSpec &ssDst);
 
+    /**
+     * Lists the CPU costs of the stream: its stages, the conversion chain and its converters.
+     *
+     * @param[out] costs named CPU costs of the stream.
+     */
+    void getCpuCosts(std::vector<std::pair<std::string, const CpuCost *> > &costs) const;
+
+    /** Stamps and writes the telemetry counters of the stream in its slot, if any. */
+    void publishTelemetry();
+
     /**
      * Init audio dump if dump properties are activated to create the dump object(s).
      * Triggered when the stream is started.
@@ -318,6 +451,24 @@ private:
      */
     HalAudioDump *mDumpAfterConv;
 
+    /**
+     * Flight recorder of the stream, created on set unless disabled by property.
+     */
+    AudioFlightRecorder *mFlightRecorder;
+
+    LatencyHistogram mLatencyHistograms[NbLatencyStages];
+
+    mutable CpuCost mCpuCosts[NbCpuCostStages];
+
+    /** Slot of the stream in the telemetry page, acquired on set, NULL if none. */
+    telemetry::StreamSlot *mTelemetrySlot;
+
+    /** Counters last published, updated with the stream lock held. */
+    telemetry::StreamCounters mTelemetryCounters;
+
+    /** Start of the last read or write call, 0 if none since standby. */
+    std::atomic<uint64_t> mLastCallStartNs;
+
     /**
      * Array of property names before conversion
      */
@@ -328,6 +479,18 @@ private:
      */
     static const std::string dumpAfterConvProps[Direction::gNbDirections];
 
+    /**
+     * Seconds of audio kept per stage by the flight recorder, 0 to disable it.
+     */
+    static const char *const mFlightRecorderSecondsProp;
+    static const uint32_t mFlightRecorderSecondsDefault;
+
+    /**
+     * Number of xruns triggering the export of the flight recorder.
+     */
+    static const char *const mFlightRecorderXrunsProp;
+    static const uint32_t mFlightRecorderXrunsDefault;
+
     /** maximum sleep time to be allowed by HAL, in microseconds. */
     static const uint32_t mMaxSleepTime = 1000000UL;
 
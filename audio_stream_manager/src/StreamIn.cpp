@@ -17,6 +17,7 @@
 
 #include "StreamIn.hpp"
 #include <AudioCommsAssert.hpp>
+#include <AudioTrace.hpp>
 #include <HalAudioDump.hpp>
 #include <KeyValuePairs.hpp>
 #include <BitField.hpp>
@@ -38,6 +39,7 @@ StreamIn::StreamIn(Device *parent, audio_io_handle_t handle, uint32_t flagMask,
                    audio_source_t source, audio_devices_t devices, const std::string &address)
     : Stream(parent, handle, flagMask),
       mFramesLost(0),
+      mHwReadNs(0),
       mFramesIn(0),
       mFramesInCount(0),
       mProcessingFramesIn(0),
@@ -96,7 +98,20 @@ status_t StreamIn::readHwFrames(void *buffer, size_t frames)
 
     std::string error;
 
-    ret = pcmReadFrames(buffer, frames, error);
+    XrunCounters xrunsBefore = getXrunCounters();
+    uint64_t hwStartNs = getMonotonicNs();
+    {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(PcmCost));
+        AUDIO_TRACE_SCOPE("StreamIn::pcmReadFrames");
+        ret = pcmReadFrames(buffer, frames, error);
+    }
+    uint64_t hwNs = getMonotonicNs() - hwStartNs;
+    recordLatency(HwBlocking, hwNs);
+    mHwReadNs += hwNs;
+    uint64_t framesLost;
+    if (recordDeviceXrunsL(xrunsBefore, &framesLost) != 0) {
+        mFramesLost += static_cast<uint32_t>(framesLost);
+    }
 
     if (ret < 0) {
         Log::Error() << __FUNCTION__ << ": read error: " << error << " - requested " << frames
@@ -109,15 +124,20 @@ status_t StreamIn::readHwFrames(void *buffer, size_t frames)
         return ret;
     }
 
+    recordFlightSamples(AudioFlightRecorder::PcmRead, buffer, frames, routeSampleSpec());
+
     // Dump audio input before eventual conversions
     // FOR DEBUG PURPOSE ONLY
     if (getDumpObjectBeforeConv() != NULL) {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(DumpCost));
         getDumpObjectBeforeConv()->dumpAudioSamples(buffer,
                                                     routeSampleSpec().convertFramesToBytes(frames),
                                                     isOut(),
                                                     routeSampleSpec().getSampleRate(),
                                                     routeSampleSpec().getChannelCount(),
-                                                    "before_conversion");
+                                                    "before_conversion",
+                                                    audio_bytes_per_sample(
+                                                        routeSampleSpec().getFormat()));
     }
 
     return ret;
@@ -140,19 +160,26 @@ status_t StreamIn::readFrames(void *buffer, size_t frames, ssize_t *processedFra
     //
     // Otherwise, request for a converted buffer
     //
+    uint64_t conversionStartNs = getMonotonicNs();
+    uint64_t hwReadStartNs = mHwReadNs;
     status_t status = getConvertedBuffer(buffer, frames, this);
+    // The provider reads the device from within the conversion: do not account it twice.
+    recordLatency(Conversion, getMonotonicNs() - conversionStartNs - (mHwReadNs - hwReadStartNs));
     if (status != android::OK) {
 
         return status;
     }
 
     if (getDumpObjectAfterConv() != NULL) {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(DumpCost));
         getDumpObjectAfterConv()->dumpAudioSamples(buffer,
                                                    streamSampleSpec().convertFramesToBytes(frames),
                                                    isOut(),
                                                    streamSampleSpec().getSampleRate(),
                                                    streamSampleSpec().getChannelCount(),
-                                                   "after_conversion");
+                                                   "after_conversion",
+                                                   audio_bytes_per_sample(
+                                                       streamSampleSpec().getFormat()));
     }
 
     *processedFrames = frames;
@@ -174,27 +201,29 @@ int StreamIn::doProcessFrames(const void *buffer, ssize_t frames,
         for (it = mPreprocessorsHandlerList.begin(); it != mPreprocessorsHandlerList.end(); ++it) {
 
             if (it->mEchoReference != NULL) {
+                AUDIO_CPU_COST_SCOPE(getCpuCost(EchoReferenceCost));
                 pushEchoReference(*processingFramesIn, it->mPreprocessor, *it->mEchoReference);
             }
-            // in_buf.frameCount and out_buf.frameCount indicate respectively
-            // the maximum number of frames to be consumed and produced by process()
-            inBuf.frameCount = *processingFramesIn;
-            inBuf.s16 = (int16_t *)((char *)mProcessingBuffer +
-                                    streamSampleSpec().convertFramesToBytes(*processedFrames));
-            outBuf.frameCount = frames - *processedFrames;
-            outBuf.s16 = (int16_t *)((char *)buffer +
-                                     streamSampleSpec().convertFramesToBytes(*processedFrames));
-
-            ret = (*(it->mPreprocessor))->process(it->mPreprocessor, &inBuf, &outBuf);
-            if (ret == 0) {
-                // Note: it is useless to recopy the output of effect processing as input
-                // for the next effect processing because it is done in webrtc::audio_processing
-
-                // process() has updated the number of frames consumed and produced in
-                // in_buf.frameCount and out_buf.frameCount respectively
-                *processingFramesIn -= inBuf.frameCount;
-                *processedFrames += outBuf.frameCount;
-            }
+        }
+        // in_buf.frameCount and out_buf.frameCount indicate respectively
+        // the maximum number of frames to be consumed and produced by the chain
+        inBuf.frameCount = *processingFramesIn;
+        inBuf.s16 = (int16_t *)((char *)mProcessingBuffer +
+                                streamSampleSpec().convertFramesToBytes(*processedFrames));
+        outBuf.frameCount = frames - *processedFrames;
+        outBuf.s16 = (int16_t *)((char *)buffer +
+                                 streamSampleSpec().convertFramesToBytes(*processedFrames));
+
+        // The chain feeds the output of each effect to the next one
+        {
+            AUDIO_CPU_COST_SCOPE(getCpuCost(EffectsCost));
+            ret = mEffectChain.process(inBuf, outBuf);
+        }
+        if (ret == 0) {
+            // process() has updated the number of frames consumed and produced in
+            // in_buf.frameCount and out_buf.frameCount respectively
+            *processingFramesIn -= inBuf.frameCount;
+            *processedFrames += outBuf.frameCount;
         }
     }
     return ret;
@@ -271,6 +300,8 @@ status_t StreamIn::processFrames(void *buffer, ssize_t frames, ssize_t *processe
 
 status_t StreamIn::read(void *buffer, size_t &bytes)
 {
+    IoCallTimer callTimer(*this);
+    AUDIO_TRACE_SCOPE("StreamIn::read");
     setStandby(false);
 
     mStreamLock.readLock();
@@ -289,6 +320,8 @@ status_t StreamIn::read(void *buffer, size_t &bytes)
 
     ssize_t received_frames = -1;
     ssize_t frames = streamSampleSpec().convertBytesToFrames(bytes);
+    uint64_t hwReadStartNs = mHwReadNs;
+    uint64_t xrunsBefore = getXrunCountL();
 
     // Take the effect lock while processing
     mPreProcEffectLock.readLock();
@@ -306,12 +339,19 @@ status_t StreamIn::read(void *buffer, size_t &bytes)
         Log::Error() << __FUNCTION__ << ": (buffer=" << buffer << ", bytes=" << bytes
                      << ") returns " << received_frames
                      << ". Generating silence for stream " << this;
+        if (getXrunCountL() == xrunsBefore) {
+            // The client is fed silence, accounted as an overrun all the same.
+            recordXrun();
+        }
         mStreamLock.unlock();
         generateSilence(bytes, buffer);
         return status;
     }
+    recordFlightSamples(AudioFlightRecorder::ClientRead, buffer, received_frames,
+                        streamSampleSpec());
     bytes = streamSampleSpec().convertFramesToBytes(received_frames);
     mFramesInCount += received_frames;
+    publishTelemetryL(mFramesInCount, mHwReadNs - hwReadStartNs);
 
     mStreamLock.unlock();
     return android::OK;
@@ -319,21 +359,16 @@ status_t StreamIn::read(void *buffer, size_t &bytes)
 
 void StreamIn::resetFramesLost()
 {
-    // setVoiceVolume and mixing during voice call cannot happen together
-    // need a lock; but deadlock may appear during simultaneous R or W
-    // so remove lock and the reset of mFramesLost which is never updated btw
+    // Atomic, as the lock would deadlock against a read blocked in the device.
+    mFramesLost = 0;
 }
 
 unsigned int StreamIn::getInputFramesLost() const
 {
-    unsigned int count = mFramesLost;   // set to 0 during construction
-
-    StreamIn *mutable_this = const_cast<StreamIn *>(this);
     // Requirement from AudioHardwareInterface.h:
     // Audio driver is expected to reset the value to 0 and restart counting upon
     // returning the current value by this function call.
-    mutable_this->resetFramesLost();
-    return count;
+    return mFramesLost.exchange(0);
 }
 
 status_t StreamIn::getCapturePosition(int64_t &frames, int64_t &time)
@@ -392,7 +427,7 @@ status_t StreamIn::detachRouteL()
 }
 
 
-bool StreamIn::isHwEffectL(effect_handle_t effect)
+bool StreamIn::isHwEffect(effect_handle_t effect)
 {
     if (effect == NULL || *effect == NULL) {
         return android::BAD_VALUE;
@@ -406,6 +441,25 @@ bool StreamIn::isHwEffectL(effect_handle_t effect)
     return implementor == mHwEffectImplementor;
 }
 
+bool StreamIn::needsSwFallback(effect_handle_t effect, uint32_t effectId)
+{
+    uint32_t effectMask = getEffectRequested();
+    if ((*effect)->process == NULL || (effectMask & effectId) != 0) {
+        return false;
+    }
+    // Requested effects are part of the criteria matching a route with the stream: the mask with
+    // the effect is only a candidate, it is not published to the routing thread.
+    const AudioRouteManager &routeManager = mParent->getStreamInterface();
+    return !routeManager.supportStreamConfig(*this, effectMask | effectId) &&
+           routeManager.supportStreamConfig(*this, effectMask);
+}
+
+bool StreamIn::isSwProcessedL(effect_handle_t effect) const
+{
+    return std::find_if(mPreprocessorsHandlerList.begin(), mPreprocessorsHandlerList.end(),
+                        std::bind2nd(MatchEffect(), effect)) != mPreprocessorsHandlerList.end();
+}
+
 status_t StreamIn::setDevice(audio_devices_t device)
 {
     if (!audio_is_input_device(device)) {
@@ -447,32 +501,15 @@ status_t StreamIn::addAudioEffect(effect_handle_t effect)
         return android::BAD_VALUE;
     }
     Log::Debug() << __FUNCTION__ << ": effect=" << effect;
-    // Called from different context than the stream,
-    // so effect Lock must be held
-    AutoW lock(mPreProcEffectLock);
-
-    if (isHwEffectL(effect)) {
-        Log::Debug() << __FUNCTION__ << ": HW Effect requested";
-        /**
-         * HW Effects management
-         */
-        string name;
-        status_t err = getAudioEffectNameFromHandle(effect, name);
-        if (err != android::OK) {
 
-            return android::BAD_VALUE;
-        }
-        addRequestedEffect(EffectHelper::convertEffectNameToProcId(name));
-        if (isStarted()) {
-            Log::Debug() << __FUNCTION__ << ": stream running, reconsider routing";
-            // If the stream is routed, force a reconsider routing to take effect into account
-            mParent->updateStreamsParametersAsync(getRole());
-        }
-    } else {
+    if (!isHwEffect(effect)) {
         Log::Debug() << __FUNCTION__ << ": SW Effect requested(effect=" << effect << ")";
         /**
          * SW Effects management
          */
+        // Called from different context than the stream,
+        // so effect Lock must be held
+        AutoW lock(mPreProcEffectLock);
         if (isAecEffect(effect)) {
 
             struct echo_reference_itfe *stReference = NULL;
@@ -480,8 +517,36 @@ status_t StreamIn::addAudioEffect(effect_handle_t effect)
             return addSwAudioEffectL(effect, stReference);
         }
         addSwAudioEffectL(effect);
+        return android::OK;
     }
+    Log::Debug() << __FUNCTION__ << ": HW Effect requested";
+    /**
+     * HW Effects management
+     * The route manager is not called with the effect lock held: the routing thread attaches the
+     * streams under their lock, which a read holds while waiting for the effect lock.
+     */
+    string name;
+    status_t err = getAudioEffectNameFromHandle(effect, name);
+    if (err != android::OK) {
 
+        return android::BAD_VALUE;
+    }
+    uint32_t effectId = EffectHelper::convertEffectNameToProcId(name);
+    if (needsSwFallback(effect, effectId)) {
+        Log::Info() << __FUNCTION__ << ": no route implements " << name
+                    << ", processing it in software";
+        AutoW lock(mPreProcEffectLock);
+        return addSwAudioEffectL(effect);
+    }
+    mPreProcEffectLock.writeLock();
+    addRequestedEffect(effectId);
+    mPreProcEffectLock.unlock();
+
+    if (isStarted()) {
+        Log::Debug() << __FUNCTION__ << ": stream running, apply effect";
+        // Applied in place if the route implements it, otherwise the routing is reconsidered
+        mParent->updateStreamEffects(*this);
+    }
     return android::OK;
 }
 
@@ -494,32 +559,38 @@ status_t StreamIn::removeAudioEffect(effect_handle_t effect)
     Log::Debug() << __FUNCTION__ << ": effect=" << effect;
     // Called from different context than the stream,
     // so effect Lock must be held.
-    AutoW lock(mPreProcEffectLock);
-
-    if (isHwEffectL(effect)) {
-        Log::Debug() << __FUNCTION__ << ": HW Effect requested";
-        /**
-         * HW Effects management
-         */
-        string name;
-        status_t err = getAudioEffectNameFromHandle(effect, name);
-        if (err != android::OK) {
+    mPreProcEffectLock.writeLock();
 
-            return android::BAD_VALUE;
-        }
-        removeRequestedEffect(EffectHelper::convertEffectNameToProcId(name));
-        if (isStarted()) {
-            Log::Debug() << __FUNCTION__ << ": stream running, reconsider routing";
-            // If the stream is routed,
-            // force a reconsider routing to take effect removal into account
-            mParent->updateStreamsParametersAsync(getRole());
-        }
-    } else {
+    // HW effects may be processed in software if no route implements them
+    if (!isHwEffect(effect) || isSwProcessedL(effect)) {
         Log::Debug() << __FUNCTION__ << ": SW Effect requested";
         /**
          * SW Effects management
          */
         removeSwAudioEffectL(effect);
+        mPreProcEffectLock.unlock();
+        return android::OK;
+    }
+    Log::Debug() << __FUNCTION__ << ": HW Effect requested";
+    /**
+     * HW Effects management
+     */
+    string name;
+    status_t err = getAudioEffectNameFromHandle(effect, name);
+    if (err != android::OK) {
+
+        mPreProcEffectLock.unlock();
+        return android::BAD_VALUE;
+    }
+    removeRequestedEffect(EffectHelper::convertEffectNameToProcId(name));
+    // The route manager is not called with the effect lock held, see addAudioEffect
+    mPreProcEffectLock.unlock();
+
+    if (isStarted()) {
+        Log::Debug() << __FUNCTION__ << ": stream running, remove effect";
+        // Applied in place if the route remains the best one, otherwise the routing is
+        // reconsidered
+        mParent->updateStreamEffects(*this);
     }
     return android::OK;
 }
@@ -540,6 +611,10 @@ status_t StreamIn::addSwAudioEffectL(effect_handle_t effect,
                        << "): it is useless to add again the same effect";
         return android::OK;
     }
+    status_t status = mEffectChain.add(effect);
+    if (status != android::OK) {
+        return status;
+    }
     mPreprocessorsHandlerList.push_back(AudioEffectHandle(effect, reference));
     Log::Debug() << __FUNCTION__ << ": (effect=" << effect
                  << "): effect added. number of stored effects is"
@@ -564,6 +639,7 @@ status_t StreamIn::removeSwAudioEffectL(effect_handle_t effect)
             it->mEchoReference = NULL;
         }
         mPreprocessorsHandlerList.erase(it);
+        mEffectChain.remove(effect);
         Log::Debug() << __FUNCTION__ << " (effect=" << effect
                      << "): effect has been found. number of effects after erase "
                      << mPreprocessorsHandlerList.size();
@@ -797,6 +873,10 @@ status_t StreamIn::allocateProcessingMemory(ssize_t frames)
         return android::NO_MEMORY;
     }
     mProcessingBuffer = processingBuffer;
+    status_t status = mEffectChain.configure(frames, streamSampleSpec().getFrameSize());
+    if (status != android::OK) {
+        return status;
+    }
     Log::Debug() << __FUNCTION__ << ": (frames=" << frames
                  << "): mProcessingBuffer=" << mProcessingBuffer
                  << " size extended to " << mProcessingBufferSizeInFrames
@@ -806,4 +886,15 @@ status_t StreamIn::allocateProcessingMemory(ssize_t frames)
     return android::OK;
 }
 
+status_t StreamIn::dump(int fd) const
+{
+    status_t status = Stream::dump(fd);
+    StreamIn *mutable_this = const_cast<StreamIn *>(this);
+    AutoR lock(mutable_this->mPreProcEffectLock);
+    if (!mEffectChain.empty()) {
+        mEffectChain.dump(fd, 4);
+    }
+    return status;
+}
+
 } // namespace intel_audio
@@ -17,7 +17,9 @@
 
 #include "Device.hpp"
 #include "Stream.hpp"
+#include "EffectChain.hpp"
 #include <media/AudioBufferProvider.h>
+#include <atomic>
 #include <vector>
 #include <list>
 
@@ -76,6 +78,12 @@ public:
 
     virtual bool isMuted() const { return false; }
 
+    /**
+     * Dump the stream and the timing of its software effects.
+     * From Stream class.
+     */
+    virtual android::status_t dump(int fd) const;
+
 protected:
     /**
      * Callback of route attachement called by the stream lib. (and so route manager).
@@ -147,7 +155,26 @@ private:
      *
      * @return true if HW effect, false if SW.
      */
-    bool isHwEffectL(effect_handle_t effect);
+    bool isHwEffect(effect_handle_t effect);
+
+    /**
+     * Checks if a HW effect shall be processed in software, as no route implements it whereas
+     * a route supports the stream without it. Only possible if the effect library provides
+     * a software fallback, i.e. if the effect implements process.
+     *
+     * @param[in] effect: handle in the HW effect.
+     * @param[in] effectId: pre processor Id of the effect.
+     *
+     * @return true if the effect shall be processed in software, false otherwise.
+     */
+    bool needsSwFallback(effect_handle_t effect, uint32_t effectId);
+
+    /**
+     * @param[in] effect: handle in the effect.
+     *
+     * @return true if the effect is processed in software by the stream, false otherwise.
+     */
+    bool isSwProcessedL(effect_handle_t effect) const;
 
     /**
      * Checks if effect is AEC.
@@ -301,9 +328,12 @@ private:
     void getCaptureDelay(struct echo_reference_buffer *buffer);
 
     /**
-     * amount of input frames lost in the audio driver (i.e. not provided on time to client).
+     * amount of input frames lost in the audio driver (i.e. not provided on time to client),
+     * added by the reads and reset by getInputFramesLost.
      */
-    unsigned int mFramesLost;
+    mutable std::atomic<uint32_t> mFramesLost;
+
+    uint64_t mHwReadNs; /**< Total time blocked reading the device, owned by the audio thread. */
 
     ssize_t mFramesIn; /**< frames available in stream input buffer. */
 
@@ -346,6 +376,9 @@ private:
      */
     std::vector<AudioEffectHandle> mPreprocessorsHandlerList;
 
+    /** Runs the SW effects of mPreprocessorsHandlerList, protected by the effect lock. */
+    EffectChain mEffectChain;
+
     char *mHwBuffer; /**< buffer in which samples are read from audio device. */
     ssize_t mHwBufferSize; /**< Size of the buffer in which samples are read from audio device. */
 
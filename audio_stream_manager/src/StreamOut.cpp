@@ -18,6 +18,7 @@
 
 #include "StreamOut.hpp"
 #include <AudioCommsAssert.hpp>
+#include <AudioTrace.hpp>
 #include <HalAudioDump.hpp>
 #include <utilities/Log.hpp>
 
@@ -89,6 +90,8 @@ status_t StreamOut::write(const void *buffer, size_t &bytes)
         Log::Error() << __FUNCTION__ << ": NULL client buffer";
         return android::BAD_VALUE;
     }
+    IoCallTimer callTimer(*this);
+    AUDIO_TRACE_SCOPE("StreamOut::write");
     setStandby(false);
 
     mStreamLock.readLock();
@@ -108,20 +111,30 @@ status_t StreamOut::write(const void *buffer, size_t &bytes)
     size_t dstFrames = 0;
     char *dstBuf = NULL;
 
-    pushEchoReference(buffer, srcFrames);
+    {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(EchoReferenceCost));
+        pushEchoReference(buffer, srcFrames);
+    }
+
+    recordFlightSamples(AudioFlightRecorder::ClientWrite, buffer, srcFrames, streamSampleSpec());
 
     // Dump audio output before any conversion.
     // FOR DEBUG PURPOSE ONLY
     if (getDumpObjectBeforeConv() != NULL) {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(DumpCost));
         getDumpObjectBeforeConv()->dumpAudioSamples(buffer,
                                                     bytes,
                                                     isOut(),
                                                     streamSampleSpec().getSampleRate(),
                                                     streamSampleSpec().getChannelCount(),
-                                                    "before_conversion");
+                                                    "before_conversion",
+                                                    audio_bytes_per_sample(
+                                                        streamSampleSpec().getFormat()));
     }
 
+    uint64_t conversionStartNs = getMonotonicNs();
     status = applyAudioConversion(buffer, (void **)&dstBuf, srcFrames, &dstFrames);
+    recordLatency(Conversion, getMonotonicNs() - conversionStartNs);
 
     if (status != android::OK) {
         mStreamLock.unlock();
@@ -132,7 +145,17 @@ status_t StreamOut::write(const void *buffer, size_t &bytes)
 
     std::string error;
 
-    status = pcmWriteFrames(dstBuf, dstFrames, error);
+    recordFlightSamples(AudioFlightRecorder::PcmWrite, dstBuf, dstFrames, routeSampleSpec());
+    XrunCounters xrunsBefore = getXrunCounters();
+    uint64_t hwStartNs = getMonotonicNs();
+    {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(PcmCost));
+        AUDIO_TRACE_SCOPE("StreamOut::pcmWriteFrames");
+        status = pcmWriteFrames(dstBuf, dstFrames, error);
+    }
+    uint64_t hwNs = getMonotonicNs() - hwStartNs;
+    recordLatency(HwBlocking, hwNs);
+    uint32_t xruns = recordDeviceXrunsL(xrunsBefore);
 
     if (status < 0) {
         Log::Error() << __FUNCTION__ << ": write error: " << error
@@ -148,6 +171,10 @@ status_t StreamOut::write(const void *buffer, size_t &bytes)
         AUDIOCOMMS_ASSERT(error.find(strerror(EBADF)) == std::string::npos,
                           "Audio Device handle closed not by Audio HAL."
                           " A corruption might have happenned, investigation required");
+        if (xruns == 0) {
+            // The frames are dropped, accounted as an underrun all the same.
+            recordXrun();
+        }
         mStreamLock.unlock();
         generateSilence(bytes);
         return android::DEAD_OBJECT;
@@ -159,19 +186,23 @@ status_t StreamOut::write(const void *buffer, size_t &bytes)
     // Dump audio output after eventual conversions
     // FOR DEBUG PURPOSE ONLY
     if (getDumpObjectAfterConv() != NULL) {
+        AUDIO_CPU_COST_SCOPE(getCpuCost(DumpCost));
         getDumpObjectAfterConv()->dumpAudioSamples((const void *)dstBuf,
                                                    routeSampleSpec().convertFramesToBytes(
                                                        dstFrames),
                                                    isOut(),
                                                    routeSampleSpec().getSampleRate(),
                                                    routeSampleSpec().getChannelCount(),
-                                                   "after_conversion");
+                                                   "after_conversion",
+                                                   audio_bytes_per_sample(
+                                                       routeSampleSpec().getFormat()));
     }
     if (mFrameCount > (std::numeric_limits<uint64_t>::max() - srcFrames)) {
         Log::Error() << __FUNCTION__ << ": overflow detected, resetting framecount";
         mFrameCount = 0;
     }
     mFrameCount += srcFrames;
+    publishTelemetryL(mFrameCount, hwNs);
     mStreamLock.unlock();
     return status;
 }
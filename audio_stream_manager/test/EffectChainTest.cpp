@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <EffectChain.hpp>
+#include <audio_effects/effect_aec.h>
+#include <audio_effects/effect_agc.h>
+#include <audio_effects/effect_ns.h>
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <string.h>
+#include <vector>
+
+namespace intel_audio
+{
+
+/**
+ * Effect adding a constant to mono 16 bits samples, recording the order it was called in.
+ * The interface comes first so that the handle can be cast back to the effect.
+ */
+struct FakeEffect
+{
+    FakeEffect(const effect_uuid_t &type, int16_t offset, std::vector<int> *calls, int id)
+        : itfe(&gInterface), type(type), offset(offset), calls(calls), id(id), status(0),
+          keptFrames(0) {}
+
+    effect_handle_t handle() { return reinterpret_cast<effect_handle_t>(this); }
+
+    static int32_t process(effect_handle_t self, audio_buffer_t *in, audio_buffer_t *out)
+    {
+        FakeEffect *effect = reinterpret_cast<FakeEffect *>(self);
+        effect->calls->push_back(effect->id);
+        if (effect->status != 0) {
+            return effect->status;
+        }
+        for (size_t i = 0; i < in->frameCount; i++) {
+            out->s16[i] = in->s16[i] + effect->offset;
+        }
+        out->frameCount = in->frameCount - effect->keptFrames;
+        return 0;
+    }
+
+    static int32_t getDescriptor(effect_handle_t self, effect_descriptor_t *desc)
+    {
+        memset(desc, 0, sizeof(*desc));
+        desc->type = reinterpret_cast<FakeEffect *>(self)->type;
+        return 0;
+    }
+
+    const struct effect_interface_s *itfe;
+    effect_uuid_t type;
+    int16_t offset;
+    std::vector<int> *calls;
+    int id;
+    int status; /**< Returned by process instead of processing if not null. */
+    size_t keptFrames; /**< Frames not produced by process. */
+
+    static const struct effect_interface_s gInterface;
+};
+
+const struct effect_interface_s FakeEffect::gInterface = {
+    FakeEffect::process, NULL, FakeEffect::getDescriptor, NULL
+};
+
+static const size_t gFrames = 80;
+
+static const effect_uuid_t gOtherType = {
+    0x12345678, 0x1234, 0x1234, 0x1234, { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 }
+};
+
+class EffectChainTest : public ::testing::Test
+{
+protected:
+    EffectChainTest()
+        : mAgc(*FX_IID_AGC, 100, &mCalls, 3), mNs(*FX_IID_NS, 10, &mCalls, 2),
+          mAec(*FX_IID_AEC, 1, &mCalls, 1), mOther(gOtherType, 1000, &mCalls, 4),
+          mIn(gFrames), mOut(gFrames)
+    {
+        for (size_t i = 0; i < gFrames; i++) {
+            mIn[i] = i;
+        }
+    }
+
+    int process(EffectChain &chain, size_t &consumed, size_t &produced)
+    {
+        audio_buffer_t in;
+        in.frameCount = gFrames;
+        in.s16 = &mIn[0];
+        audio_buffer_t out;
+        out.frameCount = gFrames;
+        out.s16 = &mOut[0];
+        int ret = chain.process(in, out);
+        consumed = in.frameCount;
+        produced = out.frameCount;
+        return ret;
+    }
+
+    std::vector<int> mCalls;
+    FakeEffect mAgc;
+    FakeEffect mNs;
+    FakeEffect mAec;
+    FakeEffect mOther;
+    std::vector<int16_t> mIn;
+    std::vector<int16_t> mOut;
+};
+
+TEST_F(EffectChainTest, effectsRunInAcousticOrder)
+{
+    EffectChain chain;
+    ASSERT_EQ(android::OK, chain.configure(gFrames, sizeof(int16_t)));
+    EXPECT_EQ(android::OK, chain.add(mOther.handle()));
+    EXPECT_EQ(android::OK, chain.add(mAgc.handle()));
+    EXPECT_EQ(android::OK, chain.add(mNs.handle()));
+    EXPECT_EQ(android::OK, chain.add(mAec.handle()));
+    EXPECT_EQ(android::ALREADY_EXISTS, chain.add(mNs.handle()));
+
+    size_t consumed, produced;
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4}), mCalls);
+    EXPECT_EQ(gFrames, consumed);
+    EXPECT_EQ(gFrames, produced);
+    EXPECT_EQ(1111, mOut[0]);
+    EXPECT_EQ(1111 + 79, mOut[79]);
+    // Input left untouched
+    EXPECT_EQ(79, mIn[79]);
+
+    EXPECT_EQ(android::OK, chain.remove(mNs.handle()));
+    EXPECT_EQ(android::BAD_VALUE, chain.remove(mNs.handle()));
+    mCalls.clear();
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(std::vector<int>({1, 3, 4}), mCalls);
+    EXPECT_EQ(1101, mOut[0]);
+}
+
+TEST_F(EffectChainTest, pingPongEffects)
+{
+    EffectChain chain;
+    ASSERT_EQ(android::OK, chain.configure(gFrames, sizeof(int16_t)));
+    chain.add(mAec.handle(), false);
+    chain.add(mNs.handle());
+    chain.add(mAgc.handle(), false);
+
+    size_t consumed, produced;
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(111, mOut[0]);
+    EXPECT_EQ(111 + 42, mOut[42]);
+}
+
+TEST_F(EffectChainTest, disabledEffectsAreBypassed)
+{
+    EffectChain chain;
+    ASSERT_EQ(android::OK, chain.configure(gFrames, sizeof(int16_t)));
+    chain.add(mAec.handle(), false);
+    chain.add(mNs.handle(), false);
+    chain.add(mAgc.handle());
+    mNs.status = -ENODATA;
+
+    size_t consumed, produced;
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), mCalls);
+    EXPECT_EQ(101, mOut[0]);
+    EXPECT_EQ(gFrames, produced);
+}
+
+TEST_F(EffectChainTest, effectKeepingFrames)
+{
+    EffectChain chain;
+    ASSERT_EQ(android::OK, chain.configure(gFrames, sizeof(int16_t)));
+    chain.add(mNs.handle());
+    chain.add(mAgc.handle());
+    mNs.keptFrames = 30;
+
+    size_t consumed, produced;
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(gFrames, consumed);
+    EXPECT_EQ(gFrames - 30, produced);
+
+    // Nothing produced: next effects are not called
+    mNs.keptFrames = gFrames;
+    mCalls.clear();
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(std::vector<int>({2}), mCalls);
+    EXPECT_EQ(0u, produced);
+}
+
+TEST_F(EffectChainTest, errors)
+{
+    EffectChain chain;
+    size_t consumed, produced;
+    EXPECT_EQ(android::NO_INIT, process(chain, consumed, produced));
+
+    ASSERT_EQ(android::OK, chain.configure(gFrames / 2, sizeof(int16_t)));
+    chain.add(mNs.handle());
+    chain.add(mAgc.handle());
+    // Capacity of the chain
+    ASSERT_EQ(0, process(chain, consumed, produced));
+    EXPECT_EQ(gFrames / 2, consumed);
+    EXPECT_EQ(gFrames / 2, produced);
+
+    mNs.status = -EINVAL;
+    mCalls.clear();
+    EXPECT_EQ(-EINVAL, process(chain, consumed, produced));
+    EXPECT_EQ(std::vector<int>({2}), mCalls);
+    EXPECT_EQ(android::BAD_VALUE, chain.add(NULL));
+}
+
+} // namespace intel_audio
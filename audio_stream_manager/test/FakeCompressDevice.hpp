@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <OffloadFragmentPlanner.hpp>
+#include <tinycompress/tinycompress.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+/**
+ * Compress device advertising given caps, whose playback is simulated as the compress core
+ * behaves: the buffer is filled when started, the writer is woken up once a fragment is free and
+ * then fills the buffer back.
+ * Opened by a stream, it reports the frames rendered and the bytes queued the test sets, and
+ * its writes can be held as when the DSP has no free fragment.
+ */
+class FakeCompressDevice : public CompressDeviceBackend
+{
+public:
+    FakeCompressDevice(const CompressCaps &caps)
+        : mCaps(caps), mAvailable(true), mCapsQueries(0), mNowUs(1000000), mFrames(0),
+          mSampleRate(48000), mQueuedBytes(0), mTstampFails(false), mBufferBytes(0),
+          mWritesHeld(false), mHeldWrites(0) {}
+
+    virtual bool getCaps(uint32_t /*card*/, uint32_t /*device*/, CompressCaps &caps)
+    {
+        mCapsQueries++;
+        caps = mCaps;
+        return mAvailable;
+    }
+
+    /**
+     * Play for a while, reporting the wakeups of the writer to the planner.
+     *
+     * @param[in] planner to report to.
+     * @param[in] plan the device is opened with.
+     * @param[in] bitRate of the stream in bps.
+     * @param[in] durationMs of the playback.
+     * @param[in] writerLatencyMs time the writer takes to fill the buffer once woken up.
+     *
+     * @return number of underruns, i.e. wakeups served after the buffer went empty.
+     */
+    uint32_t play(OffloadFragmentPlanner &planner, const OffloadFragmentPlanner::Plan &plan,
+                  uint32_t bitRate, uint32_t durationMs, uint32_t writerLatencyMs = 0)
+    {
+        uint64_t bufferUs = static_cast<uint64_t>(plan.fragments) * plan.fragmentSize * 8 *
+                            1000000 / bitRate;
+        uint64_t fragmentUs = static_cast<uint64_t>(plan.fragmentSize) * 8 * 1000000 / bitRate;
+        uint64_t endUs = mNowUs + static_cast<uint64_t>(durationMs) * 1000;
+        uint32_t underruns = 0;
+        while (mNowUs + fragmentUs <= endUs) {
+            // Full buffer after each write, poll signals once a fragment worth was consumed
+            mNowUs += fragmentUs;
+            planner.onWakeup(mNowUs);
+            if (fragmentUs + static_cast<uint64_t>(writerLatencyMs) * 1000 > bufferUs) {
+                underruns++;
+                planner.onUnderrun();
+            }
+        }
+        planner.onInterrupted();
+        return underruns;
+    }
+
+    /** Writes block from now on, until released. */
+    void holdWrites()
+    {
+        std::lock_guard<std::mutex> locker(mWriteLock);
+        mWritesHeld = true;
+    }
+
+    void releaseWrites()
+    {
+        std::lock_guard<std::mutex> locker(mWriteLock);
+        mWritesHeld = false;
+        mWriteCond.notify_all();
+    }
+
+    /** @return true once a write is blocked, false on timeout. */
+    bool waitHeldWrite(uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> locker(mWriteLock);
+        return mWriteCond.wait_for(locker, std::chrono::milliseconds(timeoutMs),
+                                   [this]() { return mHeldWrites != 0; });
+    }
+
+    virtual int getCardIndex(const char * /*name*/) { return 0; }
+    virtual int getDeviceIndex() { return 0; }
+
+    virtual struct compress *open(unsigned int /*card*/, unsigned int /*device*/,
+                                  unsigned int /*flags*/, struct compr_config *config)
+    {
+        mBufferBytes = config->fragment_size * config->fragments;
+        return reinterpret_cast<struct compress *>(this);
+    }
+
+    virtual void close(struct compress * /*compress*/) {}
+    virtual bool isReady(struct compress * /*compress*/) { return true; }
+    virtual const char *getError(struct compress * /*compress*/) { return "fake"; }
+    virtual void setNonBlocking(struct compress * /*compress*/, bool /*nonBlocking*/) {}
+
+    virtual int setGaplessMetadata(struct compress * /*compress*/,
+                                   struct compr_gapless_mdata * /*metadata*/)
+    {
+        return 0;
+    }
+
+    virtual int write(struct compress * /*compress*/, const void * /*buffer*/, size_t bytes)
+    {
+        std::unique_lock<std::mutex> locker(mWriteLock);
+        mHeldWrites++;
+        mWriteCond.notify_all();
+        mWriteCond.wait(locker, [this]() { return !mWritesHeld; });
+        mHeldWrites--;
+        return static_cast<int>(bytes);
+    }
+
+    virtual int start(struct compress * /*compress*/) { return 0; }
+    virtual int stop(struct compress * /*compress*/) { return 0; }
+    virtual int pause(struct compress * /*compress*/) { return 0; }
+    virtual int resume(struct compress * /*compress*/) { return 0; }
+    virtual int wait(struct compress * /*compress*/, int /*timeoutMs*/) { return 0; }
+    virtual int drain(struct compress * /*compress*/) { return 0; }
+    virtual int partialDrain(struct compress * /*compress*/) { return 0; }
+    virtual int nextTrack(struct compress * /*compress*/) { return 0; }
+
+    virtual int getTstamp(struct compress * /*compress*/, unsigned long *frames,
+                          unsigned int *sampleRate)
+    {
+        if (mTstampFails) {
+            return -EIO;
+        }
+        *frames = mFrames;
+        *sampleRate = mSampleRate;
+        return 0;
+    }
+
+    virtual int getHpointer(struct compress * /*compress*/, unsigned int *available,
+                            struct timespec *timestamp)
+    {
+        *available = mBufferBytes - std::min<unsigned int>(mQueuedBytes, mBufferBytes);
+        timestamp->tv_sec = 0;
+        timestamp->tv_nsec = 0;
+        return 0;
+    }
+
+    CompressCaps mCaps;
+    bool mAvailable;
+    uint32_t mCapsQueries;
+    uint64_t mNowUs;
+
+    std::atomic<unsigned long> mFrames; /**< Rendered, as reported by the timestamp. */
+    std::atomic<unsigned int> mSampleRate;
+    std::atomic<unsigned int> mQueuedBytes; /**< Written but not consumed by the DSP yet. */
+    std::atomic<bool> mTstampFails;
+
+private:
+    unsigned int mBufferBytes; /**< As opened. */
+    std::mutex mWriteLock;
+    std::condition_variable mWriteCond;
+    bool mWritesHeld;
+    uint32_t mHeldWrites;
+};
+
+} // namespace intel_audio
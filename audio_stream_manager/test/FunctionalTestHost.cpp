@@ -14,14 +14,25 @@
  * limitations under the License.
  */
 #include "FunctionalTestHost.hpp"
+#include "FakeCompressDevice.hpp"
+#include <CompressedStreamOut.hpp>
+#include <StreamIn.hpp>
+#include <AudioTrace.hpp>
+#include <UEventStandIn.hpp>
 #include <media/AudioParameter.h>
 #include <KeyValuePairs.hpp>
 #include <AudioCommsAssert.hpp>
 #include <utilities/Log.hpp>
 #include <utils/Vector.h>
+#include <hardware/audio_effect.h>
 
 #include <iostream>
 #include <algorithm>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
 
 using namespace android;
 using namespace std;
@@ -29,6 +40,151 @@ using audio_comms::utilities::Log;
 
 intel_audio::Device *AudioHalTest::mDevice = NULL;
 
+/** Startup time budget of the HAL, i.e. creation of the Device with the PFW test configuration. */
+static const uint64_t gStartupBudgetUs = 1000000;
+
+/** Budget of the routing replay once the audio subsystem recovered from a crash. */
+static const uint64_t gRecoveryBudgetUs = 100000;
+
+/** Delay to wait for the route manager to handle an injected uevent. */
+static const uint32_t gUEventTimeoutMs = 1000;
+
+static uint64_t getMonotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * Wait for the count of crashes or recoveries handled by the route manager to reach a value.
+ *
+ * @return true if reached, false on timeout.
+ */
+static bool waitRecoveryCount(uint32_t intel_audio::RoutingRecovery::Stats::*count,
+                              uint32_t expected)
+{
+    for (uint32_t ms = 0; ms < gUEventTimeoutMs; ms++) {
+        if (AudioHalTest::getDevice()->getRecoveryStats().*count == expected) {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+/** Delay to wait for the route manager to handle an asynchronous routing. */
+static const uint32_t gRoutingTimeoutMs = 1000;
+
+/**
+ * Wait for the count of routing passes executed by the route manager to exceed a value.
+ *
+ * @return true if exceeded, false on timeout.
+ */
+static bool waitRoutingCountAbove(uint32_t count)
+{
+    for (uint32_t ms = 0; ms < gRoutingTimeoutMs; ms++) {
+        if (AudioHalTest::getDevice()->getEffectUpdateStats().routingCount > count) {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+/** Noise suppression as implemented by the audio DSP, i.e. applied by the route, not by the HAL. */
+static int32_t getDspNoiseSuppressionDescriptor(effect_handle_t, effect_descriptor_t *descriptor)
+{
+    memset(descriptor, 0, sizeof(*descriptor));
+    strncpy(descriptor->name, "Noise Suppression", sizeof(descriptor->name) - 1);
+    strncpy(descriptor->implementor, "IntelLPE", sizeof(descriptor->implementor) - 1);
+    return 0;
+}
+
+static struct effect_interface_s gDspNoiseSuppression = {
+    NULL, NULL, getDspNoiseSuppressionDescriptor, NULL
+};
+static struct effect_interface_s *gDspNoiseSuppressionItfe = &gDspNoiseSuppression;
+
+/**
+ * Format the routing passes of a trace, i.e. what the executeRouting scopes enclose: the device
+ * openings and closings with their route, and the configurations applied by the PFW. Successive
+ * configurations are formatted once, their count depending on the criteria changed.
+ *
+ * @return the events, with their phase, as a single string.
+ */
+static string getRoutingTimeline(const vector<intel_audio::AudioTrace::Event> &events)
+{
+    static const char *const phases[] = { "+", "-", "#", "!" };
+    static const string routing = "AudioRouteManager::executeRouting";
+    static const string pfwConfiguration = "+Pfw::applyConfiguration -Pfw::applyConfiguration ";
+    string timeline;
+    bool inRouting = false;
+    for (const auto &event : events) {
+        string name = event.name;
+        if (name == routing) {
+            inRouting = (event.type == intel_audio::AudioTrace::Begin);
+        } else if (!inRouting ||
+                   (name != "Pfw::applyConfiguration" &&
+                    name != "AudioStreamRoute::openDevice" &&
+                    name != "AudioStreamRoute::closeDevice")) {
+            continue;
+        }
+        if (event.detail != NULL && name != "Pfw::applyConfiguration") {
+            name += string("(") + event.detail + ")";
+        }
+        timeline += phases[event.type] + name + " ";
+        if (timeline.size() >= 2 * pfwConfiguration.size() &&
+            timeline.compare(timeline.size() - 2 * pfwConfiguration.size(),
+                             pfwConfiguration.size(), pfwConfiguration) == 0 &&
+            timeline.compare(timeline.size() - pfwConfiguration.size(),
+                             pfwConfiguration.size(), pfwConfiguration) == 0) {
+            timeline.resize(timeline.size() - pfwConfiguration.size());
+        }
+    }
+    return timeline;
+}
+
+void AudioHalTest::openStartedInput(audio_io_handle_t handle, audio_source_t source,
+                                    intel_audio::StreamInInterface * &inStream,
+                                    audio_patch_handle_t &patch)
+{
+    audio_config_t config;
+    setConfig(48000, AUDIO_CHANNEL_IN_STEREO, AUDIO_FORMAT_PCM_16_BIT, config);
+    ASSERT_EQ(android::OK, getDevice()->openInputStream(handle, AUDIO_DEVICE_IN_BUILTIN_MIC,
+                                                        config, inStream,
+                                                        AUDIO_INPUT_FLAG_NONE, "", source));
+
+    // Routed by the policy from the builtin mic to the mix of the stream
+    struct audio_port_config mic;
+    memset(&mic, 0, sizeof(mic));
+    mic.id = handle + 1;
+    mic.role = AUDIO_PORT_ROLE_SOURCE;
+    mic.type = AUDIO_PORT_TYPE_DEVICE;
+    mic.ext.device.type = AUDIO_DEVICE_IN_BUILTIN_MIC;
+    struct audio_port_config mix;
+    memset(&mix, 0, sizeof(mix));
+    mix.id = handle + 2;
+    mix.role = AUDIO_PORT_ROLE_SINK;
+    mix.type = AUDIO_PORT_TYPE_MIX;
+    mix.ext.mix.handle = handle;
+    mix.ext.mix.usecase.source = source;
+    ASSERT_EQ(android::OK, getDevice()->createAudioPatch(1, &mic, 1, &mix, patch));
+
+    // The first read starts the stream, routed synchronously
+    std::vector<char> buffer(inStream->getBufferSize());
+    size_t bytes = buffer.size();
+    ASSERT_EQ(android::OK, inStream->read(buffer.data(), bytes));
+}
+
+void AudioHalTest::closeInput(intel_audio::StreamInInterface *inStream,
+                              audio_patch_handle_t patch)
+{
+    EXPECT_EQ(android::OK, inStream->standby());
+    EXPECT_EQ(android::OK, getDevice()->releaseAudioPatch(patch));
+    getDevice()->closeInputStream(inStream);
+}
+
 void AudioHalTest::setConfig(uint32_t rate, audio_channel_mask_t mask, audio_format_t format,
                              audio_config_t &config)
 {
@@ -164,6 +320,262 @@ TEST_F(AudioHalTest, audioRecordingBufferSize)
     ASSERT_EQ(48u * 20 * 2 * 2, getDevice()->getInputBufferSize(config));
 }
 
+TEST_F(AudioHalTest, startupBudget)
+{
+    const intel_audio::StartupProfiler &profiler = getDevice()->getStartupProfiler();
+    ASSERT_TRUE(profiler.isComplete());
+    EXPECT_FALSE(profiler.getPhases().empty());
+    EXPECT_LT(profiler.getTotalUs(), gStartupBudgetUs) << profiler.getReport();
+}
+
+TEST_F(AudioHalTest, subsystemRecovery)
+{
+    typedef intel_audio::RoutingRecovery::Stats Stats;
+    using intel_audio::UEventStandIn;
+    Stats stats = getDevice()->getRecoveryStats();
+
+    // Uevents not related to the audio subsystem are ignored
+    ASSERT_TRUE(UEventStandIn::inject({"change@/devices/platform/sst", "ACTION=change"}));
+
+    ASSERT_TRUE(UEventStandIn::inject({"change@/devices/platform/sst", "ACTION=change",
+                                       "EVENT_TYPE=SST_CRASHED"}));
+    ASSERT_TRUE(waitRecoveryCount(&Stats::crashCount, stats.crashCount + 1));
+
+    // A repeated crash event is not a new crash
+    ASSERT_TRUE(UEventStandIn::inject({"EVENT_TYPE=SST_CRASHED"}));
+    ASSERT_TRUE(UEventStandIn::inject({"change@/devices/platform/sst", "ACTION=change",
+                                       "EVENT_TYPE=SST_RECOVERY"}));
+    ASSERT_TRUE(waitRecoveryCount(&Stats::recoveryCount, stats.recoveryCount + 1));
+
+    Stats recovered = getDevice()->getRecoveryStats();
+    EXPECT_EQ(stats.crashCount + 1, recovered.crashCount);
+    EXPECT_EQ(0u, recovered.lastMissingStreams);
+    EXPECT_LT(recovered.lastRecoveryUs, gRecoveryBudgetUs);
+    Log::Debug() << "Recovered in " << recovered.lastRecoveryUs << " us";
+}
+
+/**
+ * Position queries of an offload stream while a write holds the codec lock, blocked until the DSP
+ * frees a fragment: they shall not wait for the write, nor go backwards once it is done.
+ */
+TEST_F(AudioHalTest, offloadPositionUnderBlockingWrite)
+{
+    static const uint64_t blockingWriteNs = 200000000;
+    static const uint64_t maxQueryLatencyNs = 10000000;
+    static const intel_audio::CompressCaps caps = {
+        2 * 1024, 128 * 1024, 2, 8
+    };
+    intel_audio::FakeCompressDevice compress(caps);
+    intel_audio::CompressedStreamOut stream(getDevice(), 0, AUDIO_OUTPUT_FLAG_DIRECT |
+                                            AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD,
+                                            AUDIO_DEVICE_OUT_SPEAKER, "", &compress);
+    audio_config_t config = AUDIO_CONFIG_INITIALIZER;
+    setConfig(48000, AUDIO_CHANNEL_OUT_STEREO, AUDIO_FORMAT_MP3, config);
+    config.offload_info.bit_rate = 128000;
+    ASSERT_EQ(android::OK, stream.set(config));
+
+    // 100 ms of audio queued to the DSP at 128 kbps
+    compress.mFrames = 48000;
+    compress.mQueuedBytes = 1600;
+    std::vector<char> buffer(stream.getBufferSize());
+    size_t bytes = buffer.size();
+    ASSERT_EQ(android::OK, stream.write(buffer.data(), bytes));
+
+    compress.holdWrites();
+    std::thread writer([&]() {
+        size_t heldBytes = buffer.size();
+        stream.write(buffer.data(), heldBytes);
+    });
+    ASSERT_TRUE(compress.waitHeldWrite(1000));
+
+    uint64_t maxLatencyNs = 0;
+    uint64_t lastFrames = 0;
+    uint32_t queries = 0;
+    for (uint64_t endNs = getMonotonicNs() + blockingWriteNs; getMonotonicNs() < endNs;) {
+        uint64_t frames;
+        struct timespec timestamp;
+        uint64_t startNs = getMonotonicNs();
+        EXPECT_EQ(android::OK, stream.getPresentationPosition(frames, timestamp));
+        maxLatencyNs = std::max(maxLatencyNs, getMonotonicNs() - startNs);
+        EXPECT_GE(frames, lastFrames);
+        lastFrames = frames;
+        queries++;
+        usleep(1000);
+    }
+    EXPECT_GT(queries, 10u);
+    EXPECT_LT(maxLatencyNs, maxQueryLatencyNs);
+    // Interpolated from the last position, no further than the audio queued
+    EXPECT_EQ(48000u + 4800, lastFrames);
+
+    // The DSP reports less than was interpolated: the position holds until it catches up
+    compress.mFrames = 48000 + 100;
+    compress.releaseWrites();
+    writer.join();
+    uint64_t frames;
+    struct timespec timestamp;
+    ASSERT_EQ(android::OK, stream.getPresentationPosition(frames, timestamp));
+    EXPECT_GE(frames, lastFrames);
+
+    // The DSP cannot be queried: no position rather than a stale one
+    compress.mTstampFails = true;
+    bytes = buffer.size();
+    ASSERT_EQ(android::OK, stream.write(buffer.data(), bytes));
+    uint32_t dspFrames;
+    EXPECT_EQ(-EINVAL, stream.getRenderPosition(dspFrames));
+    EXPECT_EQ(-EINVAL, stream.getPresentationPosition(frames, timestamp));
+}
+
+/**
+ * Effects toggled on a running capture whose route implements them: the audio path is updated
+ * without going through the routing stages, the stream stays attached to its opened device.
+ */
+TEST_F(AudioHalTest, effectToggledInPlace)
+{
+    static const audio_io_handle_t handle = 0x100;
+    intel_audio::StreamInInterface *inStream = NULL;
+    audio_patch_handle_t patch;
+    ASSERT_NO_FATAL_FAILURE(openStartedInput(handle, AUDIO_SOURCE_MIC, inStream, patch));
+    intel_audio::StreamIn *in = static_cast<intel_audio::StreamIn *>(inStream);
+    ASSERT_TRUE(in->isRouted());
+
+    intel_audio::AudioRouteManager::EffectUpdateStats stats = getDevice()->getEffectUpdateStats();
+    intel_audio::AudioTrace::clear();
+    intel_audio::AudioTrace::setEnabled(true);
+    EXPECT_EQ(android::OK, inStream->addAudioEffect(&gDspNoiseSuppressionItfe));
+    EXPECT_TRUE(in->isRouted());
+    EXPECT_EQ(android::OK, inStream->removeAudioEffect(&gDspNoiseSuppressionItfe));
+    intel_audio::AudioTrace::setEnabled(false);
+
+    intel_audio::AudioRouteManager::EffectUpdateStats toggled = getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(stats.inPlaceCount + 2, toggled.inPlaceCount);
+    EXPECT_EQ(stats.reroutingCount, toggled.reroutingCount);
+    EXPECT_EQ(stats.routingCount, toggled.routingCount);
+    EXPECT_TRUE(in->isRouted());
+
+    // Neither muted nor reopened
+    std::vector<intel_audio::AudioTrace::Event> events;
+    intel_audio::AudioTrace::snapshot(events);
+    for (const auto &event : events) {
+        EXPECT_STRNE("AudioRouteManager::executeMuteRoutingStage", event.name);
+        EXPECT_STRNE("AudioStreamRoute::openDevice", event.name);
+    }
+    intel_audio::AudioTrace::clear();
+
+    closeInput(inStream, patch);
+}
+
+/**
+ * Effect requested on a running capture whose route does not implement it: the route manager
+ * refuses to apply it in place, the routing is reconsidered instead.
+ */
+TEST_F(AudioHalTest, effectNotImplementedReroutes)
+{
+    static const audio_io_handle_t handle = 0x200;
+    intel_audio::StreamInInterface *inStream = NULL;
+    audio_patch_handle_t patch;
+    ASSERT_NO_FATAL_FAILURE(openStartedInput(handle, AUDIO_SOURCE_UNPROCESSED, inStream, patch));
+    intel_audio::StreamIn *in = static_cast<intel_audio::StreamIn *>(inStream);
+    ASSERT_TRUE(in->isRouted());
+
+    intel_audio::AudioRouteManager::EffectUpdateStats stats = getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(android::OK, inStream->addAudioEffect(&gDspNoiseSuppressionItfe));
+    intel_audio::AudioRouteManager::EffectUpdateStats requested =
+        getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(stats.inPlaceCount, requested.inPlaceCount);
+    EXPECT_EQ(stats.reroutingCount + 1, requested.reroutingCount);
+
+    // No route implements the effect for unprocessed capture
+    ASSERT_TRUE(waitRoutingCountAbove(requested.routingCount));
+    EXPECT_FALSE(in->isRouted());
+
+    // Once removed, the stream gets its route back through another routing pass
+    requested = getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(android::OK, inStream->removeAudioEffect(&gDspNoiseSuppressionItfe));
+    EXPECT_EQ(requested.reroutingCount + 1, getDevice()->getEffectUpdateStats().reroutingCount);
+    ASSERT_TRUE(waitRoutingCountAbove(requested.routingCount));
+    EXPECT_TRUE(in->isRouted());
+
+    closeInput(inStream, patch);
+}
+
+/**
+ * Effect removed from a capture whose route was only elected for that effect: the route still
+ * implements the remaining effects, yet a preceding route without effects matches the stream
+ * better, so the routing is reconsidered rather than applied in place.
+ */
+TEST_F(AudioHalTest, effectRemovedReroutesToBetterRoute)
+{
+    static const audio_io_handle_t handle = 0x280;
+    intel_audio::StreamInInterface *inStream = NULL;
+    audio_patch_handle_t patch;
+    ASSERT_NO_FATAL_FAILURE(openStartedInput(handle, AUDIO_SOURCE_VOICE_RECOGNITION, inStream,
+                                             patch));
+    intel_audio::StreamIn *in = static_cast<intel_audio::StreamIn *>(inStream);
+    ASSERT_TRUE(in->isRouted());
+
+    // Only the Media route implements the effect: the stream leaves the Raw route
+    intel_audio::AudioRouteManager::EffectUpdateStats stats = getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(android::OK, inStream->addAudioEffect(&gDspNoiseSuppressionItfe));
+    EXPECT_EQ(stats.reroutingCount + 1, getDevice()->getEffectUpdateStats().reroutingCount);
+    ASSERT_TRUE(waitRoutingCountAbove(stats.routingCount));
+    EXPECT_TRUE(in->isRouted());
+
+    // Once removed, the Raw route is elected again
+    stats = getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(android::OK, inStream->removeAudioEffect(&gDspNoiseSuppressionItfe));
+    intel_audio::AudioRouteManager::EffectUpdateStats removed =
+        getDevice()->getEffectUpdateStats();
+    EXPECT_EQ(stats.inPlaceCount, removed.inPlaceCount);
+    EXPECT_EQ(stats.reroutingCount + 1, removed.reroutingCount);
+    ASSERT_TRUE(waitRoutingCountAbove(removed.routingCount));
+    EXPECT_TRUE(in->isRouted());
+
+    closeInput(inStream, patch);
+}
+
+/**
+ * Timeline of the routing passes forced by starting then stopping a capture: the device of the
+ * route is opened once the paths are configured, and closed before they are disabled.
+ */
+TEST_F(AudioHalTest, routingTimeline)
+{
+    static const audio_io_handle_t handle = 0x300;
+    intel_audio::AudioTrace::clear();
+    intel_audio::AudioTrace::setEnabled(true);
+    intel_audio::StreamInInterface *inStream = NULL;
+    audio_patch_handle_t patch;
+    ASSERT_NO_FATAL_FAILURE(openStartedInput(handle, AUDIO_SOURCE_MIC, inStream, patch));
+    closeInput(inStream, patch);
+    intel_audio::AudioTrace::setEnabled(false);
+
+    vector<intel_audio::AudioTrace::Event> events;
+    intel_audio::AudioTrace::snapshot(events);
+    intel_audio::AudioTrace::clear();
+    EXPECT_EQ("+AudioRouteManager::executeRouting "
+              "+Pfw::applyConfiguration -Pfw::applyConfiguration "
+              "+AudioStreamRoute::openDevice(Media) -AudioStreamRoute::openDevice "
+              "+Pfw::applyConfiguration -Pfw::applyConfiguration "
+              "-AudioRouteManager::executeRouting "
+              "+AudioRouteManager::executeRouting "
+              "+Pfw::applyConfiguration -Pfw::applyConfiguration "
+              "+AudioStreamRoute::closeDevice(Media) -AudioStreamRoute::closeDevice "
+              "+Pfw::applyConfiguration -Pfw::applyConfiguration "
+              "-AudioRouteManager::executeRouting ", getRoutingTimeline(events));
+
+    // The passes run on the thread of the route manager, not on the one of the stream
+    pid_t routingTid = 0;
+    for (const auto &event : events) {
+        if (string(event.name) == "AudioRouteManager::executeRouting") {
+            routingTid = event.tid;
+        }
+    }
+    for (const auto &event : events) {
+        if (string(event.name) == "StreamIn::read") {
+            EXPECT_NE(routingTid, event.tid);
+        }
+    }
+}
+
 TEST_P(AudioHalInputStreamSupportedInputSourceTest, inputSource)
 {
     audio_config_t config;
@@ -42,6 +42,21 @@ public:
     void setConfig(uint32_t rate, audio_channel_mask_t mask, audio_format_t format,
                    audio_config_t &config);
 
+    /**
+     * Open an input stream routed by the policy from the builtin mic, and start it.
+     *
+     * @param[in] handle of the stream, its ports are numbered after it.
+     * @param[in] source of the capture.
+     * @param[out] inStream opened.
+     * @param[out] patch routing the stream.
+     */
+    void openStartedInput(audio_io_handle_t handle, audio_source_t source,
+                          intel_audio::StreamInInterface * &inStream,
+                          audio_patch_handle_t &patch);
+
+    /** Stop and close an input stream opened by openStartedInput. */
+    void closeInput(intel_audio::StreamInInterface *inStream, audio_patch_handle_t patch);
+
     virtual ~AudioHalTest() {}
 
 protected:
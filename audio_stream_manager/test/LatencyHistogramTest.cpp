@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <LatencyHistogram.hpp>
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+namespace intel_audio
+{
+
+TEST(LatencyHistogram, bucketsAreContiguous)
+{
+    EXPECT_EQ(0u, LatencyHistogram::getBucketLowerUs(0));
+    for (size_t bucket = 1; bucket < LatencyHistogram::mNbBuckets; bucket++) {
+        uint64_t lowerUs = LatencyHistogram::getBucketLowerUs(bucket);
+        ASSERT_GT(lowerUs, LatencyHistogram::getBucketLowerUs(bucket - 1));
+        EXPECT_EQ(bucket, LatencyHistogram::getBucket(lowerUs));
+        EXPECT_EQ(bucket - 1, LatencyHistogram::getBucket(lowerUs - 1));
+    }
+    // Durations out of range fall in the last bucket
+    EXPECT_EQ(LatencyHistogram::mNbBuckets - 1, LatencyHistogram::getBucket(UINT64_MAX));
+}
+
+TEST(LatencyHistogram, percentilesWithinBucket)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.getPercentileUs(50));
+
+    // 1 to 1000 us, each once
+    for (uint64_t us = 1; us <= 1000; us++) {
+        histogram.record(us * 1000);
+    }
+    EXPECT_EQ(1000u, histogram.getCount());
+    EXPECT_EQ(1000u, histogram.getMaxUs());
+
+    static const double percents[] = { 50, 90, 99 };
+    for (double percent : percents) {
+        uint64_t exactUs = percent * 10;
+        uint64_t percentileUs = histogram.getPercentileUs(percent);
+        EXPECT_GE(percentileUs, exactUs) << percent;
+        EXPECT_LE(percentileUs, exactUs * 5 / 4 + 1) << percent;
+    }
+    EXPECT_EQ(1000u, histogram.getPercentileUs(100));
+
+    histogram.reset();
+    EXPECT_EQ(0u, histogram.getCount());
+    EXPECT_EQ(0u, histogram.getMaxUs());
+    EXPECT_EQ(0u, histogram.getPercentileUs(99));
+}
+
+TEST(LatencyHistogram, outlierOnlyInTail)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 999; i++) {
+        histogram.record(5000 * 1000);
+    }
+    histogram.record(80 * 1000 * 1000);
+
+    EXPECT_LE(histogram.getPercentileUs(99), 6144u);
+    EXPECT_EQ(80000u, histogram.getPercentileUs(99.95));
+    EXPECT_EQ(80000u, histogram.getMaxUs());
+}
+
+} // namespace intel_audio
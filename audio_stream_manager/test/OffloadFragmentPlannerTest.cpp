@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FakeCompressDevice.hpp"
+#include <OffloadFragmentPlanner.hpp>
+#include <sound/compress_params.h>
+#include <gtest/gtest.h>
+
+namespace intel_audio
+{
+
+static const uint32_t gCard = 0;
+static const uint32_t gDevice = 1;
+static const CompressCaps gCaps = {
+    2 * 1024, 128 * 1024, 2, 8
+};
+
+typedef OffloadFragmentPlanner::Plan Plan;
+
+TEST(OffloadFragmentPlanner, planFollowsBitRate)
+{
+    FakeCompressDevice device(gCaps);
+    OffloadFragmentPlanner planner(&device);
+
+    Plan plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 64000);
+    EXPECT_EQ(32768u, plan.fragmentSize);
+    EXPECT_EQ(2u, plan.fragments);
+    EXPECT_EQ(4096u, plan.wakeupIntervalMs);
+    EXPECT_EQ(1u, device.mCapsQueries);
+
+    // Fragment size capped by the driver, more fragments to hold the interval
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 320000);
+    EXPECT_EQ(131072u, plan.fragmentSize);
+    EXPECT_EQ(3u, plan.fragments);
+    EXPECT_EQ(3276u, plan.wakeupIntervalMs);
+}
+
+TEST(OffloadFragmentPlanner, planWithinDriverCaps)
+{
+    CompressCaps caps = {
+        4 * 1024, 16 * 1024, 4, 6
+    };
+    FakeCompressDevice device(caps);
+    OffloadFragmentPlanner planner(&device);
+
+    Plan plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 64000);
+    EXPECT_EQ(16384u, plan.fragmentSize);
+    EXPECT_EQ(4u, plan.fragments);
+
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 128000);
+    EXPECT_EQ(16384u, plan.fragmentSize);
+    EXPECT_EQ(6u, plan.fragments);
+
+    // Driver not answering: historical limits
+    device.mAvailable = false;
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 128000);
+    EXPECT_EQ(65536u, plan.fragmentSize);
+    EXPECT_EQ(2u, plan.fragments);
+}
+
+TEST(OffloadFragmentPlanner, fragmentHoldsCodecFrame)
+{
+    FakeCompressDevice device(gCaps);
+    OffloadFragmentPlanner planner(&device);
+    planner.setWakeupIntervals(100, 100);
+
+    Plan plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_AAC, 6, 24000);
+    EXPECT_EQ(6u * 768, plan.fragmentSize);
+    EXPECT_EQ(2u, plan.fragments);
+
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 24000);
+    EXPECT_EQ(2048u, plan.fragmentSize);
+}
+
+TEST(OffloadFragmentPlanner, bufferingGrowsOnSteadyPlayback)
+{
+    FakeCompressDevice device(gCaps);
+    OffloadFragmentPlanner planner(&device);
+    const uint32_t bitRate = 64000;
+
+    Plan plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, bitRate);
+    EXPECT_EQ(0u, device.play(planner, plan, bitRate, 60000));
+    EXPECT_EQ(14u, planner.getStats().wakeups);
+    EXPECT_EQ(0u, planner.getStats().wakeupsPerMinute);
+    EXPECT_EQ(1u, planner.getStats().level);
+
+    // Applied on next start only
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, bitRate);
+    EXPECT_EQ(65536u, plan.fragmentSize);
+    EXPECT_EQ(8192u, plan.wakeupIntervalMs);
+    EXPECT_EQ(0u, device.play(planner, plan, bitRate, 120000));
+    EXPECT_EQ(7u, planner.getStats().wakeupsPerMinute);
+    EXPECT_EQ(2u, planner.getStats().level);
+
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, bitRate);
+    EXPECT_EQ(131072u, plan.fragmentSize);
+    EXPECT_EQ(0u, device.play(planner, plan, bitRate, 120000));
+    EXPECT_EQ(3u, planner.getStats().wakeupsPerMinute);
+
+    // Ceiling reached
+    OffloadFragmentPlanner::Stats stats = planner.getStats();
+    EXPECT_EQ(2u, stats.level);
+    EXPECT_EQ(2u, stats.maxLevel);
+    EXPECT_EQ(2u, stats.promotions);
+}
+
+TEST(OffloadFragmentPlanner, interruptedPlaybackIsNotSteady)
+{
+    FakeCompressDevice device(gCaps);
+    OffloadFragmentPlanner planner(&device);
+
+    Plan plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, 64000);
+    device.play(planner, plan, 64000, 30000);
+    device.play(planner, plan, 64000, 30000);
+    EXPECT_EQ(14u, planner.getStats().wakeups);
+    EXPECT_EQ(0u, planner.getStats().level);
+
+    // No growth allowed
+    planner.setWakeupIntervals(4000, 4000);
+    device.play(planner, plan, 64000, 60000);
+    EXPECT_EQ(0u, planner.getStats().maxLevel);
+    EXPECT_EQ(0u, planner.getStats().level);
+}
+
+TEST(OffloadFragmentPlanner, underrunFallsBackToBaseInterval)
+{
+    FakeCompressDevice device(gCaps);
+    OffloadFragmentPlanner planner(&device);
+    const uint32_t bitRate = 64000;
+
+    Plan plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, bitRate);
+    device.play(planner, plan, bitRate, 60000);
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, bitRate);
+    EXPECT_EQ(1u, planner.getStats().level);
+
+    // Writer slower than the buffered duration
+    EXPECT_NE(0u, device.play(planner, plan, bitRate, 30000, 10000));
+    EXPECT_EQ(0u, planner.getStats().level);
+    plan = planner.plan(gCard, gDevice, SND_AUDIOCODEC_MP3, 2, bitRate);
+    EXPECT_EQ(32768u, plan.fragmentSize);
+}
+
+} // namespace intel_audio
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <PositionSnapshot.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+namespace intel_audio
+{
+
+typedef PositionSnapshot::Position Position;
+
+/** Position whose fields all derive from a counter, so that a torn read can be told. */
+static Position makePosition(uint32_t counter)
+{
+    Position position = {
+        counter, counter, counter, static_cast<int>(counter), (counter & 1) != 0,
+        (counter & 2) != 0, counter, 0
+    };
+    return position;
+}
+
+static bool isConsistent(const Position &position)
+{
+    return position.sampleRate == position.frames && position.timestampNs == position.frames &&
+           static_cast<uint32_t>(position.state) == position.frames &&
+           position.running == ((position.frames & 1) != 0) &&
+           position.valid == ((position.frames & 2) != 0) &&
+           position.maxInterpolationNs == position.frames;
+}
+
+TEST(PositionSnapshot, interpolation)
+{
+    Position position = {
+        48000, 48000, 1000000000, 0, true, true, 500000000, 0
+    };
+    EXPECT_EQ(48000u, PositionSnapshot::getFramesAt(position, 1000000000));
+    EXPECT_EQ(48000u + 4800, PositionSnapshot::getFramesAt(position, 1100000000));
+    // Bounded
+    EXPECT_EQ(48000u + 24000, PositionSnapshot::getFramesAt(position, 3000000000));
+    // Stopped
+    position.running = false;
+    EXPECT_EQ(48000u, PositionSnapshot::getFramesAt(position, 1100000000));
+
+    PositionSnapshot snapshot;
+    EXPECT_EQ(0u, snapshot.read().frames);
+    snapshot.publish(makePosition(3));
+    EXPECT_TRUE(isConsistent(snapshot.read()));
+    EXPECT_EQ(3u, snapshot.read().frames);
+}
+
+TEST(PositionSnapshot, readsAreNeverTorn)
+{
+    PositionSnapshot snapshot;
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> tornReads(0);
+
+    std::thread reader([&]() {
+        while (!stop) {
+            if (!isConsistent(snapshot.read())) {
+                tornReads++;
+            }
+        }
+    });
+    for (uint32_t counter = 1; counter <= 1000000; counter++) {
+        snapshot.publish(makePosition(counter));
+    }
+    stop = true;
+    reader.join();
+    EXPECT_EQ(0u, tornReads.load());
+}
+
+TEST(PositionSnapshot, framesNeverGoBackwardsWithinARun)
+{
+    PositionSnapshot snapshot;
+    Position position = {
+        48000, 48000, 1000000000, 0, true, true, 500000000, 0
+    };
+    snapshot.publish(position, true);
+    EXPECT_EQ(48000u + 9600, snapshot.getMonotonicFramesAt(snapshot.read(), 1200000000));
+
+    // The DSP reports less than was interpolated: clamped until it catches up.
+    position.frames = 48000 + 4800;
+    position.timestampNs = 1200000000;
+    snapshot.publish(position);
+    EXPECT_EQ(48000u + 9600, snapshot.getMonotonicFramesAt(snapshot.read(), 1200000000));
+    EXPECT_EQ(48000u + 9600, snapshot.getMonotonicFramesAt(snapshot.read(), 1300000000));
+    EXPECT_EQ(48000u + 14400, snapshot.getMonotonicFramesAt(snapshot.read(), 1400000000));
+
+    // A position read before a rewind is not clamped with, nor clamps, the new run.
+    Position previous = snapshot.read();
+    position.frames = 0;
+    snapshot.publish(position, true);
+    EXPECT_EQ(48000u + 4800, snapshot.getMonotonicFramesAt(previous, 1200000000));
+    EXPECT_EQ(0u, snapshot.getMonotonicFramesAt(snapshot.read(), 1200000000));
+    EXPECT_EQ(4800u, snapshot.getMonotonicFramesAt(snapshot.read(), 1300000000));
+}
+
+} // namespace intel_audio
@@ -23,6 +23,11 @@ include $(OPTIONAL_QUALITY_ENV_SETUP)
 #######################################################################
 # Common variables
 
+effect_sw_dsp_src_files := \
+    src/SwDspKernels.cpp \
+    src/SwGainControl.cpp \
+    src/SwNoiseSuppressor.cpp
+
 effect_pre_proc_src_files :=  \
     src/LpeNs.cpp \
     src/LpeAgc.cpp \
@@ -32,7 +37,9 @@ effect_pre_proc_src_files :=  \
     src/AudioEffect.cpp \
     src/AudioEffectSession.cpp \
     src/LpeEffectLibrary.cpp \
-    src/LpePreProcessing.cpp
+    src/LpePreProcessing.cpp \
+    src/SwAudioEffect.cpp \
+    $(effect_sw_dsp_src_files)
 
 effect_pre_proc_includes_dir := \
 
@@ -167,4 +174,35 @@ include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
 include $(BUILD_NATIVE_TEST)
 endif
 
+# Software pre processors unit test for HOST
+#######################################################################
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+    test/SwPreProcessingTest.cpp \
+    $(effect_sw_dsp_src_files)
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/src \
+    external/gtest/include
+
+LOCAL_STATIC_LIBRARIES := \
+    libgtest_host \
+    libgtest_main_host
+
+LOCAL_LDFLAGS += -lpthread -lrt
+LOCAL_MODULE := audio_effects_sw_unit_test_host
+LOCAL_MODULE_OWNER := intel
+LOCAL_MODULE_TAGS := optional
+LOCAL_STRIP_MODULE := false
+
+# Optimized, for the CPU load measured to be meaningful
+LOCAL_CFLAGS := -Wall -Werror -Wextra -O2 -ggdb
+
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+
+include $(BUILD_HOST_EXECUTABLE)
+endif
+
 include $(OPTIONAL_QUALITY_ENV_TEARDOWN)
@@ -23,9 +23,9 @@
 #include <utilities/Log.hpp>
 #include <convert.hpp>
 #include <parameters/AudioParameters.hpp>
+#include <stdio.h>
 
 using android::status_t;
-using android::String8;
 using android::NO_ERROR;
 using audio_comms::utilities::convertTo;
 using audio_comms::utilities::Log;
@@ -36,8 +36,12 @@ AudioEffect::AudioEffect(const effect_interface_s *itfe,
                          const effect_descriptor_t *descriptor)
     : mDescriptor(descriptor),
       mItfe(itfe),
-      mSession(NULL)
+      mSession(NULL),
+      mSoftwareFallback(NULL)
 {
+    for (int32_t paramId = 0; paramId < mPrecomputedParamKeys; paramId++) {
+        mParamKeys[paramId] = formatParamKey(paramId);
+    }
 }
 
 AudioEffect::~AudioEffect()
@@ -74,20 +78,52 @@ int AudioEffect::init()
 
 int AudioEffect::reset()
 {
+    if (mSoftwareFallback != NULL) {
+        return mSoftwareFallback->reset();
+    }
     Log::Verbose() << __FUNCTION__ << ": NOP";
     return 0;
 }
 
 void AudioEffect::enable()
 {
+    if (mSoftwareFallback != NULL) {
+        mSoftwareFallback->enable();
+        return;
+    }
     Log::Verbose() << __FUNCTION__ << ": NOP";
 }
 
 void AudioEffect::disable()
 {
+    if (mSoftwareFallback != NULL) {
+        mSoftwareFallback->disable();
+        return;
+    }
     Log::Verbose() << __FUNCTION__ << ": NOP";
 }
 
+int AudioEffect::setConfig(const effect_config_t &config)
+{
+    if (mSoftwareFallback != NULL) {
+        // The LPE supports more formats than the fallback, which is bypassed on unsupported ones
+        mSoftwareFallback->setConfig(config);
+        return 0;
+    }
+    Log::Verbose() << __FUNCTION__ << ": NOP";
+    return 0;
+}
+
+int AudioEffect::process(audio_buffer_t *in, audio_buffer_t *out)
+{
+    if (mSoftwareFallback != NULL) {
+        return mSoftwareFallback->process(in, out);
+    }
+    Log::Error() << __FUNCTION__ << ": effect " << getDescriptor()->name
+                 << " only runs on the LPE";
+    return -ENOSYS;
+}
+
 int AudioEffect::getParamId(const effect_param_t *param, int32_t &paramId) const
 {
     // Retrieve the parameter(s) - Only supports until now a single paramId
@@ -102,7 +138,17 @@ int AudioEffect::getParamId(const effect_param_t *param, int32_t &paramId) const
     return 0;
 }
 
-int AudioEffect::formatParamKey(const effect_param_t *param, android::String8 &key) const
+std::string AudioEffect::formatParamKey(int32_t paramId) const
+{
+    /**
+     * Format the key. key is made of <Name of the effect>-<paramId>
+     */
+    char key[sizeof(mDescriptor->name) + 16];
+    snprintf(key, sizeof(key), "%s%s%d", mDescriptor->name, mParamKeyDelimiter.c_str(), paramId);
+    return key;
+}
+
+const char *AudioEffect::getParamKey(const effect_param_t *param) const
 {
     /**
      * Retrieve the parameter(s) - Only supports a single paramId at the moment.
@@ -110,28 +156,24 @@ int AudioEffect::formatParamKey(const effect_param_t *param, android::String8 &k
      */
     int32_t paramId = 0;
     if (getParamId(param, paramId)) {
-        return -EINVAL;
+        return NULL;
     }
-
-    /**
-     * Format the key. key is made of <Name of the effect>-<paramId>
-     */
-    std::ostringstream ostr;
-    ostr << paramId;
-    key = String8(std::string(getDescriptor()->name + mParamKeyDelimiter + ostr.str()).c_str());
-    return 0;
+    std::map<int32_t, std::string>::const_iterator it = mParamKeys.find(paramId);
+    if (it == mParamKeys.end()) {
+        it = mParamKeys.insert(std::make_pair(paramId, formatParamKey(paramId))).first;
+    }
+    return it->second.c_str();
 }
 
 int AudioEffect::setParameter(const effect_param_t *param)
 {
-    // Format a key from the effect param structure.
-    String8 key;
-    int ret = formatParamKey(param, key);
-    if (ret) {
-        return ret;
+    // Get the key of the effect param structure.
+    const char *key = getParamKey(param);
+    if (key == NULL) {
+        return -EINVAL;
     }
     Log::Verbose() << __FUNCTION__
-                   << ": effect " << getDescriptor()->name << " key " << key.string();
+                   << ": effect " << getDescriptor()->name << " key " << key;
 
     /**
      * Retrieve the value(s) - Only supports a single value at the moment.
@@ -154,23 +196,22 @@ int AudioEffect::setParameter(const effect_param_t *param)
         return -EINVAL;
     }
 
-    audio_comms::utilities::AudioParameters::set(key.c_str(), value);
+    audio_comms::utilities::AudioParameters::set(key, value);
     return 0;
 }
 
 int AudioEffect::getParameter(effect_param_t *param) const
 {
-    // Format a key from the effect param structure.
-    String8 key;
-    int ret = formatParamKey(param, key);
-    if (ret) {
-        return ret;
+    // Get the key of the effect param structure.
+    const char *key = getParamKey(param);
+    if (key == NULL) {
+        return -EINVAL;
     }
     Log::Verbose() << __FUNCTION__
-                   << ":  effect " << getDescriptor()->name << " key " << key.string();
+                   << ":  effect " << getDescriptor()->name << " key " << key;
 
     std::string value;
-    bool result = audio_comms::utilities::AudioParameters::get(key.c_str(), value);
+    bool result = audio_comms::utilities::AudioParameters::get(key, value);
 
     if (!result) {
         Log::Error() << __FUNCTION__
@@ -17,7 +17,8 @@
 
 #include <hardware/audio_effect.h>
 #include <AudioNonCopyable.hpp>
-#include <utils/String8.h>
+#include <utils/Errors.h>
+#include <map>
 #include <string>
 
 class AudioEffectSession;
@@ -62,6 +63,26 @@ public:
      */
     virtual void disable();
 
+    /**
+     * Configure the effect.
+     *
+     * @param[in] config of the input and output buffers.
+     *
+     * @return 0 if success, error code otherwise.
+     */
+    virtual int setConfig(const effect_config_t &config);
+
+    /**
+     * Process a buffer of frames.
+     * Only effects able to process in software implement it, the others are run by the LPE.
+     *
+     * @param[in] in buffer to process.
+     * @param[in,out] out buffer to fill, frame count updated with the frames produced.
+     *
+     * @return 0 if success, -ENODATA if the effect is disabled, error code otherwise.
+     */
+    virtual int process(audio_buffer_t *in, audio_buffer_t *out);
+
     /**
      * Set Parameter to the effect.
      *
@@ -126,6 +147,14 @@ public:
      */
     effect_handle_t getHandle() { return (effect_handle_t)(&mItfe); }
 
+    /**
+     * Set the software effect to which configuration, state and processing are forwarded.
+     * The audio HAL processes a LPE effect in software when no route implements it.
+     *
+     * @param[in] effect software implementation of the same effect type.
+     */
+    void setSoftwareFallback(AudioEffect *effect) { mSoftwareFallback = effect; }
+
 private:
     /**
      * Extract from the effect_param_t structure the parameter Id.
@@ -140,15 +169,26 @@ private:
     int getParamId(const effect_param_t *param, int32_t &paramId) const;
 
     /**
-     * Format the Parameter key from the effect parameter structure.
+     * Format the Parameter key of a paramId.
      * The followed formalism is:
      *      <human readable type name>-<paramId>[-<subParamId1>-<subParamId2>-...]
      *
+     * @param[in] paramId: parameter Id.
+     *
+     * @return AudioParameter key of the paramId.
+     */
+    std::string formatParamKey(int32_t paramId) const;
+
+    /**
+     * Get the Parameter key of the effect parameter structure.
+     * Each key is formatted once: at construction for the lowest paramIds, covering the standard
+     * pre processors, upon first access for the others.
+     *
      * @param[in] param: Effect Parameter structure
      *
-     * @return valid AudioParameter key if success, empty key if failure.
+     * @return valid AudioParameter key if success, NULL if failure.
      */
-    int formatParamKey(const effect_param_t *param, android::String8 &key) const;
+    const char *getParamKey(const effect_param_t *param) const;
 
     /**
      * Effect Descriptor structure.
@@ -158,5 +198,14 @@ private:
     const effect_descriptor_t *mDescriptor;
     const struct effect_interface_s *mItfe; /**< Effect control interface structure. */
     AudioEffectSession *mSession; /**< Session on which the effect is on. */
+    AudioEffect *mSoftwareFallback; /**< Software implementation, if any. */
     static const std::string mParamKeyDelimiter; /**< Delimiter chosen to format the key. */
+
+    static const int32_t mPrecomputedParamKeys = 8; /**< ParamIds with a precomputed key. */
+
+    /**
+     * Keys of the paramIds accessed so far. Parameters of an effect are accessed by the effect
+     * commands, which the effect framework serializes.
+     */
+    mutable std::map<int32_t, std::string> mParamKeys;
 };
@@ -23,6 +23,7 @@
 #include "LpeWnr.hpp"
 #include "LpeNs.hpp"
 #include "LpeAgc.hpp"
+#include "SwAudioEffect.hpp"
 #include <utils/Errors.h>
 #include <utilities/Log.hpp>
 #include <fcntl.h>
@@ -45,6 +46,26 @@ const struct effect_interface_s LpePreProcessing::mEffectInterface = {
     NULL /**< process reverse. Not implemented as this lib deals with HW effects. */
 };
 
+const struct effect_interface_s LpePreProcessing::mSwEffectInterface = {
+    &LpePreProcessing::intelLpeFxProcess,
+    &LpePreProcessing::intelLpeFxCommand,
+    &LpePreProcessing::intelLpeFxGetDescriptor,
+    NULL /**< process reverse. Not needed: the echo canceller only runs on the LPE. */
+};
+
+int LpePreProcessing::intelLpeFxProcess(effect_handle_t interface,
+                                        audio_buffer_t *in,
+                                        audio_buffer_t *out)
+{
+    LpePreProcessing *self = getInstance();
+    AudioEffect *effect = self->findEffectByInterface(interface);
+    if (effect == NULL) {
+        Log::Error() << __FUNCTION__ << ": could not find effect for requested interface";
+        return -EINVAL;
+    }
+    return effect->process(in, out);
+}
+
 int LpePreProcessing::intelLpeFxCommand(effect_handle_t interface,
                                         uint32_t cmdCode,
                                         uint32_t cmdSize,
@@ -76,7 +97,8 @@ int LpePreProcessing::intelLpeFxCommand(effect_handle_t interface,
             Log::Verbose() << __FUNCTION__ << ": EFFECT_CMD_SET_CONFIG: ERROR";
             return -EINVAL;
         }
-        *static_cast<int *>(replyData) = 0;
+        *static_cast<int *>(replyData) =
+            effect->setConfig(*static_cast<const effect_config_t *>(cmdData));
         break;
 
     case EFFECT_CMD_GET_CONFIG:
@@ -152,6 +174,7 @@ int LpePreProcessing::intelLpeFxCommand(effect_handle_t interface,
             Log::Verbose() << __FUNCTION__ << ": EFFECT_CMD_ENABLE: ERROR";
             return -EINVAL;
         }
+        effect->enable();
         *static_cast<int *>(replyData) = 0;
         break;
 
@@ -160,6 +183,7 @@ int LpePreProcessing::intelLpeFxCommand(effect_handle_t interface,
             Log::Verbose() << __FUNCTION__ << ": EFFECT_CMD_DISABLE: ERROR";
             return -EINVAL;
         }
+        effect->disable();
         *static_cast<int *>(replyData) = 0;
         break;
 
@@ -282,69 +306,50 @@ status_t LpePreProcessing::init()
 
         AudioEffectSession *effectSession = new AudioEffectSession(i);
 
+        // Software noise suppression and gain control, also run for the LPE ones by the audio
+        // HAL if no route implements them
+        SwAgcAudioEffect *swAgc = new SwAgcAudioEffect(&mSwEffectInterface);
+        addEffect(swAgc, effectSession);
+        SwNsAudioEffect *swNs = new SwNsAudioEffect(&mSwEffectInterface);
+        addEffect(swNs, effectSession);
+
         // Each session has an instance of effects provided by LPE
-        AgcAudioEffect *agc = new AgcAudioEffect(&mEffectInterface);
-        mEffectsList.push_back(agc);
-        effectSession->addEffect(agc);
-        NsAudioEffect *ns = new NsAudioEffect(&mEffectInterface);
-        mEffectsList.push_back(ns);
-        effectSession->addEffect(ns);
-        AecAudioEffect *aec = new AecAudioEffect(&mEffectInterface);
-        mEffectsList.push_back(aec);
-        effectSession->addEffect(aec);
-        BmfAudioEffect *bmf = new BmfAudioEffect(&mEffectInterface);
-        mEffectsList.push_back(bmf);
-        effectSession->addEffect(bmf);
-        WnrAudioEffect *wnr = new WnrAudioEffect(&mEffectInterface);
-        mEffectsList.push_back(wnr);
-        effectSession->addEffect(wnr);
+        AgcAudioEffect *agc = new AgcAudioEffect(&mSwEffectInterface);
+        agc->setSoftwareFallback(swAgc);
+        addEffect(agc, effectSession);
+        NsAudioEffect *ns = new NsAudioEffect(&mSwEffectInterface);
+        ns->setSoftwareFallback(swNs);
+        addEffect(ns, effectSession);
+        addEffect(new AecAudioEffect(&mEffectInterface), effectSession);
+        addEffect(new BmfAudioEffect(&mEffectInterface), effectSession);
+        addEffect(new WnrAudioEffect(&mEffectInterface), effectSession);
 
         mEffectSessionsList.push_back(effectSession);
     }
     return OK;
 }
 
-// Function to be used as the predicate in find_if call.
-struct MatchUuid : public std::binary_function<AudioEffect *, const effect_uuid_t *, bool>
+void LpePreProcessing::addEffect(AudioEffect *effect, AudioEffectSession *session)
 {
-
-    bool operator()(const AudioEffect *effect,
-                    const effect_uuid_t *uuid) const
-    {
-
-        return memcmp(effect->getUuid(), uuid, sizeof(effect_uuid_t)) == 0;
-    }
-};
+    mEffectsList.push_back(effect);
+    mEffectsByInterface[effect->getHandle()] = effect;
+    // Any instance serves the descriptor of an uuid
+    mEffectsByUuid.insert(std::make_pair(*effect->getUuid(), effect));
+    session->addEffect(effect);
+}
 
 AudioEffect *LpePreProcessing::findEffectByUuid(const effect_uuid_t *uuid)
 {
-    EffectListIterator it;
-    it = std::find_if(mEffectsList.begin(), mEffectsList.end(), std::bind2nd(MatchUuid(), uuid));
-
-    return (it != mEffectsList.end()) ? *it : NULL;
+    std::unordered_map<effect_uuid_t, AudioEffect *, UuidHash, UuidEqual>::const_iterator it =
+        mEffectsByUuid.find(*uuid);
+    return (it != mEffectsByUuid.end()) ? it->second : NULL;
 }
 
-/**
- * Function to be used as the predicate in find_if call.
- */
-struct MatchInterface : public std::binary_function<AudioEffect *, const effect_handle_t, bool>
-{
-
-    bool operator()(AudioEffect *effect,
-                    const effect_handle_t interface) const
-    {
-
-        return effect->getHandle() == interface;
-    }
-};
-
 AudioEffect *LpePreProcessing::findEffectByInterface(const effect_handle_t interface)
 {
-    EffectListIterator it;
-    it = std::find_if(mEffectsList.begin(), mEffectsList.end(),
-                      std::bind2nd(MatchInterface(), interface));
-
-    return (it != mEffectsList.end()) ? *it : NULL;
+    std::unordered_map<effect_handle_t, AudioEffect *>::const_iterator it =
+        mEffectsByInterface.find(interface);
+    return (it != mEffectsByInterface.end()) ? it->second : NULL;
 }
 
 /**
@@ -19,8 +19,10 @@
 #include <hardware/audio_effect.h>
 #include <AudioNonCopyable.hpp>
 #include <list>
+#include <unordered_map>
 #include <utils/Errors.h>
 #include <Mutex.hpp>
+#include <string.h>
 
 class AudioEffect;
 class AudioEffectSession;
@@ -97,6 +99,14 @@ public:
 private:
     android::status_t init();
 
+    /**
+     * Register an effect of a session: owned by the library and reachable from its handle.
+     *
+     * @param[in] effect to register.
+     * @param[in] session to which the effect belongs.
+     */
+    void addEffect(AudioEffect *effect, AudioEffectSession *session);
+
     /**
      * Retrieve the AudioEffect instance from the uuid.
      *
@@ -140,6 +150,28 @@ private:
      */
     std::list<AudioEffect *> mEffectsList;
 
+    struct UuidHash
+    {
+        size_t operator()(const effect_uuid_t &uuid) const
+        {
+            return uuid.timeLow ^ (uuid.timeMid << 16) ^ uuid.clockSeq;
+        }
+    };
+    struct UuidEqual
+    {
+        bool operator()(const effect_uuid_t &left, const effect_uuid_t &right) const
+        {
+            return memcmp(&left, &right, sizeof(effect_uuid_t)) == 0;
+        }
+    };
+
+    /**
+     * Effects from their handle and from their uuid, built once at init, hence read without lock
+     * by the effect interface functions.
+     */
+    std::unordered_map<effect_handle_t, AudioEffect *> mEffectsByInterface;
+    std::unordered_map<effect_uuid_t, AudioEffect *, UuidHash, UuidEqual> mEffectsByUuid;
+
     /**
      * List of Audio Effect Sessions available on LPE
      */
@@ -187,6 +219,18 @@ private:
     static int intelLpeFxGetDescriptor(effect_handle_t self,
                                        effect_descriptor_t *descriptor);
 
+    /**
+     * Process a buffer with an effect able to process in software.
+     *
+     * @param[in] self handle to the effect interface this function is called on.
+     * @param[in] in buffer to process.
+     * @param[in,out] out buffer to fill, frame count updated with the frames produced.
+     *
+     * @return 0 successful operation, -ENODATA if the effect is disabled,
+     *         -EINVAL invalid interface handle or buffers.
+     */
+    static int intelLpeFxProcess(effect_handle_t self, audio_buffer_t *in, audio_buffer_t *out);
+
     /**
      * Effect interface structure.
      * It will be used as a unique entry point to interact with audio effects by
@@ -194,6 +238,12 @@ private:
      */
     static const struct effect_interface_s mEffectInterface;
 
+    /**
+     * Interface of the effects able to process in software: either software effects, or LPE
+     * effects with a software fallback, run by the audio HAL when no route implements them.
+     */
+    static const struct effect_interface_s mSwEffectInterface;
+
     /**
      * Effects are handled in a separated thread, need to lock to protect concurrent
      * access to the input stream.
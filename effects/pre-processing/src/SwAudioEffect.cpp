@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "IntelPreProcessingFx/SwEffect"
+
+#include "SwAudioEffect.hpp"
+#include <audio_effects/effect_agc.h>
+#include <audio_effects/effect_ns.h>
+#include <utilities/Log.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <string.h>
+
+using audio_comms::utilities::Log;
+using audio_comms::utilities::Mutex;
+
+SwAudioEffect::SwAudioEffect(const effect_interface_s *itfe,
+                             const effect_descriptor_t *descriptor)
+    : AudioEffect(itfe, descriptor),
+      mEnabled(false),
+      mChannels(0)
+{
+}
+
+int SwAudioEffect::init()
+{
+    return reset();
+}
+
+int SwAudioEffect::reset()
+{
+    Mutex::Locker locker(mLock);
+    resetEngine();
+    return 0;
+}
+
+void SwAudioEffect::enable()
+{
+    Mutex::Locker locker(mLock);
+    if (!mEnabled) {
+        resetEngine();
+        mEnabled = true;
+    }
+}
+
+void SwAudioEffect::disable()
+{
+    Mutex::Locker locker(mLock);
+    mEnabled = false;
+}
+
+int SwAudioEffect::setConfig(const effect_config_t &config)
+{
+    const buffer_config_t &in = config.inputCfg;
+    const buffer_config_t &out = config.outputCfg;
+    uint32_t channels = audio_channel_count_from_in_mask(in.channels);
+    if (in.format != AUDIO_FORMAT_PCM_16_BIT || out.format != AUDIO_FORMAT_PCM_16_BIT ||
+        in.samplingRate != out.samplingRate || in.channels != out.channels) {
+        Log::Error() << __FUNCTION__ << ": effect " << getDescriptor()->name
+                     << ": input and output shall be the same 16 bits PCM";
+        return -EINVAL;
+    }
+    Mutex::Locker locker(mLock);
+    if (!configureEngine(in.samplingRate, channels)) {
+        Log::Error() << __FUNCTION__ << ": effect " << getDescriptor()->name
+                     << ": unsupported " << in.samplingRate << " Hz, " << channels
+                     << " channel(s)";
+        mChannels = 0;
+        return -EINVAL;
+    }
+    mChannels = channels;
+    return 0;
+}
+
+int SwAudioEffect::process(audio_buffer_t *in, audio_buffer_t *out)
+{
+    if (in == NULL || out == NULL || in->raw == NULL || out->raw == NULL) {
+        return -EINVAL;
+    }
+    Mutex::Locker locker(mLock);
+    if (!mEnabled || mChannels == 0) {
+        // Disabled, or not configured in a supported format: bypassed
+        return -ENODATA;
+    }
+    size_t frames = std::min(in->frameCount, out->frameCount);
+    if (in->raw != out->raw) {
+        memcpy(out->raw, in->raw, frames * mChannels * sizeof(int16_t));
+    }
+    processEngine(out->s16, frames);
+    out->frameCount = frames;
+    return 0;
+}
+
+int SwAudioEffect::setParameter(const effect_param_t *)
+{
+    return -EINVAL;
+}
+
+int SwAudioEffect::getParameter(effect_param_t *) const
+{
+    return -EINVAL;
+}
+
+SwNsAudioEffect::SwNsAudioEffect(const effect_interface_s *itfe)
+    : SwAudioEffect(itfe, &mSwNsDescriptor)
+{
+}
+
+bool SwNsAudioEffect::configureEngine(uint32_t sampleRate, uint32_t channels)
+{
+    return mEngine.configure(sampleRate, channels);
+}
+
+void SwNsAudioEffect::processEngine(int16_t *samples, size_t frames)
+{
+    mEngine.process(samples, frames);
+}
+
+const effect_descriptor_t SwNsAudioEffect::mSwNsDescriptor = {
+    .type =         FX_IID_NS_,
+    .uuid =         {
+        .timeLow = 0x1b7c5bf0,
+        .timeMid = 0x4f9e,
+        .timeHiAndVersion = 0x11e8,
+        .clockSeq = 0x9c2d,
+        .node = { 0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b }
+    },
+    .apiVersion =   EFFECT_CONTROL_API_VERSION,
+    .flags =        (EFFECT_FLAG_TYPE_PRE_PROC | EFFECT_FLAG_DEVICE_IND),
+    .cpuLoad =      0,
+    .memoryUsage =  0,
+    "Noise Suppression",       /**< name. */
+    "Intel"                    /**< implementor. */
+};
+
+SwAgcAudioEffect::SwAgcAudioEffect(const effect_interface_s *itfe)
+    : SwAudioEffect(itfe, &mSwAgcDescriptor)
+{
+}
+
+bool SwAgcAudioEffect::configureEngine(uint32_t sampleRate, uint32_t channels)
+{
+    return mEngine.configure(sampleRate, channels);
+}
+
+void SwAgcAudioEffect::processEngine(int16_t *samples, size_t frames)
+{
+    mEngine.process(samples, frames);
+}
+
+const effect_descriptor_t SwAgcAudioEffect::mSwAgcDescriptor = {
+    .type =         FX_IID_AGC_,
+    .uuid =         {
+        .timeLow = 0x2a4b7e40,
+        .timeMid = 0x4f9e,
+        .timeHiAndVersion = 0x11e8,
+        .clockSeq = 0x8f1a,
+        .node = { 0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b }
+    },
+    .apiVersion =   EFFECT_CONTROL_API_VERSION,
+    .flags =        (EFFECT_FLAG_TYPE_PRE_PROC | EFFECT_FLAG_DEVICE_IND),
+    .cpuLoad =      0,
+    .memoryUsage =  0,
+    "Automatic Gain Control",  /**< name. */
+    "Intel"                    /**< implementor. */
+};
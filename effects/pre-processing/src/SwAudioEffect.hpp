@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "AudioEffect.hpp"
+#include "SwGainControl.hpp"
+#include "SwNoiseSuppressor.hpp"
+#include <Mutex.hpp>
+
+/**
+ * Effect processed in software by the capture stream, on 16 bits PCM at 16 or 48 kHz, mono or
+ * stereo. Configuration and state changes come from the effect command thread while the stream
+ * processes, hence are serialized with the processing.
+ */
+class SwAudioEffect : public AudioEffect
+{
+public:
+    SwAudioEffect(const effect_interface_s *itfe, const effect_descriptor_t *descriptor);
+
+    virtual int init();
+    virtual int reset();
+    virtual void enable();
+    virtual void disable();
+    virtual int setConfig(const effect_config_t &config);
+    virtual int process(audio_buffer_t *in, audio_buffer_t *out);
+
+    /** Software effects are not tuned through the platform parameters. */
+    virtual int setParameter(const effect_param_t *param);
+    virtual int getParameter(effect_param_t *param) const;
+
+protected:
+    /**
+     * @param[in] sampleRate in Hz.
+     * @param[in] channels interleaved.
+     *
+     * @return true if the engine supports the configuration, false otherwise.
+     */
+    virtual bool configureEngine(uint32_t sampleRate, uint32_t channels) = 0;
+
+    virtual void resetEngine() = 0;
+
+    /**
+     * @param[in,out] samples interleaved frames to process in place.
+     * @param[in] frames number of frames.
+     */
+    virtual void processEngine(int16_t *samples, size_t frames) = 0;
+
+private:
+    audio_comms::utilities::Mutex mLock; /**< Protects the engine and the members below. */
+    bool mEnabled;
+    uint32_t mChannels; /**< Null until configured. */
+};
+
+class SwNsAudioEffect : public SwAudioEffect
+{
+public:
+    /**
+     * Instantiate a software Noise Suppressor audio effect.
+     *
+     * @param[in] itfe audio effect interface
+     */
+    SwNsAudioEffect(const effect_interface_s *itfe);
+
+private:
+    virtual bool configureEngine(uint32_t sampleRate, uint32_t channels);
+    virtual void resetEngine() { mEngine.reset(); }
+    virtual void processEngine(int16_t *samples, size_t frames);
+
+    SwNoiseSuppressor mEngine;
+
+    static const effect_descriptor_t mSwNsDescriptor;
+};
+
+class SwAgcAudioEffect : public SwAudioEffect
+{
+public:
+    /**
+     * Instantiate a software Automatic Gain Control audio effect.
+     *
+     * @param[in] itfe audio effect interface
+     */
+    SwAgcAudioEffect(const effect_interface_s *itfe);
+
+private:
+    virtual bool configureEngine(uint32_t sampleRate, uint32_t channels);
+    virtual void resetEngine() { mEngine.reset(); }
+    virtual void processEngine(int16_t *samples, size_t frames);
+
+    SwGainControl mEngine;
+
+    static const effect_descriptor_t mSwAgcDescriptor;
+};
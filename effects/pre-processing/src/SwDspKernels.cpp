@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SwDspKernels.hpp"
+#include <math.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define SW_DSP_X86
+#include <immintrin.h>
+#endif
+
+static inline int16_t saturate(long value)
+{
+    return value > INT16_MAX ? INT16_MAX : (value < INT16_MIN ? INT16_MIN : value);
+}
+
+static float sumSquaresScalar(const int16_t *samples, size_t count)
+{
+    float sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        float sample = samples[i];
+        sum += sample * sample;
+    }
+    return sum;
+}
+
+static int16_t peakScalar(const int16_t *samples, size_t count)
+{
+    int peak = 0;
+    for (size_t i = 0; i < count; i++) {
+        int value = samples[i] < 0 ? -samples[i] : samples[i];
+        peak = value > peak ? value : peak;
+    }
+    return saturate(peak);
+}
+
+static void applyGainScalar(int16_t *samples, size_t count, uint32_t channels, float gain,
+                            float step)
+{
+    for (size_t i = 0; i < count; i++) {
+        float frameGain = gain + static_cast<float>(i / channels) * step;
+        samples[i] = saturate(lrintf(samples[i] * frameGain));
+    }
+}
+
+#ifdef SW_DSP_X86
+
+static float sumSquaresSse2(const int16_t *samples, size_t count)
+{
+    __m128 sumLow = _mm_setzero_ps();
+    __m128 sumHigh = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+        // Sign extension to 32 bits
+        __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16));
+        __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16));
+        sumLow = _mm_add_ps(sumLow, _mm_mul_ps(low, low));
+        sumHigh = _mm_add_ps(sumHigh, _mm_mul_ps(high, high));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(sumLow, sumHigh));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumSquaresScalar(samples + i, count - i);
+}
+
+static int16_t peakSse2(const int16_t *samples, size_t count)
+{
+    __m128i peak = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+        // Saturated negation: -32768 gives 32767
+        __m128i negated = _mm_subs_epi16(_mm_setzero_si128(), value);
+        peak = _mm_max_epi16(peak, _mm_max_epi16(value, negated));
+    }
+    peak = _mm_max_epi16(peak, _mm_shuffle_epi32(peak, _MM_SHUFFLE(1, 0, 3, 2)));
+    peak = _mm_max_epi16(peak, _mm_shuffle_epi32(peak, _MM_SHUFFLE(2, 3, 0, 1)));
+    peak = _mm_max_epi16(peak, _mm_shufflelo_epi16(peak, _MM_SHUFFLE(2, 3, 0, 1)));
+    int16_t vectorPeak = static_cast<int16_t>(_mm_extract_epi16(peak, 0));
+    int16_t tailPeak = peakScalar(samples + i, count - i);
+    return vectorPeak > tailPeak ? vectorPeak : tailPeak;
+}
+
+static void applyGainSse2(int16_t *samples, size_t count, uint32_t channels, float gain,
+                          float step)
+{
+    // Frame index of each lane, relative to the first frame of the vector
+    const __m128 frameLow = _mm_setr_ps(0 / channels, 1 / channels, 2 / channels, 3 / channels);
+    const __m128 frameHigh = _mm_setr_ps(4 / channels, 5 / channels, 6 / channels, 7 / channels);
+    const __m128 gainVector = _mm_set1_ps(gain);
+    const __m128 stepVector = _mm_set1_ps(step);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 frame = _mm_set1_ps(static_cast<float>(i / channels));
+        __m128 gainLow = _mm_add_ps(gainVector,
+                                    _mm_mul_ps(_mm_add_ps(frame, frameLow), stepVector));
+        __m128 gainHigh = _mm_add_ps(gainVector,
+                                     _mm_mul_ps(_mm_add_ps(frame, frameHigh), stepVector));
+
+        __m128i *vector = reinterpret_cast<__m128i *>(samples + i);
+        __m128i value = _mm_loadu_si128(vector);
+        __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16));
+        __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16));
+        __m128i lowResult = _mm_cvtps_epi32(_mm_mul_ps(low, gainLow));
+        __m128i highResult = _mm_cvtps_epi32(_mm_mul_ps(high, gainHigh));
+        _mm_storeu_si128(vector, _mm_packs_epi32(lowResult, highResult));
+    }
+    applyGainScalar(samples + i, count - i, channels,
+                    gain + static_cast<float>(i / channels) * step, step);
+}
+
+__attribute__((target("avx2")))
+static float sumSquaresAvx2(const int16_t *samples, size_t count)
+{
+    __m256 sumLow = _mm256_setzero_ps();
+    __m256 sumHigh = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i *vector = reinterpret_cast<const __m128i *>(samples + i);
+        __m256 low = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(vector)));
+        __m256 high = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(vector + 1)));
+        sumLow = _mm256_add_ps(sumLow, _mm256_mul_ps(low, low));
+        sumHigh = _mm256_add_ps(sumHigh, _mm256_mul_ps(high, high));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(sumLow, sumHigh));
+    float sum = 0;
+    for (size_t lane = 0; lane < 8; lane++) {
+        sum += lanes[lane];
+    }
+    return sum + sumSquaresSse2(samples + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static int16_t peakAvx2(const int16_t *samples, size_t count)
+{
+    __m256i peak = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(samples + i));
+        __m256i negated = _mm256_subs_epi16(_mm256_setzero_si256(), value);
+        peak = _mm256_max_epi16(peak, _mm256_max_epi16(value, negated));
+    }
+    int16_t lanes[16];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), peak);
+    int16_t vectorPeak = peakSse2(lanes, 16);
+    int16_t tailPeak = peakSse2(samples + i, count - i);
+    return vectorPeak > tailPeak ? vectorPeak : tailPeak;
+}
+
+__attribute__((target("avx2")))
+static void applyGainAvx2(int16_t *samples, size_t count, uint32_t channels, float gain,
+                          float step)
+{
+    const __m256 frameLow = _mm256_setr_ps(0 / channels, 1 / channels, 2 / channels,
+                                           3 / channels, 4 / channels, 5 / channels,
+                                           6 / channels, 7 / channels);
+    const __m256 frameHigh = _mm256_setr_ps(8 / channels, 9 / channels, 10 / channels,
+                                            11 / channels, 12 / channels, 13 / channels,
+                                            14 / channels, 15 / channels);
+    const __m256 gainVector = _mm256_set1_ps(gain);
+    const __m256 stepVector = _mm256_set1_ps(step);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 frame = _mm256_set1_ps(static_cast<float>(i / channels));
+        __m256 gainLow = _mm256_add_ps(gainVector,
+                                       _mm256_mul_ps(_mm256_add_ps(frame, frameLow), stepVector));
+        __m256 gainHigh = _mm256_add_ps(gainVector,
+                                        _mm256_mul_ps(_mm256_add_ps(frame, frameHigh),
+                                                      stepVector));
+
+        __m128i *vector = reinterpret_cast<__m128i *>(samples + i);
+        __m256 low = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(vector)));
+        __m256 high = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(vector + 1)));
+        __m256i lowResult = _mm256_cvtps_epi32(_mm256_mul_ps(low, gainLow));
+        __m256i highResult = _mm256_cvtps_epi32(_mm256_mul_ps(high, gainHigh));
+        // Packing works within 128 bits lanes, restore the order of the samples
+        __m256i result = _mm256_permute4x64_epi64(_mm256_packs_epi32(lowResult, highResult),
+                                                  _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(vector), result);
+    }
+    applyGainSse2(samples + i, count - i, channels,
+                  gain + static_cast<float>(i / channels) * step, step);
+}
+
+static const SwDspKernels gKernels[SwDspKernels::NbIsa] = {
+    { sumSquaresScalar, peakScalar, applyGainScalar, SwDspKernels::Scalar },
+    { sumSquaresSse2, peakSse2, applyGainSse2, SwDspKernels::Sse2 },
+    { sumSquaresAvx2, peakAvx2, applyGainAvx2, SwDspKernels::Avx2 }
+};
+
+#else
+
+static const SwDspKernels gKernels[SwDspKernels::NbIsa] = {
+    { sumSquaresScalar, peakScalar, applyGainScalar, SwDspKernels::Scalar },
+    { sumSquaresScalar, peakScalar, applyGainScalar, SwDspKernels::Scalar },
+    { sumSquaresScalar, peakScalar, applyGainScalar, SwDspKernels::Scalar }
+};
+
+#endif
+
+bool SwDspKernels::isSupported(Isa isa)
+{
+#ifdef SW_DSP_X86
+    __builtin_cpu_init();
+    switch (isa) {
+    case Scalar:
+        return true;
+    case Sse2:
+        return __builtin_cpu_supports("sse2");
+    case Avx2:
+        return __builtin_cpu_supports("avx2");
+    default:
+        return false;
+    }
+#else
+    return isa == Scalar;
+#endif
+}
+
+const SwDspKernels &SwDspKernels::get(Isa isa)
+{
+    return isSupported(isa) ? gKernels[isa] : gKernels[Scalar];
+}
+
+const SwDspKernels &SwDspKernels::getBest()
+{
+    static const SwDspKernels &best =
+        isSupported(Avx2) ? gKernels[Avx2] : (isSupported(Sse2) ? gKernels[Sse2] :
+                                              gKernels[Scalar]);
+    return best;
+}
+
+const char *SwDspKernels::getName(Isa isa)
+{
+    static const char *const names[NbIsa] = {
+        "scalar", "sse2", "avx2"
+    };
+    return isa < NbIsa ? names[isa] : "unknown";
+}
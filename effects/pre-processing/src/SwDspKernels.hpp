@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Inner loops of the software pre processors, working on interleaved 16 bits samples.
+ * Each instruction set provides the same kernels, the best one supported by the CPU being
+ * selected at run time, so that a single binary runs on any x86 platform.
+ */
+struct SwDspKernels
+{
+    enum Isa
+    {
+        Scalar,
+        Sse2,
+        Avx2,
+        NbIsa
+    };
+
+    /**
+     * @param[in] samples to measure.
+     * @param[in] count number of samples.
+     *
+     * @return sum of the squares of the samples.
+     */
+    float (*sumSquares)(const int16_t *samples, size_t count);
+
+    /**
+     * @param[in] samples to measure.
+     * @param[in] count number of samples.
+     *
+     * @return largest absolute value of the samples, 32767 for -32768.
+     */
+    int16_t (*peak)(const int16_t *samples, size_t count);
+
+    /**
+     * Multiply the samples in place by a gain ramping linearly along the frames, saturating.
+     * The gain of frame n is gain + n * step, rounded to nearest.
+     *
+     * @param[in,out] samples to amplify.
+     * @param[in] count number of samples, multiple of channels.
+     * @param[in] channels number of interleaved channels, 1 or 2.
+     * @param[in] gain of the first frame.
+     * @param[in] step of the gain from one frame to the next.
+     */
+    void (*applyGain)(int16_t *samples, size_t count, uint32_t channels, float gain, float step);
+
+    Isa isa;
+
+    /**
+     * @param[in] isa instruction set.
+     *
+     * @return true if the CPU runs this instruction set.
+     */
+    static bool isSupported(Isa isa);
+
+    /**
+     * @param[in] isa instruction set, shall be supported.
+     *
+     * @return kernels of this instruction set.
+     */
+    static const SwDspKernels &get(Isa isa);
+
+    /** @return kernels of the best instruction set supported by the CPU. */
+    static const SwDspKernels &getBest();
+
+    static const char *getName(Isa isa);
+};
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SwGainControl.hpp"
+#include <algorithm>
+#include <math.h>
+
+const float SwGainControl::gDefaultTargetLevel = -18.0f;
+const float SwGainControl::gDefaultMaxGain = 24.0f;
+const float SwGainControl::gGateLevel = -60.0f;
+const float SwGainControl::gLimit = 29491.0f; /**< -0.9 dBFS */
+const float SwGainControl::gAttackSeconds = 0.02f;
+const float SwGainControl::gReleaseSeconds = 0.4f;
+
+static const float gFullScaleEnergy = 32768.0f * 32768.0f;
+
+static float dbToEnergy(float db)
+{
+    return gFullScaleEnergy * powf(10, db / 10);
+}
+
+SwGainControl::SwGainControl(const SwDspKernels &kernels)
+    : mKernels(kernels), mSampleRate(0), mChannels(0),
+      mTargetEnergy(dbToEnergy(gDefaultTargetLevel)), mMaxGain(powf(10, gDefaultMaxGain / 20))
+{
+    reset();
+}
+
+bool SwGainControl::configure(uint32_t sampleRate, uint32_t channels)
+{
+    if ((sampleRate != 16000 && sampleRate != 48000) || (channels != 1 && channels != 2)) {
+        return false;
+    }
+    mSampleRate = sampleRate;
+    mChannels = channels;
+    reset();
+    return true;
+}
+
+void SwGainControl::reset()
+{
+    mGain = 1;
+}
+
+void SwGainControl::setTargetLevel(float dbfs)
+{
+    mTargetEnergy = dbToEnergy(dbfs);
+}
+
+void SwGainControl::setMaxGain(float db)
+{
+    mMaxGain = std::max(1.0f, powf(10, db / 20));
+}
+
+void SwGainControl::process(int16_t *samples, size_t frames)
+{
+    if (mSampleRate == 0) {
+        return;
+    }
+    const size_t blockFrames = mSampleRate / 100;
+    while (frames != 0) {
+        size_t blockSize = std::min(frames, blockFrames);
+        processBlock(samples, blockSize);
+        samples += blockSize * mChannels;
+        frames -= blockSize;
+    }
+}
+
+void SwGainControl::processBlock(int16_t *samples, size_t frames)
+{
+    static const float gateEnergy = dbToEnergy(gGateLevel);
+
+    size_t count = frames * mChannels;
+    float seconds = static_cast<float>(frames) / mSampleRate;
+    float energy = mKernels.sumSquares(samples, count) / count;
+
+    float gain = mGain;
+    if (energy > gateEnergy) {
+        float target = std::min(std::max(sqrtf(mTargetEnergy / energy), 1.0f), mMaxGain);
+        float timeConstant = target < gain ? gAttackSeconds : gReleaseSeconds;
+        gain += (target - gain) * (1 - expf(-seconds / timeConstant));
+    }
+    float startGain = mGain;
+    int16_t peak = mKernels.peak(samples, count);
+    if (peak * gain > gLimit) {
+        // No ramp: the whole block would clip otherwise
+        gain = std::max(gLimit / peak, 1.0f);
+        startGain = std::min(startGain, gain);
+    }
+    mKernels.applyGain(samples, count, mChannels, startGain, (gain - startGain) / frames);
+    mGain = gain;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "SwDspKernels.hpp"
+
+/**
+ * Automatic gain control, processing 10 ms blocks.
+ * The gain brings the RMS level of each block to the target level, between 0 dB and the maximum
+ * gain. It decreases quickly and increases slowly, and is held on blocks quieter than the gate,
+ * so that silence is not amplified. A limiter lowers it at once if the block would clip.
+ * Levels are in dBFS, relative to the square of the full scale.
+ */
+class SwGainControl
+{
+public:
+    SwGainControl(const SwDspKernels &kernels = SwDspKernels::getBest());
+
+    /**
+     * @param[in] sampleRate in Hz, 16000 or 48000.
+     * @param[in] channels interleaved, 1 or 2.
+     *
+     * @return true if the configuration is supported, false otherwise.
+     */
+    bool configure(uint32_t sampleRate, uint32_t channels);
+
+    /** Restart from unity gain. */
+    void reset();
+
+    void setTargetLevel(float dbfs);
+    void setMaxGain(float db);
+
+    /**
+     * @param[in,out] samples interleaved frames to process in place.
+     * @param[in] frames number of frames.
+     */
+    void process(int16_t *samples, size_t frames);
+
+    /** @return gain applied to the last frame. */
+    float getGain() const { return mGain; }
+
+private:
+    void processBlock(int16_t *samples, size_t frames);
+
+    const SwDspKernels &mKernels;
+    uint32_t mSampleRate;
+    uint32_t mChannels;
+    float mTargetEnergy; /**< Mean square. */
+    float mMaxGain;
+    float mGain;
+
+    static const float gDefaultTargetLevel;
+    static const float gDefaultMaxGain;
+    static const float gGateLevel;
+    static const float gLimit; /**< Highest sample magnitude produced. */
+    static const float gAttackSeconds; /**< Time constant of the gain decrease. */
+    static const float gReleaseSeconds; /**< Time constant of the gain increase. */
+};
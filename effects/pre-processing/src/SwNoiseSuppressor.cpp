@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SwNoiseSuppressor.hpp"
+#include <algorithm>
+#include <math.h>
+
+const float SwNoiseSuppressor::gMinGain = 0.25f;
+const float SwNoiseSuppressor::gOverSubtraction = 2.0f;
+const float SwNoiseSuppressor::gNoiseRisePerSecond = 2.0f;
+const float SwNoiseSuppressor::gReleaseSeconds = 0.1f;
+
+SwNoiseSuppressor::SwNoiseSuppressor(const SwDspKernels &kernels)
+    : mKernels(kernels), mSampleRate(0), mChannels(0)
+{
+    reset();
+}
+
+bool SwNoiseSuppressor::configure(uint32_t sampleRate, uint32_t channels)
+{
+    if ((sampleRate != 16000 && sampleRate != 48000) || (channels != 1 && channels != 2)) {
+        return false;
+    }
+    mSampleRate = sampleRate;
+    mChannels = channels;
+    reset();
+    return true;
+}
+
+void SwNoiseSuppressor::reset()
+{
+    mNoiseEnergy = 0;
+    mGain = 1;
+}
+
+void SwNoiseSuppressor::process(int16_t *samples, size_t frames)
+{
+    if (mSampleRate == 0) {
+        return;
+    }
+    const size_t blockFrames = mSampleRate / 100;
+    while (frames != 0) {
+        size_t blockSize = std::min(frames, blockFrames);
+        processBlock(samples, blockSize);
+        samples += blockSize * mChannels;
+        frames -= blockSize;
+    }
+}
+
+void SwNoiseSuppressor::processBlock(int16_t *samples, size_t frames)
+{
+    size_t count = frames * mChannels;
+    float seconds = static_cast<float>(frames) / mSampleRate;
+    float energy = std::max(mKernels.sumSquares(samples, count) / count, 1.0f);
+
+    if (mNoiseEnergy == 0) {
+        mNoiseEnergy = energy;
+    } else {
+        mNoiseEnergy = std::min(energy, mNoiseEnergy * powf(gNoiseRisePerSecond, seconds));
+    }
+    float target = sqrtf(std::max(0.0f, 1 - gOverSubtraction * mNoiseEnergy / energy));
+    target = std::max(target, gMinGain);
+
+    float gain = mGain;
+    if (target > gain) {
+        gain = target;
+    } else {
+        gain += (target - gain) * (1 - expf(-seconds / gReleaseSeconds));
+    }
+    mKernels.applyGain(samples, count, mChannels, mGain, (gain - mGain) / frames);
+    mGain = gain;
+}
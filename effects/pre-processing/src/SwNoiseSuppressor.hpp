@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "SwDspKernels.hpp"
+
+/**
+ * Broadband noise suppressor, processing 10 ms blocks.
+ * The noise floor is tracked as the minimum of the block energy, slowly rising to follow noise
+ * level changes. Each block is attenuated by a Wiener like gain derived from its signal to noise
+ * ratio, bounded so that stationary noise is attenuated by 12 dB at most. The gain opens at once
+ * on speech onsets and closes smoothly, ramping along the frames.
+ */
+class SwNoiseSuppressor
+{
+public:
+    SwNoiseSuppressor(const SwDspKernels &kernels = SwDspKernels::getBest());
+
+    /**
+     * @param[in] sampleRate in Hz, 16000 or 48000.
+     * @param[in] channels interleaved, 1 or 2.
+     *
+     * @return true if the configuration is supported, false otherwise.
+     */
+    bool configure(uint32_t sampleRate, uint32_t channels);
+
+    /** Forget the noise estimate. */
+    void reset();
+
+    /**
+     * @param[in,out] samples interleaved frames to process in place.
+     * @param[in] frames number of frames.
+     */
+    void process(int16_t *samples, size_t frames);
+
+    /** @return gain applied to the last frame. */
+    float getGain() const { return mGain; }
+
+private:
+    void processBlock(int16_t *samples, size_t frames);
+
+    const SwDspKernels &mKernels;
+    uint32_t mSampleRate;
+    uint32_t mChannels;
+    float mNoiseEnergy; /**< Mean square of the noise floor, 0 if unknown. */
+    float mGain;
+
+    static const float gMinGain; /**< Maximum attenuation, as a gain. */
+    static const float gOverSubtraction; /**< Compensates the minimum tracking bias. */
+    static const float gNoiseRisePerSecond; /**< Energy ratio. */
+    static const float gReleaseSeconds; /**< Time constant of the gain closing. */
+};
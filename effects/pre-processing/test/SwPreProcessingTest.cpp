@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SwDspKernels.hpp>
+#include <SwGainControl.hpp>
+#include <SwNoiseSuppressor.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+typedef std::vector<int16_t> Signal;
+
+static const uint32_t gSampleRates[] = {
+    16000, 48000
+};
+
+/** Deterministic white noise, so that the references do not change from one run to another. */
+class NoiseGenerator
+{
+public:
+    NoiseGenerator() : mState(12345) {}
+
+    /** @return uniform sample between -amplitude and amplitude. */
+    float next(float amplitude)
+    {
+        mState = mState * 1103515245 + 12345;
+        return amplitude * (static_cast<float>((mState >> 8) & 0xffff) / 32768.0f - 1.0f);
+    }
+
+private:
+    uint32_t mState;
+};
+
+static int16_t toSample(float value)
+{
+    return value > 32767 ? 32767 : (value < -32768 ? -32768 : static_cast<int16_t>(value));
+}
+
+/**
+ * @param[in] toneAmplitude of a 1 kHz sine, null for noise only.
+ * @param[in] noiseAmplitude of a white noise added to the tone.
+ * @param[in] burstMs if not null, the tone is on and off every burstMs.
+ */
+static Signal makeSignal(uint32_t sampleRate, uint32_t channels, float seconds,
+                         float toneAmplitude, float noiseAmplitude, uint32_t burstMs = 0)
+{
+    NoiseGenerator noise;
+    size_t frames = seconds * sampleRate;
+    Signal signal(frames * channels);
+    for (size_t frame = 0; frame < frames; frame++) {
+        bool toneOn = burstMs == 0 || (frame * 1000 / sampleRate / burstMs) % 2 == 0;
+        float tone = toneOn ? toneAmplitude * sinf(2 * M_PI * 1000 * frame / sampleRate) : 0;
+        for (uint32_t channel = 0; channel < channels; channel++) {
+            signal[frame * channels + channel] = toSample(tone + noise.next(noiseAmplitude));
+        }
+    }
+    return signal;
+}
+
+/** @return RMS level in dBFS of frames [from, to[ of the signal. */
+static float getLevel(const Signal &signal, uint32_t channels, size_t from, size_t to)
+{
+    double sum = 0;
+    for (size_t i = from * channels; i < to * channels; i++) {
+        sum += static_cast<double>(signal[i]) * signal[i];
+    }
+    return 10 * log10(sum / ((to - from) * channels) / (32768.0 * 32768.0) + 1e-20);
+}
+
+template <class Processor>
+static void processBy10ms(Processor &processor, Signal &signal, uint32_t sampleRate,
+                          uint32_t channels)
+{
+    size_t blockFrames = sampleRate / 100;
+    for (size_t i = 0; i + blockFrames * channels <= signal.size(); i += blockFrames * channels) {
+        processor.process(&signal[i], blockFrames);
+    }
+}
+
+TEST(SwDspKernels, simdMatchesScalar)
+{
+    const SwDspKernels &scalar = SwDspKernels::get(SwDspKernels::Scalar);
+    NoiseGenerator noise;
+    // Odd size to run the tails, full scale samples for saturation
+    Signal input(1003 * 2);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = toSample(noise.next(40000));
+    }
+    input[17] = INT16_MIN;
+
+    for (int isa = SwDspKernels::Sse2; isa < SwDspKernels::NbIsa; isa++) {
+        if (!SwDspKernels::isSupported(static_cast<SwDspKernels::Isa>(isa))) {
+            continue;
+        }
+        const SwDspKernels &kernels = SwDspKernels::get(static_cast<SwDspKernels::Isa>(isa));
+        ASSERT_EQ(isa, kernels.isa);
+        SCOPED_TRACE(SwDspKernels::getName(kernels.isa));
+
+        float expected = scalar.sumSquares(&input[0], input.size());
+        EXPECT_NEAR(expected, kernels.sumSquares(&input[0], input.size()), expected * 1e-5);
+        EXPECT_EQ(32767, kernels.peak(&input[0], input.size()));
+        EXPECT_EQ(scalar.peak(&input[1], 100), kernels.peak(&input[1], 100));
+
+        for (uint32_t channels = 1; channels <= 2; channels++) {
+            Signal reference(input);
+            Signal simd(input);
+            scalar.applyGain(&reference[0], reference.size(), channels, 0.5f, 0.002f);
+            kernels.applyGain(&simd[0], simd.size(), channels, 0.5f, 0.002f);
+            for (size_t i = 0; i < reference.size(); i++) {
+                ASSERT_NEAR(reference[i], simd[i], 1) << "sample " << i;
+            }
+        }
+    }
+}
+
+TEST(SwNoiseSuppressor, unsupportedConfigurations)
+{
+    SwNoiseSuppressor ns;
+    EXPECT_FALSE(ns.configure(44100, 1));
+    EXPECT_FALSE(ns.configure(16000, 4));
+    SwGainControl agc;
+    EXPECT_FALSE(agc.configure(8000, 1));
+    EXPECT_TRUE(agc.configure(48000, 2));
+}
+
+TEST(SwNoiseSuppressor, stationaryNoiseIsAttenuated)
+{
+    for (uint32_t sampleRate : gSampleRates) {
+        for (uint32_t channels = 1; channels <= 2; channels++) {
+            SwNoiseSuppressor ns;
+            ASSERT_TRUE(ns.configure(sampleRate, channels));
+            // -40 dBFS noise, then speech like bursts of a -20 dBFS tone over the same noise
+            Signal noise = makeSignal(sampleRate, channels, 2, 0, 570);
+            Signal speech = makeSignal(sampleRate, channels, 2, 4634, 570, 200);
+            Signal input(noise);
+            input.insert(input.end(), speech.begin(), speech.end());
+            Signal output(input);
+            processBy10ms(ns, output, sampleRate, channels);
+
+            size_t second = sampleRate;
+            float noiseAttenuation = getLevel(input, channels, second, 2 * second) -
+                                     getLevel(output, channels, second, 2 * second);
+            EXPECT_GT(noiseAttenuation, 9.0f) << sampleRate << " Hz, " << channels << " ch";
+            EXPECT_LT(noiseAttenuation, 12.5f);
+
+            // First burst of tone, skipping the 10 ms of the onset
+            size_t burstStart = 2 * second + sampleRate / 100;
+            size_t burstEnd = 2 * second + sampleRate / 5;
+            float toneLoss = getLevel(input, channels, burstStart, burstEnd) -
+                             getLevel(output, channels, burstStart, burstEnd);
+            EXPECT_LT(fabsf(toneLoss), 0.5f) << sampleRate << " Hz, " << channels << " ch";
+        }
+    }
+}
+
+TEST(SwGainControl, quietSpeechReachesTarget)
+{
+    for (uint32_t sampleRate : gSampleRates) {
+        for (uint32_t channels = 1; channels <= 2; channels++) {
+            SwGainControl agc;
+            ASSERT_TRUE(agc.configure(sampleRate, channels));
+            // -40 dBFS tone: 22 dB to gain
+            Signal signal = makeSignal(sampleRate, channels, 4, 463, 0);
+            processBy10ms(agc, signal, sampleRate, channels);
+
+            float level = getLevel(signal, channels, 3 * sampleRate, 4 * sampleRate);
+            EXPECT_NEAR(-18.0f, level, 0.5f) << sampleRate << " Hz, " << channels << " ch";
+        }
+    }
+}
+
+TEST(SwGainControl, gainIsBoundedAndSilenceKept)
+{
+    SwGainControl agc;
+    ASSERT_TRUE(agc.configure(16000, 1));
+    // -70 dBFS: below the gate, not amplified
+    Signal silence = makeSignal(16000, 1, 1, 15, 0);
+    processBy10ms(agc, silence, 16000, 1);
+    EXPECT_FLOAT_EQ(1.0f, agc.getGain());
+
+    // -58 dBFS tone: limited to the maximum gain
+    Signal quiet = makeSignal(16000, 1, 4, 60, 0);
+    processBy10ms(agc, quiet, 16000, 1);
+    EXPECT_NEAR(24.0f, 20 * log10f(agc.getGain()), 0.1f);
+
+    // Sudden loud tone: the limiter prevents any clipping
+    Signal loud = makeSignal(16000, 1, 1, 16000, 0);
+    processBy10ms(agc, loud, 16000, 1);
+    int peak = 0;
+    for (int16_t sample : loud) {
+        peak = std::max(peak, abs(sample));
+    }
+    EXPECT_LE(peak, 29491);
+}
+
+static uint64_t getThreadCpuTimeNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/** CPU time spent by noise suppression and gain control for each 10 ms of 48 kHz stereo. */
+TEST(SwPreProcessing, cpuPer10ms)
+{
+    static const uint64_t maxCpuPer10msNs = 500000; /**< 5 % of a core. */
+    static const float seconds = 10;
+
+    Signal input = makeSignal(48000, 2, seconds, 4634, 570, 200);
+    for (int isa = SwDspKernels::Scalar; isa < SwDspKernels::NbIsa; isa++) {
+        if (!SwDspKernels::isSupported(static_cast<SwDspKernels::Isa>(isa))) {
+            continue;
+        }
+        const SwDspKernels &kernels = SwDspKernels::get(static_cast<SwDspKernels::Isa>(isa));
+        SwNoiseSuppressor ns(kernels);
+        SwGainControl agc(kernels);
+        ASSERT_TRUE(ns.configure(48000, 2));
+        ASSERT_TRUE(agc.configure(48000, 2));
+        Signal signal(input);
+
+        uint64_t startNs = getThreadCpuTimeNs();
+        for (size_t i = 0; i + 480 * 2 <= signal.size(); i += 480 * 2) {
+            ns.process(&signal[i], 480);
+            agc.process(&signal[i], 480);
+        }
+        uint64_t cpuPer10msNs = (getThreadCpuTimeNs() - startNs) / (seconds * 100);
+        // Reported in the test results, e.g. in the XML output, per instruction set
+        RecordProperty(std::string(SwDspKernels::getName(kernels.isa)) + "CpuPer10msNs",
+                       static_cast<int>(cpuPer10msNs));
+        EXPECT_LT(cpuPer10msNs, maxCpuPer10msNs);
+    }
+}
@@ -97,16 +97,23 @@ bool Criterion::setValue<std::string>(const std::string &literalValue)
 void Criterion::setCriterionState()
 {
     mSelectionCriterionInterface->setCriterionState(mValue);
+    mCommittedValue = mValue;
+}
+
+bool Criterion::commit()
+{
+    if (!isDirty()) {
+        return false;
+    }
+    setCriterionState();
+    return true;
 }
 
 template <>
 bool Criterion::setCriterionState<int32_t>(const int32_t &value)
 {
-    if (setValue<uint32_t>(value)) {
-        mSelectionCriterionInterface->setCriterionState(mValue);
-        return true;
-    }
-    return false;
+    setValue<uint32_t>(value);
+    return commit();
 }
 
 template <>
@@ -45,6 +45,16 @@ bool CriterionParameter::setValue(const std::string &value)
     return mCriterion.setValue(literalValue);
 }
 
+bool CriterionParameter::setNumericalValue(uint32_t value, bool &isValid)
+{
+    if (!mMappingValuesMap.empty()) {
+        return Parameter::setNumericalValue(value, isValid);
+    }
+    isValid = true;
+    Log::Verbose() << __FUNCTION__ << ": " << getName() << "=" << value;
+    return mCriterion.setValue<uint32_t>(value);
+}
+
 bool CriterionParameter::getValue(std::string &value) const
 {
     std::string criterionLiteralValue = mCriterion.getValue<std::string>();
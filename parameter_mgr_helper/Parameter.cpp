@@ -16,6 +16,7 @@
 
 #include "Parameter.hpp"
 #include <AudioCommsAssert.hpp>
+#include <convert.hpp>
 #include <utilities/Log.hpp>
 #if defined (HAVE_BOOST)
 #include <boost/tokenizer.hpp>
@@ -33,6 +34,28 @@ void Parameter::setMappingValuePair(const string &name, const string &value)
     mMappingValuesMap[name] = value;
 }
 
+bool Parameter::setLiteralValue(const string &value, bool &isValid)
+{
+    isValid = true;
+    if (setValue(value)) {
+        return true;
+    }
+    string oldValue;
+    getValue(oldValue);
+    isValid = (value == oldValue);
+    return false;
+}
+
+bool Parameter::setNumericalValue(uint32_t value, bool &isValid)
+{
+    string literal;
+    if (!audio_comms::utilities::convertTo(value, literal)) {
+        isValid = false;
+        return false;
+    }
+    return setLiteralValue(literal, isValid);
+}
+
 bool Parameter::getLiteralValueFromParam(const string &androidParam, string &literalValue) const
 {
     if (mMappingValuesMap.empty()) {
@@ -24,6 +24,15 @@ class CParameterMgrPlatformConnector;
 class ISelectionCriterionInterface;
 class CriterionType;
 
+/**
+ * Interned identifier of a criterion.
+ * It is resolved once from the criterion name by the owner of the criteria collection and allows
+ * accessing the criterion on hot path without any name lookup.
+ */
+typedef uint32_t CriterionId;
+
+static const CriterionId gInvalidCriterionId = UINT32_MAX;
+
 class Criterion
 {
 public:
@@ -73,6 +82,21 @@ public:
      */
     void setCriterionState();
 
+    /**
+     * Set the local value to the parameter manager only if it differs from the last value
+     * set to the parameter manager.
+     *
+     * @return true if the value was set to the parameter manager, false if unchanged.
+     */
+    bool commit();
+
+    /**
+     * Checks if the local value differs from the value known by the parameter manager.
+     *
+     * @return true if the local value needs to be committed, false otherwise.
+     */
+    bool isDirty() const { return mValue != mCommittedValue; }
+
     /**
      * Set the local value to the parameter manager.
      *
@@ -129,6 +153,8 @@ private:
     std::string mName; /**< name of the criterion. */
 
     uint32_t mValue; /**< value of the criterion. */
+
+    uint32_t mCommittedValue; /**< last value set to the parameter manager. */
 };
 
 class Criteria : public std::vector<Criterion *>
@@ -37,6 +37,12 @@ public:
 
     virtual bool setValue(const std::string &value);
 
+    /**
+     * If no mapping table is provided, the numerical value is directly set to the criterion,
+     * without any literal conversion.
+     */
+    virtual bool setNumericalValue(uint32_t value, bool &isValid);
+
     virtual bool getValue(std::string &value) const;
 
     /**
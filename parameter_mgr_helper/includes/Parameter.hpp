@@ -18,6 +18,7 @@
 
 #include <AudioNonCopyable.hpp>
 #include <map>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -93,6 +94,28 @@ public:
      */
     virtual bool setValue(const std::string &value) = 0;
 
+    /**
+     * Sets a value to the parameter and checks its validity.
+     * A value that could not be set is considered as valid if it matches the current value.
+     *
+     * @param[in] value to set (received from the keyValue pair).
+     * @param[out] isValid false if the value was rejected by the parameter, true otherwise.
+     *
+     * @return true if the value has changed, false otherwise.
+     */
+    bool setLiteralValue(const std::string &value, bool &isValid);
+
+    /**
+     * Sets a numerical value to the parameter and checks its validity.
+     * By default, the value is converted to its literal form and set with setLiteralValue.
+     *
+     * @param[in] value to set (received from the typed streams parameters).
+     * @param[out] isValid false if the value was rejected by the parameter, true otherwise.
+     *
+     * @return true if the value has changed, false otherwise.
+     */
+    virtual bool setNumericalValue(uint32_t value, bool &isValid);
+
     /**
      * Gets the value from the Parameter. The value returned must be in the domain
      * of the android parameter.
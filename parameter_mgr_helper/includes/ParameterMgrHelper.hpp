@@ -125,20 +125,22 @@ public:
      */
     CParameterHandle *getDynamicParameterHandle(const std::string &dynamicParamPath);
 
-private:
     /**
      * Helper function to retrieve a handle on a parameter.
+     * The handle is owned by the caller, which may keep it to access the parameter without
+     * looking up its path again.
      *
      * @param[in] pfwConnector Parameter Manager Connector object.
      * @param[out] handle on the parameter.
      * @param[in] paramPath of the parameter on which a handler is requested;
      *
-     * @return CParameterHandle handle on the parameter, NULL pointer if error.
+     * @return true if the handle was created, false otherwise.
      */
     static bool getParameterHandle(CParameterMgrPlatformConnector *pfwConnector,
                                    CParameterHandle * &handle,
                                    const std::string &paramPath);
 
+private:
     /**
      * Get a handle on the platform dependent parameter.
      *
@@ -29,6 +29,8 @@ namespace intel_audio
  * of a PFW Instance
  * Each time the key of this android parameters is detected, this class will wrap the accessor
  * of the android parameter to accessors of the rogue parameter of the Route PFW.
+ * The handle on the rogue parameter is resolved once the PFW is started, upon the first sync,
+ * so that accessing it neither looks up its path nor creates a handle again.
  *
  * @tparam T type of the rogue parameter value.
  */
@@ -42,9 +44,12 @@ public:
                    CParameterMgrPlatformConnector *parameterMgrConnector,
                    const std::string &defaultValue = "")
         : Parameter(key, name, defaultValue),
-          mParameterMgrConnector(parameterMgrConnector)
+          mParameterMgrConnector(parameterMgrConnector),
+          mHandle(NULL)
     {}
 
+    virtual ~RogueParameter() { delete mHandle; }
+
     virtual Type getType() const { return Parameter::RogueParameter; }
 
 protected:
@@ -95,29 +100,49 @@ protected:
     virtual bool setValue(const std::string &value)
     {
         T typedValue;
-        return convertAndroidParamValueToValue(value, typedValue) &&
-               ParameterMgrHelper::setParameterValue<T>(mParameterMgrConnector,
-                                                        getName(), typedValue);
+        std::string error;
+        return convertAndroidParamValueToValue(value, typedValue) && resolveHandle() &&
+               ParameterMgrHelper::setAsTypedValue<T>(mHandle, typedValue, error);
     }
 
     virtual bool getValue(std::string &value) const
     {
+        if (mHandle == NULL) {
+            audio_comms::utilities::Log::Error() << __FUNCTION__ << ": " << getName()
+                                                 << " not synchronized with the PFW";
+            return false;
+        }
         T typedValue;
-        return ParameterMgrHelper::getParameterValue<T>(mParameterMgrConnector, getName(),
-                                                        typedValue) &&
+        std::string error;
+        return ParameterMgrHelper::getAsTypedValue<T>(mHandle, typedValue, error) &&
                convertValueToAndroidParamValue(typedValue, value);
     }
 
     virtual bool sync()
     {
         T typedValue;
-        return audio_comms::utilities::convertTo(getDefaultLiteralValue(), typedValue) &&
-               ParameterMgrHelper::setParameterValue<T>(mParameterMgrConnector, getName(),
-                                                        typedValue);
+        std::string error;
+        return resolveHandle() &&
+               audio_comms::utilities::convertTo(getDefaultLiteralValue(), typedValue) &&
+               ParameterMgrHelper::setAsTypedValue<T>(mHandle, typedValue, error);
     }
 
 private:
+    /**
+     * Creates the handle on the rogue parameter if not done yet. Only called by the setters, as
+     * the getters may run concurrently.
+     *
+     * @return true if the handle is available, false otherwise.
+     */
+    bool resolveHandle()
+    {
+        return mHandle != NULL ||
+               ParameterMgrHelper::getParameterHandle(mParameterMgrConnector, mHandle, getName());
+    }
+
     CParameterMgrPlatformConnector *mParameterMgrConnector; /**< PFW connector. */
+
+    CParameterHandle *mHandle; /**< Handle on the rogue parameter, owned. */
 };
 
 } // namespace intel_audio
@@ -25,6 +25,8 @@ include $(OPTIONAL_QUALITY_ENV_SETUP)
 # Common variables
 
 component_src_files :=  \
+    src/AlsaMixer.cpp \
+    src/AlsaTopology.cpp \
     src/AudioUtils.cpp \
     src/SampleSpec.cpp
 
@@ -116,7 +118,9 @@ include $(BUILD_STATIC_LIBRARY)
 
 component_functional_test_src_files += \
     test/SampleSpecTest.cpp \
-    test/AudioUtilsTest.cpp
+    test/AudioUtilsTest.cpp \
+    test/AlsaTopologyTest.cpp \
+    test/AlsaMixerTest.cpp
 
 component_functional_test_static_lib := \
     libsamplespec_static
@@ -144,7 +148,8 @@ component_functional_test_static_lib_target += \
     liblog
 
 component_functional_test_shared_lib_target += \
-    libcutils
+    libcutils \
+    libtinyalsa
 
 ifeq ($(USE_ALSA_LIB), 1)
 component_functional_test_shared_lib_target += libasound
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <Mutex.hpp>
+#include <tinyalsa/asoundlib.h>
+#include <utils/Errors.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace intel_audio
+{
+
+/**
+ * Access to the mixer controls of the sound cards, one call per control access.
+ * Controls are identified by their index within the mixer of the card.
+ */
+class AlsaMixerBackend
+{
+public:
+    virtual ~AlsaMixerBackend() {}
+
+    /** @return true if the mixer of the card could be opened, false otherwise. */
+    virtual bool open(uint32_t card) = 0;
+
+    virtual void close(uint32_t card) = 0;
+
+    virtual uint32_t getControlCount(uint32_t card) = 0;
+
+    virtual std::string getControlName(uint32_t card, uint32_t control) = 0;
+
+    virtual mixer_ctl_type getControlType(uint32_t card, uint32_t control) = 0;
+
+    virtual uint32_t getValueCount(uint32_t card, uint32_t control) = 0;
+
+    /** @return 0 on success, negative value otherwise. */
+    virtual int getValues(uint32_t card, uint32_t control, int *values, uint32_t count) = 0;
+
+    /** @return 0 on success, negative value otherwise. */
+    virtual int setValues(uint32_t card, uint32_t control, const int *values,
+                          uint32_t count) = 0;
+};
+
+/**
+ * Process wide mixer service: the mixer of each card is opened once, its controls are indexed
+ * by name and the last value known of each control is cached, so that writing a control with
+ * the value it already holds is skipped.
+ * The values are cached on the assumption that the controls written through the service are
+ * owned by its clients. The cache is dropped with reset, e.g. when the audio subsystem
+ * recovers or a card is plugged or unplugged.
+ */
+class AlsaMixerService : private audio_comms::utilities::NonCopyable
+{
+public:
+    /** Values to write into a control, for batched writes. */
+    struct ControlValues
+    {
+        std::string control; /**< Name of the control, or its index within the mixer. */
+        std::vector<int> values;
+    };
+
+    struct Stats
+    {
+        uint32_t opens; /**< Mixers opened. */
+        uint32_t reads; /**< Control reads issued to the backend. */
+        uint32_t writes; /**< Control writes issued to the backend. */
+        uint32_t opensAvoided; /**< Accesses served by a mixer already opened. */
+        uint32_t writesAvoided; /**< Writes skipped as the control held the value already. */
+    };
+
+    static AlsaMixerService &getInstance();
+
+    /**
+     * Set the backend to access the mixers, e.g. a fake mixer for tests. The mixers opened are
+     * closed and the cache dropped.
+     *
+     * @param[in] backend to use, NULL to restore tinyalsa backend. Not owned by the service.
+     */
+    void setBackend(AlsaMixerBackend *backend);
+
+    /** Close the mixers opened and drop the cache. */
+    void reset();
+
+    /**
+     * @param[in] card index of the sound card.
+     * @param[in] control name of the control, or its index within the mixer.
+     * @param[out] type of the control.
+     * @param[out] count number of values of the control.
+     *
+     * @return OK if the control was found, error code otherwise.
+     */
+    android::status_t getControlInfo(uint32_t card, const std::string &control,
+                                     mixer_ctl_type &type, uint32_t &count);
+
+    /**
+     * Read the values of a control from the hardware, refreshing the cache.
+     *
+     * @param[in] card index of the sound card.
+     * @param[in] control name of the control, or its index within the mixer.
+     * @param[out] values of the control, as many as the control holds.
+     *
+     * @return OK if read, error code otherwise.
+     */
+    android::status_t getValues(uint32_t card, const std::string &control,
+                                std::vector<int> &values);
+
+    /**
+     * Write the values of a control, unless the control is known to hold them already.
+     * A single value is applied to all the values of the control.
+     *
+     * @param[in] card index of the sound card.
+     * @param[in] control name of the control, or its index within the mixer.
+     * @param[in] values to write.
+     *
+     * @return OK if written or skipped, error code otherwise.
+     */
+    android::status_t setValues(uint32_t card, const std::string &control,
+                                const std::vector<int> &values);
+
+    /**
+     * Write several controls of a card at once, in order, skipping the unchanged ones.
+     * All the controls are attempted even if one fails.
+     *
+     * @param[in] card index of the sound card.
+     * @param[in] batch controls and values to write.
+     *
+     * @return OK if all the controls were written or skipped, first error code otherwise.
+     */
+    android::status_t setValues(uint32_t card, const std::vector<ControlValues> &batch);
+
+    Stats getStats() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+private:
+    struct Control
+    {
+        uint32_t index;
+        mixer_ctl_type type;
+        uint32_t valueCount;
+        std::vector<int> values; /**< Last values known, empty if unknown. */
+    };
+
+    struct Mixer
+    {
+        std::unordered_map<std::string, uint32_t> controlIndexes; /**< Name to index. */
+        std::map<uint32_t, Control> controls; /**< Controls accessed, by index. */
+    };
+
+    AlsaMixerService();
+
+    /** @return mixer of the card, opened on first access, NULL if it cannot be opened. */
+    Mixer *getMixerUnsafe(uint32_t card);
+
+    /** @return control of the mixer, NULL if not found. */
+    Control *getControlUnsafe(uint32_t card, const std::string &control);
+
+    android::status_t setValuesUnsafe(uint32_t card, const std::string &control,
+                                      const std::vector<int> &values);
+
+    void resetUnsafe();
+
+    AlsaMixerBackend *mBackend;
+    std::map<uint32_t, Mixer> mMixers; /**< Mixers opened, by card. */
+    Stats mStats;
+    mutable audio_comms::utilities::Mutex mLock;
+};
+
+} // namespace intel_audio
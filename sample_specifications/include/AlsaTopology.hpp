@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioNonCopyable.hpp>
+#include <Mutex.hpp>
+#include <utils/Errors.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+/**
+ * Process wide cache of the ALSA topology, i.e. the card name to index translation from procfs
+ * and the PCM and compress device nodes of each card.
+ * The cache is filled on first use (or explicitly by refresh at startup) and invalidated per
+ * card on the sound uevents, so that the card and device lookups done on stream and route
+ * opening do not hit the file system.
+ */
+class AlsaTopology : private audio_comms::utilities::NonCopyable
+{
+public:
+    /** Capability of a device node. */
+    enum NodeType
+    {
+        PcmPlayback,
+        PcmCapture,
+        Compress
+    };
+
+    struct DeviceNode
+    {
+        uint32_t card;
+        uint32_t device;
+        NodeType type;
+    };
+
+    struct Stats
+    {
+        uint32_t hits; /**< Lookups served from the cache. */
+        uint32_t misses; /**< Lookups that required to browse the file system. */
+        uint32_t invalidations; /**< Sound uevents that invalidated a card. */
+    };
+
+    static AlsaTopology &getInstance();
+
+    /**
+     * Override the roots of the topology, i.e. /proc/asound and /dev/snd. Used by tests to run
+     * against a fake tree. The cache is flushed.
+     *
+     * @param[in] procRoot directory holding the card name links.
+     * @param[in] devRoot directory holding the device nodes.
+     */
+    void setRoots(const std::string &procRoot, const std::string &devRoot);
+
+    /** Flush the cache and browse the topology again, e.g. at startup. */
+    void refresh();
+
+    /**
+     * Converts a card name into its index.
+     *
+     * @param[in] name of the sound card, either friendly name or "cardX".
+     *
+     * @return index if found, negative errno otherwise. Failures are not cached.
+     */
+    int getCardIndex(const char *name);
+
+    /** @return index of the first compress device found, negative value otherwise. */
+    int getCompressDeviceIndex();
+
+    /**
+     * @param[in] card index of the sound card.
+     *
+     * @return device nodes of the card, sorted by device index.
+     */
+    std::vector<DeviceNode> getDeviceNodes(uint32_t card);
+
+    /** @return true if the given device of the card exposes a node of the given type. */
+    bool hasDeviceNode(uint32_t card, uint32_t device, NodeType type);
+
+    /**
+     * Invalidate the cards targeted by a uevent, i.e. a sequence of null terminated "key=value"
+     * entries. Uevents of subsystems other than sound are ignored.
+     *
+     * @param[in] msg uevent message.
+     * @param[in] size of the message in bytes.
+     *
+     * @return true if a card was invalidated, false otherwise.
+     */
+    bool onUEvent(const char *msg, size_t size);
+
+    /** Drop what is known of a card: names resolved to it and its device nodes. */
+    void invalidateCard(uint32_t card);
+
+    Stats getStats() const;
+
+    android::status_t dump(const int fd, int spaces = 0) const;
+
+    static const char *const gDefaultProcRoot;
+    static const char *const gDefaultDevRoot;
+
+private:
+    AlsaTopology();
+
+    /** Translates a card name into its index from procfs, uncached. */
+    int resolveCardIndex(const char *name) const;
+
+    /** Browse the device nodes, of all the cards or of the stale ones only. Lock held. */
+    void scanDeviceNodesUnsafe();
+
+    /**
+     * Parse the name of a device node, i.e. pcmC<card>D<device><p|c> or comprC<card>D<device>.
+     *
+     * @return true if the name is the one of a device node, false otherwise.
+     */
+    static bool parseNodeName(const char *name, DeviceNode &node);
+
+    /** Card a uevent entry refers to, i.e. "DEVPATH=.../sound/cardX[/...]". */
+    static bool parseUEventCard(const char *entry, size_t length, uint32_t &card);
+
+    std::string mProcRoot;
+    std::string mDevRoot;
+    std::map<std::string, int> mCardIndexes; /**< Card name to index. */
+    std::vector<DeviceNode> mDeviceNodes; /**< Sorted by card then device. */
+    bool mAllCardsStale; /**< Device nodes never browsed, or flushed. */
+    std::set<uint32_t> mStaleCards; /**< Cards to browse again on next lookup. */
+    Stats mStats;
+    mutable audio_comms::utilities::Mutex mLock;
+};
+
+} // namespace intel_audio
@@ -96,7 +96,7 @@ public:
      * Converts a card name into its index.
      * Tiny ALSA does not provide any utility to translate a name into a card index.
      * This function gets information from procfs to translate a card name into the corresponding
-     * index
+     * index, through the cache of the ALSA topology.
      *
      * @param[in] name of the sound card.
      *
@@ -106,6 +106,7 @@ public:
 
     /**
      * Get and convert a compress device into its index.
+     * The device nodes are browsed once, then served from the cache of the ALSA topology.
      *
      * @return index of the first compress device found, negative value otherwise.
      */
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "AlsaMixer"
+
+#include "AlsaMixer.hpp"
+#include <convert.hpp>
+#include <utilities/Log.hpp>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace std;
+using android::status_t;
+using audio_comms::utilities::convertTo;
+using audio_comms::utilities::Log;
+using audio_comms::utilities::Mutex;
+
+namespace intel_audio
+{
+
+/** Mixer backend relying on tinyalsa. */
+class TinyAlsaMixerBackend : public AlsaMixerBackend
+{
+public:
+    virtual ~TinyAlsaMixerBackend()
+    {
+        for (const auto &mixer : mMixers) {
+            mixer_close(mixer.second);
+        }
+    }
+
+    virtual bool open(uint32_t card)
+    {
+        struct mixer *mixer = mixer_open(card);
+        if (mixer == NULL) {
+            return false;
+        }
+        mMixers[card] = mixer;
+        return true;
+    }
+
+    virtual void close(uint32_t card)
+    {
+        map<uint32_t, struct mixer *>::iterator it = mMixers.find(card);
+        if (it != mMixers.end()) {
+            mixer_close(it->second);
+            mMixers.erase(it);
+        }
+    }
+
+    virtual uint32_t getControlCount(uint32_t card)
+    {
+        return mixer_get_num_ctls(mMixers[card]);
+    }
+
+    virtual string getControlName(uint32_t card, uint32_t control)
+    {
+        const char *name = mixer_ctl_get_name(getControl(card, control));
+        return name != NULL ? name : "";
+    }
+
+    virtual mixer_ctl_type getControlType(uint32_t card, uint32_t control)
+    {
+        return mixer_ctl_get_type(getControl(card, control));
+    }
+
+    virtual uint32_t getValueCount(uint32_t card, uint32_t control)
+    {
+        return mixer_ctl_get_num_values(getControl(card, control));
+    }
+
+    virtual int getValues(uint32_t card, uint32_t control, int *values, uint32_t count)
+    {
+        return mixer_ctl_get_array(getControl(card, control), values, count);
+    }
+
+    virtual int setValues(uint32_t card, uint32_t control, const int *values, uint32_t count)
+    {
+        return mixer_ctl_set_array(getControl(card, control), values, count);
+    }
+
+private:
+    struct mixer_ctl *getControl(uint32_t card, uint32_t control)
+    {
+        return mixer_get_ctl(mMixers[card], control);
+    }
+
+    map<uint32_t, struct mixer *> mMixers;
+};
+
+static TinyAlsaMixerBackend gTinyAlsaMixerBackend;
+
+AlsaMixerService &AlsaMixerService::getInstance()
+{
+    static AlsaMixerService instance;
+    return instance;
+}
+
+AlsaMixerService::AlsaMixerService() : mBackend(&gTinyAlsaMixerBackend), mStats()
+{
+}
+
+void AlsaMixerService::setBackend(AlsaMixerBackend *backend)
+{
+    Mutex::Locker locker(mLock);
+    resetUnsafe();
+    mBackend = backend != NULL ? backend : &gTinyAlsaMixerBackend;
+    mStats = Stats();
+}
+
+void AlsaMixerService::reset()
+{
+    Mutex::Locker locker(mLock);
+    resetUnsafe();
+}
+
+void AlsaMixerService::resetUnsafe()
+{
+    for (const auto &mixer : mMixers) {
+        mBackend->close(mixer.first);
+    }
+    mMixers.clear();
+}
+
+AlsaMixerService::Mixer *AlsaMixerService::getMixerUnsafe(uint32_t card)
+{
+    map<uint32_t, Mixer>::iterator it = mMixers.find(card);
+    if (it != mMixers.end()) {
+        mStats.opensAvoided++;
+        return &it->second;
+    }
+    if (!mBackend->open(card)) {
+        Log::Error() << __FUNCTION__ << ": Failed to open mixer for card " << card;
+        return NULL;
+    }
+    mStats.opens++;
+
+    // Index the controls once, tinyalsa looks them up by name linearly.
+    Mixer &mixer = mMixers[card];
+    uint32_t count = mBackend->getControlCount(card);
+    mixer.controlIndexes.reserve(count);
+    for (uint32_t index = 0; index < count; index++) {
+        // Keep the first control of a given name, as tinyalsa does
+        mixer.controlIndexes.insert(make_pair(mBackend->getControlName(card, index), index));
+    }
+    return &mixer;
+}
+
+AlsaMixerService::Control *AlsaMixerService::getControlUnsafe(uint32_t card,
+                                                              const string &control)
+{
+    Mixer *mixer = getMixerUnsafe(card);
+    if (mixer == NULL) {
+        return NULL;
+    }
+    uint32_t index;
+    unordered_map<string, uint32_t>::const_iterator it = mixer->controlIndexes.find(control);
+    if (it != mixer->controlIndexes.end()) {
+        index = it->second;
+    } else if (!convertTo<string, uint32_t>(control, index) ||
+               index >= mixer->controlIndexes.size()) {
+        Log::Error() << __FUNCTION__ << ": no control " << control << " on card " << card;
+        return NULL;
+    }
+    map<uint32_t, Control>::iterator controlIt = mixer->controls.find(index);
+    if (controlIt != mixer->controls.end()) {
+        return &controlIt->second;
+    }
+    Control &newControl = mixer->controls[index];
+    newControl.index = index;
+    newControl.type = mBackend->getControlType(card, index);
+    newControl.valueCount = mBackend->getValueCount(card, index);
+    return &newControl;
+}
+
+status_t AlsaMixerService::getControlInfo(uint32_t card, const string &control,
+                                          mixer_ctl_type &type, uint32_t &count)
+{
+    Mutex::Locker locker(mLock);
+    Control *mixerControl = getControlUnsafe(card, control);
+    if (mixerControl == NULL) {
+        return android::BAD_VALUE;
+    }
+    type = mixerControl->type;
+    count = mixerControl->valueCount;
+    return android::OK;
+}
+
+status_t AlsaMixerService::getValues(uint32_t card, const string &control, vector<int> &values)
+{
+    Mutex::Locker locker(mLock);
+    Control *mixerControl = getControlUnsafe(card, control);
+    if (mixerControl == NULL) {
+        return android::BAD_VALUE;
+    }
+    values.resize(mixerControl->valueCount);
+    mStats.reads++;
+    if (values.empty() ||
+        mBackend->getValues(card, mixerControl->index, &values[0], values.size()) < 0) {
+        Log::Error() << __FUNCTION__ << ": Failed to read control " << control;
+        mixerControl->values.clear();
+        return android::INVALID_OPERATION;
+    }
+    mixerControl->values = values;
+    return android::OK;
+}
+
+status_t AlsaMixerService::setValues(uint32_t card, const string &control,
+                                     const vector<int> &values)
+{
+    Mutex::Locker locker(mLock);
+    return setValuesUnsafe(card, control, values);
+}
+
+status_t AlsaMixerService::setValues(uint32_t card, const vector<ControlValues> &batch)
+{
+    Mutex::Locker locker(mLock);
+    status_t status = android::OK;
+    for (const auto &controlValues : batch) {
+        status_t ret = setValuesUnsafe(card, controlValues.control, controlValues.values);
+        if (status == android::OK) {
+            status = ret;
+        }
+    }
+    return status;
+}
+
+status_t AlsaMixerService::setValuesUnsafe(uint32_t card, const string &control,
+                                           const vector<int> &values)
+{
+    Control *mixerControl = getControlUnsafe(card, control);
+    if (mixerControl == NULL) {
+        return android::BAD_VALUE;
+    }
+    if (values.empty() || (values.size() != 1 && values.size() != mixerControl->valueCount)) {
+        Log::Error() << __FUNCTION__ << ": control " << control << " expects "
+                     << mixerControl->valueCount << " value(s), got " << values.size();
+        return android::BAD_VALUE;
+    }
+    vector<int> newValues(values.size() == 1 ? vector<int>(mixerControl->valueCount, values[0])
+                          : values);
+    if (newValues == mixerControl->values) {
+        mStats.writesAvoided++;
+        return android::OK;
+    }
+    mStats.writes++;
+    if (mBackend->setValues(card, mixerControl->index, &newValues[0], newValues.size()) < 0) {
+        Log::Error() << __FUNCTION__ << ": Failed to write control " << control;
+        mixerControl->values.clear();
+        return android::INVALID_OPERATION;
+    }
+    mixerControl->values.swap(newValues);
+    return android::OK;
+}
+
+AlsaMixerService::Stats AlsaMixerService::getStats() const
+{
+    Mutex::Locker locker(mLock);
+    return mStats;
+}
+
+status_t AlsaMixerService::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    string result;
+
+    Mutex::Locker locker(mLock);
+    snprintf(buffer, SIZE, "%*sMixers: %zu opened, %u opens, %u reads, %u writes, avoided %u opens"
+             " %u writes\n", spaces, "", mMixers.size(), mStats.opens, mStats.reads,
+             mStats.writes, mStats.opensAvoided, mStats.writesAvoided);
+    result.append(buffer);
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
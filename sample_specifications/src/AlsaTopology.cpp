@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "AlsaTopology"
+
+#include "AlsaTopology.hpp"
+#include <convert.hpp>
+#include <utilities/Log.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace std;
+using audio_comms::utilities::convertTo;
+using audio_comms::utilities::Log;
+using audio_comms::utilities::Mutex;
+
+namespace intel_audio
+{
+
+const char *const AlsaTopology::gDefaultProcRoot = "/proc/asound";
+const char *const AlsaTopology::gDefaultDevRoot = "/dev/snd";
+
+static const char *const gCardPrefix = "card";
+
+static bool operator<(const AlsaTopology::DeviceNode &left, const AlsaTopology::DeviceNode &right)
+{
+    if (left.card != right.card) {
+        return left.card < right.card;
+    }
+    if (left.device != right.device) {
+        return left.device < right.device;
+    }
+    return left.type < right.type;
+}
+
+AlsaTopology &AlsaTopology::getInstance()
+{
+    static AlsaTopology instance;
+    return instance;
+}
+
+AlsaTopology::AlsaTopology()
+    : mProcRoot(gDefaultProcRoot), mDevRoot(gDefaultDevRoot), mAllCardsStale(true), mStats()
+{
+}
+
+void AlsaTopology::setRoots(const string &procRoot, const string &devRoot)
+{
+    Mutex::Locker locker(mLock);
+    mProcRoot = procRoot;
+    mDevRoot = devRoot;
+    mCardIndexes.clear();
+    mDeviceNodes.clear();
+    mStaleCards.clear();
+    mAllCardsStale = true;
+}
+
+void AlsaTopology::refresh()
+{
+    Mutex::Locker locker(mLock);
+    mCardIndexes.clear();
+    mStaleCards.clear();
+    mAllCardsStale = true;
+    scanDeviceNodesUnsafe();
+
+    // Cache the friendly names of the cards, i.e. the links of procfs onto "cardX".
+    DIR *directory = opendir(mProcRoot.c_str());
+    if (directory == NULL) {
+        Log::Error() << __FUNCTION__ << ": cannot browse " << mProcRoot;
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN) {
+            continue;
+        }
+        int index = resolveCardIndex(entry->d_name);
+        if (index >= 0) {
+            mCardIndexes[entry->d_name] = index;
+        }
+    }
+    closedir(directory);
+    Log::Debug() << __FUNCTION__ << ": " << mCardIndexes.size() << " card name(s), "
+                 << mDeviceNodes.size() << " device node(s)";
+}
+
+int AlsaTopology::resolveCardIndex(const char *name) const
+{
+    char cardNameWithIndex[NAME_MAX] = {
+        0
+    };
+    const int cardLen = strlen(gCardPrefix);
+    string cardFilePath = mProcRoot + "/" + name;
+
+    /**
+     * The card name might have been provided with user friendly name.
+     * This entry, if exists, must be a symbolic link on the real audio card known as "cardX".
+     */
+    ssize_t written = readlink(cardFilePath.c_str(), cardNameWithIndex,
+                               sizeof(cardNameWithIndex));
+    if (written < 0) {
+        return -errno;
+    } else if (written >= (ssize_t)sizeof(cardNameWithIndex)) {
+
+        // This will probably never happen
+        return -ENAMETOOLONG;
+    } else if (written <= cardLen || strncmp(cardNameWithIndex, gCardPrefix, cardLen)) {
+
+        // Waiting at least card length + index of the card
+        return -EBADFD;
+    }
+    uint32_t indexCard = 0;
+    if (!convertTo<string, uint32_t>(cardNameWithIndex + cardLen, indexCard)) {
+        return -EINVAL;
+    }
+    return indexCard;
+}
+
+int AlsaTopology::getCardIndex(const char *name)
+{
+    if (name == NULL) {
+        Log::Error() << __FUNCTION__ << ": invalid card name";
+        return -1;
+    }
+    const int cardLen = strlen(gCardPrefix);
+    if (!strncmp(name, gCardPrefix, cardLen)) {
+
+        // Card name provided as "cardX", no need to browse procfs.
+        uint32_t indexCard = 0;
+        if (!convertTo<string, uint32_t>(name + cardLen, indexCard)) {
+            return -EINVAL;
+        }
+        return indexCard;
+    }
+    Mutex::Locker locker(mLock);
+    map<string, int>::const_iterator it = mCardIndexes.find(name);
+    if (it != mCardIndexes.end()) {
+        mStats.hits++;
+        return it->second;
+    }
+    mStats.misses++;
+    int index = resolveCardIndex(name);
+    if (index < 0) {
+        Log::Error() << "Sound card " << name << " does not exist";
+        return index;
+    }
+    mCardIndexes[name] = index;
+    return index;
+}
+
+bool AlsaTopology::parseNodeName(const char *name, DeviceNode &node)
+{
+    int consumed = 0;
+    char direction = 0;
+    if (sscanf(name, "pcmC%uD%u%c%n", &node.card, &node.device, &direction, &consumed) == 3 &&
+        name[consumed] == '\0' && (direction == 'p' || direction == 'c')) {
+        node.type = direction == 'p' ? PcmPlayback : PcmCapture;
+        return true;
+    }
+    consumed = 0;
+    if (sscanf(name, "comprC%uD%u%n", &node.card, &node.device, &consumed) == 2 &&
+        consumed != 0 && name[consumed] == '\0') {
+        node.type = Compress;
+        return true;
+    }
+    return false;
+}
+
+void AlsaTopology::scanDeviceNodesUnsafe()
+{
+    if (!mAllCardsStale && mStaleCards.empty()) {
+        mStats.hits++;
+        return;
+    }
+    mStats.misses++;
+    if (mAllCardsStale) {
+        mDeviceNodes.clear();
+    }
+    DIR *directory = opendir(mDevRoot.c_str());
+    if (directory == NULL) {
+        Log::Error() << __FUNCTION__ << ": cannot browse " << mDevRoot;
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        DeviceNode node;
+        if (parseNodeName(entry->d_name, node) &&
+            (mAllCardsStale || mStaleCards.find(node.card) != mStaleCards.end())) {
+            mDeviceNodes.push_back(node);
+        }
+    }
+    closedir(directory);
+    sort(mDeviceNodes.begin(), mDeviceNodes.end());
+    mAllCardsStale = false;
+    mStaleCards.clear();
+}
+
+int AlsaTopology::getCompressDeviceIndex()
+{
+    Mutex::Locker locker(mLock);
+    scanDeviceNodesUnsafe();
+    int count = 0;
+    int device = -ENODEV;
+    for (const auto &node : mDeviceNodes) {
+        if (node.type == Compress) {
+            if (count++ == 0) {
+                device = node.device;
+            }
+        }
+    }
+    if (count == 0) {
+        Log::Error() << __FUNCTION__ << ": no compressed devices found";
+    } else if (count > 1) {
+        Log::Verbose() << __FUNCTION__ << ": multiple (" << count
+                       << ") compressed devices found, using first one";
+    }
+    return device;
+}
+
+vector<AlsaTopology::DeviceNode> AlsaTopology::getDeviceNodes(uint32_t card)
+{
+    Mutex::Locker locker(mLock);
+    scanDeviceNodesUnsafe();
+    vector<DeviceNode> nodes;
+    for (const auto &node : mDeviceNodes) {
+        if (node.card == card) {
+            nodes.push_back(node);
+        }
+    }
+    return nodes;
+}
+
+bool AlsaTopology::hasDeviceNode(uint32_t card, uint32_t device, NodeType type)
+{
+    Mutex::Locker locker(mLock);
+    scanDeviceNodesUnsafe();
+    DeviceNode node = {
+        card, device, type
+    };
+    return binary_search(mDeviceNodes.begin(), mDeviceNodes.end(), node);
+}
+
+bool AlsaTopology::parseUEventCard(const char *entry, size_t length, uint32_t &card)
+{
+    static const char *const devPath = "DEVPATH=";
+    static const char *const soundCard = "/sound/card";
+    if (length <= strlen(devPath) || strncmp(entry, devPath, strlen(devPath))) {
+        return false;
+    }
+    const char *path = strstr(entry, soundCard);
+    if (path == NULL) {
+        return false;
+    }
+    path += strlen(soundCard);
+    size_t digits = strspn(path, "0123456789");
+    return digits != 0 && (path[digits] == '\0' || path[digits] == '/') &&
+           convertTo<string, uint32_t>(string(path, digits), card);
+}
+
+bool AlsaTopology::onUEvent(const char *msg, size_t size)
+{
+    bool isSound = false;
+    bool isHotplug = false;
+    bool hasCard = false;
+    uint32_t card = 0;
+    const char *end = msg + size;
+    for (const char *entry = msg; entry < end; entry += strnlen(entry, end - entry) + 1) {
+        size_t length = strnlen(entry, end - entry);
+        string keyValue(entry, length);
+        if (keyValue == "SUBSYSTEM=sound") {
+            isSound = true;
+        } else if (keyValue == "ACTION=add" || keyValue == "ACTION=remove") {
+            isHotplug = true;
+        } else if (parseUEventCard(keyValue.c_str(), length, card)) {
+            hasCard = true;
+        }
+    }
+    if (!isSound || !isHotplug || !hasCard) {
+        return false;
+    }
+    invalidateCard(card);
+    return true;
+}
+
+void AlsaTopology::invalidateCard(uint32_t card)
+{
+    Mutex::Locker locker(mLock);
+    mStats.invalidations++;
+    for (map<string, int>::iterator it = mCardIndexes.begin(); it != mCardIndexes.end();) {
+        if (it->second == static_cast<int>(card)) {
+            mCardIndexes.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+    mDeviceNodes.erase(remove_if(mDeviceNodes.begin(), mDeviceNodes.end(),
+                                 [card](const DeviceNode &node) { return node.card == card; }),
+                       mDeviceNodes.end());
+    mStaleCards.insert(card);
+    Log::Debug() << __FUNCTION__ << ": card " << card;
+}
+
+AlsaTopology::Stats AlsaTopology::getStats() const
+{
+    Mutex::Locker locker(mLock);
+    return mStats;
+}
+
+android::status_t AlsaTopology::dump(const int fd, int spaces) const
+{
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    string result;
+
+    Mutex::Locker locker(mLock);
+    snprintf(buffer, SIZE, "%*sALSA topology: hits %u misses %u invalidations %u\n", spaces, "",
+             mStats.hits, mStats.misses, mStats.invalidations);
+    result.append(buffer);
+    for (const auto &cardIndex : mCardIndexes) {
+        snprintf(buffer, SIZE, "%*s%s: card%d\n", spaces + 4, "", cardIndex.first.c_str(),
+                 cardIndex.second);
+        result.append(buffer);
+    }
+    static const char *const nodeTypes[] = {
+        "playback", "capture", "compress"
+    };
+    for (const auto &node : mDeviceNodes) {
+        snprintf(buffer, SIZE, "%*scard%u device %u: %s\n", spaces + 4, "", node.card,
+                 node.device, nodeTypes[node.type]);
+        result.append(buffer);
+    }
+    write(fd, result.c_str(), result.size());
+    return android::OK;
+}
+
+} // namespace intel_audio
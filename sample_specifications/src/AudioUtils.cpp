@@ -16,19 +16,18 @@
 #define LOG_TAG "AudioUtils"
 
 #include "AudioUtils.hpp"
+#include "AlsaTopology.hpp"
 #include "SampleSpec.hpp"
 #include <AudioCommsAssert.hpp>
 #include <cerrno>
-#include <convert.hpp>
+#include <limits>
 #include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <dirent.h>
 #include <hardware/audio.h>
 #include <utilities/Log.hpp>
 
 using namespace std;
-using audio_comms::utilities::convertTo;
 using audio_comms::utilities::Log;
 
 namespace intel_audio
@@ -114,85 +113,12 @@ pcm_format AudioUtils::convertHalToTinyFormat(audio_format_t format)
 
 int AudioUtils::getCardIndexByName(const char *name)
 {
-    if (name == NULL) {
-        Log::Error() << __FUNCTION__ << ": invalid card name";
-        return -1;
-    }
-    char cardFilePath[PATH_MAX] = {
-        0
-    };
-    char cardNameWithIndex[NAME_MAX] = {
-        0
-    };
-    const char *const card = "card";
-    const int cardLen = strlen(card);
-
-    if (!strncmp(name, card, cardLen)) {
-
-        /**
-         * Checks first if the card name provided as "cardX". (Must start with 'card').
-         */
-        snprintf(cardNameWithIndex, sizeof(cardNameWithIndex), "%s", name);
-    } else {
-
-        /**
-         * The card name might have been provided with user friendly name.
-         * To retrieve the index, checks first if this name matches an entry in /proc/asound.
-         * This entry, if exists, must be a symbolic link on the real audio card known as "cardX".
-         */
-        ssize_t written;
-
-        snprintf(cardFilePath, sizeof(cardFilePath), "/proc/asound/%s", name);
-
-        written = readlink(cardFilePath, cardNameWithIndex, sizeof(cardNameWithIndex));
-        if (written < 0) {
-            Log::Error() << "Sound card " << name << " does not exist";
-            return -errno;
-        } else if (written >= (ssize_t)sizeof(cardNameWithIndex)) {
-
-            // This will probably never happen
-            return -ENAMETOOLONG;
-        } else if (written <= cardLen) {
-
-            // Waiting at least card length + index of the card
-            return -EBADFD;
-        }
-    }
-
-    uint32_t indexCard = 0;
-    if (!convertTo<string, uint32_t>(cardNameWithIndex + cardLen, indexCard)) {
-
-        return -EINVAL;
-    }
-    return indexCard;
-}
-
-static int compressDeviceFilter(const struct dirent *entry)
-{
-    static const char *const compressDevicePrefix = "comprC";
-    return !strncmp(entry->d_name, compressDevicePrefix, strlen(compressDevicePrefix));
+    return AlsaTopology::getInstance().getCardIndex(name);
 }
 
 int AudioUtils::getCompressDeviceIndex()
 {
-    struct dirent **fileList;
-    int count = scandir("/dev/snd", &fileList, compressDeviceFilter, NULL);
-    if (count <= 0) {
-        Log::Error() << __FUNCTION__ << ": no compressed devices found";
-        return -ENODEV;
-    } else if (count > 1) {
-        Log::Verbose() << __FUNCTION__ << ": multiple (" << count
-                       << ") compressed devices found, using first one";
-    }
-    const char *devName = fileList[0]->d_name;
-    Log::Verbose() << __FUNCTION__ << ": compressed device node: " << devName;
-
-    int dev = 0;
-    static const char *compressDevice = "comprCxD";
-    if (!convertTo<std::string, int>(devName + strlen(compressDevice), dev)) {
-        return -ENODEV;
-    }
-    return dev;
+    return AlsaTopology::getInstance().getCompressDeviceIndex();
 }
 
 uint32_t AudioUtils::convertUsecToMsec(uint32_t timeUsec)
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FakeMixerBackend.hpp"
+#include <AlsaMixer.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace std;
+
+namespace intel_audio
+{
+
+static const uint32_t gCard = 1;
+
+class AlsaMixerTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        mBackend.addControl(gCard, "media0_in volume 0 volume", MIXER_CTL_TYPE_INT, {0, 0});
+        mBackend.addControl(gCard, "media0_in volume 0 mute", MIXER_CTL_TYPE_BOOL, {1});
+        mBackend.addControl(gCard, "media0_in volume 0 rampduration", MIXER_CTL_TYPE_INT,
+                            {0, 0});
+        mBackend.addControl(gCard, "Playback Channel Map", MIXER_CTL_TYPE_INT, {1, 1, 0, 0});
+        AlsaMixerService::getInstance().setBackend(&mBackend);
+    }
+
+    virtual void TearDown()
+    {
+        AlsaMixerService::getInstance().setBackend(NULL);
+    }
+
+    FakeMixerBackend mBackend;
+};
+
+TEST_F(AlsaMixerTest, mixerIsOpenedOnce)
+{
+    AlsaMixerService &service = AlsaMixerService::getInstance();
+    vector<int> values;
+    EXPECT_EQ(android::OK, service.getValues(gCard, "media0_in volume 0 mute", values));
+    EXPECT_EQ(android::OK, service.getValues(gCard, "Playback Channel Map", values));
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 mute", {0}));
+
+    EXPECT_EQ(1u, mBackend.mOpens);
+    EXPECT_EQ(4u, mBackend.mNameQueries);
+    EXPECT_EQ(1u, service.getStats().opens);
+    EXPECT_EQ(2u, service.getStats().opensAvoided);
+
+    service.reset();
+    EXPECT_EQ(1u, mBackend.mCloses);
+    EXPECT_EQ(android::OK, service.getValues(gCard, "media0_in volume 0 mute", values));
+    EXPECT_EQ(2u, mBackend.mOpens);
+}
+
+TEST_F(AlsaMixerTest, controlLookup)
+{
+    AlsaMixerService &service = AlsaMixerService::getInstance();
+    mixer_ctl_type type;
+    uint32_t count;
+    ASSERT_EQ(android::OK, service.getControlInfo(gCard, "Playback Channel Map", type, count));
+    EXPECT_EQ(MIXER_CTL_TYPE_INT, type);
+    EXPECT_EQ(4u, count);
+
+    // By index within the mixer
+    ASSERT_EQ(android::OK, service.getControlInfo(gCard, "1", type, count));
+    EXPECT_EQ(MIXER_CTL_TYPE_BOOL, type);
+    EXPECT_EQ(1u, count);
+
+    EXPECT_NE(android::OK, service.getControlInfo(gCard, "4", type, count));
+    EXPECT_NE(android::OK, service.getControlInfo(gCard, "Unknown", type, count));
+    EXPECT_NE(android::OK, service.getControlInfo(gCard + 1, "1", type, count));
+}
+
+TEST_F(AlsaMixerTest, readValues)
+{
+    AlsaMixerService &service = AlsaMixerService::getInstance();
+    vector<int> values;
+    ASSERT_EQ(android::OK, service.getValues(gCard, "Playback Channel Map", values));
+    EXPECT_EQ(vector<int>({1, 1, 0, 0}), values);
+
+    // Reads always reach the hardware, the control may change behind the service
+    mBackend.getControl(gCard, 3).values = {1, 1, 1, 1, 1, 1};
+    ASSERT_EQ(android::OK, service.getValues(gCard, "Playback Channel Map", values));
+    EXPECT_EQ(vector<int>({1, 1, 1, 1}), values);
+    EXPECT_EQ(2u, mBackend.mReads);
+}
+
+TEST_F(AlsaMixerTest, unchangedWritesAreSkipped)
+{
+    AlsaMixerService &service = AlsaMixerService::getInstance();
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 volume", {-60, -30}));
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 volume", {-60, -30}));
+    EXPECT_EQ(vector<int>({-60, -30}), mBackend.getControl(gCard, 0).values);
+    EXPECT_EQ(1u, mBackend.mWrites);
+
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 volume", {-60, -20}));
+    EXPECT_EQ(2u, mBackend.mWrites);
+
+    // A single value is applied to all the values of the control
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 rampduration", {5}));
+    EXPECT_EQ(vector<int>({5, 5}), mBackend.getControl(gCard, 2).values);
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 rampduration", {5, 5}));
+    EXPECT_EQ(3u, mBackend.mWrites);
+
+    // A value read is known as held by the control
+    vector<int> values;
+    EXPECT_EQ(android::OK, service.getValues(gCard, "media0_in volume 0 mute", values));
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 mute", {1}));
+    EXPECT_EQ(3u, mBackend.mWrites);
+
+    AlsaMixerService::Stats stats = service.getStats();
+    EXPECT_EQ(3u, stats.writes);
+    EXPECT_EQ(3u, stats.writesAvoided);
+
+    // Cache dropped on reset
+    service.reset();
+    EXPECT_EQ(android::OK, service.setValues(gCard, "media0_in volume 0 volume", {-60, -20}));
+    EXPECT_EQ(4u, mBackend.mWrites);
+}
+
+TEST_F(AlsaMixerTest, invalidWrites)
+{
+    AlsaMixerService &service = AlsaMixerService::getInstance();
+    EXPECT_EQ(android::BAD_VALUE, service.setValues(gCard, "media0_in volume 0 volume", {}));
+    EXPECT_EQ(android::BAD_VALUE,
+              service.setValues(gCard, "media0_in volume 0 volume", {1, 2, 3}));
+    EXPECT_EQ(android::BAD_VALUE, service.setValues(gCard, "Unknown", {1}));
+    EXPECT_EQ(0u, mBackend.mWrites);
+}
+
+TEST_F(AlsaMixerTest, batchedWrites)
+{
+    AlsaMixerService &service = AlsaMixerService::getInstance();
+    vector<AlsaMixerService::ControlValues> batch = {
+        {"media0_in volume 0 rampduration", {5}},
+        {"media0_in volume 0 volume", {-60, -60}},
+        {"media0_in volume 0 mute", {0}}
+    };
+    EXPECT_EQ(android::OK, service.setValues(gCard, batch));
+    EXPECT_EQ(3u, mBackend.mWrites);
+    EXPECT_EQ(vector<int>({0}), mBackend.getControl(gCard, 1).values);
+
+    // Only the changed control is written, the failing one does not prevent the others
+    batch[1].values = {-50, -50};
+    batch.insert(batch.begin(), {"Unknown", {1}});
+    EXPECT_EQ(android::BAD_VALUE, service.setValues(gCard, batch));
+    EXPECT_EQ(4u, mBackend.mWrites);
+    EXPECT_EQ(vector<int>({-50, -50}), mBackend.getControl(gCard, 0).values);
+}
+
+} // namespace intel_audio
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AlsaTopology.hpp>
+#include <AudioUtils.hpp>
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <fstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace intel_audio
+{
+
+/** Runs against a fake /proc/asound and /dev/snd tree. */
+class AlsaTopologyTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char directory[] = "/tmp/alsa_topology_testXXXXXX";
+        ASSERT_TRUE(mkdtemp(directory) != NULL);
+        mDirectory = directory;
+        mProcRoot = mDirectory + "/asound";
+        mDevRoot = mDirectory + "/snd";
+        ASSERT_EQ(0, mkdir(mProcRoot.c_str(), 0755));
+        ASSERT_EQ(0, mkdir(mDevRoot.c_str(), 0755));
+
+        addCard("Intel", 0);
+        addNode("controlC0");
+        addNode("pcmC0D0p");
+        addNode("pcmC0D0c");
+        addNode("pcmC0D1p");
+        addNode("comprC0D5");
+        AlsaTopology::getInstance().setRoots(mProcRoot, mDevRoot);
+    }
+
+    virtual void TearDown()
+    {
+        AlsaTopology::getInstance().setRoots(AlsaTopology::gDefaultProcRoot,
+                                             AlsaTopology::gDefaultDevRoot);
+        for (const auto &file : mFiles) {
+            unlink(file.c_str());
+        }
+        rmdir(mProcRoot.c_str());
+        rmdir(mDevRoot.c_str());
+        rmdir(mDirectory.c_str());
+    }
+
+    void addCard(const string &name, int index)
+    {
+        string link = mProcRoot + "/" + name;
+        ASSERT_EQ(0, symlink(("card" + to_string(index)).c_str(), link.c_str()));
+        mFiles.push_back(link);
+    }
+
+    void removeCard(const string &name)
+    {
+        ASSERT_EQ(0, unlink((mProcRoot + "/" + name).c_str()));
+    }
+
+    void addNode(const string &name)
+    {
+        string node = mDevRoot + "/" + name;
+        ofstream file(node.c_str());
+        mFiles.push_back(node);
+    }
+
+    void removeNode(const string &name)
+    {
+        ASSERT_EQ(0, unlink((mDevRoot + "/" + name).c_str()));
+    }
+
+    /** Sends a uevent made of the given entries, joined with null characters. */
+    static bool sendUEvent(const vector<string> &entries)
+    {
+        string msg;
+        for (const auto &entry : entries) {
+            msg.append(entry).push_back('\0');
+        }
+        return AlsaTopology::getInstance().onUEvent(msg.c_str(), msg.size());
+    }
+
+    string mDirectory;
+    string mProcRoot;
+    string mDevRoot;
+    vector<string> mFiles;
+};
+
+TEST_F(AlsaTopologyTest, cardNameToIndex)
+{
+    AlsaTopology &topology = AlsaTopology::getInstance();
+    EXPECT_EQ(0, AudioUtils::getCardIndexByName("Intel"));
+    EXPECT_EQ(9, AudioUtils::getCardIndexByName("card9"));
+    EXPECT_EQ(-EINVAL, AudioUtils::getCardIndexByName("cardXYZ"));
+    EXPECT_EQ(-ENOENT, AudioUtils::getCardIndexByName("Unknown"));
+    EXPECT_EQ(-1, AudioUtils::getCardIndexByName(NULL));
+
+    addCard("Broken", 2);
+    removeCard("Broken");
+    ASSERT_EQ(0, symlink("Inte", (mProcRoot + "/Broken").c_str()));
+    EXPECT_EQ(-EBADFD, topology.getCardIndex("Broken"));
+}
+
+TEST_F(AlsaTopologyTest, cardNameIsCached)
+{
+    AlsaTopology &topology = AlsaTopology::getInstance();
+    AlsaTopology::Stats before = topology.getStats();
+    EXPECT_EQ(0, topology.getCardIndex("Intel"));
+    removeCard("Intel");
+    EXPECT_EQ(0, topology.getCardIndex("Intel"));
+
+    AlsaTopology::Stats after = topology.getStats();
+    EXPECT_EQ(before.misses + 1, after.misses);
+    EXPECT_EQ(before.hits + 1, after.hits);
+}
+
+TEST_F(AlsaTopologyTest, refreshCachesAllCards)
+{
+    AlsaTopology &topology = AlsaTopology::getInstance();
+    addCard("HDMI", 1);
+    addNode("pcmC1D3p");
+    topology.refresh();
+
+    AlsaTopology::Stats before = topology.getStats();
+    EXPECT_EQ(1, topology.getCardIndex("HDMI"));
+    EXPECT_EQ(0, topology.getCardIndex("Intel"));
+    EXPECT_TRUE(topology.hasDeviceNode(1, 3, AlsaTopology::PcmPlayback));
+    EXPECT_EQ(before.misses, topology.getStats().misses);
+}
+
+TEST_F(AlsaTopologyTest, deviceNodes)
+{
+    AlsaTopology &topology = AlsaTopology::getInstance();
+    vector<AlsaTopology::DeviceNode> nodes = topology.getDeviceNodes(0);
+    ASSERT_EQ(4u, nodes.size());
+    EXPECT_EQ(0u, nodes[0].device);
+    EXPECT_EQ(AlsaTopology::PcmPlayback, nodes[0].type);
+    EXPECT_EQ(0u, nodes[1].device);
+    EXPECT_EQ(AlsaTopology::PcmCapture, nodes[1].type);
+    EXPECT_EQ(1u, nodes[2].device);
+    EXPECT_EQ(5u, nodes[3].device);
+    EXPECT_EQ(AlsaTopology::Compress, nodes[3].type);
+
+    EXPECT_TRUE(topology.hasDeviceNode(0, 1, AlsaTopology::PcmPlayback));
+    EXPECT_FALSE(topology.hasDeviceNode(0, 1, AlsaTopology::PcmCapture));
+    EXPECT_TRUE(topology.getDeviceNodes(1).empty());
+    EXPECT_EQ(5, AudioUtils::getCompressDeviceIndex());
+
+    // Served from the cache once browsed
+    removeNode("comprC0D5");
+    EXPECT_EQ(5, AudioUtils::getCompressDeviceIndex());
+}
+
+TEST_F(AlsaTopologyTest, hotplugInvalidatesCard)
+{
+    AlsaTopology &topology = AlsaTopology::getInstance();
+    EXPECT_EQ(0, topology.getCardIndex("Intel"));
+    EXPECT_TRUE(topology.getDeviceNodes(1).empty());
+
+    // Card plugged
+    addCard("USB", 1);
+    addNode("pcmC1D0p");
+    addNode("pcmC1D0c");
+    EXPECT_TRUE(sendUEvent({"add@/devices/pci0000:00/usb1/1-1/sound/card1",
+                            "ACTION=add", "DEVPATH=/devices/pci0000:00/usb1/1-1/sound/card1",
+                            "SUBSYSTEM=sound", "SEQNUM=1234"}));
+    EXPECT_EQ(2u, topology.getDeviceNodes(1).size());
+    EXPECT_EQ(1, topology.getCardIndex("USB"));
+
+    // Card unplugged: the other card is left untouched
+    removeCard("USB");
+    removeNode("pcmC1D0p");
+    removeNode("pcmC1D0c");
+    removeCard("Intel");
+    EXPECT_TRUE(sendUEvent({"remove@/devices/pci0000:00/usb1/1-1/sound/card1/pcmC1D0p",
+                            "ACTION=remove",
+                            "DEVPATH=/devices/pci0000:00/usb1/1-1/sound/card1/pcmC1D0p",
+                            "SUBSYSTEM=sound", "DEVNAME=snd/pcmC1D0p"}));
+    EXPECT_TRUE(topology.getDeviceNodes(1).empty());
+    EXPECT_EQ(-ENOENT, topology.getCardIndex("USB"));
+    EXPECT_EQ(0, topology.getCardIndex("Intel"));
+    EXPECT_EQ(4u, topology.getDeviceNodes(0).size());
+}
+
+TEST_F(AlsaTopologyTest, unrelatedUEventsAreIgnored)
+{
+    AlsaTopology &topology = AlsaTopology::getInstance();
+    EXPECT_EQ(0, topology.getCardIndex("Intel"));
+    uint32_t invalidations = topology.getStats().invalidations;
+
+    EXPECT_FALSE(sendUEvent({"ACTION=add", "DEVPATH=/devices/platform/usb1", "SUBSYSTEM=usb"}));
+    EXPECT_FALSE(sendUEvent({"ACTION=change", "DEVPATH=/devices/platform/sound/card0",
+                             "SUBSYSTEM=sound"}));
+    EXPECT_FALSE(sendUEvent({"ACTION=add", "DEVPATH=/devices/platform/sound/cardX",
+                             "SUBSYSTEM=sound"}));
+    EXPECT_FALSE(sendUEvent({"EVENT_TYPE=SST_RECOVERY"}));
+    EXPECT_EQ(invalidations, topology.getStats().invalidations);
+}
+
+} // namespace intel_audio
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AlsaMixer.hpp>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+/** Mixer backend made of in-memory controls, counting the accesses as ioctls would be. */
+class FakeMixerBackend : public AlsaMixerBackend
+{
+public:
+    struct FakeControl
+    {
+        std::string name;
+        mixer_ctl_type type;
+        std::vector<int> values;
+    };
+
+    FakeMixerBackend() : mOpens(0), mCloses(0), mNameQueries(0), mReads(0), mWrites(0) {}
+
+    void addControl(uint32_t card, const std::string &name, mixer_ctl_type type,
+                    const std::vector<int> &values)
+    {
+        FakeControl control = {
+            name, type, values
+        };
+        mCards[card].push_back(control);
+    }
+
+    FakeControl &getControl(uint32_t card, uint32_t control) { return mCards[card][control]; }
+
+    virtual bool open(uint32_t card)
+    {
+        if (mCards.find(card) == mCards.end()) {
+            return false;
+        }
+        mOpens++;
+        return true;
+    }
+
+    virtual void close(uint32_t /*card*/) { mCloses++; }
+
+    virtual uint32_t getControlCount(uint32_t card) { return mCards[card].size(); }
+
+    virtual std::string getControlName(uint32_t card, uint32_t control)
+    {
+        mNameQueries++;
+        return getControl(card, control).name;
+    }
+
+    virtual mixer_ctl_type getControlType(uint32_t card, uint32_t control)
+    {
+        return getControl(card, control).type;
+    }
+
+    virtual uint32_t getValueCount(uint32_t card, uint32_t control)
+    {
+        return getControl(card, control).values.size();
+    }
+
+    virtual int getValues(uint32_t card, uint32_t control, int *values, uint32_t count)
+    {
+        mReads++;
+        const std::vector<int> &controlValues = getControl(card, control).values;
+        if (count > controlValues.size()) {
+            return -1;
+        }
+        std::copy(controlValues.begin(), controlValues.begin() + count, values);
+        return 0;
+    }
+
+    virtual int setValues(uint32_t card, uint32_t control, const int *values, uint32_t count)
+    {
+        mWrites++;
+        std::vector<int> &controlValues = getControl(card, control).values;
+        if (count > controlValues.size()) {
+            return -1;
+        }
+        std::copy(values, values + count, controlValues.begin());
+        return 0;
+    }
+
+    uint32_t mOpens;
+    uint32_t mCloses;
+    uint32_t mNameQueries;
+    uint32_t mReads;
+    uint32_t mWrites;
+
+private:
+    std::map<uint32_t, std::vector<FakeControl> > mCards;
+};
+
+} // namespace intel_audio
@@ -59,6 +59,12 @@ android::status_t AlsaAudioDevice::open(const char *deviceName, uint32_t /*devic
                  << " channels=" << routeConfig.getChannelCount()
                  << ").";
 
+    snd_pcm_uframes_t bufferSize, periodSize;
+    if (snd_pcm_get_params(mPcmDevice, &bufferSize, &periodSize) < 0) {
+        bufferSize = routeConfig.periodSize * routeConfig.periodCount;
+        periodSize = routeConfig.periodSize;
+    }
+    mXrunDetector.reset(routeConfig.getRate(), bufferSize, periodSize);
     return android::OK;
 
 close_device:
@@ -264,10 +270,12 @@ android::status_t AlsaAudioDevice::pcmReadFrames(void *buffer, size_t frames, st
         return android::BAD_VALUE;
     }
 
+    checkXrun();
     snd_pcm_sframes_t frames_read;
     frames_read = snd_pcm_readi(mPcmDevice, (char *)buffer, frames);
 
     if (frames_read < 0) {
+        mXrunDetector.onError(frames_read);
         error = snd_strerror(frames_read);
         if (snd_pcm_recover(mPcmDevice, frames_read, 0) != android::OK) {
             Log::Error() << "Unable to recover from pcm_read, error: " << snd_strerror(frames_read);
@@ -275,6 +283,8 @@ android::status_t AlsaAudioDevice::pcmReadFrames(void *buffer, size_t frames, st
         return frames_read;
     }
 
+    mXrunDetector.onTransfer(frames_read);
+
     if ((size_t)frames_read < frames) {
         Log::Warning() << " We read " << frames_read << " instead of " << frames;
     }
@@ -284,8 +294,10 @@ android::status_t AlsaAudioDevice::pcmReadFrames(void *buffer, size_t frames, st
 
 android::status_t AlsaAudioDevice::pcmWriteFrames(void *buffer, ssize_t frames, string &error) const
 {
+    checkXrun();
     snd_pcm_sframes_t frames_written = snd_pcm_writei(mPcmDevice, (char *)buffer, frames);
     if (frames_written < 0) {
+        mXrunDetector.onError(frames_written);
         error = snd_strerror(frames_written);
         if (snd_pcm_recover(mPcmDevice, frames_written, 0) != android::OK) {
             Log::Error() << "Unable to recover from pcm_write, error: " << snd_strerror(
@@ -293,6 +305,7 @@ android::status_t AlsaAudioDevice::pcmWriteFrames(void *buffer, ssize_t frames,
         }
         return frames_written;
     }
+    mXrunDetector.onTransfer(frames_written);
 
     return android::OK;
 }
@@ -333,6 +346,7 @@ android::status_t AlsaAudioDevice::getFramesAvailable(size_t &avail, struct time
 
 android::status_t AlsaAudioDevice::pcmStop() const
 {
+    mXrunDetector.onStop();
     int err = snd_pcm_drain(mPcmDevice);
     Log::Error() << __FUNCTION__ << " draining samples returned " << snd_strerror(err);
     err = snd_pcm_close(mPcmDevice);
@@ -341,4 +355,14 @@ android::status_t AlsaAudioDevice::pcmStop() const
     return err;
 }
 
+void AlsaAudioDevice::checkXrun() const
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    // Synchronizes with the hardware pointer, fails with EPIPE once stopped by an xrun.
+    snd_pcm_sframes_t avail = snd_pcm_avail(mPcmDevice);
+    bool isRunning = avail >= 0 && snd_pcm_state(mPcmDevice) == SND_PCM_STATE_RUNNING;
+    mXrunDetector.onAvail(isRunning, isRunning ? avail : 0, now);
+}
+
 } // namespace intel_audio
@@ -25,7 +25,8 @@ component_export_include_dir := $(LOCAL_PATH)/include
 
 component_src_files :=  \
     IoStream.cpp \
-    TinyAlsaAudioDevice.cpp 
+    TinyAlsaAudioDevice.cpp \
+    XrunDetector.cpp
 
 ifeq ($(USE_ALSA_LIB), 1)
 component_src_files += AlsaAudioDevice.cpp
@@ -111,3 +112,23 @@ LOCAL_MODULE_TAGS := optional
 include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
 
 include $(BUILD_STATIC_LIBRARY)
+
+#######################################################################
+# Unit test
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := test/XrunDetectorTest.cpp
+
+LOCAL_C_INCLUDES := $(component_includes_dir_host)
+
+LOCAL_STATIC_LIBRARIES := libstream_static_host $(component_static_lib_host)
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := stream_xrun_detector_test
+LOCAL_MODULE_OWNER := intel
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+include $(BUILD_HOST_NATIVE_TEST)
+endif
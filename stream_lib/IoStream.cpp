@@ -161,6 +161,11 @@ android::status_t IoStream::getFramesAvailable(size_t &avail, struct timespec &t
     return mAudioDevice->getFramesAvailable(avail, tStamp);
 }
 
+XrunCounters IoStream::getXrunCounters() const
+{
+    return mAudioDevice->getXrunCounters();
+}
+
 android::status_t IoStream::pcmStop() const
 {
     return mAudioDevice->pcmStop();
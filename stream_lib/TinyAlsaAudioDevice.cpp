@@ -20,6 +20,8 @@
 #include <SampleSpec.hpp>
 #include <AudioCommsAssert.hpp>
 #include <utilities/Log.hpp>
+#include <errno.h>
+#include <time.h>
 
 using audio_comms::utilities::Log;
 using namespace std;
@@ -36,16 +38,7 @@ android::status_t TinyAlsaAudioDevice::open(const char *cardName,
     AUDIOCOMMS_ASSERT(cardName != NULL, "Null card name");
 
     pcm_config config;
-    config.rate = routeConfig.getRate();
-    config.channels = routeConfig.getChannelCount();
-    config.format = AudioUtils::convertHalToTinyFormat(routeConfig.getFormat());
-    config.period_size = routeConfig.periodSize;
-    config.period_count = routeConfig.periodCount;
-    config.start_threshold = routeConfig.startThreshold;
-    config.stop_threshold = routeConfig.stopThreshold;
-    config.silence_threshold = routeConfig.silenceThreshold;
-    config.silence_size = 0;
-    config.avail_min = routeConfig.availMin;
+    routeConfig.getPcmConfig(config);
 
     Log::Debug() << __FUNCTION__ << ": card (" << cardName << ", " << deviceId
                  << ") \n\t config (rate=" << config.rate
@@ -88,6 +81,7 @@ android::status_t TinyAlsaAudioDevice::open(const char *cardName,
                        << "(frames), expected by AudioHAL and AudioFlinger = "
                        << config.period_count * config.period_size << " (frames)";
     }
+    mXrunDetector.reset(config.rate, pcm_get_buffer_size(mPcmDevice), config.period_size);
     return android::OK;
 
 close_device:
@@ -122,13 +116,16 @@ android::status_t TinyAlsaAudioDevice::pcmReadFrames(void *buffer, size_t frames
         return android::BAD_VALUE;
     }
 
+    checkXrun();
     android::status_t ret;
     ret = pcm_read(mPcmDevice, (char *)buffer, pcm_frames_to_bytes(mPcmDevice, frames));
 
     if (ret < 0) {
+        mXrunDetector.onError(-errno);
         error = pcm_get_error(mPcmDevice);
         return ret;
     }
+    mXrunDetector.onTransfer(frames);
 
     return android::OK;
 }
@@ -138,12 +135,15 @@ android::status_t TinyAlsaAudioDevice::pcmWriteFrames(void *buffer, ssize_t fram
 {
     android::status_t ret;
 
+    checkXrun();
     ret = pcm_write(mPcmDevice, (char *)buffer, pcm_frames_to_bytes(mPcmDevice, frames));
 
     if (ret < 0) {
+        mXrunDetector.onError(-errno);
         error = pcm_get_error(mPcmDevice);
         return ret;
     }
+    mXrunDetector.onTransfer(frames);
 
     return android::OK;
 }
@@ -173,7 +173,21 @@ android::status_t TinyAlsaAudioDevice::getFramesAvailable(size_t &avail,
 
 android::status_t TinyAlsaAudioDevice::pcmStop() const
 {
+    mXrunDetector.onStop();
     return pcm_stop(mPcmDevice);
 }
 
+void TinyAlsaAudioDevice::checkXrun() const
+{
+    unsigned int avail;
+    struct timespec tStamp;
+    // Opened with PCM_MONOTONIC, fails if the device is not running.
+    if (pcm_get_htimestamp(mPcmDevice, &avail, &tStamp) == 0) {
+        mXrunDetector.onAvail(true, avail, tStamp);
+    } else {
+        clock_gettime(CLOCK_MONOTONIC, &tStamp);
+        mXrunDetector.onAvail(false, 0, tStamp);
+    }
+}
+
 } // namespace intel_audio
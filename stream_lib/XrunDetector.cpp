@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "XrunDetector.hpp"
+#include <algorithm>
+#include <errno.h>
+
+namespace intel_audio
+{
+
+static const uint64_t gNsPerSec = 1000000000;
+
+void XrunDetector::reset(uint32_t rate, size_t bufferFrames, size_t periodFrames)
+{
+    mRate = rate;
+    mBufferFrames = bufferFrames;
+    mPeriodFrames = periodFrames;
+    mCounters.xruns = 0;
+    mCounters.framesLost = 0;
+    mIsRunning = false;
+    mAvail = 0;
+    mTimeNs = 0;
+    mXrunChecked = false;
+    mHasReference = false;
+    mReferenceNs = 0;
+    mHeadroomFrames = 0;
+}
+
+void XrunDetector::onAvail(bool isRunning, size_t avail, const struct timespec &timestamp)
+{
+    mIsRunning = isRunning;
+    mAvail = avail;
+    mTimeNs = static_cast<uint64_t>(timestamp.tv_sec) * gNsPerSec + timestamp.tv_nsec;
+    mXrunChecked = false;
+    if (!mHasReference) {
+        return;
+    }
+    mHasReference = false;
+
+    uint64_t elapsedFrames = mTimeNs > mReferenceNs ?
+                             (mTimeNs - mReferenceNs) * mRate / gNsPerSec : 0;
+    uint64_t gapFrames = elapsedFrames > mHeadroomFrames ? elapsedFrames - mHeadroomFrames : 0;
+    if (!isRunning) {
+        // Stopped behind our back: the device ran out of headroom, however late we are.
+        accountXrun(gapFrames);
+    } else if (avail >= mBufferFrames) {
+        // Kept running past the end of the headroom, e.g. with no stop threshold.
+        accountXrun(std::max<uint64_t>(avail - mBufferFrames, gapFrames));
+    } else if (gapFrames > mPeriodFrames) {
+        accountXrun(gapFrames);
+    }
+}
+
+void XrunDetector::onTransfer(size_t frames)
+{
+    mHasReference = mIsRunning;
+    if (mHasReference) {
+        mReferenceNs = mTimeNs;
+        mHeadroomFrames = (mBufferFrames > mAvail ? mBufferFrames - mAvail : 0) + frames;
+    }
+}
+
+void XrunDetector::onError(int error)
+{
+    mHasReference = false;
+    if ((error == -EPIPE || error == -ESTRPIPE) && !mXrunChecked) {
+        accountXrun(0);
+    }
+}
+
+void XrunDetector::accountXrun(uint64_t framesLost)
+{
+    mCounters.xruns++;
+    mCounters.framesLost += framesLost;
+    mXrunChecked = true;
+}
+
+} // namespace intel_audio
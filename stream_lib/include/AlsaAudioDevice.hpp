@@ -50,11 +50,19 @@ public:
 
     virtual android::status_t pcmStop() const;
 
+    virtual XrunCounters getXrunCounters() const { return mXrunDetector.getCounters(); }
+
 private:
+    /** Checks the ring buffer for an xrun before a transfer. */
+    void checkXrun() const;
+
     int setPcmParams(snd_pcm_stream_t stream, const MixPortConfig &config,
                      snd_pcm_access_t access, int soft_resample);
 
     snd_pcm_t *mPcmDevice; /**< Handle on alsa PCM device. */
+
+    /** Fed by the transfers, which are const as seen from the stream. */
+    mutable XrunDetector mXrunDetector;
 };
 
 } // namespace intel_audio
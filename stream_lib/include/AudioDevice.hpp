@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "XrunDetector.hpp"
 #include <MixPortConfig.hpp>
 #include <stdint.h>
 #include <utils/Errors.h>
@@ -53,6 +54,13 @@ public:
     virtual android::status_t getFramesAvailable(size_t &avail, struct timespec &tStamp) const = 0;
 
     virtual android::status_t pcmStop() const = 0;
+
+    /**
+     * Xruns detected by the transfers since the device was opened.
+     *
+     * @return counters of the device, reset when opened.
+     */
+    virtual XrunCounters getXrunCounters() const = 0;
 };
 
 } // namespace intel_audio
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "XrunDetector.hpp"
 #include <SampleSpec.hpp>
 #include <system/audio.h>
 #include <utils/RWLock.h>
@@ -314,6 +315,12 @@ public:
      */
     android::status_t getFramesAvailable(size_t &avail, struct timespec &tStamp) const;
 
+    /**
+     * Xruns detected by the audio device since it was opened.
+     * Sampled around a transfer, tells the xruns of this transfer. Must be called routed.
+     */
+    XrunCounters getXrunCounters() const;
+
     IStreamRoute *getCurrentStreamRoute() const { return mCurrentStreamRoute; }
 
     IStreamRoute *getNewStreamRoute() const { return mNewStreamRoute; }
@@ -48,8 +48,16 @@ public:
 
     virtual android::status_t pcmStop() const;
 
+    virtual XrunCounters getXrunCounters() const { return mXrunDetector.getCounters(); }
+
 private:
+    /** Checks the ring buffer for an xrun before a transfer. */
+    void checkXrun() const;
+
     pcm *mPcmDevice; /**< Handle on tiny alsa PCM device. */
+
+    /** Fed by the transfers, which are const as seen from the stream. */
+    mutable XrunDetector mXrunDetector;
 };
 
 } // namespace intel_audio
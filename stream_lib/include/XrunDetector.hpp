@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+namespace intel_audio
+{
+
+/** Xruns of an audio device, accounted since it was opened. */
+struct XrunCounters
+{
+    uint32_t xruns;
+    uint64_t framesLost; /**< At the rate of the device, the gaps that could be measured. */
+};
+
+/**
+ * Detects the xruns of a ring buffer from what the device reports around each transfer:
+ *  - a transfer failing with EPIPE (xrun) or ESTRPIPE (suspend),
+ *  - a device found stopped although it was running at the previous transfer, or reporting at
+ *    least a full buffer available, i.e. drained for playback or full for capture,
+ *  - more time elapsed since the previous transfer than the frames it left queued (playback)
+ *    or the room it left (capture) could cover.
+ * The frames lost are the frames of the uncovered time, at the rate of the device.
+ *
+ * Not thread safe: the transfers of a device are serialized by the lock of its stream.
+ */
+class XrunDetector
+{
+public:
+    XrunDetector() { reset(0, 0, 0); }
+
+    /**
+     * Forgets the history and the counters, to be called when the device is opened.
+     *
+     * @param[in] rate of the device.
+     * @param[in] bufferFrames size of the ring buffer.
+     * @param[in] periodFrames size of a period, the tolerance of the timing check.
+     */
+    void reset(uint32_t rate, size_t bufferFrames, size_t periodFrames);
+
+    /**
+     * Checks the ring buffer before a transfer.
+     *
+     * @param[in] isRunning false if the device is not running, i.e. not started yet or stopped
+     *                      by an xrun, avail is then ignored.
+     * @param[in] avail frames available: free frames for playback, ready frames for capture.
+     * @param[in] timestamp CLOCK_MONOTONIC time at which avail was sampled.
+     */
+    void onAvail(bool isRunning, size_t avail, const struct timespec &timestamp);
+
+    /**
+     * Accounts the transfer that followed the last check, once succeeded.
+     *
+     * @param[in] frames transferred.
+     */
+    void onTransfer(size_t frames);
+
+    /**
+     * Accounts the transfer that followed the last check, once failed.
+     *
+     * @param[in] error negative errno of the transfer.
+     */
+    void onError(int error);
+
+    /** Forgets the history, to be called when the device is stopped on purpose. */
+    void onStop() { mHasReference = false; }
+
+    const XrunCounters &getCounters() const { return mCounters; }
+
+private:
+    void accountXrun(uint64_t framesLost);
+
+    uint32_t mRate;
+    size_t mBufferFrames;
+    size_t mPeriodFrames;
+
+    XrunCounters mCounters;
+
+    bool mIsRunning; /**< State found by the last check. */
+    size_t mAvail; /**< Frames available found by the last check. */
+    uint64_t mTimeNs; /**< Time of the last check. */
+    bool mXrunChecked; /**< True if the last check already accounted an xrun. */
+
+    /** True if the last transfer left a known headroom in a running ring buffer. */
+    bool mHasReference;
+    uint64_t mReferenceNs; /**< Time from which the headroom is consumed. */
+    uint64_t mHeadroomFrames; /**< Frames queued (playback) or room left (capture). */
+};
+
+} // namespace intel_audio
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <XrunDetector.hpp>
+#include <gtest/gtest.h>
+#include <errno.h>
+
+namespace intel_audio
+{
+
+/** 48 kHz ring buffer of 4 periods of 10 ms, driven with a simulated clock. */
+class XrunDetectorTest : public ::testing::Test
+{
+protected:
+    static const uint32_t mRate = 48000;
+    static const size_t mPeriod = 480;
+    static const size_t mBuffer = 4 * mPeriod;
+
+    virtual void SetUp() { mDetector.reset(mRate, mBuffer, mPeriod); }
+
+    /** Checks the ring buffer at a given time, then transfers a period. */
+    void transfer(uint32_t timeMs, bool isRunning, size_t avail)
+    {
+        struct timespec timestamp;
+        timestamp.tv_sec = timeMs / 1000;
+        timestamp.tv_nsec = (timeMs % 1000) * 1000000;
+        mDetector.onAvail(isRunning, avail, timestamp);
+        mDetector.onTransfer(mPeriod);
+    }
+
+    XrunDetector mDetector;
+};
+
+TEST_F(XrunDetectorTest, steadyStreamHasNoXrun)
+{
+    // Not started yet, then one period consumed each 10 ms.
+    transfer(0, false, mBuffer);
+    transfer(1, false, mBuffer - mPeriod);
+    for (uint32_t time = 10; time < 10000; time += 10) {
+        transfer(time, true, mPeriod);
+    }
+    EXPECT_EQ(0u, mDetector.getCounters().xruns);
+    EXPECT_EQ(0u, mDetector.getCounters().framesLost);
+}
+
+TEST_F(XrunDetectorTest, lateTransferIsMeasured)
+{
+    transfer(0, true, mPeriod);
+    // 4 periods were queued at 0 ms, 100 ms later 60 ms of audio are missing.
+    transfer(100, true, mBuffer - 1);
+    EXPECT_EQ(1u, mDetector.getCounters().xruns);
+    EXPECT_EQ(60u * mRate / 1000, mDetector.getCounters().framesLost);
+
+    // Jitter within a period is tolerated.
+    transfer(105, true, mPeriod);
+    transfer(150, true, mPeriod);
+    EXPECT_EQ(1u, mDetector.getCounters().xruns);
+}
+
+TEST_F(XrunDetectorTest, stoppedOrOverflowedDeviceIsAnXrun)
+{
+    // Stopped by the driver: an xrun even when the timing could not tell.
+    transfer(0, true, mPeriod);
+    transfer(10, false, 0);
+    EXPECT_EQ(1u, mDetector.getCounters().xruns);
+
+    // Restarted, then ran past its buffer: the extra frames available are lost.
+    transfer(20, true, mPeriod);
+    transfer(30, true, mBuffer + 100);
+    EXPECT_EQ(2u, mDetector.getCounters().xruns);
+    EXPECT_EQ(100u, mDetector.getCounters().framesLost);
+}
+
+TEST_F(XrunDetectorTest, brokenPipeCountedOnce)
+{
+    struct timespec timestamp = { 0, 0 };
+    mDetector.onAvail(true, mPeriod, timestamp);
+    mDetector.onError(-EPIPE);
+    EXPECT_EQ(1u, mDetector.getCounters().xruns);
+
+    // Already accounted when the check found the device stopped.
+    transfer(10, true, mPeriod);
+    timestamp.tv_sec = 1;
+    mDetector.onAvail(false, 0, timestamp);
+    mDetector.onError(-EPIPE);
+    EXPECT_EQ(2u, mDetector.getCounters().xruns);
+
+    // Other errors are not xruns.
+    mDetector.onAvail(true, mPeriod, timestamp);
+    mDetector.onError(-EIO);
+    EXPECT_EQ(2u, mDetector.getCounters().xruns);
+}
+
+TEST_F(XrunDetectorTest, stopForgetsHistory)
+{
+    transfer(0, true, mPeriod);
+    mDetector.onStop();
+    transfer(1000, true, mBuffer);
+    EXPECT_EQ(0u, mDetector.getCounters().xruns);
+
+    mDetector.onError(-ESTRPIPE);
+    EXPECT_EQ(1u, mDetector.getCounters().xruns);
+    mDetector.reset(mRate, mBuffer, mPeriod);
+    EXPECT_EQ(0u, mDetector.getCounters().xruns);
+}
+
+} // namespace intel_audio
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+namespace intel_audio
+{
+
+/**
+ * CPU time spent by the audio threads in a stage of the audio pipeline.
+ * Updated with relaxed atomics from the audio thread, only meant for dump.
+ */
+class CpuCost
+{
+public:
+    CpuCost() : mCalls(0), mCpuTimeNs(0), mMaxCpuTimeNs(0) {}
+
+    /**
+     * Accounts a run of the stage.
+     *
+     * @param[in] cpuTimeNs CPU time of the run, in nanoseconds.
+     */
+    void add(uint64_t cpuTimeNs)
+    {
+        mCalls.fetch_add(1, std::memory_order_relaxed);
+        mCpuTimeNs.fetch_add(cpuTimeNs, std::memory_order_relaxed);
+        if (cpuTimeNs > mMaxCpuTimeNs.load(std::memory_order_relaxed)) {
+            mMaxCpuTimeNs.store(cpuTimeNs, std::memory_order_relaxed);
+        }
+    }
+
+    void reset()
+    {
+        mCalls.store(0, std::memory_order_relaxed);
+        mCpuTimeNs.store(0, std::memory_order_relaxed);
+        mMaxCpuTimeNs.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t getCalls() const { return mCalls.load(std::memory_order_relaxed); }
+    uint64_t getCpuTimeNs() const { return mCpuTimeNs.load(std::memory_order_relaxed); }
+    uint64_t getMaxCpuTimeNs() const { return mMaxCpuTimeNs.load(std::memory_order_relaxed); }
+
+    /** @return CPU time consumed by the calling thread, in nanoseconds. */
+    static uint64_t getThreadCpuTimeNs()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+
+private:
+    std::atomic<uint64_t> mCalls;
+    std::atomic<uint64_t> mCpuTimeNs;
+    std::atomic<uint64_t> mMaxCpuTimeNs;
+};
+
+/** Accounts the CPU time of the calling thread, for its scope, to a stage. */
+class CpuCostScope
+{
+public:
+    explicit CpuCostScope(CpuCost &cost)
+        : mCost(cost),
+          mStartNs(CpuCost::getThreadCpuTimeNs())
+    {
+    }
+
+    ~CpuCostScope()
+    {
+        mCost.add(CpuCost::getThreadCpuTimeNs() - mStartNs);
+    }
+
+private:
+    CpuCostScope(const CpuCostScope &);
+    CpuCostScope &operator=(const CpuCostScope &);
+
+    CpuCost &mCost;
+    uint64_t mStartNs;
+};
+
+} // namespace intel_audio
+
+/**
+ * Accounts the CPU time of the enclosing scope to a CpuCost.
+ * Compiled out unless the build defines AUDIO_CPU_COST_ACCOUNTING.
+ */
+#if defined(AUDIO_CPU_COST_ACCOUNTING)
+#define AUDIO_CPU_COST_CONCAT_(a, b) a##b
+#define AUDIO_CPU_COST_CONCAT(a, b) AUDIO_CPU_COST_CONCAT_(a, b)
+#define AUDIO_CPU_COST_SCOPE(cost) \
+    intel_audio::CpuCostScope AUDIO_CPU_COST_CONCAT(cpuCostScope, __LINE__)(cost)
+#else
+#define AUDIO_CPU_COST_SCOPE(cost) do {} while (0)
+#endif
@@ -27,7 +27,9 @@ component_export_include_dir := \
 
 component_src_files :=  \
     src/KeyValuePairs.cpp \
+    src/KeyValueSlices.cpp \
     src/Parameters.cpp \
+    src/StreamsParameters.cpp \
 
 component_static_lib := \
     libaudio_hal_utilities \
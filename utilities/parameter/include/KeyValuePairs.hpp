@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "KeyValueSlices.hpp"
 #include <convert.hpp>
 #include <string>
 #include <map>
@@ -25,6 +26,8 @@ namespace intel_audio
 
 /**
  * Helper class to parse / retrieve a semi-colon separated string of {key, value} pairs.
+ * Parsing and typed conversions rely on KeyValueSlices, this class adds ownership of the
+ * pairs so that they can be edited. Read only clients may use KeyValueSlices directly.
  */
 class KeyValuePairs
 {
@@ -109,15 +112,11 @@ public:
     template <typename T>
     android::status_t get(const std::string &key, T &value) const
     {
-        std::string literalValue;
-        android::status_t status = getLiteral(key, literalValue);
-        if (status != android::OK) {
-            return status;
-        }
-        if (!audio_comms::utilities::convertTo(literalValue, value)) {
+        MapConstIterator it = mMap.find(key);
+        if (it == mMap.end()) {
             return android::BAD_VALUE;
         }
-        return android::OK;
+        return KeyValueSlices::convert(it->second, value) ? android::OK : android::BAD_VALUE;
     }
 
     /**
@@ -140,17 +139,6 @@ private:
      */
     android::status_t addLiteral(const std::string &key, const std::string &value);
 
-    /**
-     * Get a literal value from a given key from the collection.
-     *
-     * @param[in] key associated to the value to get.
-     * @param[out] value to get.
-     *
-     * @return OK if the key was found and the value is returned into value parameter.
-     * @return error code otherwise.
-     */
-    android::status_t getLiteral(const std::string &key, std::string &value) const;
-
     std::map<std::string, std::string> mMap; /**< value pair collection Map indexed by the key. */
 
     static const char *const mPairDelimiter; /**< Delimiter between {key, value} pairs. */
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <convert.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <utils/Errors.h>
+
+namespace intel_audio
+{
+
+/**
+ * Non owning view on a range of characters.
+ * The buffer the slice refers to must outlive the slice.
+ */
+class StringSlice
+{
+public:
+    StringSlice() : mData(""), mSize(0) {}
+    StringSlice(const char *data, size_t size) : mData(data), mSize(size) {}
+    StringSlice(const char *str) : mData(str), mSize(strlen(str)) {}
+    StringSlice(const std::string &str) : mData(str.data()), mSize(str.size()) {}
+
+    const char *data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    bool operator==(const StringSlice &other) const
+    {
+        return mSize == other.mSize && memcmp(mData, other.mData, mSize) == 0;
+    }
+    bool operator!=(const StringSlice &other) const { return !(*this == other); }
+
+    /** @return a copy of the characters of the slice. */
+    std::string toString() const { return std::string(mData, mSize); }
+
+private:
+    const char *mData;
+    size_t mSize;
+};
+
+/**
+ * Single pass tokenizer of a semi-colon separated string of {key, value} pairs.
+ * Keys and values are kept as slices of the caller's buffer, so parsing neither duplicates the
+ * buffer nor allocates as long as the number of pairs fits in the inline storage.
+ * The buffer given to parse must outlive the collection.
+ */
+class KeyValueSlices
+{
+public:
+    struct Pair
+    {
+        StringSlice key;
+        StringSlice value;
+    };
+
+    KeyValueSlices() : mSize(0) {}
+
+    /**
+     * @param[in] keyValuePairs semi-colon separated string of {key, value} pairs, must outlive
+     *                          the collection.
+     */
+    explicit KeyValueSlices(const std::string &keyValuePairs) : mSize(0)
+    {
+        parse(keyValuePairs);
+    }
+
+    /** A temporary string would not outlive the collection, its slices would dangle. */
+    explicit KeyValueSlices(std::string &&keyValuePairs) = delete;
+
+    /**
+     * Tokenize a semi-colon separated string of {key, value} pairs. Previous pairs are dropped.
+     * An audio parameter can be made of key;key or key=value;key=value. If a key is found more
+     * than once, the last value is kept.
+     *
+     * @param[in] buffer to tokenize, must outlive the collection.
+     * @param[in] size of the buffer in characters.
+     *
+     * @return OK if all key / value pairs were tokenized correctly.
+     * @return ALREADY_EXISTS if a key was found more than once.
+     * @return BAD_VALUE if a pair has no key, tokenizing stops at this pair.
+     */
+    android::status_t parse(const char *buffer, size_t size);
+
+    android::status_t parse(const std::string &keyValuePairs)
+    {
+        return parse(keyValuePairs.data(), keyValuePairs.size());
+    }
+
+    android::status_t parse(std::string &&keyValuePairs) = delete;
+
+    /** @return the number of {key, value} pairs found in the collection. */
+    size_t size() const { return mSize; }
+
+    /** @return the pair at the given position, in order of first appearance in the buffer. */
+    const Pair &operator[](size_t index) const
+    {
+        return index < gInlineCapacity ? mInlinePairs[index] :
+               mOverflowPairs[index - gInlineCapacity];
+    }
+
+    /** @return true if the key is found within the collection of pairs, false otherwise. */
+    bool hasKey(const StringSlice &key) const { return find(key) != NULL; }
+
+    /**
+     * Get a literal value from a given key from the collection.
+     *
+     * @param[in] key associated to the value to get.
+     * @param[out] value to get, refers to the tokenized buffer.
+     *
+     * @return OK if the key was found, BAD_VALUE otherwise.
+     */
+    android::status_t getLiteral(const StringSlice &key, StringSlice &value) const
+    {
+        const Pair *pair = find(key);
+        if (pair == NULL) {
+            return android::BAD_VALUE;
+        }
+        value = pair->value;
+        return android::OK;
+    }
+
+    /**
+     * Get a value from a given key from the collection, converted in place.
+     *
+     * @tparam T type of the value to get.
+     * @param[in] key associated to the value to get.
+     * @param[out] value to get.
+     *
+     * @return OK if the key was found and the value is returned into value parameter.
+     * @return error code otherwise.
+     */
+    template <typename T>
+    android::status_t get(const StringSlice &key, T &value) const
+    {
+        StringSlice literal;
+        android::status_t status = getLiteral(key, literal);
+        if (status != android::OK) {
+            return status;
+        }
+        return convert(literal, value) ? android::OK : android::BAD_VALUE;
+    }
+
+    /**
+     * Locale independent conversions of a literal value, without any intermediate string.
+     * Integers may be given in decimal or in hexadecimal with a 0x prefix. Booleans may be given
+     * as 0, 1, false or true.
+     *
+     * @param[in] literal value to convert.
+     * @param[out] value converted, set only if return is true.
+     *
+     * @return true if the whole literal was converted, false otherwise.
+     */
+    static bool convert(const StringSlice &literal, uint32_t &value);
+    static bool convert(const StringSlice &literal, int32_t &value);
+    static bool convert(const StringSlice &literal, bool &value);
+    static bool convert(const StringSlice &literal, float &value);
+    static bool convert(const StringSlice &literal, double &value);
+    static bool convert(const StringSlice &literal, std::string &value)
+    {
+        value.assign(literal.data(), literal.size());
+        return true;
+    }
+
+    /** Conversion of other types fall back to the generic string conversion. */
+    template <typename T>
+    static bool convert(const StringSlice &literal, T &value)
+    {
+        return audio_comms::utilities::convertTo(literal.toString(), value);
+    }
+
+private:
+    const Pair *find(const StringSlice &key) const;
+    Pair *find(const StringSlice &key)
+    {
+        return const_cast<Pair *>(static_cast<const KeyValueSlices *>(this)->find(key));
+    }
+
+    /**
+     * Add a pair to the collection, or update the value if the key is already in the collection.
+     *
+     * @return OK if the pair was added, ALREADY_EXISTS if the value was updated.
+     */
+    android::status_t add(const Pair &pair);
+
+    /** Number of pairs stored without allocation, enough for any routing request. */
+    static const size_t gInlineCapacity = 16;
+
+    Pair mInlinePairs[gInlineCapacity]; /**< First pairs of the collection. */
+    std::vector<Pair> mOverflowPairs; /**< Pairs beyond the inline capacity. */
+    size_t mSize; /**< Number of pairs in the collection. */
+
+    static const char mPairDelimiter = ';'; /**< Delimiter between {key, value} pairs. */
+    static const char mPairAssociator = '='; /**< key value Pair token. */
+};
+
+}   // namespace intel_audio
@@ -59,6 +59,24 @@ public:
     /** PreProc Parameter Key. */
     static const std::string &gKeyPreProcRequested;
 
+    /** Flight recorder export Parameter Key, freezes and exports the recorders of all streams. */
+    static const std::string &gKeyFlightRecorderExport;
+
+    /**
+     * Latency statistics reset Parameter Key, clears the latency histograms and the CPU costs of
+     * all streams.
+     */
+    static const std::string &gKeyLatencyStatsReset;
+
+    /** CPU cost Parameter Key, returns the CPU time spent per stage of a stream. */
+    static const std::string &gKeyCpuCost;
+
+    /** Audio trace Parameter Key, enables or disables the recording of the trace points. */
+    static const std::string &gKeyAudioTrace;
+
+    /** Audio trace export Parameter Key, writes the trace points in the given file. */
+    static const std::string &gKeyAudioTraceExport;
+
     /** Always Listening Route/VTSV Parameters Keys */
     static const std::string &gkeyAlwaysListeningRoute;
     static const std::string &gKeyLpalDevice;
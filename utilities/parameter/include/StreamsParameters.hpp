@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <Direction.hpp>
+#include <bitset>
+#include <stdint.h>
+#include <string>
+
+namespace intel_audio
+{
+
+/**
+ * Typed collection of the parameters inferred from the streams (devices, flags, use cases,
+ * effects...) and exchanged internally between the device, the route manager and the platform
+ * state.
+ * Contrary to KeyValuePairs, parameters are indexed by an identifier and numerical values are
+ * kept as is, so that no string is built nor parsed on the stream start / stop path.
+ * The string form of a parameter (its key, @see Parameters) is only required at the public
+ * setParameters boundary.
+ */
+class StreamsParameters
+{
+public:
+    enum Id
+    {
+        AndroidMode = 0,
+        VoipBandType,
+        PreProcRequested,
+        InputUseCases,
+        OutputUseCases,
+        InputDevices,
+        OutputDevices,
+        InputDeviceAddresses,
+        OutputDeviceAddresses,
+        InputFlags,
+        OutputFlags
+    };
+
+    static const size_t gNbIds = OutputFlags + 1;
+
+    StreamsParameters();
+
+    /** @return identifier of the use cases parameter for the given direction. */
+    static Id getUseCasesId(Direction::Values direction)
+    {
+        return direction == Direction::Output ? OutputUseCases : InputUseCases;
+    }
+
+    /** @return identifier of the devices parameter for the given direction. */
+    static Id getDevicesId(Direction::Values direction)
+    {
+        return direction == Direction::Output ? OutputDevices : InputDevices;
+    }
+
+    /** @return identifier of the device addresses parameter for the given direction. */
+    static Id getDeviceAddressesId(Direction::Values direction)
+    {
+        return direction == Direction::Output ? OutputDeviceAddresses : InputDeviceAddresses;
+    }
+
+    /** @return identifier of the flags parameter for the given direction. */
+    static Id getFlagsId(Direction::Values direction)
+    {
+        return direction == Direction::Output ? OutputFlags : InputFlags;
+    }
+
+    /**
+     * Get the android parameter key associated to a parameter identifier.
+     *
+     * @param[in] id of the parameter.
+     *
+     * @return key of the android parameter.
+     */
+    static const std::string &getKey(Id id);
+
+    /**
+     * Get the parameter identifier associated to an android parameter key.
+     *
+     * @param[in] key of the android parameter.
+     * @param[out] id of the parameter. Set only if return is true.
+     *
+     * @return true if the key is associated to a typed parameter, false otherwise.
+     */
+    static bool getId(const std::string &key, Id &id);
+
+    /**
+     * Set a numerical value to a parameter.
+     *
+     * @param[in] id of the parameter.
+     * @param[in] value to set.
+     */
+    void set(Id id, uint32_t value);
+
+    /**
+     * Set a literal value to a parameter, for parameters which have no numerical representation
+     * (device addresses for example).
+     *
+     * @param[in] id of the parameter.
+     * @param[in] literal value to set.
+     */
+    void set(Id id, const std::string &literal);
+
+    /** @return true if the parameter has been set, false otherwise. */
+    bool isSet(Id id) const { return mIsSet.test(id); }
+
+    /** @return true if the parameter has been set with a literal value, false otherwise. */
+    bool isLiteral(Id id) const { return mIsLiteral.test(id); }
+
+    /** @return true if no parameter has been set, false otherwise. */
+    bool isEmpty() const { return mIsSet.none(); }
+
+    /** @return numerical value of the parameter, meaningfull only if not literal. */
+    uint32_t getValue(Id id) const { return mValues[id]; }
+
+    /** @return literal value of the parameter, meaningfull only if literal. */
+    const std::string &getLiteral(Id id) const { return mLiterals[id]; }
+
+    /**
+     * Convert the parameters into a semi-colon separated string of {key, value} pairs.
+     * Intended for logs only.
+     *
+     * @return semi-colon separated string of {key, value} pairs.
+     */
+    std::string toString() const;
+
+private:
+    std::bitset<gNbIds> mIsSet; /**< Parameters set in the collection. */
+    std::bitset<gNbIds> mIsLiteral; /**< Parameters set with a literal value. */
+    uint32_t mValues[gNbIds]; /**< Numerical values, indexed by parameter identifier. */
+    std::string mLiterals[gNbIds]; /**< Literal values, indexed by parameter identifier. */
+};
+
+}   // namespace intel_audio
@@ -41,13 +41,17 @@ KeyValuePairs::~KeyValuePairs()
 
 string KeyValuePairs::toString()
 {
+    size_t length = 0;
+    for (MapConstIterator it = mMap.begin(); it != mMap.end(); ++it) {
+        length += it->first.size() + it->second.size() + 2;
+    }
     string keyValueList;
-    MapConstIterator it;
-    for (it = mMap.begin(); it != mMap.end(); ++it) {
-        keyValueList += it->first + mPairAssociator + it->second;
-        if (it->first != mMap.rbegin()->first) {
+    keyValueList.reserve(length);
+    for (MapConstIterator it = mMap.begin(); it != mMap.end(); ++it) {
+        if (it != mMap.begin()) {
             keyValueList += mPairDelimiter;
         }
+        keyValueList.append(it->first).append(mPairAssociator).append(it->second);
     }
     return keyValueList;
 }
@@ -63,48 +67,14 @@ android::status_t KeyValuePairs::remove(const string &key)
 
 android::status_t KeyValuePairs::add(const string &keyValuePairs)
 {
-    android::status_t status = android::OK;
-    char *pairs = strdup(keyValuePairs.c_str());
-    if(pairs == NULL) {
-        Log::Error() << __FUNCTION__ << ": No Enough Memory for keyValuePairs String duplicate ";
-        return android::BAD_VALUE;
-    }
-    char *context;
-    char *pair = strtok_r(pairs, mPairDelimiter, &context);
-    while (pair != NULL) {
-        if (strlen(pair) != 0) {
-            string key;
-            string value;
-            // An audio parameter can be constructed with key;key or key=value;key=value
-            if (strchr(pair, *mPairAssociator) != NULL) {
-                if (strcspn(pair, mPairAssociator) == 0) {
-                    // No key provided, bailing out
-                    status = android::BAD_VALUE;
-                    break;
-                }
-                char *tmp = strtok(pair, mPairAssociator);
-                if (tmp == NULL) {
-                    Log::Error() << __FUNCTION__ << ": No key nor value provided within " << pair
-                                 << " with expected '" << mPairAssociator << "'' associator.";
-                    status = android::BAD_VALUE;
-                    break;
-                }
-                key = tmp;
-                tmp = strtok(NULL, mPairAssociator);
-                if (tmp != NULL) {
-                    value = tmp;
-                }
-            } else {
-                key = pair;
-            }
-            android::status_t res = addLiteral(key, value);
-            if (res != android::OK) {
-                status = res;
-            }
+    KeyValueSlices slices;
+    android::status_t status = slices.parse(keyValuePairs);
+    for (size_t i = 0; i < slices.size(); i++) {
+        android::status_t res = addLiteral(slices[i].key.toString(), slices[i].value.toString());
+        if (res != android::OK && status == android::OK) {
+            status = res;
         }
-        pair = strtok_r(NULL, mPairDelimiter, &context);
     }
-    free(pairs);
     return status;
 }
 
@@ -118,14 +88,4 @@ android::status_t KeyValuePairs::addLiteral(const string &key, const string &val
     return android::OK;
 }
 
-android::status_t KeyValuePairs::getLiteral(const string &key, string &value) const
-{
-    MapConstIterator it = mMap.find(key);
-    if (it == mMap.end()) {
-        return android::BAD_VALUE;
-    }
-    value = it->second;
-    return android::OK;
-}
-
 }   // namespace intel_audio
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "KeyValueSlices.hpp"
+#include <cmath>
+#include <limits>
+#include <stdlib.h>
+
+using namespace std;
+
+namespace intel_audio
+{
+
+/** Longest floating point literal accepted, digits and exponent included. */
+static const size_t gMaxFloatLiteralSize = 64;
+
+/**
+ * Parse an integer from a slice, in decimal or in hexadecimal with a 0x prefix.
+ * Like stream extraction, leading blanks are skipped and a sign is accepted.
+ * Only intended for 32 bits integers.
+ */
+template <typename T>
+static bool parseIntegral(const StringSlice &literal, T &value)
+{
+    const char *it = literal.data();
+    const char *end = it + literal.size();
+    while (it != end && (*it == ' ' || *it == '\t')) {
+        ++it;
+    }
+    bool isNegative = false;
+    if (it != end && (*it == '+' || *it == '-')) {
+        isNegative = (*it == '-');
+        ++it;
+    }
+    if (isNegative && !numeric_limits<T>::is_signed) {
+        return false;
+    }
+    uint64_t base = 10;
+    if (end - it > 2 && it[0] == '0' && (it[1] == 'x' || it[1] == 'X')) {
+        base = 16;
+        it += 2;
+    }
+    if (it == end) {
+        return false;
+    }
+    uint64_t limit = static_cast<uint64_t>(numeric_limits<T>::max()) + (isNegative ? 1 : 0);
+    uint64_t result = 0;
+    for (; it != end; ++it) {
+        uint64_t digit;
+        if (*it >= '0' && *it <= '9') {
+            digit = *it - '0';
+        } else if (base == 16 && *it >= 'a' && *it <= 'f') {
+            digit = *it - 'a' + 10;
+        } else if (base == 16 && *it >= 'A' && *it <= 'F') {
+            digit = *it - 'A' + 10;
+        } else {
+            return false;
+        }
+        if (result > (limit - digit) / base) {
+            return false;
+        }
+        result = result * base + digit;
+    }
+    value = isNegative ? static_cast<T>(-static_cast<int64_t>(result)) : static_cast<T>(result);
+    return true;
+}
+
+static inline void parseFloating(const char *buffer, char **end, float &value)
+{
+    value = strtof(buffer, end);
+}
+
+static inline void parseFloating(const char *buffer, char **end, double &value)
+{
+    value = strtod(buffer, end);
+}
+
+/**
+ * Parse a floating point from a slice. The C library is only called on a null terminated copy
+ * on the stack.
+ */
+template <typename T>
+static bool parseFloating(const StringSlice &literal, T &value)
+{
+    if (literal.empty() || literal.size() >= gMaxFloatLiteralSize) {
+        return false;
+    }
+    char buffer[gMaxFloatLiteralSize];
+    memcpy(buffer, literal.data(), literal.size());
+    buffer[literal.size()] = '\0';
+
+    char *end = NULL;
+    T result;
+    parseFloating(buffer, &end, result);
+    if (end != buffer + literal.size() || !std::isfinite(result)) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+bool KeyValueSlices::convert(const StringSlice &literal, uint32_t &value)
+{
+    return parseIntegral(literal, value);
+}
+
+bool KeyValueSlices::convert(const StringSlice &literal, int32_t &value)
+{
+    return parseIntegral(literal, value);
+}
+
+bool KeyValueSlices::convert(const StringSlice &literal, bool &value)
+{
+    if (literal == "1" || literal == "true") {
+        value = true;
+        return true;
+    }
+    if (literal == "0" || literal == "false") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool KeyValueSlices::convert(const StringSlice &literal, float &value)
+{
+    return parseFloating(literal, value);
+}
+
+bool KeyValueSlices::convert(const StringSlice &literal, double &value)
+{
+    return parseFloating(literal, value);
+}
+
+android::status_t KeyValueSlices::parse(const char *buffer, size_t size)
+{
+    mSize = 0;
+    mOverflowPairs.clear();
+
+    android::status_t status = android::OK;
+    const char *end = buffer + size;
+    for (const char *pair = buffer; pair < end;) {
+        const char *pairEnd = static_cast<const char *>(memchr(pair, mPairDelimiter, end - pair));
+        if (pairEnd == NULL) {
+            pairEnd = end;
+        }
+        if (pairEnd != pair) {
+            Pair keyValue;
+            const char *associator =
+                static_cast<const char *>(memchr(pair, mPairAssociator, pairEnd - pair));
+            if (associator == NULL) {
+                keyValue.key = StringSlice(pair, pairEnd - pair);
+            } else {
+                if (associator == pair) {
+                    // No key provided, bailing out
+                    status = android::BAD_VALUE;
+                    break;
+                }
+                keyValue.key = StringSlice(pair, associator - pair);
+                // Value stands between the associator(s) and the next associator, if any
+                const char *value = associator;
+                while (value != pairEnd && *value == mPairAssociator) {
+                    ++value;
+                }
+                const char *valueEnd =
+                    static_cast<const char *>(memchr(value, mPairAssociator, pairEnd - value));
+                keyValue.value = StringSlice(value, (valueEnd ? valueEnd : pairEnd) - value);
+            }
+            android::status_t res = add(keyValue);
+            if (res != android::OK) {
+                status = res;
+            }
+        }
+        pair = pairEnd + 1;
+    }
+    return status;
+}
+
+const KeyValueSlices::Pair *KeyValueSlices::find(const StringSlice &key) const
+{
+    for (size_t i = 0; i < mSize; i++) {
+        const Pair &pair = (*this)[i];
+        if (pair.key == key) {
+            return &pair;
+        }
+    }
+    return NULL;
+}
+
+android::status_t KeyValueSlices::add(const Pair &pair)
+{
+    Pair *existingPair = find(pair.key);
+    if (existingPair != NULL) {
+        existingPair->value = pair.value;
+        return android::ALREADY_EXISTS;
+    }
+    if (mSize < gInlineCapacity) {
+        mInlinePairs[mSize] = pair;
+    } else {
+        mOverflowPairs.push_back(pair);
+    }
+    mSize++;
+    return android::OK;
+}
+
+}   // namespace intel_audio
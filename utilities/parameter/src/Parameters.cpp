@@ -43,6 +43,16 @@ const std::string &Parameters::gKeyVoipBandType = "voip_band_type";
 
 const std::string &Parameters::gKeyPreProcRequested = "pre_proc_requested";
 
+const std::string &Parameters::gKeyFlightRecorderExport = "flight_recorder_export";
+
+const std::string &Parameters::gKeyLatencyStatsReset = "latency_stats_reset";
+
+const std::string &Parameters::gKeyCpuCost = "cpu_cost";
+
+const std::string &Parameters::gKeyAudioTrace = "audio_trace";
+
+const std::string &Parameters::gKeyAudioTraceExport = "audio_trace_export";
+
 const std::string &Parameters::gkeyAlwaysListeningRoute = "vtsv_route";
 
 const std::string &Parameters::gKeyLpalDevice = "lpal_device";
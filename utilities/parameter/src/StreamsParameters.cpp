@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StreamsParameters.hpp"
+#include "Parameters.hpp"
+#include <convert.hpp>
+
+using namespace std;
+
+namespace intel_audio
+{
+
+StreamsParameters::StreamsParameters()
+    : mValues()
+{
+}
+
+const string &StreamsParameters::getKey(Id id)
+{
+    switch (id) {
+    case AndroidMode:
+        return Parameters::gKeyAndroidMode;
+    case VoipBandType:
+        return Parameters::gKeyVoipBandType;
+    case PreProcRequested:
+        return Parameters::gKeyPreProcRequested;
+    case InputUseCases:
+        return Parameters::gKeyUseCases[Direction::Input];
+    case OutputUseCases:
+        return Parameters::gKeyUseCases[Direction::Output];
+    case InputDevices:
+        return Parameters::gKeyDevices[Direction::Input];
+    case OutputDevices:
+        return Parameters::gKeyDevices[Direction::Output];
+    case InputDeviceAddresses:
+        return Parameters::gKeyDeviceAddresses[Direction::Input];
+    case OutputDeviceAddresses:
+        return Parameters::gKeyDeviceAddresses[Direction::Output];
+    case InputFlags:
+        return Parameters::gKeyFlags[Direction::Input];
+    case OutputFlags:
+        return Parameters::gKeyFlags[Direction::Output];
+    }
+    static const string unknownKey;
+    return unknownKey;
+}
+
+bool StreamsParameters::getId(const string &key, Id &id)
+{
+    for (size_t i = 0; i < gNbIds; i++) {
+        if (getKey(static_cast<Id>(i)) == key) {
+            id = static_cast<Id>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void StreamsParameters::set(Id id, uint32_t value)
+{
+    mValues[id] = value;
+    mIsLiteral.reset(id);
+    mIsSet.set(id);
+}
+
+void StreamsParameters::set(Id id, const string &literal)
+{
+    mLiterals[id] = literal;
+    mIsLiteral.set(id);
+    mIsSet.set(id);
+}
+
+string StreamsParameters::toString() const
+{
+    string keyValueList;
+    for (size_t i = 0; i < gNbIds; i++) {
+        Id id = static_cast<Id>(i);
+        if (!isSet(id)) {
+            continue;
+        }
+        string literal;
+        if (isLiteral(id)) {
+            literal = getLiteral(id);
+        } else {
+            audio_comms::utilities::convertTo(getValue(id), literal);
+        }
+        keyValueList += (keyValueList.empty() ? "" : ";") + getKey(id) + "=" + literal;
+    }
+    return keyValueList;
+}
+
+}   // namespace intel_audio
@@ -16,7 +16,12 @@
 
 #include "KeyValuePairsTest.hpp"
 #include <KeyValuePairs.hpp>
+#include <KeyValueSlices.hpp>
+#include <chrono>
+#include <map>
 #include <string>
+#include <string.h>
+#include <stdlib.h>
 #include <gtest/gtest.h>
 
 
@@ -334,3 +339,195 @@ INSTANTIATE_TEST_CASE_P(
                       std::numeric_limits<float>::min()
                       )
     );
+
+/**
+ * Reference strtok based tokenizer, as KeyValuePairs used to parse before relying on
+ * KeyValueSlices. Used to check both tokenizers agree on any input.
+ */
+static android::status_t referenceParse(const string &keyValuePairs, map<string, string> &pairs)
+{
+    android::status_t status = android::OK;
+    char *buffer = strdup(keyValuePairs.c_str());
+    char *context;
+    char *pair = strtok_r(buffer, ";", &context);
+    while (pair != NULL) {
+        string key;
+        string value;
+        if (strchr(pair, '=') != NULL) {
+            if (strcspn(pair, "=") == 0) {
+                status = android::BAD_VALUE;
+                break;
+            }
+            key = strtok(pair, "=");
+            char *tmp = strtok(NULL, "=");
+            if (tmp != NULL) {
+                value = tmp;
+            }
+        } else {
+            key = pair;
+        }
+        if (pairs.find(key) != pairs.end()) {
+            status = android::ALREADY_EXISTS;
+        }
+        pairs[key] = value;
+        pair = strtok_r(NULL, ";", &context);
+    }
+    free(buffer);
+    return status;
+}
+
+/** Deterministic pseudo random generator, so that fuzz cases are reproducible. */
+static uint32_t nextRandom(uint32_t &seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7FFF;
+}
+
+TEST(KeyValueSlicesTest, SlicesReferToCallerBuffer)
+{
+    const string keyValuePairs = "output_devices=2;mic_mute;input_flags=0x1";
+
+    KeyValueSlices pairs(keyValuePairs);
+    ASSERT_EQ(3u, pairs.size());
+
+    StringSlice value;
+    ASSERT_EQ(android::OK, pairs.getLiteral("output_devices", value));
+    EXPECT_EQ(keyValuePairs.data() + strlen("output_devices="), value.data());
+    EXPECT_EQ("2", value.toString());
+
+    ASSERT_EQ(android::OK, pairs.getLiteral("mic_mute", value));
+    EXPECT_TRUE(value.empty());
+    EXPECT_EQ(android::BAD_VALUE, pairs.getLiteral("output", value));
+
+    uint32_t flags = 0;
+    ASSERT_EQ(android::OK, pairs.get("input_flags", flags));
+    EXPECT_EQ(1u, flags);
+}
+
+TEST(KeyValueSlicesTest, TypedGetters)
+{
+    uint32_t unsignedValue = 0;
+    EXPECT_TRUE(KeyValueSlices::convert("4294967295", unsignedValue));
+    EXPECT_EQ(4294967295u, unsignedValue);
+    EXPECT_TRUE(KeyValueSlices::convert("0x80000000", unsignedValue));
+    EXPECT_EQ(0x80000000u, unsignedValue);
+    EXPECT_FALSE(KeyValueSlices::convert("4294967296", unsignedValue));
+    EXPECT_FALSE(KeyValueSlices::convert("-1", unsignedValue));
+    EXPECT_FALSE(KeyValueSlices::convert("12u", unsignedValue));
+    EXPECT_FALSE(KeyValueSlices::convert("0x", unsignedValue));
+    EXPECT_FALSE(KeyValueSlices::convert("", unsignedValue));
+
+    int32_t signedValue = 0;
+    EXPECT_TRUE(KeyValueSlices::convert("-2147483648", signedValue));
+    EXPECT_EQ(numeric_limits<int32_t>::min(), signedValue);
+    EXPECT_TRUE(KeyValueSlices::convert("+2147483647", signedValue));
+    EXPECT_EQ(numeric_limits<int32_t>::max(), signedValue);
+    EXPECT_FALSE(KeyValueSlices::convert("2147483648", signedValue));
+
+    bool boolValue = false;
+    EXPECT_TRUE(KeyValueSlices::convert("true", boolValue));
+    EXPECT_TRUE(boolValue);
+    EXPECT_TRUE(KeyValueSlices::convert("0", boolValue));
+    EXPECT_FALSE(boolValue);
+    EXPECT_FALSE(KeyValueSlices::convert("on", boolValue));
+
+    float floatValue = 0.0f;
+    EXPECT_TRUE(KeyValueSlices::convert("0.5", floatValue));
+    EXPECT_FLOAT_EQ(0.5f, floatValue);
+    EXPECT_FALSE(KeyValueSlices::convert("0.5dB", floatValue));
+    EXPECT_FALSE(KeyValueSlices::convert("1e39", floatValue));
+}
+
+TEST(KeyValueSlicesTest, FuzzRoundTrip)
+{
+    static const char alphabet[] = "abcXYZ019_-|.:/ ";
+    static const uint32_t nbIterations = 2000;
+    uint32_t seed = 42;
+
+    for (uint32_t iteration = 0; iteration < nbIterations; iteration++) {
+        KeyValuePairs pairs;
+        map<string, string> expected;
+        uint32_t nbPairs = nextRandom(seed) % 24;
+        for (uint32_t i = 0; i < nbPairs; i++) {
+            string key(1 + nextRandom(seed) % 12, ' ');
+            string value(nextRandom(seed) % 16, ' ');
+            for (auto &c : key) {
+                c = alphabet[nextRandom(seed) % (sizeof(alphabet) - 1)];
+            }
+            for (auto &c : value) {
+                c = alphabet[nextRandom(seed) % (sizeof(alphabet) - 1)];
+            }
+            pairs.add(key, value);
+            expected[key] = value;
+        }
+        string keyValuePairs = pairs.toString();
+
+        KeyValueSlices slices(keyValuePairs);
+        ASSERT_EQ(expected.size(), slices.size()) << keyValuePairs;
+        for (const auto &pair : expected) {
+            string value;
+            ASSERT_EQ(android::OK, slices.get(pair.first, value)) << keyValuePairs;
+            EXPECT_EQ(pair.second, value);
+        }
+        EXPECT_EQ(keyValuePairs, KeyValuePairs(keyValuePairs).toString());
+    }
+}
+
+TEST(KeyValueSlicesTest, FuzzAgainstReferenceTokenizer)
+{
+    static const char alphabet[] = "ab1;;==x ";
+    static const uint32_t nbIterations = 20000;
+    uint32_t seed = 7;
+
+    for (uint32_t iteration = 0; iteration < nbIterations; iteration++) {
+        string keyValuePairs(nextRandom(seed) % 32, ' ');
+        for (auto &c : keyValuePairs) {
+            c = alphabet[nextRandom(seed) % (sizeof(alphabet) - 1)];
+        }
+        map<string, string> expected;
+        android::status_t expectedStatus = referenceParse(keyValuePairs, expected);
+
+        KeyValueSlices slices;
+        EXPECT_EQ(expectedStatus, slices.parse(keyValuePairs)) << keyValuePairs;
+        ASSERT_EQ(expected.size(), slices.size()) << keyValuePairs;
+        for (size_t i = 0; i < slices.size(); i++) {
+            auto it = expected.find(slices[i].key.toString());
+            ASSERT_TRUE(it != expected.end()) << keyValuePairs;
+            EXPECT_EQ(it->second, slices[i].value.toString()) << keyValuePairs;
+        }
+    }
+}
+
+TEST(KeyValueSlicesTest, ParsingThroughputBenchmark)
+{
+    static const uint32_t nbParses = 50000;
+    const string keyValuePairs =
+        "android_mode=0;input_device_addresses=;input_devices=2147483652;input_flags=0;"
+        "input_sources=1;output_device_addresses=;output_devices=2;output_flags=2;"
+        "output_usecase=0;pre_proc_requested=0;voip_band_type=1";
+
+    uint32_t checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nbParses; i++) {
+        map<string, string> pairs;
+        referenceParse(keyValuePairs, pairs);
+        checksum += pairs.size();
+    }
+    auto reference = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start);
+
+    start = chrono::steady_clock::now();
+    KeyValueSlices slices;
+    for (uint32_t i = 0; i < nbParses; i++) {
+        slices.parse(keyValuePairs);
+        uint32_t devices = 0;
+        slices.get("output_devices", devices);
+        checksum -= slices.size() + devices - 2;
+    }
+    auto sliced = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+
+    // Reported in the test results, e.g. in the XML output
+    RecordProperty("strtokMapNsPerParse", static_cast<int>(reference.count() / nbParses));
+    RecordProperty("slicesNsPerParse", static_cast<int>(sliced.count() / nbParses));
+    EXPECT_EQ(0u, checksum);
+}
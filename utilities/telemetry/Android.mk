@@ -0,0 +1,143 @@
+#
+#
+# Copyright (C) Intel 2018
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+LOCAL_PATH := $(call my-dir)
+include $(OPTIONAL_QUALITY_ENV_SETUP)
+
+#######################################################################
+# Common variables
+
+component_export_include_dir := \
+    $(LOCAL_PATH)/include \
+
+component_src_files :=  \
+    src/AudioTelemetry.cpp \
+    src/AudioTelemetryReader.cpp \
+
+component_static_lib := \
+    libaudio_comms_utilities \
+
+component_static_lib_host := \
+    $(foreach lib, $(component_static_lib), $(lib)_host) \
+
+component_cflags := $(HAL_COMMON_CFLAGS)
+
+#######################################################################
+# Target Component Build
+
+include $(CLEAR_VARS)
+
+LOCAL_STATIC_LIBRARIES := $(component_static_lib)
+
+LOCAL_SRC_FILES := $(component_src_files)
+
+LOCAL_C_INCLUDES := $(component_export_include_dir)
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(component_export_include_dir)
+LOCAL_CFLAGS := $(component_cflags)
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libaudiotelemetry
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_MODULE_OWNER := intel
+LOCAL_HEADER_LIBRARIES += libutils_headers
+
+include $(BUILD_STATIC_LIBRARY)
+
+#######################################################################
+# Host Component Build
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_STATIC_LIBRARIES := $(component_static_lib_host)
+
+LOCAL_SRC_FILES := $(component_src_files)
+
+LOCAL_C_INCLUDES := $(component_export_include_dir)
+LOCAL_CFLAGS := $(component_cflags) -O0 -ggdb
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(component_export_include_dir)
+
+LOCAL_STRIP_MODULE := false
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libaudiotelemetry_host
+LOCAL_MODULE_OWNER := intel
+
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+
+include $(BUILD_HOST_STATIC_LIBRARY)
+endif
+
+#######################################################################
+# Reader tool, sampling the telemetry page of a running HAL
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := tools/AudioTelemetryTool.cpp
+LOCAL_STATIC_LIBRARIES := libaudiotelemetry $(component_static_lib)
+LOCAL_CFLAGS := $(component_cflags)
+LOCAL_HEADER_LIBRARIES += libutils_headers
+LOCAL_SHARED_LIBRARIES := liblog
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := audio_telemetry_reader
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_MODULE_OWNER := intel
+
+include $(BUILD_EXECUTABLE)
+
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := tools/AudioTelemetryTool.cpp
+LOCAL_STATIC_LIBRARIES := libaudiotelemetry_host $(component_static_lib_host)
+LOCAL_CFLAGS := $(component_cflags)
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := audio_telemetry_reader_host
+LOCAL_MODULE_OWNER := intel
+
+include $(BUILD_HOST_EXECUTABLE)
+endif
+
+# Functional test
+#######################################################################
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES += test/AudioTelemetryTest.cpp \
+
+LOCAL_C_INCLUDES := \
+
+LOCAL_STATIC_LIBRARIES += \
+    libaudiotelemetry_host \
+    libaudio_comms_utilities_host \
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra
+LOCAL_LDFLAGS += -lpthread
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := audio_telemetry_test
+LOCAL_MODULE_OWNER := intel
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+include $(BUILD_HOST_NATIVE_TEST)
+endif
+
+include $(OPTIONAL_QUALITY_RUN_TEST)
+
+#######################################################################
+
+include $(OPTIONAL_QUALITY_ENV_TEARDOWN)
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "AudioTelemetryLayout.hpp"
+#include <AudioNonCopyable.hpp>
+#include <utils/Errors.h>
+#include <mutex>
+
+namespace intel_audio
+{
+
+/**
+ * Publishes counters of the HAL in a shared memory page, a memfd, that monitoring tools map
+ * read-only from /proc/<pid>/fd to sample it without any IPC nor lock of the HAL.
+ * Each slot of the page has a single writer, which never waits for the readers.
+ */
+class AudioTelemetry : private audio_comms::utilities::NonCopyable
+{
+public:
+    AudioTelemetry();
+    ~AudioTelemetry();
+
+    /**
+     * Creates and maps the page. Until then, or if it failed, no slot is given.
+     *
+     * @return OK if the page is published, error code otherwise.
+     */
+    android::status_t init();
+
+    /** @return file descriptor of the page, -1 if not published. */
+    int getFd() const { return mFd; }
+
+    /**
+     * Gives a stream slot, marked in use once written by its stream.
+     *
+     * @return the slot, NULL if none is left or the page is not published.
+     */
+    telemetry::StreamSlot *acquireStreamSlot();
+
+    /**
+     * Gives back a stream slot, marked unused for the readers.
+     *
+     * @param[in] slot given by acquireStreamSlot, NULL is ignored.
+     */
+    void releaseStreamSlot(telemetry::StreamSlot *slot);
+
+    /** @return the routing slot, NULL if the page is not published. */
+    telemetry::RoutingSlot *getRoutingSlot();
+
+    /** @return CLOCK_MONOTONIC time, the time base of the page. */
+    static uint64_t getMonotonicNs();
+
+private:
+    struct Page
+    {
+        telemetry::Header header;
+        telemetry::RoutingSlot routing;
+        telemetry::StreamSlot streams[telemetry::gMaxStreams];
+    };
+
+    int mFd;
+    Page *mPage;
+
+    std::mutex mSlotLock; /**< Protects the ownership of the stream slots. */
+    bool mSlotUsed[telemetry::gMaxStreams];
+};
+
+} // namespace intel_audio
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Layout of the telemetry page shared by the audio HAL with the monitoring tools.
+ * All fields have a fixed size and alignment, so that 32 and 64 bits processes agree on it.
+ *
+ * The page starts with a header describing the position of the other sections, readers must
+ * use its offsets and strides rather than the sizes of their own structures. Compatible changes,
+ * i.e. fields appended to a section, keep the version: readers only use the fields they know.
+ */
+namespace intel_audio
+{
+namespace telemetry
+{
+
+static const uint32_t gMagic = 0x4d4c5441; /**< "ATLM" in little endian. */
+static const uint32_t gVersion = 2;
+
+/** Name of the memfd holding the page, as seen in /proc/<pid>/fd. */
+static const char *const gPageName = "audio_hal_telemetry";
+
+static const size_t gMaxStreams = 32;
+static const size_t gRouteNameSize = 32;
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t pageSize;
+    uint32_t routingOffset;
+    uint32_t streamOffset;
+    uint32_t streamStride;
+    uint32_t streamCount;
+    int32_t pid; /**< Process publishing the page. */
+    uint32_t reserved;
+    uint64_t creationTimeNs; /**< CLOCK_MONOTONIC. */
+};
+
+struct StreamCounters
+{
+    uint32_t inUse; /**< 1 while the slot belongs to a stream, other fields are stale if 0. */
+    int32_t handle; /**< I/O handle given by the policy. */
+    uint32_t isOutput;
+    uint32_t sampleRate; /**< Of the client side of the stream. */
+    uint32_t channelCount;
+    uint32_t latencyMs; /**< Nominal latency of the route. */
+    uint64_t frames; /**< Frames written or read by the client. */
+    uint64_t underruns; /**< Playback errors and xruns. */
+    uint64_t overruns; /**< Capture errors and xruns. */
+    uint64_t framesLost; /**< Client frames lost by the xruns the device could measure. */
+    uint64_t lastXrunTimeNs; /**< CLOCK_MONOTONIC, 0 if none. */
+    uint64_t hwBlockingNs; /**< Time blocked in the device during the last read or write. */
+    uint64_t updateTimeNs; /**< CLOCK_MONOTONIC. */
+    char route[gRouteNameSize]; /**< Route the stream is attached to, empty if none. */
+};
+
+struct RoutingCounters
+{
+    uint64_t routingCount; /**< Routing passes executed. */
+    uint64_t routingTotalUs;
+    uint64_t routingMaxUs;
+    uint64_t lastRoutingTimeNs; /**< CLOCK_MONOTONIC end of the last routing pass. */
+    uint32_t enabledPlaybackRoutes; /**< Mask of the enabled playback routes. */
+    uint32_t enabledCaptureRoutes; /**< Mask of the enabled capture routes. */
+    uint64_t updateTimeNs; /**< CLOCK_MONOTONIC. */
+};
+
+/**
+ * Payload published with a sequence lock, so that a single writer never waits for the readers.
+ * The sequence is odd while the payload is written: a reader retries when it changed or was odd
+ * during its copy. The payload is copied as words of relaxed atomics, as readers race the writer.
+ */
+template <typename Payload>
+class SeqLocked
+{
+public:
+    /** Publishes a payload. Writers of a given object must be serialized. */
+    void write(const Payload &payload)
+    {
+        uint64_t words[mWords];
+        memcpy(words, &payload, sizeof(payload));
+        uint32_t sequence = mSequence.load(std::memory_order_relaxed);
+        mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < mWords; i++) {
+            mPayload[i].store(words[i], std::memory_order_relaxed);
+        }
+        mSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * Copies the last payload published.
+     *
+     * @param[out] payload copied, undefined if torn.
+     *
+     * @return true if the copy is consistent, false if torn by a concurrent write.
+     */
+    bool tryRead(Payload &payload) const
+    {
+        uint32_t sequence = mSequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            return false;
+        }
+        uint64_t words[mWords];
+        for (size_t i = 0; i < mWords; i++) {
+            words[i] = mPayload[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mSequence.load(std::memory_order_relaxed) != sequence) {
+            return false;
+        }
+        memcpy(&payload, words, sizeof(payload));
+        return true;
+    }
+
+private:
+    static_assert(sizeof(Payload) % sizeof(uint64_t) == 0, "Payload must be made of words");
+    static const size_t mWords = sizeof(Payload) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> mSequence;
+    uint32_t mPadding;
+    std::atomic<uint64_t> mPayload[mWords];
+};
+
+typedef SeqLocked<StreamCounters> StreamSlot;
+typedef SeqLocked<RoutingCounters> RoutingSlot;
+
+} // namespace telemetry
+} // namespace intel_audio
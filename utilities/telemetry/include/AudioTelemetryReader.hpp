@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "AudioTelemetryLayout.hpp"
+#include <AudioNonCopyable.hpp>
+#include <utils/Errors.h>
+#include <sys/types.h>
+#include <string>
+
+namespace intel_audio
+{
+
+/**
+ * Maps read-only the telemetry page of a HAL, and samples it without disturbing the HAL.
+ */
+class AudioTelemetryReader : private audio_comms::utilities::NonCopyable
+{
+public:
+    AudioTelemetryReader();
+    ~AudioTelemetryReader();
+
+    /**
+     * Maps a telemetry page and checks its layout.
+     *
+     * @param[in] path of the page, e.g. /proc/<pid>/fd/<fd>.
+     *
+     * @return OK if mapped, BAD_VALUE if the file is not a page of a supported version,
+     *         error code otherwise.
+     */
+    android::status_t open(const std::string &path);
+
+    /**
+     * Finds the telemetry page published by a process.
+     *
+     * @param[in] pid of the process.
+     * @param[out] path of the page in /proc.
+     *
+     * @return OK if found, NAME_NOT_FOUND if the process publishes none, error code otherwise.
+     */
+    static android::status_t findPage(pid_t pid, std::string &path);
+
+    /** Unmaps the page, if any. */
+    void close();
+
+    /** @return header of the page, only valid when opened. */
+    const telemetry::Header &getHeader() const { return *mHeader; }
+
+    /** @return number of stream slots of the page, 0 if not opened. */
+    size_t getStreamCount() const;
+
+    /**
+     * Copies the counters of a stream slot, consistent even if updated meanwhile.
+     *
+     * @param[in] index of the slot.
+     * @param[out] counters of the slot, meaningful if in use.
+     *
+     * @return true if copied, false if the index is out of range or the slot kept changing.
+     */
+    bool readStream(size_t index, telemetry::StreamCounters &counters) const;
+
+    /**
+     * Copies the routing counters, consistent even if updated meanwhile.
+     *
+     * @param[out] counters of the routing.
+     *
+     * @return true if copied, false if not opened or the counters kept changing.
+     */
+    bool readRouting(telemetry::RoutingCounters &counters) const;
+
+    /** Attempts of a read before giving up, when the writer keeps updating the slot. */
+    static const uint32_t mMaxReadAttempts = 1000;
+
+private:
+    template <typename Payload>
+    bool read(const telemetry::SeqLocked<Payload> &slot, Payload &payload) const;
+
+    const uint8_t *mAddress;
+    size_t mSize;
+    const telemetry::Header *mHeader;
+};
+
+} // namespace intel_audio
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AudioTelemetry"
+
+#include "AudioTelemetry.hpp"
+#include <utilities/Log.hpp>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+using android::status_t;
+using audio_comms::utilities::Log;
+
+namespace intel_audio
+{
+
+using namespace telemetry;
+
+AudioTelemetry::AudioTelemetry()
+    : mFd(-1),
+      mPage(NULL)
+{
+    for (auto &used : mSlotUsed) {
+        used = false;
+    }
+}
+
+AudioTelemetry::~AudioTelemetry()
+{
+    if (mPage != NULL) {
+        munmap(mPage, sizeof(Page));
+    }
+    if (mFd >= 0) {
+        close(mFd);
+    }
+}
+
+status_t AudioTelemetry::init()
+{
+    if (mPage != NULL) {
+        return android::OK;
+    }
+#ifdef __NR_memfd_create
+    int fd = syscall(__NR_memfd_create, gPageName, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    int fd = -1;
+    errno = ENOSYS;
+#endif
+    if (fd < 0) {
+        Log::Error() << __FUNCTION__ << ": Cannot create memfd: " << strerror(errno);
+        return android::NO_INIT;
+    }
+    if (ftruncate(fd, sizeof(Page)) != 0) {
+        Log::Error() << __FUNCTION__ << ": Cannot size memfd: " << strerror(errno);
+        close(fd);
+        return android::NO_INIT;
+    }
+#ifdef F_ADD_SEALS
+    // Readers keep a mapping of the page: it must never shrink under them.
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        Log::Warning() << __FUNCTION__ << ": Cannot seal memfd: " << strerror(errno);
+    }
+#endif
+    void *address = mmap(NULL, sizeof(Page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        Log::Error() << __FUNCTION__ << ": Cannot map memfd: " << strerror(errno);
+        close(fd);
+        return android::NO_INIT;
+    }
+    // The page is zero-filled: all the slots are unused, with an even sequence.
+    mPage = static_cast<Page *>(address);
+    mFd = fd;
+
+    Header &header = mPage->header;
+    header.version = gVersion;
+    header.headerSize = sizeof(Header);
+    header.pageSize = sizeof(Page);
+    header.routingOffset = offsetof(Page, routing);
+    header.streamOffset = offsetof(Page, streams);
+    header.streamStride = sizeof(StreamSlot);
+    header.streamCount = gMaxStreams;
+    header.pid = getpid();
+    header.creationTimeNs = getMonotonicNs();
+    // The magic comes last, readers ignore the page until then.
+    std::atomic_thread_fence(std::memory_order_release);
+    header.magic = gMagic;
+
+    Log::Info() << __FUNCTION__ << ": telemetry published in fd " << mFd << ", "
+                << sizeof(Page) << " bytes";
+    return android::OK;
+}
+
+StreamSlot *AudioTelemetry::acquireStreamSlot()
+{
+    if (mPage == NULL) {
+        return NULL;
+    }
+    std::lock_guard<std::mutex> lock(mSlotLock);
+    for (size_t i = 0; i < gMaxStreams; i++) {
+        if (!mSlotUsed[i]) {
+            mSlotUsed[i] = true;
+            return &mPage->streams[i];
+        }
+    }
+    Log::Warning() << __FUNCTION__ << ": no stream slot left, stream not published";
+    return NULL;
+}
+
+void AudioTelemetry::releaseStreamSlot(StreamSlot *slot)
+{
+    if (slot == NULL || mPage == NULL) {
+        return;
+    }
+    StreamCounters unused;
+    memset(&unused, 0, sizeof(unused));
+    unused.updateTimeNs = getMonotonicNs();
+    slot->write(unused);
+
+    std::lock_guard<std::mutex> lock(mSlotLock);
+    mSlotUsed[slot - mPage->streams] = false;
+}
+
+RoutingSlot *AudioTelemetry::getRoutingSlot()
+{
+    return mPage != NULL ? &mPage->routing : NULL;
+}
+
+uint64_t AudioTelemetry::getMonotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+} // namespace intel_audio
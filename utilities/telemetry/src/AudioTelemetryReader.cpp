@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AudioTelemetryReader.hpp"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using android::status_t;
+
+namespace intel_audio
+{
+
+using namespace telemetry;
+
+AudioTelemetryReader::AudioTelemetryReader()
+    : mAddress(NULL),
+      mSize(0),
+      mHeader(NULL)
+{
+}
+
+AudioTelemetryReader::~AudioTelemetryReader()
+{
+    close();
+}
+
+status_t AudioTelemetryReader::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -errno;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        int error = errno;
+        ::close(fd);
+        return -error;
+    }
+    size_t size = status.st_size;
+    if (size < sizeof(Header)) {
+        ::close(fd);
+        return android::BAD_VALUE;
+    }
+    void *address = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the page alive.
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return -errno;
+    }
+    mAddress = static_cast<const uint8_t *>(address);
+    mSize = size;
+    mHeader = reinterpret_cast<const Header *>(mAddress);
+
+    const Header &header = *mHeader;
+    if (header.magic != gMagic || header.version != gVersion ||
+        header.headerSize < sizeof(Header) || header.pageSize > mSize ||
+        header.routingOffset + sizeof(RoutingSlot) > header.pageSize ||
+        header.streamStride < sizeof(StreamSlot) ||
+        header.streamOffset + static_cast<uint64_t>(header.streamStride) * header.streamCount >
+        header.pageSize) {
+        close();
+        return android::BAD_VALUE;
+    }
+    return android::OK;
+}
+
+status_t AudioTelemetryReader::findPage(pid_t pid, std::string &path)
+{
+    std::string fdDir = "/proc/" + std::to_string(pid) + "/fd";
+    DIR *dir = opendir(fdDir.c_str());
+    if (dir == NULL) {
+        return -errno;
+    }
+    // A memfd is linked to "/memfd:<name> (deleted)".
+    std::string target = std::string("/memfd:") + gPageName;
+    status_t status = android::NAME_NOT_FOUND;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string fdPath = fdDir + "/" + entry->d_name;
+        char link[256];
+        ssize_t length = readlink(fdPath.c_str(), link, sizeof(link) - 1);
+        if (length <= 0) {
+            continue;
+        }
+        link[length] = '\0';
+        if (std::string(link).compare(0, target.size(), target) == 0 &&
+            (link[target.size()] == '\0' || link[target.size()] == ' ')) {
+            path = fdPath;
+            status = android::OK;
+            break;
+        }
+    }
+    closedir(dir);
+    return status;
+}
+
+void AudioTelemetryReader::close()
+{
+    if (mAddress != NULL) {
+        munmap(const_cast<uint8_t *>(mAddress), mSize);
+    }
+    mAddress = NULL;
+    mSize = 0;
+    mHeader = NULL;
+}
+
+size_t AudioTelemetryReader::getStreamCount() const
+{
+    return mHeader != NULL ? mHeader->streamCount : 0;
+}
+
+template <typename Payload>
+bool AudioTelemetryReader::read(const SeqLocked<Payload> &slot, Payload &payload) const
+{
+    for (uint32_t attempt = 0; attempt < mMaxReadAttempts; attempt++) {
+        if (slot.tryRead(payload)) {
+            return true;
+        }
+        // The writer got preempted while updating, let it complete.
+        sched_yield();
+    }
+    return false;
+}
+
+bool AudioTelemetryReader::readStream(size_t index, StreamCounters &counters) const
+{
+    if (index >= getStreamCount()) {
+        return false;
+    }
+    const uint8_t *slot = mAddress + mHeader->streamOffset + index * mHeader->streamStride;
+    return read(*reinterpret_cast<const StreamSlot *>(slot), counters);
+}
+
+bool AudioTelemetryReader::readRouting(RoutingCounters &counters) const
+{
+    if (mHeader == NULL) {
+        return false;
+    }
+    const uint8_t *slot = mAddress + mHeader->routingOffset;
+    return read(*reinterpret_cast<const RoutingSlot *>(slot), counters);
+}
+
+} // namespace intel_audio
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AudioTelemetry.hpp>
+#include <AudioTelemetryReader.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+namespace intel_audio
+{
+
+using namespace telemetry;
+
+TEST(AudioTelemetry, readerSeesPublishedCounters)
+{
+    AudioTelemetry telemetry;
+    ASSERT_EQ(android::OK, telemetry.init());
+
+    std::string path;
+    ASSERT_EQ(android::OK, AudioTelemetryReader::findPage(getpid(), path));
+    AudioTelemetryReader reader;
+    ASSERT_EQ(android::OK, reader.open(path));
+    EXPECT_EQ(getpid(), reader.getHeader().pid);
+    EXPECT_EQ(gMaxStreams, reader.getStreamCount());
+
+    StreamSlot *slot = telemetry.acquireStreamSlot();
+    ASSERT_TRUE(slot != NULL);
+    StreamCounters counters;
+    memset(&counters, 0, sizeof(counters));
+    counters.inUse = 1;
+    counters.handle = 13;
+    counters.isOutput = 1;
+    counters.frames = 4800;
+    counters.underruns = 2;
+    counters.framesLost = 960;
+    strncpy(counters.route, "Media", sizeof(counters.route));
+    slot->write(counters);
+
+    RoutingCounters routing;
+    memset(&routing, 0, sizeof(routing));
+    routing.routingCount = 3;
+    routing.enabledPlaybackRoutes = 0x5;
+    telemetry.getRoutingSlot()->write(routing);
+
+    size_t found = 0;
+    for (size_t i = 0; i < reader.getStreamCount(); i++) {
+        StreamCounters read;
+        ASSERT_TRUE(reader.readStream(i, read));
+        if (read.inUse) {
+            found++;
+            EXPECT_EQ(13, read.handle);
+            EXPECT_EQ(4800u, read.frames);
+            EXPECT_EQ(2u, read.underruns);
+            EXPECT_EQ(960u, read.framesLost);
+            EXPECT_STREQ("Media", read.route);
+        }
+    }
+    EXPECT_EQ(1u, found);
+    RoutingCounters readRouting;
+    ASSERT_TRUE(reader.readRouting(readRouting));
+    EXPECT_EQ(3u, readRouting.routingCount);
+    EXPECT_EQ(0x5u, readRouting.enabledPlaybackRoutes);
+
+    // A released slot is seen unused, and given again.
+    telemetry.releaseStreamSlot(slot);
+    for (size_t i = 0; i < reader.getStreamCount(); i++) {
+        StreamCounters read;
+        ASSERT_TRUE(reader.readStream(i, read));
+        EXPECT_EQ(0u, read.inUse);
+    }
+    EXPECT_EQ(slot, telemetry.acquireStreamSlot());
+}
+
+TEST(AudioTelemetry, slotsExhausted)
+{
+    AudioTelemetry unpublished;
+    EXPECT_TRUE(unpublished.acquireStreamSlot() == NULL);
+    EXPECT_TRUE(unpublished.getRoutingSlot() == NULL);
+
+    AudioTelemetry telemetry;
+    ASSERT_EQ(android::OK, telemetry.init());
+    for (size_t i = 0; i < gMaxStreams; i++) {
+        EXPECT_TRUE(telemetry.acquireStreamSlot() != NULL);
+    }
+    EXPECT_TRUE(telemetry.acquireStreamSlot() == NULL);
+}
+
+TEST(AudioTelemetry, readsAreNeverTorn)
+{
+    AudioTelemetry telemetry;
+    ASSERT_EQ(android::OK, telemetry.init());
+    StreamSlot *slot = telemetry.acquireStreamSlot();
+    ASSERT_TRUE(slot != NULL);
+
+    AudioTelemetryReader reader;
+    ASSERT_EQ(android::OK, reader.open("/proc/self/fd/" + std::to_string(telemetry.getFd())));
+
+    // The writer keeps all the counters equal, a torn read would see them differ.
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        StreamCounters counters;
+        memset(&counters, 0, sizeof(counters));
+        counters.inUse = 1;
+        for (uint64_t i = 1; !done; i++) {
+            counters.frames = counters.underruns = counters.overruns = counters.hwBlockingNs = i;
+            slot->write(counters);
+        }
+    });
+    uint64_t lastFrames = 0;
+    bool consistent = true;
+    for (int reads = 0; reads < 100000 && consistent;) {
+        StreamCounters read;
+        if (!reader.readStream(0, read) || !read.inUse) {
+            continue;
+        }
+        reads++;
+        consistent = read.frames == read.underruns && read.frames == read.overruns &&
+                     read.frames == read.hwBlockingNs && read.frames >= lastFrames;
+        lastFrames = read.frames;
+    }
+    done = true;
+    writer.join();
+    EXPECT_TRUE(consistent) << "torn read at frames " << lastFrames;
+    EXPECT_GT(lastFrames, 0u);
+}
+
+TEST(AudioTelemetry, unsupportedPageRejected)
+{
+    char path[] = "/tmp/audio_telemetry_test_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = gMagic;
+    header.version = gVersion + 1;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(header)), write(fd, &header, sizeof(header)));
+    close(fd);
+
+    AudioTelemetryReader reader;
+    EXPECT_EQ(android::BAD_VALUE, reader.open(path));
+    EXPECT_EQ(0u, reader.getStreamCount());
+    unlink(path);
+
+    EXPECT_NE(android::OK, reader.open("/nonexistent/audio_telemetry"));
+}
+
+} // namespace intel_audio
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Samples the telemetry page of an audio HAL and prints its counters.
+ *
+ * Usage: audio_telemetry_reader <pid|path> [period ms, default 1000] [samples, 0 for ever]
+ */
+
+#include <AudioTelemetryReader.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using intel_audio::AudioTelemetryReader;
+using namespace intel_audio::telemetry;
+
+static void printSample(const AudioTelemetryReader &reader)
+{
+    RoutingCounters routing;
+    if (reader.readRouting(routing)) {
+        printf("routing: passes %llu, mean %llu us, max %llu us, last at %llu ns, "
+               "playback routes 0x%x, capture routes 0x%x\n",
+               static_cast<unsigned long long>(routing.routingCount),
+               static_cast<unsigned long long>(
+                   routing.routingCount ? routing.routingTotalUs / routing.routingCount : 0),
+               static_cast<unsigned long long>(routing.routingMaxUs),
+               static_cast<unsigned long long>(routing.lastRoutingTimeNs),
+               routing.enabledPlaybackRoutes, routing.enabledCaptureRoutes);
+    }
+    for (size_t i = 0; i < reader.getStreamCount(); i++) {
+        StreamCounters stream;
+        if (!reader.readStream(i, stream) || !stream.inUse) {
+            continue;
+        }
+        // The writer is not trusted to terminate the route name.
+        char route[gRouteNameSize + 1];
+        memcpy(route, stream.route, gRouteNameSize);
+        route[gRouteNameSize] = '\0';
+        printf("  %s %d: %u Hz %u ch, route '%s', latency %u ms, frames %llu, "
+               "underruns %llu, overruns %llu, frames lost %llu, last xrun at %llu ns, "
+               "hw blocking %llu us\n",
+               stream.isOutput ? "out" : "in", stream.handle, stream.sampleRate,
+               stream.channelCount, route, stream.latencyMs,
+               static_cast<unsigned long long>(stream.frames),
+               static_cast<unsigned long long>(stream.underruns),
+               static_cast<unsigned long long>(stream.overruns),
+               static_cast<unsigned long long>(stream.framesLost),
+               static_cast<unsigned long long>(stream.lastXrunTimeNs),
+               static_cast<unsigned long long>(stream.hwBlockingNs / 1000));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <pid|path> [period ms] [samples]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::string path = argv[1];
+    char *end;
+    long pid = strtol(argv[1], &end, 10);
+    if (*end == '\0' && AudioTelemetryReader::findPage(pid, path) != android::OK) {
+        fprintf(stderr, "no telemetry page found in process %ld\n", pid);
+        return EXIT_FAILURE;
+    }
+    uint32_t periodMs = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000;
+    uint32_t samples = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+
+    AudioTelemetryReader reader;
+    android::status_t status = reader.open(path);
+    if (status != android::OK) {
+        fprintf(stderr, "cannot open telemetry page %s: %s\n", path.c_str(),
+                status == android::BAD_VALUE ? "unsupported layout" : strerror(-status));
+        return EXIT_FAILURE;
+    }
+    printf("telemetry page %s of process %d, version %u\n", path.c_str(),
+           reader.getHeader().pid, reader.getHeader().version);
+    for (uint32_t sample = 0; samples == 0 || sample < samples; sample++) {
+        if (sample != 0) {
+            usleep(periodMs * 1000);
+        }
+        printSample(reader);
+        fflush(stdout);
+    }
+    return EXIT_SUCCESS;
+}
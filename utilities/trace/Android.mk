@@ -0,0 +1,115 @@
+#
+#
+# Copyright (C) Intel 2018
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+LOCAL_PATH := $(call my-dir)
+include $(OPTIONAL_QUALITY_ENV_SETUP)
+
+#######################################################################
+# Common variables
+
+component_export_include_dir := \
+    $(LOCAL_PATH)/include \
+
+component_src_files :=  \
+    src/AudioTrace.cpp \
+
+component_static_lib := \
+    libaudio_comms_utilities \
+
+component_static_lib_host := \
+    $(foreach lib, $(component_static_lib), $(lib)_host) \
+
+component_cflags := $(HAL_COMMON_CFLAGS)
+
+#######################################################################
+# Target Component Build
+
+include $(CLEAR_VARS)
+
+LOCAL_STATIC_LIBRARIES := $(component_static_lib)
+
+LOCAL_SRC_FILES := $(component_src_files)
+
+LOCAL_C_INCLUDES := $(component_export_include_dir)
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(component_export_include_dir)
+LOCAL_CFLAGS := $(component_cflags)
+
+# Forwards the trace points to atrace, for systrace.
+ifeq ($(AUDIO_TRACE_ATRACE), 1)
+LOCAL_CFLAGS += -DAUDIO_TRACE_ATRACE
+LOCAL_SHARED_LIBRARIES := libcutils
+endif
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libaudiotrace
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_MODULE_OWNER := intel
+LOCAL_HEADER_LIBRARIES += libutils_headers
+
+include $(BUILD_STATIC_LIBRARY)
+
+#######################################################################
+# Host Component Build
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_STATIC_LIBRARIES := $(component_static_lib_host)
+
+LOCAL_SRC_FILES := $(component_src_files)
+
+LOCAL_C_INCLUDES := $(component_export_include_dir)
+LOCAL_CFLAGS := $(component_cflags) -O0 -ggdb
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(component_export_include_dir)
+
+LOCAL_STRIP_MODULE := false
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libaudiotrace_host
+LOCAL_MODULE_OWNER := intel
+
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+
+include $(BUILD_HOST_STATIC_LIBRARY)
+endif
+# Functional test
+#######################################################################
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES += test/AudioTraceTest.cpp \
+
+LOCAL_C_INCLUDES := \
+
+LOCAL_STATIC_LIBRARIES += \
+    libaudiotrace_host \
+    libaudio_comms_utilities_host \
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra
+LOCAL_LDFLAGS += -lpthread
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := audio_trace_test
+LOCAL_MODULE_OWNER := intel
+include $(OPTIONAL_QUALITY_COVERAGE_JUMPER)
+include $(BUILD_HOST_NATIVE_TEST)
+endif
+
+include $(OPTIONAL_QUALITY_RUN_TEST)
+
+#######################################################################
+
+include $(OPTIONAL_QUALITY_ENV_TEARDOWN)
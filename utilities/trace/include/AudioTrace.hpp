@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <utils/Errors.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+namespace intel_audio
+{
+
+/**
+ * Trace points of the audio HAL, to correlate on a single timeline the events of the streams,
+ * of the routing and of the platform configuration.
+ *
+ * Each thread records its events in its own circular buffer, allocated on its first event: the
+ * recording is lock-free and allocation-free afterwards. When the buffer of a thread is full, its
+ * oldest events are overwritten. The events are exported in the Chrome trace JSON format, which
+ * chrome://tracing and Perfetto load. When built with AUDIO_TRACE_ATRACE, the events are also
+ * forwarded to atrace, to appear in systrace along with the rest of the platform.
+ *
+ * Names and details are not copied: they must outlive the trace, i.e. be string literals or
+ * strings of objects living as long as the HAL, such as route names.
+ */
+class AudioTrace
+{
+public:
+    enum Type
+    {
+        Begin,   /**< Start of a duration, on the calling thread. */
+        End,     /**< End of the last duration begun on the calling thread. */
+        Counter, /**< Value of a counter. */
+        Instant  /**< Punctual event. */
+    };
+
+    struct Event
+    {
+        Type type;
+        const char *name;
+        const char *detail; /**< Optional, NULL if none. */
+        int64_t value; /**< Value of a counter, 0 otherwise. */
+        uint64_t timeNs; /**< Monotonic time of the event. */
+        pid_t tid; /**< Thread of the event. */
+    };
+
+    /** Enables or disables the recording, disabled by default. */
+    static void setEnabled(bool enabled);
+
+    /** @return true if events are recorded, either in the buffers or in atrace. */
+    static bool isEnabled();
+
+    static void begin(const char *name, const char *detail = NULL);
+    static void end(const char *name);
+    static void counter(const char *name, int64_t value);
+    static void instant(const char *name, const char *detail = NULL);
+
+    /**
+     * Copies the events recorded by all the threads, ordered by time.
+     * Events being overwritten during the copy are left out.
+     *
+     * @param[out] events recorded.
+     */
+    static void snapshot(std::vector<Event> &events);
+
+    /** Forgets the events recorded so far. */
+    static void clear();
+
+    /** @return number of events overwritten or not recorded since the last clear. */
+    static uint64_t getLostEvents();
+
+    /**
+     * Formats events as a Chrome trace JSON object.
+     *
+     * @param[in] events to format, as returned by snapshot.
+     *
+     * @return the JSON object.
+     */
+    static std::string toChromeJson(const std::vector<Event> &events);
+
+    /**
+     * Exports the recorded events in a file, as a Chrome trace JSON object.
+     *
+     * @param[in] path of the file, overwritten.
+     *
+     * @return OK if exported, error code otherwise.
+     */
+    static android::status_t exportChromeJson(const std::string &path);
+
+    /** Slots per thread: the last events but one are kept, a slot being possibly written. */
+    static const size_t mEventsPerThread = 4096;
+
+    /** Threads with a buffer, the events of extra threads are lost. */
+    static const size_t mMaxThreads = 64;
+
+private:
+    friend class AudioTraceScope;
+
+    /** @return true if recorded in the buffer of the calling thread, false otherwise. */
+    static bool record(Type type, const char *name, const char *detail, int64_t value);
+
+    /**
+     * Ends a scope. Its end is recorded in the buffer whenever its begin was, even if the
+     * recording was disabled meanwhile, so that no duration is left open in the trace.
+     *
+     * @param[in] name of the scope.
+     * @param[in] isBuffered true if the begin of the scope was recorded in the buffer.
+     */
+    static void endScope(const char *name, bool isBuffered);
+
+    static bool recordInBuffer(Type type, const char *name, const char *detail, int64_t value);
+};
+
+/** Traces a duration for the lifetime of the scope. */
+class AudioTraceScope
+{
+public:
+    explicit AudioTraceScope(const char *name, const char *detail = NULL)
+        : mName(AudioTrace::isEnabled() ? name : NULL),
+          mIsBuffered(false)
+    {
+        if (mName != NULL) {
+            mIsBuffered = AudioTrace::record(AudioTrace::Begin, mName, detail, 0);
+        }
+    }
+
+    ~AudioTraceScope()
+    {
+        if (mName != NULL) {
+            AudioTrace::endScope(mName, mIsBuffered);
+        }
+    }
+
+private:
+    AudioTraceScope(const AudioTraceScope &);
+    AudioTraceScope &operator=(const AudioTraceScope &);
+
+    const char *mName;
+    bool mIsBuffered; /**< The begin was recorded in the buffer, the end shall be as well. */
+};
+
+} // namespace intel_audio
+
+#define AUDIO_TRACE_CONCAT_(a, b) a##b
+#define AUDIO_TRACE_CONCAT(a, b) AUDIO_TRACE_CONCAT_(a, b)
+
+/** Traces the enclosing scope, with an optional detail such as a route name. */
+#define AUDIO_TRACE_SCOPE(...) \
+    intel_audio::AudioTraceScope AUDIO_TRACE_CONCAT(audioTraceScope, __LINE__)(__VA_ARGS__)
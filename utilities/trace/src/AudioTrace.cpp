@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AudioTrace"
+
+#include "AudioTrace.hpp"
+#include <utilities/Log.hpp>
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef AUDIO_TRACE_ATRACE
+#define ATRACE_TAG ATRACE_TAG_AUDIO
+#include <cutils/trace.h>
+#endif
+
+using android::status_t;
+using audio_comms::utilities::Log;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+
+namespace intel_audio
+{
+
+/** Recorded event, its fields are atomics as the export may read them while overwritten. */
+struct TraceSlot
+{
+    std::atomic<int> type;
+    std::atomic<const char *> name;
+    std::atomic<const char *> detail;
+    std::atomic<int64_t> value;
+    std::atomic<uint64_t> timeNs;
+    std::atomic<pid_t> tid;
+};
+
+/**
+ * Circular buffer of the events of a thread, only written by this thread.
+ * The write index counts the events ever written: an event is published once the index is past
+ * it, and its slot is reused once the index is a buffer size further.
+ */
+struct TraceBuffer
+{
+    TraceSlot slots[AudioTrace::mEventsPerThread];
+    std::atomic<uint64_t> writeIndex;
+    std::atomic<uint64_t> clearIndex; /**< Events before it are forgotten. */
+    std::atomic<bool> inUse; /**< Owned by a thread, released when the thread exits. */
+};
+
+const size_t AudioTrace::mEventsPerThread;
+const size_t AudioTrace::mMaxThreads;
+
+static std::atomic<bool> gEnabled(false);
+
+/** Buffers are never freed, those of exited threads are reused by new threads. */
+static TraceBuffer *gBuffers[AudioTrace::mMaxThreads];
+static std::atomic<size_t> gBufferCount(0);
+static std::mutex gBufferLock; /**< Serializes the allocation of the buffers. */
+
+/** Events of threads which got no buffer. */
+static std::atomic<uint64_t> gUnbufferedEvents(0);
+
+static thread_local TraceBuffer *gThreadBuffer = NULL;
+static thread_local pid_t gThreadId = 0;
+static pthread_key_t gThreadExitKey;
+static pthread_once_t gThreadExitKeyOnce = PTHREAD_ONCE_INIT;
+
+static void releaseThreadBuffer(void *buffer)
+{
+    static_cast<TraceBuffer *>(buffer)->inUse.store(false, memory_order_release);
+}
+
+static void createThreadExitKey()
+{
+    pthread_key_create(&gThreadExitKey, releaseThreadBuffer);
+}
+
+/** @return the buffer of the calling thread, NULL if none is left. */
+static TraceBuffer *getThreadBuffer()
+{
+    if (gThreadBuffer != NULL) {
+        return gThreadBuffer;
+    }
+    pthread_once(&gThreadExitKeyOnce, createThreadExitKey);
+
+    TraceBuffer *buffer = NULL;
+    {
+        std::lock_guard<std::mutex> lock(gBufferLock);
+        size_t count = gBufferCount.load(memory_order_relaxed);
+        for (size_t i = 0; i < count && buffer == NULL; i++) {
+            bool inUse = false;
+            if (gBuffers[i]->inUse.compare_exchange_strong(inUse, true, memory_order_acquire)) {
+                buffer = gBuffers[i];
+            }
+        }
+        if (buffer == NULL && count < AudioTrace::mMaxThreads) {
+            buffer = new TraceBuffer;
+            buffer->writeIndex.store(0, memory_order_relaxed);
+            buffer->clearIndex.store(0, memory_order_relaxed);
+            buffer->inUse.store(true, memory_order_relaxed);
+            gBuffers[count] = buffer;
+            gBufferCount.store(count + 1, memory_order_release);
+        }
+    }
+    if (buffer == NULL) {
+        return NULL;
+    }
+    pthread_setspecific(gThreadExitKey, buffer);
+    gThreadId = static_cast<pid_t>(syscall(SYS_gettid));
+    gThreadBuffer = buffer;
+    return buffer;
+}
+
+static uint64_t getMonotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+static bool isAtraceEnabled()
+{
+#ifdef AUDIO_TRACE_ATRACE
+    return ATRACE_ENABLED();
+#else
+    return false;
+#endif
+}
+
+static void forwardToAtrace(AudioTrace::Type type, const char *name, int64_t value)
+{
+#ifdef AUDIO_TRACE_ATRACE
+    switch (type) {
+    case AudioTrace::Begin:
+        ATRACE_BEGIN(name);
+        break;
+    case AudioTrace::End:
+        ATRACE_END();
+        break;
+    case AudioTrace::Counter:
+        ATRACE_INT64(name, value);
+        break;
+    case AudioTrace::Instant:
+        ATRACE_BEGIN(name);
+        ATRACE_END();
+        break;
+    }
+#else
+    (void)type;
+    (void)name;
+    (void)value;
+#endif
+}
+
+void AudioTrace::setEnabled(bool enabled)
+{
+    gEnabled.store(enabled, memory_order_relaxed);
+    Log::Info() << __FUNCTION__ << ": audio trace " << (enabled ? "enabled" : "disabled");
+}
+
+bool AudioTrace::isEnabled()
+{
+    return gEnabled.load(memory_order_relaxed) || isAtraceEnabled();
+}
+
+void AudioTrace::begin(const char *name, const char *detail)
+{
+    record(Begin, name, detail, 0);
+}
+
+void AudioTrace::end(const char *name)
+{
+    record(End, name, NULL, 0);
+}
+
+void AudioTrace::counter(const char *name, int64_t value)
+{
+    record(Counter, name, NULL, value);
+}
+
+void AudioTrace::instant(const char *name, const char *detail)
+{
+    record(Instant, name, detail, 0);
+}
+
+bool AudioTrace::record(Type type, const char *name, const char *detail, int64_t value)
+{
+    forwardToAtrace(type, name, value);
+    if (!gEnabled.load(memory_order_relaxed)) {
+        return false;
+    }
+    return recordInBuffer(type, name, detail, value);
+}
+
+void AudioTrace::endScope(const char *name, bool isBuffered)
+{
+    forwardToAtrace(End, name, 0);
+    if (isBuffered) {
+        recordInBuffer(End, name, NULL, 0);
+    }
+}
+
+bool AudioTrace::recordInBuffer(Type type, const char *name, const char *detail, int64_t value)
+{
+    TraceBuffer *buffer = getThreadBuffer();
+    if (buffer == NULL) {
+        gUnbufferedEvents.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    uint64_t index = buffer->writeIndex.load(memory_order_relaxed);
+    // Orders the slot updates after the publication of the previous event, so that an export
+    // seeing them also sees the slot as being overwritten.
+    std::atomic_thread_fence(memory_order_release);
+
+    TraceSlot &slot = buffer->slots[index % mEventsPerThread];
+    slot.type.store(type, memory_order_relaxed);
+    slot.name.store(name, memory_order_relaxed);
+    slot.detail.store(detail, memory_order_relaxed);
+    slot.value.store(value, memory_order_relaxed);
+    slot.timeNs.store(getMonotonicNs(), memory_order_relaxed);
+    slot.tid.store(gThreadId, memory_order_relaxed);
+    buffer->writeIndex.store(index + 1, memory_order_release);
+    return true;
+}
+
+void AudioTrace::snapshot(std::vector<Event> &events)
+{
+    events.clear();
+    size_t count = gBufferCount.load(memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        const TraceBuffer &buffer = *gBuffers[i];
+        uint64_t endIndex = buffer.writeIndex.load(memory_order_acquire);
+        uint64_t startIndex = endIndex >= mEventsPerThread ? endIndex + 1 - mEventsPerThread : 0;
+        startIndex = std::max(startIndex, buffer.clearIndex.load(memory_order_relaxed));
+
+        size_t firstEvent = events.size();
+        for (uint64_t index = startIndex; index < endIndex; index++) {
+            const TraceSlot &slot = buffer.slots[index % mEventsPerThread];
+            Event event;
+            event.type = static_cast<Type>(slot.type.load(memory_order_relaxed));
+            event.name = slot.name.load(memory_order_relaxed);
+            event.detail = slot.detail.load(memory_order_relaxed);
+            event.value = slot.value.load(memory_order_relaxed);
+            event.timeNs = slot.timeNs.load(memory_order_relaxed);
+            event.tid = slot.tid.load(memory_order_relaxed);
+            events.push_back(event);
+        }
+        // Drop the events whose slot was reused while copied, including the one being written.
+        std::atomic_thread_fence(memory_order_acquire);
+        uint64_t writeIndex = buffer.writeIndex.load(memory_order_relaxed);
+        if (writeIndex + 1 > startIndex + mEventsPerThread) {
+            size_t overwritten = std::min<uint64_t>(writeIndex + 1 - mEventsPerThread - startIndex,
+                                                    endIndex - startIndex);
+            events.erase(events.begin() + firstEvent,
+                         events.begin() + firstEvent + overwritten);
+        }
+    }
+    // Events of each thread are already in order, keep it for events of the same time.
+    std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+        return a.timeNs < b.timeNs;
+    });
+}
+
+void AudioTrace::clear()
+{
+    size_t count = gBufferCount.load(memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        gBuffers[i]->clearIndex.store(gBuffers[i]->writeIndex.load(memory_order_relaxed),
+                                      memory_order_relaxed);
+    }
+    gUnbufferedEvents.store(0, memory_order_relaxed);
+}
+
+uint64_t AudioTrace::getLostEvents()
+{
+    uint64_t lost = gUnbufferedEvents.load(memory_order_relaxed);
+    size_t count = gBufferCount.load(memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t recorded = gBuffers[i]->writeIndex.load(memory_order_relaxed) -
+                            gBuffers[i]->clearIndex.load(memory_order_relaxed);
+        if (recorded >= mEventsPerThread) {
+            lost += recorded + 1 - mEventsPerThread;
+        }
+    }
+    return lost;
+}
+
+/** Appends a string as a JSON string literal. */
+static void appendJsonString(std::string &json, const char *value)
+{
+    json += '"';
+    for (const char *c = value; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            json += '\\';
+            json += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            json += escaped;
+        } else {
+            json += *c;
+        }
+    }
+    json += '"';
+}
+
+std::string AudioTrace::toChromeJson(const std::vector<Event> &events)
+{
+    static const char phases[] = { 'B', 'E', 'C', 'i' };
+    const size_t SIZE = 128;
+    char buffer[SIZE];
+    pid_t pid = getpid();
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event &event = events[i];
+        json += i == 0 ? "\n{\"name\":" : ",\n{\"name\":";
+        appendJsonString(json, event.name);
+        // Chrome trace timestamps are in microseconds.
+        snprintf(buffer, SIZE, ",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":%d,\"tid\":%d",
+                 phases[event.type], static_cast<unsigned long long>(event.timeNs / 1000),
+                 static_cast<unsigned long long>(event.timeNs % 1000), pid, event.tid);
+        json += buffer;
+        if (event.type == Counter) {
+            snprintf(buffer, SIZE, ",\"args\":{\"value\":%lld}",
+                     static_cast<long long>(event.value));
+            json += buffer;
+        } else if (event.detail != NULL) {
+            json += ",\"args\":{\"detail\":";
+            appendJsonString(json, event.detail);
+            json += '}';
+        }
+        if (event.type == Instant) {
+            json += ",\"s\":\"t\"";
+        }
+        json += '}';
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+status_t AudioTrace::exportChromeJson(const std::string &path)
+{
+    std::vector<Event> events;
+    snapshot(events);
+    std::string json = toChromeJson(events);
+
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        Log::Error() << __FUNCTION__ << ": Cannot open " << path << ": " << strerror(errno);
+        return android::UNKNOWN_ERROR;
+    }
+    bool written = fwrite(json.c_str(), 1, json.size(), file) == json.size();
+    if (fclose(file) != 0 || !written) {
+        Log::Error() << __FUNCTION__ << ": Cannot write " << path << ": " << strerror(errno);
+        return android::UNKNOWN_ERROR;
+    }
+    Log::Info() << __FUNCTION__ << ": " << events.size() << " event(s) exported to " << path
+                << ", " << getLostEvents() << " lost";
+    return android::OK;
+}
+
+} // namespace intel_audio
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AudioTrace.hpp>
+#include <gtest/gtest.h>
+#include <string.h>
+#include <thread>
+
+namespace intel_audio
+{
+
+class AudioTraceTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        AudioTrace::clear();
+        AudioTrace::setEnabled(true);
+    }
+
+    virtual void TearDown()
+    {
+        AudioTrace::setEnabled(false);
+        AudioTrace::clear();
+    }
+
+    /** @return the names of the events, with their phase, as a single string. */
+    static std::string getTimeline(const std::vector<AudioTrace::Event> &events)
+    {
+        static const char *const phases[] = { "+", "-", "#", "!" };
+        std::string timeline;
+        for (const auto &event : events) {
+            timeline += std::string(phases[event.type]) + event.name + " ";
+        }
+        return timeline;
+    }
+};
+
+TEST_F(AudioTraceTest, disabledRecordsNothing)
+{
+    AudioTrace::setEnabled(false);
+    {
+        AUDIO_TRACE_SCOPE("ignored");
+        AudioTrace::instant("ignored");
+    }
+    std::vector<AudioTrace::Event> events;
+    AudioTrace::snapshot(events);
+    EXPECT_TRUE(events.empty());
+}
+
+TEST_F(AudioTraceTest, nestedScopes)
+{
+    static const char detail[] = "Media";
+    {
+        AUDIO_TRACE_SCOPE("outer");
+        {
+            AUDIO_TRACE_SCOPE("first");
+        }
+        {
+            AUDIO_TRACE_SCOPE("second");
+            AUDIO_TRACE_SCOPE("inner", detail);
+        }
+        AudioTrace::counter("changes", 3);
+        AudioTrace::instant("done");
+    }
+    std::vector<AudioTrace::Event> events;
+    AudioTrace::snapshot(events);
+    EXPECT_EQ("+outer +first -first +second +inner -inner -second #changes !done -outer ",
+              getTimeline(events));
+
+    ASSERT_EQ(10u, events.size());
+    EXPECT_STREQ(detail, events[4].detail);
+    EXPECT_EQ(3, events[7].value);
+    for (size_t i = 1; i < events.size(); i++) {
+        EXPECT_LE(events[i - 1].timeNs, events[i].timeNs);
+        EXPECT_EQ(events[0].tid, events[i].tid);
+    }
+}
+
+TEST_F(AudioTraceTest, scopeEndedAcrossEnabling)
+{
+    {
+        AUDIO_TRACE_SCOPE("disabledInside");
+        AudioTrace::setEnabled(false);
+    }
+    {
+        AUDIO_TRACE_SCOPE("enabledInside");
+        AudioTrace::setEnabled(true);
+    }
+    std::vector<AudioTrace::Event> events;
+    AudioTrace::snapshot(events);
+    EXPECT_EQ("+disabledInside -disabledInside ", getTimeline(events));
+}
+
+TEST_F(AudioTraceTest, threadsMergedInTimeOrder)
+{
+    AudioTrace::instant("main");
+    std::thread([] { AudioTrace::instant("worker"); }).join();
+    AudioTrace::instant("main");
+
+    std::vector<AudioTrace::Event> events;
+    AudioTrace::snapshot(events);
+    EXPECT_EQ("!main !worker !main ", getTimeline(events));
+    ASSERT_EQ(3u, events.size());
+    EXPECT_NE(events[0].tid, events[1].tid);
+    EXPECT_EQ(events[0].tid, events[2].tid);
+}
+
+TEST_F(AudioTraceTest, oldestEventsOverwritten)
+{
+    for (size_t i = 0; i < AudioTrace::mEventsPerThread + 10; i++) {
+        AudioTrace::counter("frames", i);
+    }
+    std::vector<AudioTrace::Event> events;
+    AudioTrace::snapshot(events);
+    ASSERT_EQ(AudioTrace::mEventsPerThread - 1, events.size());
+    EXPECT_EQ(11, events.front().value);
+    EXPECT_EQ(11u, AudioTrace::getLostEvents());
+
+    AudioTrace::clear();
+    AudioTrace::snapshot(events);
+    EXPECT_TRUE(events.empty());
+    EXPECT_EQ(0u, AudioTrace::getLostEvents());
+}
+
+TEST_F(AudioTraceTest, chromeJson)
+{
+    AudioTrace::Event events[] = {
+        { AudioTrace::Begin, "open", "Media \"out\"", 0, 1000, 12 },
+        { AudioTrace::End, "open", NULL, 0, 2500, 12 },
+        { AudioTrace::Counter, "frames", NULL, -4, 3000, 13 },
+        { AudioTrace::Instant, "xrun", NULL, 0, 4000001, 13 }
+    };
+    std::string json = AudioTrace::toChromeJson(
+        std::vector<AudioTrace::Event>(events, events + 4));
+    std::string pid = std::to_string(getpid());
+
+    EXPECT_NE(std::string::npos, json.find(
+                  "{\"name\":\"open\",\"ph\":\"B\",\"ts\":1.000,\"pid\":" + pid +
+                  ",\"tid\":12,\"args\":{\"detail\":\"Media \\\"out\\\"\"}}"));
+    EXPECT_NE(std::string::npos, json.find(
+                  "{\"name\":\"open\",\"ph\":\"E\",\"ts\":2.500,\"pid\":" + pid + ",\"tid\":12}"));
+    EXPECT_NE(std::string::npos, json.find(
+                  "{\"name\":\"frames\",\"ph\":\"C\",\"ts\":3.000,\"pid\":" + pid +
+                  ",\"tid\":13,\"args\":{\"value\":-4}}"));
+    EXPECT_NE(std::string::npos, json.find(
+                  "{\"name\":\"xrun\",\"ph\":\"i\",\"ts\":4000.001,\"pid\":" + pid +
+                  ",\"tid\":13,\"s\":\"t\"}"));
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_EQ("\n]}\n", json.substr(json.size() - 4));
+}
+
+} // namespace intel_audio
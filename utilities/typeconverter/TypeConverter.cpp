@@ -16,143 +16,200 @@
 
 #include "TypeConverter.hpp"
 #include <policy.h>
+#include <algorithm>
 
 namespace intel_audio
 {
 
-template <>
-const DeviceConverter::Table DeviceConverter::mTypeConversion = {
-    { "AUDIO_DEVICE_OUT_EARPIECE", AUDIO_DEVICE_OUT_EARPIECE },
-    { "AUDIO_DEVICE_OUT_SPEAKER", AUDIO_DEVICE_OUT_SPEAKER },
-    { "AUDIO_DEVICE_OUT_SPEAKER_SAFE", AUDIO_DEVICE_OUT_SPEAKER_SAFE },
-    { "AUDIO_DEVICE_OUT_WIRED_HEADSET", AUDIO_DEVICE_OUT_WIRED_HEADSET },
-    { "AUDIO_DEVICE_OUT_WIRED_HEADPHONE", AUDIO_DEVICE_OUT_WIRED_HEADPHONE },
-    { "AUDIO_DEVICE_OUT_BLUETOOTH_SCO", AUDIO_DEVICE_OUT_BLUETOOTH_SCO },
-    { "AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET", AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET },
-    { "AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT", AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT },
-    { "AUDIO_DEVICE_OUT_ALL_SCO", AUDIO_DEVICE_OUT_ALL_SCO },
-    { "AUDIO_DEVICE_OUT_BLUETOOTH_A2DP", AUDIO_DEVICE_OUT_BLUETOOTH_A2DP },
-    { "AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_HEADPHONES", AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_HEADPHONES },
-    { "AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_SPEAKER", AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_SPEAKER },
-    { "AUDIO_DEVICE_OUT_ALL_A2DP", AUDIO_DEVICE_OUT_ALL_A2DP },
-    { "AUDIO_DEVICE_OUT_HDMI", AUDIO_DEVICE_OUT_HDMI },
-    { "AUDIO_DEVICE_OUT_AUX_DIGITAL", AUDIO_DEVICE_OUT_AUX_DIGITAL },
-    { "AUDIO_DEVICE_OUT_ANLG_DOCK_HEADSET", AUDIO_DEVICE_OUT_ANLG_DOCK_HEADSET },
-    { "AUDIO_DEVICE_OUT_DGTL_DOCK_HEADSET", AUDIO_DEVICE_OUT_DGTL_DOCK_HEADSET },
-    { "AUDIO_DEVICE_OUT_USB_ACCESSORY", AUDIO_DEVICE_OUT_USB_ACCESSORY },
-    { "AUDIO_DEVICE_OUT_USB_DEVICE", AUDIO_DEVICE_OUT_USB_DEVICE },
-    { "AUDIO_DEVICE_OUT_ALL_USB", AUDIO_DEVICE_OUT_ALL_USB },
-    { "AUDIO_DEVICE_OUT_REMOTE_SUBMIX", AUDIO_DEVICE_OUT_REMOTE_SUBMIX },
-    { "AUDIO_DEVICE_OUT_TELEPHONY_TX", AUDIO_DEVICE_OUT_TELEPHONY_TX },
-    { "AUDIO_DEVICE_OUT_LINE", AUDIO_DEVICE_OUT_LINE },
-    { "AUDIO_DEVICE_OUT_HDMI_ARC", AUDIO_DEVICE_OUT_HDMI_ARC },
-    { "AUDIO_DEVICE_OUT_SPDIF", AUDIO_DEVICE_OUT_SPDIF },
-    { "AUDIO_DEVICE_OUT_FM", AUDIO_DEVICE_OUT_FM },
-    { "AUDIO_DEVICE_OUT_AUX_LINE", AUDIO_DEVICE_OUT_AUX_LINE },
-    { "AUDIO_DEVICE_OUT_IP", AUDIO_DEVICE_OUT_IP },
-    { "AUDIO_DEVICE_OUT_BUS", AUDIO_DEVICE_OUT_BUS },
-    { "AUDIO_DEVICE_OUT_STUB", AUDIO_DEVICE_OUT_STUB },
-    { "AUDIO_DEVICE_IN_AMBIENT", AUDIO_DEVICE_IN_AMBIENT },
-    { "AUDIO_DEVICE_IN_BUILTIN_MIC", AUDIO_DEVICE_IN_BUILTIN_MIC },
-    { "AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET", AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET },
+/**
+ * Compare two literals the same way as strcmp, but within constant expressions.
+ */
+static constexpr int compareLiterals(const char *left, const char *right)
+{
+    return (*left != *right || *left == '\0') ?
+           static_cast<unsigned char>(*left) - static_cast<unsigned char>(*right) :
+           compareLiterals(left + 1, right + 1);
+}
+
+template <typename T>
+static constexpr bool isSorted(const ConversionEntry<T> *entries, size_t size)
+{
+    return size < 2 || (compareLiterals(entries[0].literal, entries[1].literal) < 0 &&
+                        isSorted(entries + 1, size - 1));
+}
+
+/**
+ * Checks at build time that the literals of a conversion table are strictly sorted, as required
+ * by the dichotomic search of TypeConverter::toEnum.
+ */
+template <typename T, size_t N>
+static constexpr bool isSorted(const ConversionEntry<T>(&entries)[N])
+{
+    return isSorted(entries, N);
+}
+
+template <typename T, size_t N>
+static constexpr ConversionTable<T> makeTable(const ConversionEntry<T>(&entries)[N])
+{
+    return { entries, N };
+}
+
+static constexpr DeviceConverter::Entry gDeviceConversion[] = {
     { "AUDIO_DEVICE_IN_ALL_SCO", AUDIO_DEVICE_IN_ALL_SCO },
-    { "AUDIO_DEVICE_IN_WIRED_HEADSET", AUDIO_DEVICE_IN_WIRED_HEADSET },
+    { "AUDIO_DEVICE_IN_AMBIENT", AUDIO_DEVICE_IN_AMBIENT },
+    { "AUDIO_DEVICE_IN_ANLG_DOCK_HEADSET", AUDIO_DEVICE_IN_ANLG_DOCK_HEADSET },
     { "AUDIO_DEVICE_IN_AUX_DIGITAL", AUDIO_DEVICE_IN_AUX_DIGITAL },
-    { "AUDIO_DEVICE_IN_HDMI", AUDIO_DEVICE_IN_HDMI },
-    { "AUDIO_DEVICE_IN_TELEPHONY_RX", AUDIO_DEVICE_IN_TELEPHONY_RX },
-    { "AUDIO_DEVICE_IN_VOICE_CALL", AUDIO_DEVICE_IN_VOICE_CALL },
     { "AUDIO_DEVICE_IN_BACK_MIC", AUDIO_DEVICE_IN_BACK_MIC },
-    { "AUDIO_DEVICE_IN_REMOTE_SUBMIX", AUDIO_DEVICE_IN_REMOTE_SUBMIX },
-    { "AUDIO_DEVICE_IN_ANLG_DOCK_HEADSET", AUDIO_DEVICE_IN_ANLG_DOCK_HEADSET },
+    { "AUDIO_DEVICE_IN_BLUETOOTH_A2DP", AUDIO_DEVICE_IN_BLUETOOTH_A2DP },
+    { "AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET", AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET },
+    { "AUDIO_DEVICE_IN_BUILTIN_MIC", AUDIO_DEVICE_IN_BUILTIN_MIC },
+    { "AUDIO_DEVICE_IN_BUS", AUDIO_DEVICE_IN_BUS },
     { "AUDIO_DEVICE_IN_DGTL_DOCK_HEADSET", AUDIO_DEVICE_IN_DGTL_DOCK_HEADSET },
-    { "AUDIO_DEVICE_IN_USB_ACCESSORY", AUDIO_DEVICE_IN_USB_ACCESSORY },
-    { "AUDIO_DEVICE_IN_USB_DEVICE", AUDIO_DEVICE_IN_USB_DEVICE },
     { "AUDIO_DEVICE_IN_FM_TUNER", AUDIO_DEVICE_IN_FM_TUNER },
-    { "AUDIO_DEVICE_IN_TV_TUNER", AUDIO_DEVICE_IN_TV_TUNER },
+    { "AUDIO_DEVICE_IN_HDMI", AUDIO_DEVICE_IN_HDMI },
+    { "AUDIO_DEVICE_IN_IP", AUDIO_DEVICE_IN_IP },
     { "AUDIO_DEVICE_IN_LINE", AUDIO_DEVICE_IN_LINE },
-    { "AUDIO_DEVICE_IN_SPDIF", AUDIO_DEVICE_IN_SPDIF },
-    { "AUDIO_DEVICE_IN_BLUETOOTH_A2DP", AUDIO_DEVICE_IN_BLUETOOTH_A2DP },
     { "AUDIO_DEVICE_IN_LOOPBACK", AUDIO_DEVICE_IN_LOOPBACK },
-    { "AUDIO_DEVICE_IN_IP", AUDIO_DEVICE_IN_IP },
-    { "AUDIO_DEVICE_IN_BUS", AUDIO_DEVICE_IN_BUS },
+    { "AUDIO_DEVICE_IN_REMOTE_SUBMIX", AUDIO_DEVICE_IN_REMOTE_SUBMIX },
+    { "AUDIO_DEVICE_IN_SPDIF", AUDIO_DEVICE_IN_SPDIF },
     { "AUDIO_DEVICE_IN_STUB", AUDIO_DEVICE_IN_STUB },
+    { "AUDIO_DEVICE_IN_TELEPHONY_RX", AUDIO_DEVICE_IN_TELEPHONY_RX },
+    { "AUDIO_DEVICE_IN_TV_TUNER", AUDIO_DEVICE_IN_TV_TUNER },
+    { "AUDIO_DEVICE_IN_USB_ACCESSORY", AUDIO_DEVICE_IN_USB_ACCESSORY },
+    { "AUDIO_DEVICE_IN_USB_DEVICE", AUDIO_DEVICE_IN_USB_DEVICE },
+    { "AUDIO_DEVICE_IN_VOICE_CALL", AUDIO_DEVICE_IN_VOICE_CALL },
+    { "AUDIO_DEVICE_IN_WIRED_HEADSET", AUDIO_DEVICE_IN_WIRED_HEADSET },
+    { "AUDIO_DEVICE_OUT_ALL_A2DP", AUDIO_DEVICE_OUT_ALL_A2DP },
+    { "AUDIO_DEVICE_OUT_ALL_SCO", AUDIO_DEVICE_OUT_ALL_SCO },
+    { "AUDIO_DEVICE_OUT_ALL_USB", AUDIO_DEVICE_OUT_ALL_USB },
+    { "AUDIO_DEVICE_OUT_ANLG_DOCK_HEADSET", AUDIO_DEVICE_OUT_ANLG_DOCK_HEADSET },
+    { "AUDIO_DEVICE_OUT_AUX_DIGITAL", AUDIO_DEVICE_OUT_AUX_DIGITAL },
+    { "AUDIO_DEVICE_OUT_AUX_LINE", AUDIO_DEVICE_OUT_AUX_LINE },
+    { "AUDIO_DEVICE_OUT_BLUETOOTH_A2DP", AUDIO_DEVICE_OUT_BLUETOOTH_A2DP },
+    { "AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_HEADPHONES", AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_HEADPHONES },
+    { "AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_SPEAKER", AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_SPEAKER },
+    { "AUDIO_DEVICE_OUT_BLUETOOTH_SCO", AUDIO_DEVICE_OUT_BLUETOOTH_SCO },
+    { "AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT", AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT },
+    { "AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET", AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET },
+    { "AUDIO_DEVICE_OUT_BUS", AUDIO_DEVICE_OUT_BUS },
+    { "AUDIO_DEVICE_OUT_DGTL_DOCK_HEADSET", AUDIO_DEVICE_OUT_DGTL_DOCK_HEADSET },
+    { "AUDIO_DEVICE_OUT_EARPIECE", AUDIO_DEVICE_OUT_EARPIECE },
+    { "AUDIO_DEVICE_OUT_FM", AUDIO_DEVICE_OUT_FM },
+    { "AUDIO_DEVICE_OUT_HDMI", AUDIO_DEVICE_OUT_HDMI },
+    { "AUDIO_DEVICE_OUT_HDMI_ARC", AUDIO_DEVICE_OUT_HDMI_ARC },
+    { "AUDIO_DEVICE_OUT_IP", AUDIO_DEVICE_OUT_IP },
+    { "AUDIO_DEVICE_OUT_LINE", AUDIO_DEVICE_OUT_LINE },
+    { "AUDIO_DEVICE_OUT_REMOTE_SUBMIX", AUDIO_DEVICE_OUT_REMOTE_SUBMIX },
+    { "AUDIO_DEVICE_OUT_SPDIF", AUDIO_DEVICE_OUT_SPDIF },
+    { "AUDIO_DEVICE_OUT_SPEAKER", AUDIO_DEVICE_OUT_SPEAKER },
+    { "AUDIO_DEVICE_OUT_SPEAKER_SAFE", AUDIO_DEVICE_OUT_SPEAKER_SAFE },
+    { "AUDIO_DEVICE_OUT_STUB", AUDIO_DEVICE_OUT_STUB },
+    { "AUDIO_DEVICE_OUT_TELEPHONY_TX", AUDIO_DEVICE_OUT_TELEPHONY_TX },
+    { "AUDIO_DEVICE_OUT_USB_ACCESSORY", AUDIO_DEVICE_OUT_USB_ACCESSORY },
+    { "AUDIO_DEVICE_OUT_USB_DEVICE", AUDIO_DEVICE_OUT_USB_DEVICE },
+    { "AUDIO_DEVICE_OUT_WIRED_HEADPHONE", AUDIO_DEVICE_OUT_WIRED_HEADPHONE },
+    { "AUDIO_DEVICE_OUT_WIRED_HEADSET", AUDIO_DEVICE_OUT_WIRED_HEADSET },
 };
-
+static_assert(isSorted(gDeviceConversion), "Literals shall be sorted");
 
 template <>
-const OutputFlagConverter::Table OutputFlagConverter::mTypeConversion = {
+const DeviceConverter::Table DeviceConverter::mTypeConversion =
+    makeTable(gDeviceConversion);
+
+
+static constexpr OutputFlagConverter::Entry gOutputFlagConversion[] = {
+    { "AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD", AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD },
+    { "AUDIO_OUTPUT_FLAG_DEEP_BUFFER", AUDIO_OUTPUT_FLAG_DEEP_BUFFER },
     { "AUDIO_OUTPUT_FLAG_DIRECT", AUDIO_OUTPUT_FLAG_DIRECT },
-    { "AUDIO_OUTPUT_FLAG_PRIMARY", AUDIO_OUTPUT_FLAG_PRIMARY },
     { "AUDIO_OUTPUT_FLAG_FAST", AUDIO_OUTPUT_FLAG_FAST },
-    { "AUDIO_OUTPUT_FLAG_DEEP_BUFFER", AUDIO_OUTPUT_FLAG_DEEP_BUFFER },
-    { "AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD", AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD },
-    { "AUDIO_OUTPUT_FLAG_NON_BLOCKING", AUDIO_OUTPUT_FLAG_NON_BLOCKING },
     { "AUDIO_OUTPUT_FLAG_HW_AV_SYNC", AUDIO_OUTPUT_FLAG_HW_AV_SYNC },
-    { "AUDIO_OUTPUT_FLAG_TTS", AUDIO_OUTPUT_FLAG_TTS },
+    { "AUDIO_OUTPUT_FLAG_IEC958_NONAUDIO", AUDIO_OUTPUT_FLAG_IEC958_NONAUDIO },
+    { "AUDIO_OUTPUT_FLAG_NON_BLOCKING", AUDIO_OUTPUT_FLAG_NON_BLOCKING },
+    { "AUDIO_OUTPUT_FLAG_PRIMARY", AUDIO_OUTPUT_FLAG_PRIMARY },
     { "AUDIO_OUTPUT_FLAG_RAW", AUDIO_OUTPUT_FLAG_RAW },
     { "AUDIO_OUTPUT_FLAG_SYNC", AUDIO_OUTPUT_FLAG_SYNC },
-    { "AUDIO_OUTPUT_FLAG_IEC958_NONAUDIO", AUDIO_OUTPUT_FLAG_IEC958_NONAUDIO },
+    { "AUDIO_OUTPUT_FLAG_TTS", AUDIO_OUTPUT_FLAG_TTS },
 };
+static_assert(isSorted(gOutputFlagConversion), "Literals shall be sorted");
 
 template <>
-const InputFlagConverter::Table InputFlagConverter::mTypeConversion = {
+const OutputFlagConverter::Table OutputFlagConverter::mTypeConversion =
+    makeTable(gOutputFlagConversion);
+
+static constexpr InputFlagConverter::Entry gInputFlagConversion[] = {
     { "AUDIO_INPUT_FLAG_FAST", AUDIO_INPUT_FLAG_FAST },
     { "AUDIO_INPUT_FLAG_HW_HOTWORD", AUDIO_INPUT_FLAG_HW_HOTWORD },
+    { "AUDIO_INPUT_FLAG_PRIMARY", AUDIO_INPUT_FLAG_PRIMARY },
     { "AUDIO_INPUT_FLAG_RAW", AUDIO_INPUT_FLAG_RAW },
     { "AUDIO_INPUT_FLAG_SYNC", AUDIO_INPUT_FLAG_SYNC },
-    { "AUDIO_INPUT_FLAG_PRIMARY", AUDIO_INPUT_FLAG_PRIMARY },
 };
+static_assert(isSorted(gInputFlagConversion), "Literals shall be sorted");
 
 template <>
-const FormatConverter::Table FormatConverter::mTypeConversion = {
-    { "AUDIO_FORMAT_PCM_16_BIT", AUDIO_FORMAT_PCM_16_BIT },
-    { "AUDIO_FORMAT_PCM_8_BIT", AUDIO_FORMAT_PCM_8_BIT },
-    { "AUDIO_FORMAT_PCM_32_BIT", AUDIO_FORMAT_PCM_32_BIT },
-    { "AUDIO_FORMAT_PCM_8_24_BIT", AUDIO_FORMAT_PCM_8_24_BIT },
-    { "AUDIO_FORMAT_PCM_FLOAT", AUDIO_FORMAT_PCM_FLOAT },
-    { "AUDIO_FORMAT_PCM_24_BIT_PACKED", AUDIO_FORMAT_PCM_24_BIT_PACKED },
-    { "AUDIO_FORMAT_MP3", AUDIO_FORMAT_MP3 },
+const InputFlagConverter::Table InputFlagConverter::mTypeConversion =
+    makeTable(gInputFlagConversion);
+
+static constexpr FormatConverter::Entry gFormatConversion[] = {
     { "AUDIO_FORMAT_AAC", AUDIO_FORMAT_AAC },
-    { "AUDIO_FORMAT_AAC_MAIN", AUDIO_FORMAT_AAC_MAIN },
+    { "AUDIO_FORMAT_AAC_ELD", AUDIO_FORMAT_AAC_ELD },
+    { "AUDIO_FORMAT_AAC_ERLC", AUDIO_FORMAT_AAC_ERLC },
+    { "AUDIO_FORMAT_AAC_HE_V1", AUDIO_FORMAT_AAC_HE_V1 },
+    { "AUDIO_FORMAT_AAC_HE_V2", AUDIO_FORMAT_AAC_HE_V2 },
     { "AUDIO_FORMAT_AAC_LC", AUDIO_FORMAT_AAC_LC },
-    { "AUDIO_FORMAT_AAC_SSR", AUDIO_FORMAT_AAC_SSR },
+    { "AUDIO_FORMAT_AAC_LD", AUDIO_FORMAT_AAC_LD },
     { "AUDIO_FORMAT_AAC_LTP", AUDIO_FORMAT_AAC_LTP },
-    { "AUDIO_FORMAT_AAC_HE_V1", AUDIO_FORMAT_AAC_HE_V1 },
+    { "AUDIO_FORMAT_AAC_MAIN", AUDIO_FORMAT_AAC_MAIN },
     { "AUDIO_FORMAT_AAC_SCALABLE", AUDIO_FORMAT_AAC_SCALABLE },
-    { "AUDIO_FORMAT_AAC_ERLC", AUDIO_FORMAT_AAC_ERLC },
-    { "AUDIO_FORMAT_AAC_LD", AUDIO_FORMAT_AAC_LD },
-    { "AUDIO_FORMAT_AAC_HE_V2", AUDIO_FORMAT_AAC_HE_V2 },
-    { "AUDIO_FORMAT_AAC_ELD", AUDIO_FORMAT_AAC_ELD },
-    { "AUDIO_FORMAT_VORBIS", AUDIO_FORMAT_VORBIS },
-    { "AUDIO_FORMAT_HE_AAC_V1", AUDIO_FORMAT_HE_AAC_V1 },
-    { "AUDIO_FORMAT_HE_AAC_V2", AUDIO_FORMAT_HE_AAC_V2 },
-    { "AUDIO_FORMAT_OPUS", AUDIO_FORMAT_OPUS },
+    { "AUDIO_FORMAT_AAC_SSR", AUDIO_FORMAT_AAC_SSR },
     { "AUDIO_FORMAT_AC3", AUDIO_FORMAT_AC3 },
-    { "AUDIO_FORMAT_E_AC3", AUDIO_FORMAT_E_AC3 },
     { "AUDIO_FORMAT_DTS", AUDIO_FORMAT_DTS },
     { "AUDIO_FORMAT_DTS_HD", AUDIO_FORMAT_DTS_HD },
+    { "AUDIO_FORMAT_E_AC3", AUDIO_FORMAT_E_AC3 },
+    { "AUDIO_FORMAT_HE_AAC_V1", AUDIO_FORMAT_HE_AAC_V1 },
+    { "AUDIO_FORMAT_HE_AAC_V2", AUDIO_FORMAT_HE_AAC_V2 },
+    { "AUDIO_FORMAT_MP3", AUDIO_FORMAT_MP3 },
+    { "AUDIO_FORMAT_OPUS", AUDIO_FORMAT_OPUS },
+    { "AUDIO_FORMAT_PCM_16_BIT", AUDIO_FORMAT_PCM_16_BIT },
+    { "AUDIO_FORMAT_PCM_24_BIT_PACKED", AUDIO_FORMAT_PCM_24_BIT_PACKED },
+    { "AUDIO_FORMAT_PCM_32_BIT", AUDIO_FORMAT_PCM_32_BIT },
+    { "AUDIO_FORMAT_PCM_8_24_BIT", AUDIO_FORMAT_PCM_8_24_BIT },
+    { "AUDIO_FORMAT_PCM_8_BIT", AUDIO_FORMAT_PCM_8_BIT },
+    { "AUDIO_FORMAT_PCM_FLOAT", AUDIO_FORMAT_PCM_FLOAT },
+    { "AUDIO_FORMAT_VORBIS", AUDIO_FORMAT_VORBIS },
 };
+static_assert(isSorted(gFormatConversion), "Literals shall be sorted");
 
 template <>
-const OutputChannelConverter::Table OutputChannelConverter::mTypeConversion = {
-    { "AUDIO_CHANNEL_OUT_MONO", AUDIO_CHANNEL_OUT_MONO },
-    { "AUDIO_CHANNEL_OUT_STEREO", AUDIO_CHANNEL_OUT_STEREO },
-    { "AUDIO_CHANNEL_OUT_QUAD", AUDIO_CHANNEL_OUT_QUAD },
-    { "AUDIO_CHANNEL_OUT_QUAD_SIDE", AUDIO_CHANNEL_OUT_QUAD_SIDE },
+const FormatConverter::Table FormatConverter::mTypeConversion =
+    makeTable(gFormatConversion);
+
+static constexpr OutputChannelConverter::Entry gOutputChannelConversion[] = {
     { "AUDIO_CHANNEL_OUT_5POINT1", AUDIO_CHANNEL_OUT_5POINT1 },
     { "AUDIO_CHANNEL_OUT_5POINT1_SIDE", AUDIO_CHANNEL_OUT_5POINT1_SIDE },
     { "AUDIO_CHANNEL_OUT_7POINT1", AUDIO_CHANNEL_OUT_7POINT1 },
+    { "AUDIO_CHANNEL_OUT_MONO", AUDIO_CHANNEL_OUT_MONO },
+    { "AUDIO_CHANNEL_OUT_QUAD", AUDIO_CHANNEL_OUT_QUAD },
+    { "AUDIO_CHANNEL_OUT_QUAD_SIDE", AUDIO_CHANNEL_OUT_QUAD_SIDE },
+    { "AUDIO_CHANNEL_OUT_STEREO", AUDIO_CHANNEL_OUT_STEREO },
 };
+static_assert(isSorted(gOutputChannelConversion), "Literals shall be sorted");
 
 template <>
-const InputChannelConverter::Table InputChannelConverter::mTypeConversion = {
+const OutputChannelConverter::Table OutputChannelConverter::mTypeConversion =
+    makeTable(gOutputChannelConversion);
+
+static constexpr InputChannelConverter::Entry gInputChannelConversion[] = {
+    { "AUDIO_CHANNEL_IN_FRONT_BACK", AUDIO_CHANNEL_IN_FRONT_BACK },
     { "AUDIO_CHANNEL_IN_MONO", AUDIO_CHANNEL_IN_MONO },
     { "AUDIO_CHANNEL_IN_STEREO", AUDIO_CHANNEL_IN_STEREO },
-    { "AUDIO_CHANNEL_IN_FRONT_BACK", AUDIO_CHANNEL_IN_FRONT_BACK },
 };
+static_assert(isSorted(gInputChannelConversion), "Literals shall be sorted");
 
 template <>
-const ChannelIndexConverter::Table ChannelIndexConverter::mTypeConversion = {
+const InputChannelConverter::Table InputChannelConverter::mTypeConversion =
+    makeTable(gInputChannelConversion);
+
+static constexpr ChannelIndexConverter::Entry gChannelIndexConversion[] = {
     { "AUDIO_CHANNEL_INDEX_MASK_1", static_cast<audio_channel_mask_t>(AUDIO_CHANNEL_INDEX_MASK_1) },
     { "AUDIO_CHANNEL_INDEX_MASK_2", static_cast<audio_channel_mask_t>(AUDIO_CHANNEL_INDEX_MASK_2) },
     { "AUDIO_CHANNEL_INDEX_MASK_3", static_cast<audio_channel_mask_t>(AUDIO_CHANNEL_INDEX_MASK_3) },
@@ -162,84 +219,141 @@ const ChannelIndexConverter::Table ChannelIndexConverter::mTypeConversion = {
     { "AUDIO_CHANNEL_INDEX_MASK_7", static_cast<audio_channel_mask_t>(AUDIO_CHANNEL_INDEX_MASK_7) },
     { "AUDIO_CHANNEL_INDEX_MASK_8", static_cast<audio_channel_mask_t>(AUDIO_CHANNEL_INDEX_MASK_8) },
 };
+static_assert(isSorted(gChannelIndexConversion), "Literals shall be sorted");
 
 template <>
-const GainModeConverter::Table GainModeConverter::mTypeConversion = {
-    { "AUDIO_GAIN_MODE_JOINT", AUDIO_GAIN_MODE_JOINT },
+const ChannelIndexConverter::Table ChannelIndexConverter::mTypeConversion =
+    makeTable(gChannelIndexConversion);
+
+static constexpr GainModeConverter::Entry gGainModeConversion[] = {
     { "AUDIO_GAIN_MODE_CHANNELS", AUDIO_GAIN_MODE_CHANNELS },
+    { "AUDIO_GAIN_MODE_JOINT", AUDIO_GAIN_MODE_JOINT },
     { "AUDIO_GAIN_MODE_RAMP", AUDIO_GAIN_MODE_RAMP },
 };
+static_assert(isSorted(gGainModeConversion), "Literals shall be sorted");
 
 template <>
-const StreamTypeConverter::Table StreamTypeConverter::mTypeConversion = {
-    { "AUDIO_STREAM_VOICE_CALL", AUDIO_STREAM_VOICE_CALL },
-    { "AUDIO_STREAM_SYSTEM", AUDIO_STREAM_SYSTEM },
-    { "AUDIO_STREAM_RING", AUDIO_STREAM_RING },
-    { "AUDIO_STREAM_MUSIC", AUDIO_STREAM_MUSIC },
+const GainModeConverter::Table GainModeConverter::mTypeConversion =
+    makeTable(gGainModeConversion);
+
+static constexpr StreamTypeConverter::Entry gStreamTypeConversion[] = {
+    { "AUDIO_STREAM_ACCESSIBILITY", AUDIO_STREAM_ACCESSIBILITY },
     { "AUDIO_STREAM_ALARM", AUDIO_STREAM_ALARM },
-    { "AUDIO_STREAM_NOTIFICATION", AUDIO_STREAM_NOTIFICATION },
     { "AUDIO_STREAM_BLUETOOTH_SCO", AUDIO_STREAM_BLUETOOTH_SCO },
-    { "AUDIO_STREAM_ENFORCED_AUDIBLE", AUDIO_STREAM_ENFORCED_AUDIBLE },
     { "AUDIO_STREAM_DTMF", AUDIO_STREAM_DTMF },
-    { "AUDIO_STREAM_TTS", AUDIO_STREAM_TTS },
-    { "AUDIO_STREAM_ACCESSIBILITY", AUDIO_STREAM_ACCESSIBILITY },
-    { "AUDIO_STREAM_REROUTING", AUDIO_STREAM_REROUTING },
+    { "AUDIO_STREAM_ENFORCED_AUDIBLE", AUDIO_STREAM_ENFORCED_AUDIBLE },
+    { "AUDIO_STREAM_MUSIC", AUDIO_STREAM_MUSIC },
+    { "AUDIO_STREAM_NOTIFICATION", AUDIO_STREAM_NOTIFICATION },
     { "AUDIO_STREAM_PATCH", AUDIO_STREAM_PATCH },
+    { "AUDIO_STREAM_REROUTING", AUDIO_STREAM_REROUTING },
+    { "AUDIO_STREAM_RING", AUDIO_STREAM_RING },
+    { "AUDIO_STREAM_SYSTEM", AUDIO_STREAM_SYSTEM },
+    { "AUDIO_STREAM_TTS", AUDIO_STREAM_TTS },
+    { "AUDIO_STREAM_VOICE_CALL", AUDIO_STREAM_VOICE_CALL },
 };
+static_assert(isSorted(gStreamTypeConversion), "Literals shall be sorted");
 
 template <>
-const InputSourceConverter::Table InputSourceConverter::mTypeConversion = {
-    { "AUDIO_SOURCE_MIC", AUDIO_SOURCE_MIC },
-    { "AUDIO_SOURCE_VOICE_UPLINK", AUDIO_SOURCE_VOICE_UPLINK },
-    { "AUDIO_SOURCE_VOICE_DOWNLINK", AUDIO_SOURCE_VOICE_DOWNLINK },
-    { "AUDIO_SOURCE_VOICE_CALL", AUDIO_SOURCE_VOICE_CALL },
+const StreamTypeConverter::Table StreamTypeConverter::mTypeConversion =
+    makeTable(gStreamTypeConversion);
+
+static constexpr InputSourceConverter::Entry gInputSourceConversion[] = {
     { "AUDIO_SOURCE_CAMCORDER", AUDIO_SOURCE_CAMCORDER },
-    { "AUDIO_SOURCE_VOICE_RECOGNITION", AUDIO_SOURCE_VOICE_RECOGNITION },
-    { "AUDIO_SOURCE_VOICE_COMMUNICATION", AUDIO_SOURCE_VOICE_COMMUNICATION },
-    { "AUDIO_SOURCE_REMOTE_SUBMIX", AUDIO_SOURCE_REMOTE_SUBMIX },
-    { "AUDIO_SOURCE_UNPROCESSED", AUDIO_SOURCE_UNPROCESSED },
     { "AUDIO_SOURCE_FM_TUNER", static_cast<audio_source_t>(AUDIO_SOURCE_CNT) },
     { "AUDIO_SOURCE_HOTWORD", static_cast<audio_source_t>(AUDIO_SOURCE_CNT + 1) },
+    { "AUDIO_SOURCE_MIC", AUDIO_SOURCE_MIC },
+    { "AUDIO_SOURCE_REMOTE_SUBMIX", AUDIO_SOURCE_REMOTE_SUBMIX },
+    { "AUDIO_SOURCE_UNPROCESSED", AUDIO_SOURCE_UNPROCESSED },
+    { "AUDIO_SOURCE_VOICE_CALL", AUDIO_SOURCE_VOICE_CALL },
+    { "AUDIO_SOURCE_VOICE_COMMUNICATION", AUDIO_SOURCE_VOICE_COMMUNICATION },
+    { "AUDIO_SOURCE_VOICE_DOWNLINK", AUDIO_SOURCE_VOICE_DOWNLINK },
+    { "AUDIO_SOURCE_VOICE_RECOGNITION", AUDIO_SOURCE_VOICE_RECOGNITION },
+    { "AUDIO_SOURCE_VOICE_UPLINK", AUDIO_SOURCE_VOICE_UPLINK },
 };
+static_assert(isSorted(gInputSourceConversion), "Literals shall be sorted");
 
 template <>
-const PortRoleConverter::Table PortRoleConverter::mTypeConversion = {
+const InputSourceConverter::Table InputSourceConverter::mTypeConversion =
+    makeTable(gInputSourceConversion);
+
+static constexpr PortRoleConverter::Entry gPortRoleConversion[] = {
     { "AUDIO_PORT_ROLE_NONE", AUDIO_PORT_ROLE_NONE },
-    { "AUDIO_PORT_ROLE_SOURCE", AUDIO_PORT_ROLE_SOURCE },
     { "AUDIO_PORT_ROLE_SINK", AUDIO_PORT_ROLE_SINK },
+    { "AUDIO_PORT_ROLE_SOURCE", AUDIO_PORT_ROLE_SOURCE },
 };
+static_assert(isSorted(gPortRoleConversion), "Literals shall be sorted");
 
 template <>
-const PortTypeConverter::Table PortTypeConverter::mTypeConversion = {
-    { "AUDIO_PORT_TYPE_NONE", AUDIO_PORT_TYPE_NONE },
+const PortRoleConverter::Table PortRoleConverter::mTypeConversion =
+    makeTable(gPortRoleConversion);
+
+static constexpr PortTypeConverter::Entry gPortTypeConversion[] = {
     { "AUDIO_PORT_TYPE_DEVICE", AUDIO_PORT_TYPE_DEVICE },
     { "AUDIO_PORT_TYPE_MIX", AUDIO_PORT_TYPE_MIX },
+    { "AUDIO_PORT_TYPE_NONE", AUDIO_PORT_TYPE_NONE },
     { "AUDIO_PORT_TYPE_SESSION", AUDIO_PORT_TYPE_SESSION },
 };
+static_assert(isSorted(gPortTypeConversion), "Literals shall be sorted");
+
+template <>
+const PortTypeConverter::Table PortTypeConverter::mTypeConversion =
+    makeTable(gPortTypeConversion);
+
+template <class Traits>
+const typename TypeConverter<Traits>::Entry *TypeConverter<Traits>::findLiteral(
+    const std::string &literal)
+{
+    const Entry *entry = std::lower_bound(mTypeConversion.begin(), mTypeConversion.end(),
+                                          literal.c_str(),
+                                          [](const Entry &candidate, const char *literal) {
+                                              return strcmp(candidate.literal, literal) < 0;
+                                          });
+    return (entry != mTypeConversion.end() && literal == entry->literal) ? entry : NULL;
+}
+
+template <class Traits>
+const typename TypeConverter<Traits>::Entry *TypeConverter<Traits>::findValue(const T value)
+{
+    // Index of the entries sorted by value, built on first use. The sort being stable, values
+    // shared by several literals keep the alphabetical order, so the first literal is returned.
+    static const std::vector<const Entry *> valueIndex = [] {
+        std::vector<const Entry *> index;
+        index.reserve(mTypeConversion.size);
+        for (const auto &entry : mTypeConversion) {
+            index.push_back(&entry);
+        }
+        std::stable_sort(index.begin(), index.end(), [](const Entry *left, const Entry *right) {
+            return left->value < right->value;
+        });
+        return index;
+    } ();
+    auto entry = std::lower_bound(valueIndex.begin(), valueIndex.end(), value,
+                                  [](const Entry *candidate, const T value) {
+                                      return candidate->value < value;
+                                  });
+    return (entry != valueIndex.end() && (*entry)->value == value) ? *entry : NULL;
+}
 
 template <class Traits>
 bool TypeConverter<Traits>::toEnum(const std::string &literal, T &enumVal)
 {
-    try {
-        enumVal = mTypeConversion.at(literal);
-        return true;
-    }
-    catch (std::out_of_range &) {
+    const Entry *entry = findLiteral(literal);
+    if (entry == NULL) {
         return false;
     }
-    return false;
+    enumVal = entry->value;
+    return true;
 }
 
 template <class Traits>
 bool TypeConverter<Traits>::toString(const T enumVal, std::string &literal)
 {
-    for (const auto &candidate : mTypeConversion) {
-        if (candidate.second == enumVal) {
-            literal = candidate.first;
-            return true;
-        }
+    const Entry *entry = findValue(enumVal);
+    if (entry == NULL) {
+        return false;
     }
-    return false;
+    literal = entry->literal;
+    return true;
 }
 
 template <class Traits>
@@ -302,11 +416,11 @@ std::string TypeConverter<Traits>::maskToString(uint32_t mask, const char *del)
 {
     std::string formattedMasks;
     for (const auto &candidate : mTypeConversion) {
-        if ((mask & candidate.second) == candidate.second) {
+        if ((mask & candidate.value) == candidate.value) {
             if (not formattedMasks.empty()) {
                 formattedMasks += del;
             }
-            formattedMasks +=  candidate.first;
+            formattedMasks += candidate.literal;
         }
     }
     return formattedMasks;
@@ -317,12 +431,12 @@ std::string TypeConverter<DeviceTraits>::maskToString(uint32_t mask, const char
 {
     std::string literalDevices;
     for (const auto &candidate : mTypeConversion) {
-        if ((audio_is_output_devices(candidate.second) == audio_is_output_devices(mask)) &&
-            ((mask & candidate.second) == candidate.second)) {
+        if ((audio_is_output_devices(candidate.value) == audio_is_output_devices(mask)) &&
+            ((mask & candidate.value) == candidate.value)) {
             if (not literalDevices.empty()) {
                 literalDevices += del;
             }
-            literalDevices +=  candidate.first;
+            literalDevices += candidate.literal;
         }
     }
     return literalDevices;
@@ -113,12 +113,37 @@ std::string collectionToString(const std::vector<typename Traits::Type> &collect
     return literals;
 }
 
+/**
+ * Entry of a conversion table, i.e. a literal and its associated value.
+ */
+template <typename T>
+struct ConversionEntry
+{
+    const char *literal;
+    T value;
+};
+
+/**
+ * Conversion table: constant array of entries, sorted by literal and checked at build time.
+ * Iterating over the table follows the alphabetical order of the literals.
+ */
+template <typename T>
+struct ConversionTable
+{
+    const ConversionEntry<T> *entries;
+    size_t size;
+
+    const ConversionEntry<T> *begin() const { return entries; }
+    const ConversionEntry<T> *end() const { return entries + size; }
+};
+
 template <class Traits>
 class TypeConverter
 {
 public:
     typedef typename Traits::Type T;
-    typedef const std::map<const std::string, T> Table;
+    typedef ConversionEntry<T> Entry;
+    typedef ConversionTable<T> Table;
     typedef std::vector<T> Collection;
 
     static bool toEnum(const std::string &literal, T &enumVal);
@@ -131,7 +156,14 @@ public:
     static uint32_t maskFromString(const std::string &str, const char *del);
     static std::string maskToString(uint32_t mask, const char *del = "|");
 
-    static Table mTypeConversion;
+    static const Table mTypeConversion;
+
+private:
+    /** @return entry of the literal, found by dichotomy, NULL if none. */
+    static const Entry *findLiteral(const std::string &literal);
+
+    /** @return first entry of the value in alphabetical order, found by dichotomy, NULL if none. */
+    static const Entry *findValue(const T value);
 };
 
 typedef TypeConverter<DeviceTraits> DeviceConverter;